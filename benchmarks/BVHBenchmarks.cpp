@@ -0,0 +1,136 @@
+#include "ge/BVH.hpp"
+#include <benchmark/benchmark.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <random>
+
+namespace
+{
+	std::vector<BoundingBox> random_boxes(int n, unsigned seed)
+	{
+		// keep density roughly constant, so query results grow linearly with object count
+		const float half_size = 10.f * std::cbrt((float)n);
+		std::mt19937 rng(seed);
+		std::uniform_real_distribution<float> pos(-half_size, half_size), ext(0.1f, 2.f);
+		std::vector<BoundingBox> boxes;
+		boxes.reserve(n);
+		for (int i = 0; i < n; i++)
+		{
+			glm::vec3 c(pos(rng), pos(rng), pos(rng));
+			glm::vec3 e(ext(rng), ext(rng), ext(rng));
+			boxes.emplace_back(c - e, c + e);
+		}
+		return boxes;
+	}
+
+	void fill(DynamicBVH& bvh, const std::vector<BoundingBox>& boxes, std::vector<int>& proxies)
+	{
+		proxies.clear();
+		for (int i = 0; i < (int)boxes.size(); i++)
+			proxies.push_back(bvh.create_proxy(boxes[i], i));
+	}
+}
+
+static void BM_BVHInsert(benchmark::State& state)
+{
+	const auto boxes = random_boxes((int)state.range(0), 1);
+	std::vector<int> proxies;
+	for (auto _ : state)
+	{
+		DynamicBVH bvh;
+		fill(bvh, boxes, proxies);
+		benchmark::DoNotOptimize(bvh.height());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_BVHRebuild(benchmark::State& state)
+{
+	const auto boxes = random_boxes((int)state.range(0), 1);
+	std::vector<int> proxies;
+	DynamicBVH bvh;
+	fill(bvh, boxes, proxies);
+	for (auto _ : state)
+	{
+		bvh.rebuild();
+		benchmark::DoNotOptimize(bvh.height());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// every object moves a bit each frame, as with continuously animated scene
+static void BM_BVHRefit(benchmark::State& state)
+{
+	auto boxes = random_boxes((int)state.range(0), 1);
+	std::vector<int> proxies;
+	DynamicBVH bvh;
+	fill(bvh, boxes, proxies);
+	std::mt19937 rng(2);
+	std::uniform_real_distribution<float> step(-0.05f, 0.05f);
+	for (auto _ : state)
+	{
+		for (int i = 0; i < (int)boxes.size(); i++)
+		{
+			const glm::vec3 d(step(rng), step(rng), step(rng));
+			boxes[i] = BoundingBox(boxes[i].min() + d, boxes[i].max() + d);
+			bvh.move_proxy(proxies[i], boxes[i]);
+		}
+		bvh.optimize();
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_BVHFrustumQuery(benchmark::State& state)
+{
+	const auto boxes = random_boxes((int)state.range(0), 1);
+	std::vector<int> proxies;
+	DynamicBVH bvh;
+	fill(bvh, boxes, proxies);
+	const glm::mat4 proj = glm::perspective(glm::radians(45.f), 16.f / 9.f, 0.1f, 500.f);
+	const glm::mat4 view = glm::lookAt(glm::vec3(0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec3(0.f, 1.f, 0.f));
+	const Frustum frustum(proj * view);
+	int64_t nvisible = 0;
+	for (auto _ : state)
+	{
+		bvh.query(frustum, [&nvisible](int, bool) { nvisible++; });
+	}
+	state.counters["visible"] = benchmark::Counter((double)nvisible, benchmark::Counter::kAvgIterations);
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_BVHRaycast(benchmark::State& state)
+{
+	const auto boxes = random_boxes((int)state.range(0), 1);
+	std::vector<int> proxies;
+	DynamicBVH bvh;
+	fill(bvh, boxes, proxies);
+	std::mt19937 rng(3);
+	std::uniform_real_distribution<float> dir(-1.f, 1.f);
+	std::vector<Ray> rays;
+	for (int i = 0; i < 1024; i++)
+		rays.emplace_back(glm::vec3(0.f), glm::normalize(glm::vec3(dir(rng), dir(rng), dir(rng))));
+	size_t r = 0;
+	for (auto _ : state)
+	{
+		const Ray& ray = rays[r++ & 1023];
+		const glm::vec3 inv_dir = safe_inverse(ray.direction);
+		float closest = 1e6f;
+		bvh.raycast(ray, closest, [&](int user, const Ray& ray, float max_t)
+			{
+				float t;
+				if (intersect_aabb(ray, inv_dir, boxes[user].min(), boxes[user].max(), max_t, t))
+				{
+					closest = t;
+					return t;
+				}
+				return max_t;
+			});
+		benchmark::DoNotOptimize(closest);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_BVHInsert)->RangeMultiplier(10)->Range(10'000, 1'000'000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_BVHRebuild)->RangeMultiplier(10)->Range(10'000, 1'000'000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_BVHRefit)->RangeMultiplier(10)->Range(10'000, 1'000'000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_BVHFrustumQuery)->RangeMultiplier(10)->Range(10'000, 1'000'000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_BVHRaycast)->RangeMultiplier(10)->Range(10'000, 1'000'000);
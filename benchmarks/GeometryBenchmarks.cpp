@@ -0,0 +1,150 @@
+#include "ge/Icosahedron.hpp"
+#include <benchmark/benchmark.h>
+#include <vector>
+
+namespace
+{
+	// exposes normal calculation, which objects otherwise run only when shading changes
+	struct Sphere : Icosahedron
+	{
+		explicit Sphere(int level)
+		{
+			subdivide_triangles(level);
+			project_points_on_sphere();
+		}
+		using Object3D::calc_normals;
+	};
+
+	// faces of icosahedron subdivided level times
+	int64_t face_count(int level)
+	{
+		return 20ll << (2 * level);
+	}
+}
+
+static void BM_IcosahedronSubdivide(benchmark::State& state)
+{
+	const int level = (int)state.range(0);
+	for (auto _ : state)
+	{
+		Icosahedron ico;
+		ico.subdivide_triangles(level);
+		ico.project_points_on_sphere();
+		benchmark::DoNotOptimize(ico.mesh(0).vertices().data());
+	}
+	state.SetItemsProcessed(state.iterations() * face_count(level));
+}
+
+// first transition to a mode computes meshes, measured on fresh copy of sphere each time
+static void BM_ApplyShadingFirst(benchmark::State& state)
+{
+	const Sphere source((int)state.range(0));
+	const auto mode = (Object3D::ShadingMode)state.range(1);
+	for (auto _ : state)
+	{
+		state.PauseTiming();
+		Sphere sphere = source;
+		state.ResumeTiming();
+		sphere.apply_shading(mode);
+		benchmark::DoNotOptimize(sphere.mesh(0).vertices().data());
+	}
+	state.SetItemsProcessed(state.iterations() * face_count((int)state.range(0)));
+}
+
+// later transitions between the same modes restore cached meshes
+static void BM_ApplyShadingCached(benchmark::State& state)
+{
+	Sphere sphere((int)state.range(0));
+	sphere.apply_shading(Object3D::ShadingMode::FLAT_SHADING);
+	sphere.apply_shading(Object3D::ShadingMode::SMOOTH_SHADING);
+	for (auto _ : state)
+	{
+		sphere.apply_shading(Object3D::ShadingMode::FLAT_SHADING);
+		sphere.apply_shading(Object3D::ShadingMode::SMOOTH_SHADING);
+		benchmark::DoNotOptimize(sphere.mesh(0).vertices().data());
+	}
+	state.SetItemsProcessed(state.iterations() * 2);
+}
+
+static void BM_CalcNormals(benchmark::State& state)
+{
+	Sphere sphere((int)state.range(0));
+	const auto mode = (Object3D::ShadingMode)state.range(1);
+	sphere.apply_shading(mode);
+	for (auto _ : state)
+	{
+		sphere.calc_normals(sphere.mesh(0), mode);
+		benchmark::DoNotOptimize(sphere.mesh(0).vertices().data());
+	}
+	state.SetItemsProcessed(state.iterations() * face_count((int)state.range(0)));
+}
+
+static void BM_FacesAsIndices(benchmark::State& state)
+{
+	Sphere sphere((int)state.range(0));
+	for (auto _ : state)
+	{
+		std::vector<GLuint> indices = sphere.mesh(0).faces_as_indices();
+		benchmark::DoNotOptimize(indices.data());
+	}
+	state.SetItemsProcessed(state.iterations() * face_count((int)state.range(0)));
+}
+
+// same indices written into preallocated memory, as with mapped buffer
+static void BM_WriteIndices(benchmark::State& state)
+{
+	Sphere sphere((int)state.range(0));
+	std::vector<GLuint> indices(sphere.mesh(0).index_count());
+	for (auto _ : state)
+	{
+		sphere.mesh(0).write_indices(indices.data());
+		benchmark::DoNotOptimize(indices.data());
+	}
+	state.SetItemsProcessed(state.iterations() * face_count((int)state.range(0)));
+}
+
+static void BM_CalculateBBox(benchmark::State& state)
+{
+	Sphere sphere((int)state.range(0));
+	for (auto _ : state)
+	{
+		BoundingBox bbox = sphere.calculate_bbox();
+		benchmark::DoNotOptimize(bbox);
+	}
+	state.SetItemsProcessed(state.iterations() * sphere.mesh(0).vertices().size());
+}
+
+static void BM_Center(benchmark::State& state)
+{
+	Sphere sphere((int)state.range(0));
+	for (auto _ : state)
+	{
+		glm::vec3 center = sphere.center();
+		benchmark::DoNotOptimize(center);
+	}
+	state.SetItemsProcessed(state.iterations() * sphere.mesh(0).vertices().size());
+}
+
+static void BM_NormalsAsLines(benchmark::State& state)
+{
+	Sphere sphere((int)state.range(0));
+	sphere.apply_shading(Object3D::ShadingMode::SMOOTH_SHADING);
+	std::vector<Vertex> lines;
+	for (auto _ : state)
+	{
+		sphere.normals_as_lines(sphere.mesh(0), lines);
+		benchmark::DoNotOptimize(lines.data());
+	}
+	state.SetItemsProcessed(state.iterations() * sphere.mesh(0).vertices().size());
+}
+
+// levels up to 8 (1.3M faces); shading of the largest ones takes seconds, so it stops at 6
+BENCHMARK(BM_IcosahedronSubdivide)->DenseRange(1, 8)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ApplyShadingFirst)->ArgsProduct({ benchmark::CreateDenseRange(2, 6, 2), { Object3D::FLAT_SHADING, Object3D::SMOOTH_SHADING } })->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ApplyShadingCached)->DenseRange(2, 6, 2)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_CalcNormals)->ArgsProduct({ benchmark::CreateDenseRange(2, 6, 2), { Object3D::FLAT_SHADING, Object3D::SMOOTH_SHADING } })->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_FacesAsIndices)->DenseRange(2, 8, 2)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_WriteIndices)->DenseRange(2, 8, 2)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_CalculateBBox)->DenseRange(2, 8, 2)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Center)->DenseRange(2, 8, 2)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_NormalsAsLines)->DenseRange(2, 6, 2)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,34 @@
+#include "ge/LightClusters.hpp"
+#include <benchmark/benchmark.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <random>
+
+namespace
+{
+	std::vector<glm::vec4> random_lights(int n, unsigned seed)
+	{
+		std::mt19937 rng(seed);
+		std::uniform_real_distribution<float> xy(-40.f, 40.f), depth(0.5f, 100.f), radius(0.5f, 5.f);
+		std::vector<glm::vec4> lights;
+		lights.reserve(n);
+		for (int i = 0; i < n; i++)
+			lights.emplace_back(xy(rng), xy(rng), -depth(rng), radius(rng));
+		return lights;
+	}
+}
+
+// range(0) - number of lights, range(1) - number of threads (0 - automatic)
+static void BM_LightClustersBuild(benchmark::State& state)
+{
+	const auto lights = random_lights((int)state.range(0), 1);
+	LightClusters clusters;
+	clusters.set_projection(glm::perspective(glm::radians(45.f), 16.f / 9.f, 0.1f, 100.f));
+	for (auto _ : state)
+	{
+		clusters.build(lights, (int)state.range(1));
+		benchmark::DoNotOptimize(clusters.light_indices().data());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_LightClustersBuild)->ArgsProduct({ { 100, 1'000, 10'000 }, { 1, 0 } })->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,144 @@
+#include "core/ModelLoader.hpp"
+#include "core/MeshCache.hpp"
+#include "core/Texture2D.hpp"
+#include "ge/Icosahedron.hpp"
+#include "support/RecordingGL.hpp"
+#include <benchmark/benchmark.h>
+#include <stb_image_write.h>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+	std::string temp_file(const std::string& name)
+	{
+		return (std::filesystem::temp_directory_path() / name).string();
+	}
+
+	// subdivided sphere with texture coordinates and normals, written once per level
+	const std::string& sphere_obj(int level)
+	{
+		static std::vector<std::string> files(16);
+		std::string& filename = files[level];
+		if (!filename.empty())
+			return filename;
+		Icosahedron ico;
+		ico.subdivide_triangles(level);
+		ico.project_points_on_sphere();
+		const Mesh& mesh = ico.mesh(0);
+		filename = temp_file("opengl_engine_sphere_" + std::to_string(level) + ".obj");
+		std::ofstream out(filename);
+		for (const Vertex& v : mesh.vertices())
+			out << "v " << v.position.x << ' ' << v.position.y << ' ' << v.position.z << '\n';
+		for (const Vertex& v : mesh.vertices())
+			out << "vt " << std::atan2(v.position.z, v.position.x) * 0.159155f + 0.5f << ' ' << v.position.y * 0.5f + 0.5f << '\n';
+		for (const Vertex& v : mesh.vertices())
+			out << "vn " << v.position.x << ' ' << v.position.y << ' ' << v.position.z << '\n';
+		for (const Face& f : mesh.faces())
+		{
+			out << 'f';
+			for (int i = 0; i < f.size; i++)
+				out << ' ' << f.data[i] + 1 << '/' << f.data[i] + 1 << '/' << f.data[i] + 1;
+			out << '\n';
+		}
+		return filename;
+	}
+
+	// noisy gradient, so png doesn't compress to nothing
+	const std::string& texture_png(int size)
+	{
+		static std::vector<std::pair<int, std::string>> files;
+		for (const auto& file : files)
+			if (file.first == size)
+				return file.second;
+		std::mt19937 rng(size);
+		std::uniform_int_distribution<int> noise(0, 31);
+		std::vector<unsigned char> pixels((size_t)size * size * 3);
+		for (int y = 0; y < size; y++)
+		{
+			for (int x = 0; x < size; x++)
+			{
+				unsigned char* p = &pixels[((size_t)y * size + x) * 3];
+				p[0] = (unsigned char)(x * 224 / size + noise(rng));
+				p[1] = (unsigned char)(y * 224 / size + noise(rng));
+				p[2] = (unsigned char)noise(rng);
+			}
+		}
+		files.emplace_back(size, temp_file("opengl_engine_texture_" + std::to_string(size) + ".png"));
+		stbi_write_png(files.back().second.c_str(), size, size, 3, pixels.data(), size * 3);
+		return files.back().second;
+	}
+}
+
+// same flags as scene loading models from command line
+static void BM_ModelLoaderLoad(benchmark::State& state)
+{
+	const int level = (int)state.range(0);
+	const std::string& filename = sphere_obj(level);
+	for (auto _ : state)
+	{
+		ModelLoader loader;
+		std::optional<ComplexModel> model = loader.load(filename, aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_GenBoundingBoxes);
+		if (!model)
+		{
+			state.SkipWithError("could not load generated obj");
+			break;
+		}
+		benchmark::DoNotOptimize(model->meshes().data());
+	}
+	state.SetItemsProcessed(state.iterations() * (20ll << (2 * level)));
+}
+
+// warm load of the same files, level 7 obj is about 100 MB
+static void BM_ModelLoaderLoadCached(benchmark::State& state)
+{
+	const int level = (int)state.range(0);
+	const std::string& filename = sphere_obj(level);
+	const unsigned int flags = aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_GenBoundingBoxes;
+	const MeshCache cache(temp_file("opengl_engine_mesh_cache"));
+	// first load imports the file and writes entry
+	ModelLoader(&cache).load(filename, flags);
+	if (!cache.load(filename, flags))
+	{
+		state.SkipWithError("could not write mesh cache entry");
+		return;
+	}
+	for (auto _ : state)
+	{
+		ModelLoader loader(&cache);
+		std::optional<ComplexModel> model = loader.load(filename, flags);
+		if (!model)
+		{
+			state.SkipWithError("could not load cached model");
+			break;
+		}
+		benchmark::DoNotOptimize(model->meshes().data());
+	}
+	state.SetItemsProcessed(state.iterations() * (20ll << (2 * level)));
+}
+
+// decoding only. texture object needs GL names, which recording backend hands out without context
+static void BM_TextureLoad(benchmark::State& state)
+{
+	const int size = (int)state.range(0);
+	const std::string& filename = texture_png(size);
+	RecordingGL gl;
+	{
+		Texture2D texture(1, 1, GL_RGB, GL_RGB, GL_UNSIGNED_BYTE);
+		stbi_set_flip_vertically_on_load(true);
+		for (auto _ : state)
+		{
+			auto data = texture.load(filename);
+			benchmark::DoNotOptimize(data.get());
+		}
+	}
+	state.SetBytesProcessed(state.iterations() * size * size * 3);
+}
+
+BENCHMARK(BM_ModelLoaderLoad)->DenseRange(2, 6, 2)->Arg(7)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ModelLoaderLoadCached)->DenseRange(2, 6, 2)->Arg(7)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_TextureLoad)->RangeMultiplier(4)->Range(256, 4096)->Unit(benchmark::kMillisecond);
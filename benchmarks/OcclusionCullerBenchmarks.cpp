@@ -0,0 +1,81 @@
+#include "ge/OcclusionCuller.hpp"
+#include "ge/Frustum.hpp"
+#include <benchmark/benchmark.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <random>
+
+namespace
+{
+	// city blocks on a grid with streets between them, camera stands in the street, so most buildings are hidden
+	struct City
+	{
+		City(int blocks_per_side, int objects, unsigned seed)
+		{
+			std::mt19937 rng(seed);
+			std::uniform_real_distribution<float> height(3.f, 30.f), unit(0.f, 1.f);
+			const float block = 10.f, street = 4.f;
+			const float half = blocks_per_side * (block + street) * 0.5f;
+			for (int z = 0; z < blocks_per_side; z++)
+			{
+				for (int x = 0; x < blocks_per_side; x++)
+				{
+					const glm::vec3 min(-half + x * (block + street) + street * 0.5f, 0.f, -half + z * (block + street) + street * 0.5f);
+					buildings.emplace_back(min, min + glm::vec3(block, height(rng), block));
+				}
+			}
+			const glm::mat4 view = glm::lookAt(glm::vec3(0.f, 1.7f, 0.f), glm::vec3(1.f, 1.7f, -3.f), glm::vec3(0.f, 1.f, 0.f));
+			view_projection = glm::perspective(glm::radians(45.f), 16.f / 9.f, 0.1f, 1000.f) * view;
+			// only objects which passed frustum culling reach occlusion culling
+			const Frustum frustum(view_projection);
+			while ((int)boxes.size() < objects)
+			{
+				const glm::vec3 c((unit(rng) * 2.f - 1.f) * half, unit(rng) * 10.f, (unit(rng) * 2.f - 1.f) * half);
+				const BoundingBox b(c - glm::vec3(0.5f), c + glm::vec3(0.5f));
+				if (frustum.intersects(b))
+					boxes.push_back(b);
+			}
+		}
+		std::vector<BoundingBox> buildings;
+		std::vector<BoundingBox> boxes;
+		glm::mat4 view_projection;
+	};
+}
+
+static void BM_OcclusionRasterize(benchmark::State& state)
+{
+	const City city((int)state.range(0), 0, 1);
+	OcclusionCuller culler;
+	for (auto _ : state)
+	{
+		culler.begin_frame(city.view_projection);
+		for (const BoundingBox& b : city.buildings)
+			culler.add_occluder(b);
+		culler.finish_occluders();
+		benchmark::DoNotOptimize(culler.depth(0, 0, 0));
+	}
+	state.counters["polygons"] = (double)culler.polygon_count();
+	state.SetItemsProcessed(state.iterations() * city.buildings.size());
+}
+
+static void BM_OcclusionQuery(benchmark::State& state)
+{
+	const City city(20, (int)state.range(0), 1);
+	OcclusionCuller culler;
+	culler.begin_frame(city.view_projection);
+	for (const BoundingBox& b : city.buildings)
+		culler.add_occluder(b);
+	culler.finish_occluders();
+	int visible = 0;
+	for (auto _ : state)
+	{
+		visible = 0;
+		for (const BoundingBox& b : city.boxes)
+			visible += culler.is_visible(b);
+		benchmark::DoNotOptimize(visible);
+	}
+	state.counters["visible"] = visible;
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_OcclusionRasterize)->RangeMultiplier(2)->Range(8, 32)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_OcclusionQuery)->RangeMultiplier(10)->Range(1'000, 100'000)->Unit(benchmark::kMicrosecond);
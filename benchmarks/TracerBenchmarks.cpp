@@ -0,0 +1,28 @@
+#include "core/Tracer.hpp"
+#include <benchmark/benchmark.h>
+
+// cost of one zone, Tracer::Zone is used directly so it's measured in builds without tracing too
+static void BM_TracerZone(benchmark::State& state)
+{
+	for (auto _ : state)
+	{
+		Tracer::Zone zone("zone");
+		benchmark::ClobberMemory();
+	}
+}
+
+static void BM_TracerNestedZones(benchmark::State& state)
+{
+	for (auto _ : state)
+	{
+		Tracer::Zone outer("outer");
+		{
+			Tracer::Zone inner("inner");
+			benchmark::ClobberMemory();
+		}
+	}
+}
+
+BENCHMARK(BM_TracerZone);
+BENCHMARK(BM_TracerNestedZones);
+BENCHMARK(BM_TracerZone)->Threads(4);
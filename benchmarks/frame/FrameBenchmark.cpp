@@ -0,0 +1,48 @@
+#include <iostream>
+#include <stdexcept>
+#include "./core/SceneRenderer.hpp"
+#include "./core/MainWindow.hpp"
+#include "./core/Tracer.hpp"
+
+// Renders scene headless along camera path with fixed time step and writes percentiles of frame measurements.
+// Defaults differ from engine only, all engine options can be passed, e.g.
+// OpenGLEngineFrameBenchmark --scene cubes:1000,spheres:100 --frames 1200 --report cubes.json
+// Exits with 77 (skipped test for ctest) when machine has no OpenGL 4.4 context
+int main(int argc, char** argv)
+{
+  LaunchOptions& options = SceneRenderer::launch_options();
+  options.headless = true;
+  options.frames = 600;
+  options.warmup_frames = 60;
+  options.camera_path = "orbit";
+  options.output.clear();
+  options.report = "benchmark.json";
+  if (auto error = options.parse(argc, argv))
+  {
+    std::cerr << *error << '\n' << LaunchOptions::usage();
+    return 1;
+  }
+  if (options.help)
+  {
+    std::cout << LaunchOptions::usage();
+    return 0;
+  }
+  try
+  {
+    auto& scene = SceneRenderer::instance();
+    scene.render();
+    if (!options.trace.empty() && !Tracer::save(options.trace))
+      std::cerr << "Could not write trace " << options.trace << '\n';
+  }
+  catch (const ContextError& e)
+  {
+    std::cerr << e.what() << '\n';
+    return 77;
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << e.what() << '\n';
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,94 @@
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cassert>
+#include <glm/gtc/constants.hpp>
+#include "CameraPath.hpp"
+
+CameraPath::CameraPath(std::vector<Keyframe> keyframes) : m_keyframes(std::move(keyframes))
+{
+  std::stable_sort(m_keyframes.begin(), m_keyframes.end(), [](const Keyframe& a, const Keyframe& b) { return a.time < b.time; });
+}
+
+std::optional<CameraPath> CameraPath::load(const std::string& filename)
+{
+  std::ifstream file(filename);
+  if (!file)
+    return std::nullopt;
+  std::vector<Keyframe> keyframes;
+  std::string line;
+  while (std::getline(file, line))
+  {
+    line = line.substr(0, line.find('#'));
+    std::istringstream stream(line);
+    Keyframe key;
+    if (!(stream >> key.time))
+      continue;
+    if (!(stream >> key.position.x >> key.position.y >> key.position.z >> key.target.x >> key.target.y >> key.target.z))
+      return std::nullopt;
+    keyframes.push_back(key);
+  }
+  if (keyframes.empty())
+    return std::nullopt;
+  return CameraPath(std::move(keyframes));
+}
+
+CameraPath CameraPath::orbit(const glm::vec3& center, float radius, float height, float duration)
+{
+  // spline through 12 points stays close to circle
+  constexpr int nkeys = 12;
+  std::vector<Keyframe> keyframes;
+  for (int i = 0; i < nkeys; i++)
+  {
+    const float angle = glm::two_pi<float>() * i / nkeys;
+    const glm::vec3 offset(std::cos(angle) * radius, height, std::sin(angle) * radius);
+    keyframes.push_back({ duration * i / nkeys, center + offset, center });
+  }
+  // exact copy of first point closes the loop
+  keyframes.push_back({ duration, keyframes[0].position, center });
+  return CameraPath(std::move(keyframes));
+}
+
+int CameraPath::segment(float time, float& t) const
+{
+  assert(m_keyframes.size() > 1);
+  const auto next = std::upper_bound(m_keyframes.begin(), m_keyframes.end(), time, [](float time, const Keyframe& key) { return time < key.time; });
+  const int i = std::clamp((int)(next - m_keyframes.begin()) - 1, 0, (int)m_keyframes.size() - 2);
+  const float length = m_keyframes[i + 1].time - m_keyframes[i].time;
+  t = length > 0.f ? std::clamp((time - m_keyframes[i].time) / length, 0.f, 1.f) : 1.f;
+  return i;
+}
+
+template<typename Getter>
+glm::vec3 CameraPath::sample(float time, Getter get) const
+{
+  if (m_keyframes.size() == 1)
+    return get(m_keyframes[0]);
+  float t;
+  const int i = segment(time, t);
+  const int last = (int)m_keyframes.size() - 1;
+  // closed path wraps around, so loop is smooth at its start. otherwise end points are repeated and spline
+  // doesn't overshoot there
+  const bool closed = last > 1 && get(m_keyframes[0]) == get(m_keyframes[last]);
+  const int prev = i > 0 ? i - 1 : (closed ? last - 1 : 0);
+  const int next = i + 2 <= last ? i + 2 : (closed ? 1 : last);
+  const glm::vec3 p0 = get(m_keyframes[prev]);
+  const glm::vec3 p1 = get(m_keyframes[i]);
+  const glm::vec3 p2 = get(m_keyframes[i + 1]);
+  const glm::vec3 p3 = get(m_keyframes[next]);
+  const float t2 = t * t;
+  const float t3 = t2 * t;
+  return 0.5f * (2.f * p1 + (p2 - p0) * t + (2.f * p0 - 5.f * p1 + 4.f * p2 - p3) * t2 + (3.f * p1 - p0 - 3.f * p2 + p3) * t3);
+}
+
+glm::vec3 CameraPath::position(float time) const
+{
+  assert(!m_keyframes.empty());
+  return sample(time, [](const Keyframe& key) { return key.position; });
+}
+
+glm::vec3 CameraPath::target(float time) const
+{
+  assert(!m_keyframes.empty());
+  return sample(time, [](const Keyframe& key) { return key.target; });
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <optional>
+#include <glm/glm.hpp>
+
+// Scripted camera movement for benchmarks and captures. Position and look at point are interpolated between
+// keyframes with Catmull-Rom spline, so camera passes through every keyframe and moves smoothly. Path whose last
+// keyframe repeats the first one is a loop. Before first and after last keyframe camera stays at the end points.
+class CameraPath
+{
+public:
+  struct Keyframe
+  {
+    float time;  // seconds, increasing
+    glm::vec3 position;
+    glm::vec3 target;
+  };
+public:
+  CameraPath() = default;
+  explicit CameraPath(std::vector<Keyframe> keyframes);
+  // lines "time px py pz tx ty tz", '#' starts comment. nullopt if file can't be read or has no keyframes
+  static std::optional<CameraPath> load(const std::string& filename);
+  // one turn around center in given time, looking at center
+  static CameraPath orbit(const glm::vec3& center, float radius, float height, float duration);
+  glm::vec3 position(float time) const;
+  glm::vec3 target(float time) const;
+  float duration() const { return m_keyframes.empty() ? 0.f : m_keyframes.back().time; }
+  const std::vector<Keyframe>& keyframes() const { return m_keyframes; }
+private:
+  // segment and parameter within it
+  int segment(float time, float& t) const;
+  template<typename Getter>
+  glm::vec3 sample(float time, Getter get) const;
+private:
+  std::vector<Keyframe> m_keyframes;
+};
@@ -52,6 +52,11 @@ void FrameBufferObject::attach_texture(Texture2D&& tex)
   m_texture = std::move(tex);
 }
 
+void FrameBufferObject::attach(const Texture2D& tex, GLenum attachment)
+{
+  glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, tex.id(), 0);
+}
+
 FrameBufferObject::~FrameBufferObject()
 {
   glDeleteFramebuffers(1, id_ref());
@@ -14,6 +14,8 @@ public:
   void attach_renderbuffer(int w, int h, GLenum internalformat, GLenum attachment);
   void attach_texture(int w, int h, GLint internalformat, GLint format, GLint type);
   void attach_texture(Texture2D&& tex);
+  // texture owned elsewhere, framebuffer has to be bound
+  void attach(const Texture2D& tex, GLenum attachment);
   void bind() const override;
   void unbind() const override;
   bool is_complete() const;
@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <numeric>
+#include "FrameProfiler.hpp"
+
+void FrameProfiler::History::push(float value)
+{
+  values[next] = value;
+  next = (next + 1) % history_size;
+  count = std::min(count + 1, history_size);
+}
+
+float FrameProfiler::History::min() const
+{
+  return count ? *std::min_element(values.begin(), values.begin() + count) : 0.f;
+}
+
+float FrameProfiler::History::max() const
+{
+  return count ? *std::max_element(values.begin(), values.begin() + count) : 0.f;
+}
+
+float FrameProfiler::History::average() const
+{
+  return count ? std::accumulate(values.begin(), values.begin() + count, 0.f) / count : 0.f;
+}
+
+FrameProfiler::~FrameProfiler()
+{
+  for (Frame& frame : m_frames)
+  {
+    if (frame.queries.size())
+      glDeleteQueries((GLsizei)frame.queries.size(), frame.queries.data());
+  }
+}
+
+void FrameProfiler::begin_frame()
+{
+  // oldest frame first, so histories stay in order
+  for (int i = 0; i < frames_in_flight; i++)
+    read(m_frames[(m_next + i) % frames_in_flight]);
+  // queries which are about to be reused are still running, their results are given up rather than waited for
+  Frame& frame = m_frames[m_next];
+  if (frame.pending)
+  {
+    for (size_t pass = 0; pass < frame.measured.size(); pass++)
+      m_passes[pass].gpu_dropped += frame.measured[pass];
+    frame.pending = false;
+  }
+  std::fill(frame.measured.begin(), frame.measured.end(), 0);
+}
+
+void FrameProfiler::begin_pass(int pass, const std::string& name)
+{
+  if (pass >= (int)m_passes.size())
+    m_passes.resize(pass + 1);
+  if (m_passes[pass].name.empty())
+    m_passes[pass].name = name;
+  Frame& frame = m_frames[m_next];
+  const size_t nqueries = frame.queries.size();
+  if (nqueries < 2 * (size_t)(pass + 1))
+  {
+    frame.queries.resize(2 * (pass + 1));
+    frame.measured.resize(pass + 1);
+    glGenQueries(GLsizei(frame.queries.size() - nqueries), frame.queries.data() + nqueries);
+  }
+  glQueryCounter(frame.queries[2 * pass], GL_TIMESTAMP);
+  m_pass_start = std::chrono::steady_clock::now();
+}
+
+void FrameProfiler::end_pass(int pass)
+{
+  Frame& frame = m_frames[m_next];
+  m_passes[pass].cpu_ms.push(std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - m_pass_start).count());
+  glQueryCounter(frame.queries[2 * pass + 1], GL_TIMESTAMP);
+  frame.measured[pass] = 1;
+  frame.last_query = frame.queries[2 * pass + 1];
+  frame.pending = true;
+}
+
+void FrameProfiler::end_frame()
+{
+  m_next = (m_next + 1) % frames_in_flight;
+}
+
+void FrameProfiler::read(Frame& frame)
+{
+  if (!frame.pending)
+    return;
+  GLint available = GL_FALSE;
+  glGetQueryObjectiv(frame.last_query, GL_QUERY_RESULT_AVAILABLE, &available);
+  if (!available)
+    return;
+  for (size_t pass = 0; pass < frame.measured.size(); pass++)
+  {
+    if (!frame.measured[pass])
+      continue;
+    GLuint64 begin = 0, end = 0;
+    glGetQueryObjectui64v(frame.queries[2 * pass], GL_QUERY_RESULT, &begin);
+    glGetQueryObjectui64v(frame.queries[2 * pass + 1], GL_QUERY_RESULT, &end);
+    m_passes[pass].gpu_ms.push((end - begin) / 1e6f);
+  }
+  frame.pending = false;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <glad/glad.h>
+#include "OpenGLObject.hpp"
+#include "GPUTimer.hpp"
+
+// CPU and GPU time of every pass of a frame. GPU time is the difference of timestamp queries written before and
+// after pass, so unlike GPUTimer passes may be measured while time elapsed query of whole frame is running.
+// Queries of several frames are in flight and read once available, results are kept in short rolling history.
+// When GPU is more than frames_in_flight frames behind, results of the oldest frame are dropped instead of waiting.
+// CPU time is only time of submitting pass commands.
+class FrameProfiler
+{
+public:
+  static constexpr int frames_in_flight = GPUTimer::frames_in_flight;
+  static constexpr int history_size = 120;
+  // last measurements, oldest first once history is full
+  struct History
+  {
+    std::array<float, history_size> values = {};
+    int count = 0;
+    int next = 0;
+    void push(float value);
+    float last() const { return values[(next + history_size - 1) % history_size]; }
+    float min() const;
+    float max() const;
+    float average() const;
+  };
+  struct PassTimes
+  {
+    std::string name;
+    History cpu_ms;
+    History gpu_ms;
+    int gpu_dropped = 0;  // measurements whose queries were reused before they finished
+  };
+public:
+  OnlyMovable(FrameProfiler)
+  FrameProfiler() = default;
+  ~FrameProfiler();
+  void begin_frame();
+  // passes are identified by index, name is taken once
+  void begin_pass(int pass, const std::string& name);
+  void end_pass(int pass);
+  void end_frame();
+  const std::vector<PassTimes>& passes() const { return m_passes; }
+private:
+  struct Frame
+  {
+    std::vector<GLuint> queries;    // begin and end timestamp per pass
+    std::vector<uint8_t> measured;  // passes which ran in frame
+    GLuint last_query = 0;          // timestamps finish in order, so whole frame is done when this one is
+    bool pending = false;
+  };
+private:
+  void read(Frame& frame);
+private:
+  std::array<Frame, frames_in_flight> m_frames;
+  std::vector<PassTimes> m_passes;
+  int m_next = 0;
+  std::chrono::steady_clock::time_point m_pass_start;
+};
@@ -0,0 +1,93 @@
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <sstream>
+#include "FrameRecorder.hpp"
+
+static std::string json_string(const std::string& str)
+{
+  std::string out = "\"";
+  for (char c : str)
+  {
+    if (c == '"' || c == '\\')
+      out += '\\';
+    out += c;
+  }
+  return out + '"';
+}
+
+static std::string json_number(double value)
+{
+  std::ostringstream os;
+  os.precision(6);
+  os << value;
+  return os.str();
+}
+
+void FrameRecorder::record(const std::string& metric, double value)
+{
+  auto it = std::find_if(m_metrics.begin(), m_metrics.end(), [&metric](const Metric& m) { return m.name == metric; });
+  if (it == m_metrics.end())
+  {
+    m_metrics.push_back({ metric, {} });
+    it = m_metrics.end() - 1;
+  }
+  it->samples.push_back(value);
+}
+
+void FrameRecorder::set_info(const std::string& key, const std::string& value)
+{
+  m_info.emplace_back(key, json_string(value));
+}
+
+void FrameRecorder::set_info(const std::string& key, double value)
+{
+  m_info.emplace_back(key, json_number(value));
+}
+
+const std::vector<double>* FrameRecorder::samples(const std::string& metric) const
+{
+  for (const Metric& m : m_metrics)
+  {
+    if (m.name == metric)
+      return &m.samples;
+  }
+  return nullptr;
+}
+
+FrameRecorder::Summary FrameRecorder::summarize(std::vector<double> values)
+{
+  Summary summary;
+  if (values.empty())
+    return summary;
+  std::sort(values.begin(), values.end());
+  const size_t n = values.size();
+  auto percentile = [&values, n](double p)
+    {
+      const size_t rank = (size_t)std::ceil(p / 100.0 * n);
+      return values[std::clamp<size_t>(rank, 1, n) - 1];
+    };
+  summary.count = (int)n;
+  summary.mean = std::accumulate(values.begin(), values.end(), 0.0) / n;
+  summary.p50 = percentile(50.0);
+  summary.p95 = percentile(95.0);
+  summary.p99 = percentile(99.0);
+  summary.max = values.back();
+  return summary;
+}
+
+void FrameRecorder::write_json(std::ostream& os) const
+{
+  os << "{\n";
+  for (const auto& [key, value] : m_info)
+    os << "  " << json_string(key) << ": " << value << ",\n";
+  os << "  \"metrics\": {";
+  for (size_t i = 0; i < m_metrics.size(); i++)
+  {
+    const Summary s = summarize(m_metrics[i].samples);
+    os << (i ? ",\n" : "\n") << "    " << json_string(m_metrics[i].name) << ": { \"count\": " << s.count
+      << ", \"mean\": " << json_number(s.mean) << ", \"p50\": " << json_number(s.p50) << ", \"p95\": " << json_number(s.p95)
+      << ", \"p99\": " << json_number(s.p99) << ", \"max\": " << json_number(s.max) << " }";
+  }
+  os << "\n  }\n}\n";
+}
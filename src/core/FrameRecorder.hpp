@@ -0,0 +1,38 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <ostream>
+
+// Per frame measurements of benchmark run, reported as distribution of every metric in JSON.
+// Metrics keep order of their first record
+class FrameRecorder
+{
+public:
+  struct Summary
+  {
+    int count = 0;
+    double mean = 0.0;
+    double p50 = 0.0;
+    double p95 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+  };
+public:
+  void record(const std::string& metric, double value);
+  // describes run (scene, resolution, commit), written as string or number next to metrics
+  void set_info(const std::string& key, const std::string& value);
+  void set_info(const std::string& key, double value);
+  const std::vector<double>* samples(const std::string& metric) const;
+  // nearest rank percentiles
+  static Summary summarize(std::vector<double> values);
+  void write_json(std::ostream& os) const;
+private:
+  struct Metric
+  {
+    std::string name;
+    std::vector<double> samples;
+  };
+  std::vector<Metric> m_metrics;
+  std::vector<std::pair<std::string, std::string>> m_info;  // values are already JSON
+};
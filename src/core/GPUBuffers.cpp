@@ -3,20 +3,33 @@
 GPUBuffers::GPUBuffers() 
 {
   vao = std::make_unique<VertexArrayObject>();
-  vbo = std::make_unique<VertexBufferObject>();
-  ebo = std::make_unique<ElementBufferObject>();
+  stream = std::make_unique<StreamingBuffer>();
 }
 
 void GPUBuffers::bind_all() 
 {
   vao->bind();
-  vbo->bind();
-  ebo->bind();
+  glBindBuffer(GL_ARRAY_BUFFER, stream->id());
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, stream->id());
 }
 
 void GPUBuffers::unbind_all() 
 {
   vao->unbind();
-  vbo->unbind();
-  ebo->unbind();
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+StreamingBuffer::Allocation GPUBuffers::stream_vertices(const void* data, size_t count, size_t stride)
+{
+  StreamingBuffer::Allocation alloc = stream->upload(data, count * stride, stride);
+  glBindBuffer(GL_ARRAY_BUFFER, alloc.buffer);
+  return alloc;
+}
+
+StreamingBuffer::Allocation GPUBuffers::stream_indices(const GLuint* data, size_t count)
+{
+  StreamingBuffer::Allocation alloc = stream->upload(data, count * sizeof(GLuint), sizeof(GLuint));
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, alloc.buffer);
+  return alloc;
 }
@@ -2,16 +2,19 @@
 
 #include <memory>
 #include "VertexArrayObject.hpp"
-#include "VertexBufferObject.hpp"
-#include "ElementBufferObject.hpp"
+#include "StreamingBuffer.hpp"
 
 struct GPUBuffers 
 {
   GPUBuffers();
   void bind_all();
   void unbind_all();
+  // copy data of current draw into streaming buffer and bind it as vertex or element buffer.
+  // data can be null, then caller writes into returned allocation itself. link vertex attributes afterwards,
+  // because streaming buffer may be recreated by any allocation
+  StreamingBuffer::Allocation stream_vertices(const void* data, size_t count, size_t stride);
+  StreamingBuffer::Allocation stream_indices(const GLuint* data, size_t count);
 
   std::unique_ptr<VertexArrayObject> vao;
-  std::unique_ptr<VertexBufferObject> vbo;
-  std::unique_ptr<ElementBufferObject> ebo;
+  std::unique_ptr<StreamingBuffer> stream;
 };
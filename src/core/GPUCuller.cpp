@@ -0,0 +1,156 @@
+#include <cassert>
+#include <algorithm>
+#include "GPUCuller.hpp"
+#include "./ge/Frustum.hpp"
+
+static GLuint create_storage_buffer()
+{
+  GLuint buffer = 0;
+  glGenBuffers(1, &buffer);
+  return buffer;
+}
+
+// empty buffers can't be bound to indexed targets, so there is always at least one element
+template<typename T>
+static void upload_storage(GLuint buffer, const std::vector<T>& data, GLenum usage)
+{
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+  glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(T) * std::max<size_t>(data.size(), 1), data.empty() ? nullptr : data.data(), usage);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+GPUCuller::GPUCuller(const char* shader_file)
+{
+  GLint major = 0, minor = 0;
+  glGetIntegerv(GL_MAJOR_VERSION, &major);
+  glGetIntegerv(GL_MINOR_VERSION, &minor);
+  // compute shaders are core since 4.3
+  if (major * 10 + minor >= 43)
+  {
+    m_shader.load_compute(shader_file);
+    m_supported = m_shader.is_linked();
+  }
+  m_draws_buffer.id = create_storage_buffer();
+  m_params_buffer.id = create_storage_buffer();
+  m_commands_buffer.id = create_storage_buffer();
+  m_buckets_buffer.id = create_storage_buffer();
+  m_counters_buffer.id = create_storage_buffer();
+}
+
+GPUCuller::~GPUCuller()
+{
+  glDeleteBuffers(1, &m_draws_buffer.id);
+  glDeleteBuffers(1, &m_params_buffer.id);
+  glDeleteBuffers(1, &m_commands_buffer.id);
+  glDeleteBuffers(1, &m_buckets_buffer.id);
+  glDeleteBuffers(1, &m_counters_buffer.id);
+}
+
+void GPUCuller::build(IndirectRenderer& renderer, const std::vector<std::unique_ptr<Object3D>>& objects)
+{
+  std::vector<CullDraw> draws;
+  std::vector<IndirectRenderer::DrawParams> params;
+  std::vector<uint32_t> bucket_firsts;
+  m_buckets.clear();
+  m_sources.clear();
+  // draws are laid out bucket by bucket, draw index of command is its position
+  for (const IndirectRenderer::Bucket& bucket : renderer.buckets())
+  {
+    if (bucket.commands.empty())
+      continue;
+    const uint32_t bucket_index = (uint32_t)m_buckets.size();
+    m_buckets.push_back({ bucket.texture, (uint32_t)draws.size(), (uint32_t)bucket.commands.size() });
+    bucket_firsts.push_back((uint32_t)draws.size());
+    for (size_t i = 0; i < bucket.commands.size(); i++)
+    {
+      const IndirectRenderer::DrawCommand& cmd = bucket.commands[i];
+      const IndirectRenderer::DrawSource& source = bucket.sources[i];
+      const BoundingBox bbox = objects[source.object]->world_bbox();
+      CullDraw draw;
+      draw.center = glm::vec4(bbox.center(), 0.f);
+      draw.extents = glm::vec4(bbox.extents(), 0.f);
+      draw.count = cmd.count;
+      draw.first_index = cmd.first_index;
+      draw.base_vertex = cmd.base_vertex;
+      draw.bucket = bucket_index;
+      draws.push_back(draw);
+      params.push_back(bucket.params[i]);
+      m_sources.push_back(source);
+    }
+  }
+  upload_storage(m_draws_buffer, draws, GL_STATIC_DRAW);
+  upload_storage(m_params_buffer, params, GL_STATIC_DRAW);
+  upload_storage(m_buckets_buffer, bucket_firsts, GL_STATIC_DRAW);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_commands_buffer);
+  glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(IndirectRenderer::DrawCommand) * std::max<size_t>(draws.size(), 1), nullptr, GL_DYNAMIC_COPY);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_counters_buffer);
+  glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GLuint) * std::max<size_t>(m_buckets.size(), 1), nullptr, GL_DYNAMIC_COPY);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+  m_arena_version = renderer.arena().version();
+}
+
+void GPUCuller::cull(const glm::mat4& view_projection)
+{
+  assert(m_supported);
+  if (m_sources.empty())
+    return;
+  const Frustum frustum(view_projection);
+  glm::vec4 planes[Frustum::PLANE_COUNT];
+  for (int i = 0; i < Frustum::PLANE_COUNT; i++)
+    planes[i] = frustum.plane(static_cast<Frustum::Plane>(i));
+
+  // zeroed commands draw nothing, so culled draws at the end of buckets don't need separate count
+  const GLuint zero = 0;
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_commands_buffer);
+  glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_counters_buffer);
+  glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+  m_shader.bind();
+  m_shader.set_vec4_array("frustumPlanes", planes, Frustum::PLANE_COUNT);
+  m_shader.set_uint("drawCount", (GLuint)m_sources.size());
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, m_draws_buffer);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 7, m_commands_buffer);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 8, m_buckets_buffer);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 9, m_counters_buffer);
+  glDispatchCompute((GLuint)((m_sources.size() + group_size - 1) / group_size), 1, 1);
+  m_shader.unbind();
+}
+
+int GPUCuller::draw(Shader& shader, IndirectRenderer& renderer)
+{
+  if (m_sources.empty())
+    return 0;
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_params_buffer);
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commands_buffer);
+  shader.set_bool("drawIndirect", true);
+  renderer.bind_vao(m_sources.size());
+  for (const Bucket& bucket : m_buckets)
+  {
+    glBindTexture(GL_TEXTURE_2D, bucket.texture);
+    glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)(sizeof(IndirectRenderer::DrawCommand) * bucket.first), (GLsizei)bucket.size, 0);
+  }
+  glBindTexture(GL_TEXTURE_2D, 0);
+  renderer.unbind_vao();
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+  shader.set_bool("drawIndirect", false);
+  return (int)m_buckets.size();
+}
+
+void GPUCuller::read_visible(std::vector<uint8_t>& visible) const
+{
+  visible.assign(m_sources.size(), 0);
+  if (m_sources.empty())
+    return;
+  std::vector<IndirectRenderer::DrawCommand> commands(m_sources.size());
+  glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_commands_buffer);
+  glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(IndirectRenderer::DrawCommand) * commands.size(), commands.data());
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+  for (const IndirectRenderer::DrawCommand& cmd : commands)
+  {
+    if (cmd.instance_count != 0)
+      visible[cmd.base_instance] = 1;
+  }
+}
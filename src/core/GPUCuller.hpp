@@ -0,0 +1,68 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "IndirectRenderer.hpp"
+#include "Shader.hpp"
+#include "./ge/Object3D.hpp"
+
+// Frustum culling of static batched meshes in compute shader. Commands, draw parameters and world bounds of
+// meshes are uploaded once when static content changes. Every frame shader tests bounds against frustum planes
+// and compacts commands of visible meshes to the front of their texture bucket in indirect buffer, which is
+// then drawn as is, so CPU does no work per object. Tail of every bucket is zeroed before culling, empty
+// commands are skipped by GPU (draw count can't be taken from buffer without GL 4.6 or ARB_indirect_parameters).
+class GPUCuller
+{
+public:
+  static constexpr int group_size = 64;
+public:
+  OnlyMovable(GPUCuller)
+  GPUCuller(const char* shader_file = "./src/glsl/cull.comp");
+  ~GPUCuller();
+  // false if context has no compute shaders or culling shader failed to build
+  bool is_supported() const { return m_supported; }
+  // takes draws submitted to renderer since its begin_frame as static content. object bounds are used for all
+  // meshes of object, so result matches culling of objects on CPU
+  void build(IndirectRenderer& renderer, const std::vector<std::unique_ptr<Object3D>>& objects);
+  // arena version of build, draws have to be rebuilt when allocations were moved
+  uint32_t arena_version() const { return m_arena_version; }
+  size_t draw_count() const { return m_sources.size(); }
+  const std::vector<IndirectRenderer::DrawSource>& draw_sources() const { return m_sources; }
+  // dispatches culling. draw has to be ordered after it with GL_COMMAND_BARRIER_BIT (render graph places it)
+  void cull(const glm::mat4& view_projection);
+  // returns number of multi draw calls
+  int draw(Shader& shader, IndirectRenderer& renderer);
+  // reads commands back and marks draw indices which passed culling. stalls, meant for tests and debugging
+  void read_visible(std::vector<uint8_t>& visible) const;
+private:
+  // matches CullDraw in cull.comp (std430)
+  struct CullDraw
+  {
+    glm::vec4 center;
+    glm::vec4 extents;
+    uint32_t count;
+    uint32_t first_index;
+    int32_t base_vertex;
+    uint32_t bucket;
+  };
+  struct Bucket
+  {
+    GLuint texture;
+    uint32_t first;  // first command of bucket in indirect buffer
+    uint32_t size;
+  };
+private:
+  Shader m_shader;
+  bool m_supported = false;
+  OpenGLIdWrapper<GLuint> m_draws_buffer;     // CullDraw per draw index
+  OpenGLIdWrapper<GLuint> m_params_buffer;    // IndirectRenderer::DrawParams per draw index
+  OpenGLIdWrapper<GLuint> m_commands_buffer;  // written by shader
+  OpenGLIdWrapper<GLuint> m_buckets_buffer;   // first command of every bucket
+  OpenGLIdWrapper<GLuint> m_counters_buffer;  // visible commands of every bucket
+  std::vector<Bucket> m_buckets;
+  std::vector<IndirectRenderer::DrawSource> m_sources;
+  uint32_t m_arena_version = ~0u;
+};
@@ -0,0 +1,177 @@
+#include <cassert>
+#include <algorithm>
+#include <limits>
+#include "GPUPicker.hpp"
+#include "ShaderStorage.hpp"
+
+using namespace GlobalState;
+
+GPUPicker::GPUPicker(int w, int h)
+{
+  glGenBuffers(1, &m_pbo.id);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pbo);
+  glBufferData(GL_PIXEL_PACK_BUFFER, region_size * region_size * sizeof(GLuint), nullptr, GL_STREAM_READ);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  resize(w, h);
+}
+
+GPUPicker::~GPUPicker()
+{
+  if (m_fence)
+    glDeleteSync(m_fence);
+  glDeleteBuffers(1, &m_pbo.id);
+}
+
+void GPUPicker::resize(int w, int h)
+{
+  m_width = w;
+  m_height = h;
+  m_fbo.bind();
+  m_fbo.attach_texture(w, h, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT);
+  m_fbo.attach_renderbuffer(w, h, GL_DEPTH_COMPONENT24, GL_DEPTH_ATTACHMENT);
+  assert(m_fbo.is_complete());
+  m_fbo.unbind();
+}
+
+void GPUPicker::request(int x, int y)
+{
+  m_request = glm::ivec2(x, y);
+}
+
+void GPUPicker::render(const std::vector<std::unique_ptr<Object3D>>& objects, const std::vector<uint8_t>& visible,
+  const glm::mat4& view, const glm::mat4& projection, GPUBuffers* gpu_buffers, const VisibilityBuffer* visibility)
+{
+  if (!m_request || m_fence)
+    return;
+  const glm::ivec2 cursor = *m_request;
+  m_request.reset();
+  if (cursor.x < 0 || cursor.y < 0 || cursor.x >= m_width || cursor.y >= m_height)
+    return;
+  const int half = region_size / 2;
+  m_region_origin = glm::ivec2(std::max(cursor.x - half, 0), std::max(cursor.y - half, 0));
+  m_region_size = glm::ivec2(std::min(cursor.x + half + 1, m_width) - m_region_origin.x, std::min(cursor.y + half + 1, m_height) - m_region_origin.y);
+  m_region_cursor = glm::ivec2(cursor.x - m_region_origin.x, cursor.y - m_region_origin.y);
+  m_ranges.clear();
+
+  if (visibility && visibility->has_frame())
+  {
+    // ids of draws are already there, every draw is one mesh
+    const auto& sources = visibility->draw_sources();
+    for (int d = 0; d < (int)sources.size(); d++)
+      m_ranges.push_back({ VisibilityBuffer::first_id(d), sources[d].object, sources[d].mesh });
+    visibility->fbo().bind();
+  }
+  else
+  {
+    render_ids(objects, visible, view, projection, gpu_buffers);
+  }
+
+  // copy into pixel buffer. returns immediately, data is fetched by GPU later
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pbo);
+  glReadBuffer(GL_COLOR_ATTACHMENT0);
+  glReadPixels(m_region_origin.x, m_region_origin.y, m_region_size.x, m_region_size.y, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  m_fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  m_fbo.unbind();
+}
+
+void GPUPicker::render_ids(const std::vector<std::unique_ptr<Object3D>>& objects, const std::vector<uint8_t>& visible,
+  const glm::mat4& view, const glm::mat4& projection, GPUBuffers* gpu_buffers)
+{
+  m_fbo.bind();
+  // previous pass may have left viewport of scaled scene target
+  GLint viewport[4];
+  glGetIntegerv(GL_VIEWPORT, viewport);
+  glViewport(0, 0, m_width, m_height);
+  glEnable(GL_SCISSOR_TEST);
+  glScissor(m_region_origin.x, m_region_origin.y, m_region_size.x, m_region_size.y);
+  const GLuint background = 0;
+  glClearBufferuiv(GL_COLOR, 0, &background);
+  glClear(GL_DEPTH_BUFFER_BIT);
+  glEnable(GL_DEPTH_TEST);
+
+  Shader& shader = ShaderStorage::get(ShaderStorage::PICKING);
+  shader.bind();
+  shader.set_matrix4f("viewMatrix", view);
+  shader.set_matrix4f("projectionMatrix", projection);
+  // id 0 is background, so ids of primitives start from 1
+  GLuint next_id = 1;
+  for (int i = 0; i < (int)objects.size(); i++)
+  {
+    if (i < (int)visible.size() && !visible[i])
+      continue;
+    Object3D* pobj = objects[i].get();
+    shader.set_matrix4f("modelMatrix", pobj->model_matrix());
+    shader.set_uint("objectIdBase", next_id);
+    for (int m = 0; m < (int)pobj->meshes().size(); m++)
+    {
+      m_ranges.push_back({ next_id, i, m });
+      next_id += pobj->primitive_count(m);
+    }
+    pobj->render(gpu_buffers, Object3D::RenderPass::PICKING);
+  }
+  shader.unbind();
+  glDisable(GL_SCISSOR_TEST);
+  glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+}
+
+std::optional<GPUPicker::Result> GPUPicker::poll()
+{
+  if (!m_fence)
+    return std::nullopt;
+  const GLenum status = glClientWaitSync(m_fence, 0, 0);
+  if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+    return std::nullopt;
+  glDeleteSync(m_fence);
+  m_fence = nullptr;
+
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pbo);
+  const GLsizeiptr size = m_region_size.x * m_region_size.y * sizeof(GLuint);
+  const GLuint* ids = static_cast<const GLuint*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT));
+  // pixel under cursor, otherwise the closest one which is not background
+  GLuint id = 0;
+  int best_dist = std::numeric_limits<int>::max();
+  for (int y = 0; ids && y < m_region_size.y; y++)
+  {
+    for (int x = 0; x < m_region_size.x; x++)
+    {
+      const GLuint value = ids[y * m_region_size.x + x];
+      const int dist = (x - m_region_cursor.x) * (x - m_region_cursor.x) + (y - m_region_cursor.y) * (y - m_region_cursor.y);
+      if (value != 0 && dist < best_dist)
+      {
+        best_dist = dist;
+        id = value;
+      }
+    }
+  }
+  if (ids)
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  return decode(id);
+}
+
+void GPUPicker::cancel()
+{
+  if (!m_fence)
+    return;
+  glDeleteSync(m_fence);
+  m_fence = nullptr;
+  if (!m_request)
+    m_request = m_region_origin + m_region_cursor;
+}
+
+GPUPicker::Result GPUPicker::decode(GLuint id) const
+{
+  Result result;
+  if (id == 0)
+    return result;
+  // last range which starts not after id
+  auto it = std::upper_bound(m_ranges.begin(), m_ranges.end(), id, [](GLuint value, const MeshRange& range) { return value < range.first_id; });
+  if (it == m_ranges.begin())
+    return result;
+  --it;
+  result.object = it->object;
+  result.mesh = it->mesh;
+  result.primitive = (int)(id - it->first_id);
+  return result;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <optional>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "FrameBufferObject.hpp"
+#include "GPUBuffers.hpp"
+#include "VisibilityBuffer.hpp"
+#include "./ge/Object3D.hpp"
+
+// Picking by rendering ids of primitives into R32UI target.
+// Renders only when query is pending and only inside of small region around the cursor. Readback goes through
+// pixel buffer and fence, so result is available a frame or two later and render thread never waits for GPU.
+class GPUPicker
+{
+public:
+  struct Result
+  {
+    int object = -1;     // -1 if there was nothing under cursor
+    int mesh = -1;
+    int primitive = -1;  // triangle of surface or segment of line strip
+  };
+  // side of square around cursor which is rendered and read back. lines close to cursor are picked too
+  static constexpr int region_size = 7;
+public:
+  OnlyMovable(GPUPicker)
+  GPUPicker(int w, int h);
+  ~GPUPicker();
+  void resize(int w, int h);
+  // query at pixel in window coordinates with origin at bottom left. newer query replaces pending one
+  void request(int x, int y);
+  bool has_request() const { return m_request.has_value(); }
+  // query waits for render or its readback is in flight
+  bool busy() const { return m_request.has_value() || m_fence != nullptr; }
+  // renders pending query and starts asynchronous readback. does nothing while previous readback is in flight.
+  // if visibility buffer holds a frame, its ids are read instead of rendering (only batched meshes are pickable then)
+  void render(const std::vector<std::unique_ptr<Object3D>>& objects, const std::vector<uint8_t>& visible,
+    const glm::mat4& view, const glm::mat4& projection, GPUBuffers* gpu_buffers, const VisibilityBuffer* visibility = nullptr);
+  // returns result once readback finished, never waits for it
+  std::optional<Result> poll();
+  // objects were added or removed, so ids of readback in flight may refer to other objects. it's dropped and
+  // its query is rendered again with current objects, unless newer query replaced it
+  void cancel();
+private:
+  // first id of every drawn mesh, sorted by id
+  struct MeshRange
+  {
+    GLuint first_id;
+    int object;
+    int mesh;
+  };
+  void render_ids(const std::vector<std::unique_ptr<Object3D>>& objects, const std::vector<uint8_t>& visible,
+    const glm::mat4& view, const glm::mat4& projection, GPUBuffers* gpu_buffers);
+  Result decode(GLuint id) const;
+private:
+  FrameBufferObject m_fbo;
+  OpenGLIdWrapper<GLuint> m_pbo;
+  GLsync m_fence = nullptr;
+  std::optional<glm::ivec2> m_request;
+  glm::ivec2 m_region_origin = glm::ivec2(0, 0);  // of region in flight
+  glm::ivec2 m_region_cursor = glm::ivec2(0, 0);  // cursor relative to region origin
+  glm::ivec2 m_region_size = glm::ivec2(0, 0);
+  std::vector<MeshRange> m_ranges;
+  int m_width;
+  int m_height;
+};
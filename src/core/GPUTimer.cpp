@@ -0,0 +1,46 @@
+#include "GPUTimer.hpp"
+
+GPUTimer::GPUTimer()
+{
+  glGenQueries(frames_in_flight, m_queries.data());
+}
+
+GPUTimer::~GPUTimer()
+{
+  glDeleteQueries(frames_in_flight, m_queries.data());
+}
+
+void GPUTimer::begin()
+{
+  // oldest query first, so last_ms ends up with the newest result
+  for (int i = 0; i < frames_in_flight; i++)
+    read((m_next + i) % frames_in_flight, false);
+  // query which is about to be reused has to be finished. happens only when GPU is more than few frames behind
+  read(m_next, true);
+  glBeginQuery(GL_TIME_ELAPSED, m_queries[m_next]);
+}
+
+void GPUTimer::end()
+{
+  glEndQuery(GL_TIME_ELAPSED);
+  m_pending[m_next] = true;
+  m_next = (m_next + 1) % frames_in_flight;
+}
+
+void GPUTimer::read(int query, bool wait)
+{
+  if (!m_pending[query])
+    return;
+  GLint available = GL_FALSE;
+  if (!wait)
+  {
+    glGetQueryObjectiv(m_queries[query], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available)
+      return;
+  }
+  GLuint64 ns = 0;
+  glGetQueryObjectui64v(m_queries[query], GL_QUERY_RESULT, &ns);
+  m_last_ms = ns / 1e6f;
+  m_measurements++;
+  m_pending[query] = false;
+}
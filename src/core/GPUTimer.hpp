@@ -0,0 +1,32 @@
+#pragma once
+
+#include <array>
+#include <glad/glad.h>
+#include "OpenGLObject.hpp"
+
+// Measures GPU time of commands between begin and end with timer queries. Queries of several frames are in
+// flight and results are read once available, so measurement doesn't make CPU wait for GPU.
+// Time elapsed queries can't be nested, only one timer may be running at once.
+class GPUTimer
+{
+public:
+  static constexpr int frames_in_flight = 3;
+public:
+  OnlyMovable(GPUTimer)
+  GPUTimer();
+  ~GPUTimer();
+  void begin();
+  void end();
+  // latest finished measurement, negative until first one is available
+  float last_ms() const { return m_last_ms; }
+  // number of finished measurements, changes when last_ms has new result
+  int measurements() const { return m_measurements; }
+private:
+  void read(int query, bool wait);
+private:
+  std::array<GLuint, frames_in_flight> m_queries = {};
+  std::array<bool, frames_in_flight> m_pending = {};
+  int m_next = 0;
+  float m_last_ms = -1.f;
+  int m_measurements = 0;
+};
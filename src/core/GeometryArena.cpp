@@ -0,0 +1,138 @@
+#include <cassert>
+#include "GeometryArena.hpp"
+
+static GLuint create_buffer(size_t size_in_bytes)
+{
+  GLuint id;
+  glGenBuffers(1, &id);
+  // bind to copy target to not disturb element buffer binding of currently bound vertex array
+  glBindBuffer(GL_COPY_WRITE_BUFFER, id);
+  glBufferData(GL_COPY_WRITE_BUFFER, size_in_bytes, nullptr, GL_STATIC_DRAW);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+  return id;
+}
+
+GeometryArena::GeometryArena(uint32_t vertex_capacity, uint32_t index_capacity)
+{
+  m_vbo.id = create_buffer(sizeof(Vertex) * (size_t)vertex_capacity);
+  m_ebo.id = create_buffer(sizeof(GLuint) * (size_t)index_capacity);
+  m_vertex_ranges.reset(vertex_capacity);
+  m_index_ranges.reset(index_capacity);
+}
+
+GeometryArena::~GeometryArena()
+{
+  glDeleteBuffers(1, &m_vbo.id);
+  glDeleteBuffers(1, &m_ebo.id);
+}
+
+int GeometryArena::allocate(const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices)
+{
+  const uint32_t nvertices = (uint32_t)vertices.size();
+  const uint32_t nindices = (uint32_t)indices.size();
+  std::optional<uint32_t> first_vertex = m_vertex_ranges.allocate(nvertices);
+  std::optional<uint32_t> first_index = m_index_ranges.allocate(nindices);
+  if ((nvertices && !first_vertex) || (nindices && !first_index))
+  {
+    if (first_vertex)
+      m_vertex_ranges.free(*first_vertex, nvertices);
+    if (first_index)
+      m_index_ranges.free(*first_index, nindices);
+    // at least double the size, so series of allocations causes only few copies
+    relocate(std::max(m_vertex_ranges.capacity() * 2, m_vertex_ranges.used() + nvertices),
+      std::max(m_index_ranges.capacity() * 2, m_index_ranges.used() + nindices));
+    first_vertex = m_vertex_ranges.allocate(nvertices);
+    first_index = m_index_ranges.allocate(nindices);
+  }
+  Allocation alloc;
+  alloc.first_vertex = first_vertex.value_or(0);
+  alloc.vertex_count = nvertices;
+  alloc.first_index = first_index.value_or(0);
+  alloc.index_count = nindices;
+
+  glBindBuffer(GL_COPY_WRITE_BUFFER, m_vbo);
+  glBufferSubData(GL_COPY_WRITE_BUFFER, sizeof(Vertex) * (size_t)alloc.first_vertex, sizeof(Vertex) * vertices.size(), vertices.data());
+  glBindBuffer(GL_COPY_WRITE_BUFFER, m_ebo);
+  glBufferSubData(GL_COPY_WRITE_BUFFER, sizeof(GLuint) * (size_t)alloc.first_index, sizeof(GLuint) * indices.size(), indices.data());
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+  int handle;
+  if (m_free_handles.size())
+  {
+    handle = m_free_handles.back();
+    m_free_handles.pop_back();
+    m_allocations[handle] = alloc;
+    m_alive[handle] = 1;
+  }
+  else
+  {
+    handle = (int)m_allocations.size();
+    m_allocations.push_back(alloc);
+    m_alive.push_back(1);
+  }
+  return handle;
+}
+
+void GeometryArena::free(int handle)
+{
+  assert(handle >= 0 && handle < (int)m_allocations.size() && m_alive[handle]);
+  const Allocation& alloc = m_allocations[handle];
+  m_vertex_ranges.free(alloc.first_vertex, alloc.vertex_count);
+  m_index_ranges.free(alloc.first_index, alloc.index_count);
+  m_alive[handle] = 0;
+  m_free_handles.push_back(handle);
+  m_dirty = true;
+}
+
+void GeometryArena::defragment()
+{
+  relocate(m_vertex_ranges.capacity(), m_index_ranges.capacity());
+}
+
+void GeometryArena::maintain()
+{
+  if (m_dirty && fragmentation() > defragment_threshold)
+    defragment();
+  m_dirty = false;
+}
+
+void GeometryArena::relocate(uint32_t vertex_capacity, uint32_t index_capacity)
+{
+  // copy live allocations one after another into new buffers. copy happens on GPU, nothing is read back
+  GLuint vbo = create_buffer(sizeof(Vertex) * (size_t)vertex_capacity);
+  GLuint ebo = create_buffer(sizeof(GLuint) * (size_t)index_capacity);
+  uint32_t next_vertex = 0, next_index = 0;
+  for (size_t i = 0; i < m_allocations.size(); i++)
+  {
+    if (!m_alive[i])
+      continue;
+    Allocation& alloc = m_allocations[i];
+    if (alloc.vertex_count)
+    {
+      glBindBuffer(GL_COPY_READ_BUFFER, m_vbo);
+      glBindBuffer(GL_COPY_WRITE_BUFFER, vbo);
+      glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, sizeof(Vertex) * (size_t)alloc.first_vertex,
+        sizeof(Vertex) * (size_t)next_vertex, sizeof(Vertex) * (size_t)alloc.vertex_count);
+    }
+    if (alloc.index_count)
+    {
+      glBindBuffer(GL_COPY_READ_BUFFER, m_ebo);
+      glBindBuffer(GL_COPY_WRITE_BUFFER, ebo);
+      glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, sizeof(GLuint) * (size_t)alloc.first_index,
+        sizeof(GLuint) * (size_t)next_index, sizeof(GLuint) * (size_t)alloc.index_count);
+    }
+    alloc.first_vertex = next_vertex;
+    alloc.first_index = next_index;
+    next_vertex += alloc.vertex_count;
+    next_index += alloc.index_count;
+  }
+  glBindBuffer(GL_COPY_READ_BUFFER, 0);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+  glDeleteBuffers(1, &m_vbo.id);
+  glDeleteBuffers(1, &m_ebo.id);
+  m_vbo.id = vbo;
+  m_ebo.id = ebo;
+  m_vertex_ranges.reset(vertex_capacity, next_vertex);
+  m_index_ranges.reset(index_capacity, next_index);
+  m_version++;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <glad/glad.h>
+#include "OpenGLObject.hpp"
+#include "./ge/Vertex.hpp"
+#include "./utils/RangeAllocator.hpp"
+
+// Shared vertex and index buffers for static meshes, so many meshes can be drawn without rebinding buffers.
+// Meshes are sub-allocated from free lists. Indices stay relative to the first vertex of their mesh, therefore
+// whole mesh can be moved by GPU side copy without touching indices when arena grows or gets compacted.
+class GeometryArena
+{
+public:
+  struct Allocation
+  {
+    uint32_t first_vertex = 0;
+    uint32_t vertex_count = 0;
+    uint32_t first_index = 0;
+    uint32_t index_count = 0;
+  };
+  // compact when more than this share of free space is unusable for large allocations
+  static constexpr float defragment_threshold = 0.5f;
+public:
+  OnlyMovable(GeometryArena)
+  GeometryArena(uint32_t vertex_capacity = 1 << 16, uint32_t index_capacity = 1 << 18);
+  ~GeometryArena();
+  // returns handle. grows buffers if there is no free range big enough
+  int allocate(const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices);
+  void free(int handle);
+  const Allocation& allocation(int handle) const { return m_allocations[handle]; }
+  // moves all allocations to the beginning of buffers, offsets of allocations change
+  void defragment();
+  // defragments if free space is too fragmented. cheap to call every frame
+  void maintain();
+  float fragmentation() const { return std::max(m_vertex_ranges.fragmentation(), m_index_ranges.fragmentation()); }
+  GLuint vertex_buffer() const { return m_vbo; }
+  GLuint index_buffer() const { return m_ebo; }
+  // changes whenever buffers were recreated, vertex array objects which refer to them must be updated
+  uint32_t version() const { return m_version; }
+  int allocation_count() const { return (int)m_allocations.size() - (int)m_free_handles.size(); }
+private:
+  void relocate(uint32_t vertex_capacity, uint32_t index_capacity);
+private:
+  OpenGLIdWrapper<GLuint> m_vbo;
+  OpenGLIdWrapper<GLuint> m_ebo;
+  RangeAllocator m_vertex_ranges;
+  RangeAllocator m_index_ranges;
+  std::vector<Allocation> m_allocations;
+  std::vector<uint8_t> m_alive;
+  std::vector<int> m_free_handles;
+  bool m_dirty = false;     // something was freed since last compaction
+  uint32_t m_version = 0;
+};
@@ -0,0 +1,187 @@
+#include <cassert>
+#include <cstring>
+#include <numeric>
+#include <iterator>
+#include "IndirectRenderer.hpp"
+
+bool IndirectRenderer::is_batchable(const Object3D& obj)
+{
+  return obj.has_surface() && !obj.is_normals_visible() && !obj.is_bbox_visible();
+}
+
+IndirectRenderer::IndirectRenderer()
+{
+  glGenBuffers(1, &m_draw_index_buffer.id);
+  GLint alignment = 0;
+  glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+  m_storage_alignment = std::max<size_t>(alignment, 16);
+}
+
+IndirectRenderer::~IndirectRenderer()
+{
+  glDeleteBuffers(1, &m_draw_index_buffer.id);
+}
+
+void IndirectRenderer::add_object()
+{
+  m_handles.emplace_back();
+}
+
+void IndirectRenderer::remove_object(int index)
+{
+  assert(index >= 0 && index < (int)m_handles.size());
+  for (int handle : m_handles[index])
+  {
+    if (handle >= 0)
+      m_arena.free(handle);
+  }
+  m_handles.erase(m_handles.begin() + index);
+}
+
+void IndirectRenderer::upload(int index, const Object3D& obj)
+{
+  std::vector<int>& handles = m_handles[index];
+  for (int handle : handles)
+  {
+    if (handle >= 0)
+      m_arena.free(handle);
+  }
+  handles.clear();
+  for (const Mesh& mesh : obj.meshes())
+  {
+    m_indices.resize(mesh.index_count());
+    mesh.write_indices(m_indices.data());
+    handles.push_back(m_indices.empty() ? -1 : m_arena.allocate(mesh.vertices(), m_indices));
+  }
+}
+
+void IndirectRenderer::begin_frame()
+{
+  for (Bucket& bucket : m_buckets)
+  {
+    bucket.commands.clear();
+    bucket.params.clear();
+    bucket.sources.clear();
+  }
+}
+
+void IndirectRenderer::submit(int index, const Object3D& obj)
+{
+  const std::vector<int>& handles = m_handles[index];
+  assert(handles.size() == obj.meshes().size());
+  const bool apply_shading = obj.shading_mode() != Object3D::ShadingMode::NO_SHADING && !obj.is_light_source();
+  for (size_t i = 0; i < handles.size(); i++)
+  {
+    if (handles[i] < 0)
+      continue;
+    const Mesh& mesh = obj.mesh(i);
+    const auto& texture = mesh.texture();
+    const GLuint tex_id = texture ? texture->id() : 0;
+    // scenes use only few textures, linear search is fine
+    auto bucket = std::find_if(m_buckets.begin(), m_buckets.end(), [tex_id](const Bucket& b) { return b.texture == tex_id; });
+    if (bucket == m_buckets.end())
+    {
+      m_buckets.emplace_back();
+      m_buckets.back().texture = tex_id;
+      bucket = std::prev(m_buckets.end());
+    }
+    const GeometryArena::Allocation& alloc = m_arena.allocation(handles[i]);
+    DrawCommand cmd;
+    cmd.count = alloc.index_count;
+    cmd.instance_count = 1;
+    cmd.first_index = alloc.first_index;
+    cmd.base_vertex = (GLint)alloc.first_vertex;
+    cmd.base_instance = 0;  // assigned in draw once order of all draws is known
+    bucket->commands.push_back(cmd);
+    DrawParams params;
+    params.model = obj.model_matrix();
+    params.flags = (apply_shading ? APPLY_SHADING : 0) | (texture && !texture->disabled() ? APPLY_TEXTURE : 0);
+    params.first_index = alloc.first_index;
+    params.base_vertex = (int32_t)alloc.first_vertex;
+    params.padding = 0;
+    bucket->params.push_back(params);
+    bucket->sources.push_back({ index, (int)i });
+  }
+}
+
+int IndirectRenderer::draw(Shader& shader, StreamingBuffer& stream)
+{
+  size_t total = 0;
+  m_draw_sources.clear();
+  for (Bucket& bucket : m_buckets)
+  {
+    for (DrawCommand& cmd : bucket.commands)
+      cmd.base_instance = (GLuint)total++;
+    m_draw_sources.insert(m_draw_sources.end(), bucket.sources.begin(), bucket.sources.end());
+  }
+  if (total == 0)
+    return 0;
+
+  // draw parameters of all buckets are stored one after another in order of draw index
+  const StreamingBuffer::Allocation params = stream.allocate(sizeof(DrawParams) * total, m_storage_alignment);
+  const StreamingBuffer::Allocation commands = stream.allocate(sizeof(DrawCommand) * total, sizeof(GLuint));
+  size_t offset = 0;
+  for (const Bucket& bucket : m_buckets)
+  {
+    memcpy(static_cast<DrawParams*>(params.data) + offset, bucket.params.data(), sizeof(DrawParams) * bucket.params.size());
+    memcpy(static_cast<DrawCommand*>(commands.data) + offset, bucket.commands.data(), sizeof(DrawCommand) * bucket.commands.size());
+    offset += bucket.commands.size();
+  }
+  glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 0, params.buffer, params.offset, sizeof(DrawParams) * total);
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commands.buffer);
+
+  shader.set_bool("drawIndirect", true);
+  bind_vao(total);
+  int ndraws = 0;
+  offset = 0;
+  for (const Bucket& bucket : m_buckets)
+  {
+    if (bucket.commands.empty())
+      continue;
+    glBindTexture(GL_TEXTURE_2D, bucket.texture);
+    glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)(commands.offset + sizeof(DrawCommand) * offset), (GLsizei)bucket.commands.size(), 0);
+    offset += bucket.commands.size();
+    ndraws++;
+  }
+  glBindTexture(GL_TEXTURE_2D, 0);
+  m_vao.unbind();
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+  shader.set_bool("drawIndirect", false);
+  return ndraws;
+}
+
+void IndirectRenderer::bind_vao(size_t draw_count)
+{
+  if (draw_count > m_draw_index_capacity)
+  {
+    m_draw_index_capacity = std::max((uint32_t)draw_count, m_draw_index_capacity * 2);
+    std::vector<GLuint> indices(m_draw_index_capacity);
+    std::iota(indices.begin(), indices.end(), 0);
+    glBindBuffer(GL_ARRAY_BUFFER, m_draw_index_buffer);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(GLuint) * indices.size(), indices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+  }
+  if (m_arena_version != m_arena.version())
+    link_vao();
+  m_vao.bind();
+}
+
+void IndirectRenderer::link_vao()
+{
+  m_vao.bind();
+  glBindBuffer(GL_ARRAY_BUFFER, m_arena.vertex_buffer());
+  m_vao.link_attrib(0, 3, GL_FLOAT, sizeof(Vertex), nullptr);                         // position
+  m_vao.link_attrib(1, 3, GL_FLOAT, sizeof(Vertex), (void*)(sizeof(GLfloat) * 3));    // normal
+  m_vao.link_attrib(2, 4, GL_FLOAT, sizeof(Vertex), (void*)(sizeof(GLfloat) * 6));    // color
+  m_vao.link_attrib(3, 2, GL_FLOAT, sizeof(Vertex), (void*)(sizeof(GLfloat) * 10));   // texture
+  glBindBuffer(GL_ARRAY_BUFFER, m_draw_index_buffer);
+  glVertexAttribIPointer(4, 1, GL_UNSIGNED_INT, sizeof(GLuint), nullptr);             // draw index
+  glEnableVertexAttribArray(4);
+  glVertexAttribDivisor(4, 1);
+  // element buffer binding is part of vertex array state
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_arena.index_buffer());
+  m_vao.unbind();
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+  m_arena_version = m_arena.version();
+}
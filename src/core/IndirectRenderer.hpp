@@ -0,0 +1,94 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "GeometryArena.hpp"
+#include "VertexArrayObject.hpp"
+#include "Shader.hpp"
+#include "StreamingBuffer.hpp"
+#include "./ge/Object3D.hpp"
+
+// Draws static meshes from shared geometry arena with one glMultiDrawElementsIndirect per texture.
+// Visible objects are submitted every frame, their model matrices and shading flags go into shader storage
+// buffer which is indexed by draw index in vertex shader. Objects are identified by their index in scene
+// and add_object/remove_object must mirror changes of scene object list.
+class IndirectRenderer
+{
+public:
+  // objects with helper lines (normals, bounds) are drawn one by one
+  static bool is_batchable(const Object3D& obj);
+public:
+  OnlyMovable(IndirectRenderer)
+  IndirectRenderer();
+  ~IndirectRenderer();
+  void add_object();
+  void remove_object(int index);
+  // (re)uploads geometry of object to arena
+  void upload(int index, const Object3D& obj);
+  bool has_geometry(int index) const { return m_handles[index].size() != 0; }
+  GeometryArena& arena() { return m_arena; }
+  void begin_frame();
+  void submit(int index, const Object3D& obj);
+  // returns number of multi draw calls. commands and draw parameters are written into streaming buffer
+  int draw(Shader& shader, StreamingBuffer& stream);
+public:
+  // matches DrawParams in draw_params.glsl (std430)
+  struct DrawParams
+  {
+    glm::mat4 model;
+    uint32_t flags;
+    uint32_t first_index;  // mesh location in arena, lets shaders fetch vertices of triangle
+    int32_t base_vertex;
+    uint32_t padding;
+  };
+  enum DrawFlag
+  {
+    APPLY_SHADING = (1 << 0),
+    APPLY_TEXTURE = (1 << 1)
+  };
+  // layout is defined by OpenGL
+  struct DrawCommand
+  {
+    GLuint count;
+    GLuint instance_count;
+    GLuint first_index;
+    GLint base_vertex;
+    GLuint base_instance;
+  };
+  struct DrawSource
+  {
+    int object;
+    int mesh;
+  };
+  // draws of bucket get consecutive draw indices starting from base instance of the first command
+  struct Bucket
+  {
+    GLuint texture = 0;
+    std::vector<DrawCommand> commands;
+    std::vector<DrawParams> params;
+    std::vector<DrawSource> sources;
+  };
+  const std::vector<Bucket>& buckets() const { return m_buckets; }
+  // object and mesh of every draw of the last draw call, in order of draw index
+  const std::vector<DrawSource>& draw_sources() const { return m_draw_sources; }
+  // binds arena vertex array which provides draw indices [0, draw_count) through base instance of commands
+  void bind_vao(size_t draw_count);
+  void unbind_vao() { m_vao.unbind(); }
+private:
+  void link_vao();
+private:
+  GeometryArena m_arena;
+  std::vector<std::vector<int>> m_handles;  // per scene object, arena allocation per mesh (-1 for empty mesh)
+  std::vector<Bucket> m_buckets;            // reused between frames, so submission doesn't allocate
+  std::vector<DrawSource> m_draw_sources;
+  std::vector<GLuint> m_indices;            // indices of uploaded mesh, capacity reused by next upload
+  VertexArrayObject m_vao;
+  // 0, 1, 2 ... read as instanced attribute. base instance of command selects draw index, so draw parameters
+  // can be found without gl_DrawID which needs GL 4.6 or ARB_shader_draw_parameters
+  OpenGLIdWrapper<GLuint> m_draw_index_buffer;
+  uint32_t m_draw_index_capacity = 0;
+  size_t m_storage_alignment = 16;
+  uint32_t m_arena_version = ~0u;
+};
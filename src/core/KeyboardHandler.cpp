@@ -42,6 +42,16 @@ KeyboardHandler::KeyState KeyboardHandler::get_keystate(InputKey key) const
   return m_keystate.at(key);
 }
 
+bool KeyboardHandler::has_pressed_keys() const
+{
+  for (const auto& [key, state] : m_keystate)
+  {
+    if (state == KeyState::PRESSED)
+      return true;
+  }
+  return false;
+}
+
 void KeyboardHandler::reset_state(InputKey key)
 {
   m_keystate[key] = NO_STATE;
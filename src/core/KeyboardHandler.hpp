@@ -21,6 +21,7 @@ public:
     SPACE = GLFW_KEY_SPACE,
     LEFT_CTRL = GLFW_KEY_LEFT_CONTROL,
     ESC = GLFW_KEY_ESCAPE,
+    DEL = GLFW_KEY_DELETE,
     UNKNOWN = 0xFFFF
   };
 
@@ -33,12 +34,14 @@ public:
 
   static constexpr InputKey registered_keys[] = {
     W, A, S, D, ARROW_UP, ARROW_DOWN, ARROW_LEFT, ARROW_RIGHT, LEFT_SHIFT,
-    ESC, T, R, SPACE, LEFT_CTRL
+    ESC, T, R, SPACE, LEFT_CTRL, DEL
   };
 
   OnlyMovable(KeyboardHandler)
   KeyboardHandler(MainWindow* window);
   KeyboardHandler::KeyState get_keystate(KeyboardHandler::InputKey key) const;
+  // some of registered keys is held down
+  bool has_pressed_keys() const;
   void reset_state(InputKey key);
 private:
   void key_callback(int key, int scancode, int action, int mods);
@@ -0,0 +1,189 @@
+#include <cstdio>
+#include <cstdlib>
+#include "LaunchOptions.hpp"
+
+static bool parse_int(const char* str, int& value)
+{
+  char* end = nullptr;
+  const long v = std::strtol(str, &end, 10);
+  if (end == str || *end != '\0')
+    return false;
+  value = (int)v;
+  return true;
+}
+
+static bool parse_float(const char* str, float& value)
+{
+  char* end = nullptr;
+  const float v = std::strtof(str, &end);
+  if (end == str || *end != '\0')
+    return false;
+  value = v;
+  return true;
+}
+
+// "x,y,z"
+static bool parse_vec3(const char* str, glm::vec3& value)
+{
+  char tail = 0;
+  return std::sscanf(str, "%f,%f,%f%c", &value.x, &value.y, &value.z, &tail) == 3;
+}
+
+std::optional<std::string> LaunchOptions::parse(int argc, const char* const* argv)
+{
+  for (int i = 1; i < argc; i++)
+  {
+    const std::string arg = argv[i];
+    if (arg == "--help" || arg == "-h")
+    {
+      help = true;
+      continue;
+    }
+    if (arg == "--headless")
+    {
+      headless = true;
+      continue;
+    }
+    if (arg == "--helper-lines")
+    {
+      helper_lines = true;
+      continue;
+    }
+    if (arg == "--no-mesh-cache")
+    {
+      mesh_cache.clear();
+      continue;
+    }
+    // the rest have value
+    if (i + 1 >= argc)
+      return "missing value of " + arg;
+    const char* value = argv[++i];
+    bool ok = true;
+    if (arg == "--size")
+    {
+      char tail = 0;
+      ok = std::sscanf(value, "%dx%d%c", &width, &height, &tail) == 2 && width > 0 && height > 0;
+    }
+    else if (arg == "--scene")
+    {
+      scene = value;
+      for (const std::string& item : scene_items())
+      {
+        const size_t colon = item.find(':');
+        const std::string kind = item.substr(0, colon);
+        int count = 0;
+        if (kind == "cubes" || kind == "spheres")
+          ok = ok && colon != std::string::npos && parse_int(item.c_str() + colon + 1, count) && count > 0;
+        else
+          ok = ok && !item.empty();
+      }
+    }
+    else if (arg == "--camera")
+    {
+      glm::vec3 position;
+      ok = parse_vec3(value, position);
+      camera_position = position;
+    }
+    else if (arg == "--look-at")
+    {
+      glm::vec3 target;
+      ok = parse_vec3(value, target);
+      camera_target = target;
+    }
+    else if (arg == "--frames")
+      ok = parse_int(value, frames) && frames > 0;
+    else if (arg == "--frame-time")
+      ok = parse_float(value, frame_time) && frame_time > 0.f;
+    else if (arg == "--output")
+    {
+      output = value;
+      ok = !output.empty();
+    }
+    else if (arg == "--output-every")
+      ok = parse_int(value, output_every) && output_every >= 0;
+    else if (arg == "--camera-path")
+    {
+      camera_path = value;
+      ok = !camera_path.empty();
+    }
+    else if (arg == "--warmup")
+      ok = parse_int(value, warmup_frames) && warmup_frames >= 0;
+    else if (arg == "--report")
+    {
+      report = value;
+      ok = !report.empty();
+    }
+    else if (arg == "--trace")
+    {
+      trace = value;
+      ok = !trace.empty();
+    }
+    else if (arg == "--max-frame-allocations")
+      ok = parse_int(value, max_frame_allocations) && max_frame_allocations >= 0;
+    else if (arg == "--mesh-cache")
+    {
+      mesh_cache = value;
+      ok = !mesh_cache.empty();
+    }
+    else
+      return "unknown option " + arg;
+    if (!ok)
+      return "invalid value of " + arg + ": " + value;
+  }
+  return std::nullopt;
+}
+
+std::vector<std::string> LaunchOptions::scene_items() const
+{
+  std::vector<std::string> items;
+  size_t start = 0;
+  while (true)
+  {
+    const size_t comma = scene.find(',', start);
+    items.push_back(scene.substr(start, comma - start));
+    if (comma == std::string::npos)
+      return items;
+    start = comma + 1;
+  }
+}
+
+std::string LaunchOptions::output_path(int frame) const
+{
+  if (output.empty())
+    return std::string();
+  if (output_every == 0)
+    return frame == frames - 1 ? output : std::string();
+  if (frame % output_every != 0 && frame != frames - 1)
+    return std::string();
+  const size_t dot = output.find_last_of('.');
+  const size_t slash = output.find_last_of("/\\");
+  const bool has_extension = dot != std::string::npos && (slash == std::string::npos || dot > slash);
+  char number[16];
+  std::snprintf(number, sizeof(number), "_%04d", frame);
+  return has_extension ? output.substr(0, dot) + number + output.substr(dot) : output + number + ".png";
+}
+
+const char* LaunchOptions::usage()
+{
+  return
+    "usage: OpenGLEngine [options]\n"
+    "  --headless            render offscreen without window and write frames to disk\n"
+    "  --size WxH            framebuffer size, default 1600x900\n"
+    "  --scene NAME          default, or comma separated cubes:N, spheres:N and paths of model files\n"
+    "  --camera X,Y,Z        camera position\n"
+    "  --look-at X,Y,Z       point camera looks at\n"
+    "  --frames N            frames rendered in headless mode, default 1\n"
+    "  --frame-time SEC      animation step of headless frame, default 1/60\n"
+    "  --output FILE         PNG of last frame, default frame.png\n"
+    "  --output-every N      write every N-th frame as FILE_<frame>.png\n"
+    "  --camera-path PATH    orbit or file with lines \"time px py pz tx ty tz\", camera follows it\n"
+    "  --warmup N            frames rendered before measurements start\n"
+    "  --report FILE         JSON with percentiles of frame times, draw calls and uploaded bytes\n"
+    "  --trace FILE          Chrome trace of CPU zones written at exit, tracing builds only\n"
+    "  --helper-lines        draw normals and bounding boxes of all objects\n"
+    "  --max-frame-allocations N\n"
+    "                        fail when scene frame after warmup does more heap allocations, UI isn't drawn in\n"
+    "                        headless mode. memory tracking builds only\n"
+    "  --mesh-cache DIR      binary copies of imported models for fast loading, default cache/meshes\n"
+    "  --no-mesh-cache       import models from their files every time\n";
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <optional>
+#include <glm/glm.hpp>
+
+// How application runs, parsed from command line. In headless mode there is no visible window, input or ui:
+// given number of frames is rendered offscreen with fixed time step and written to PNG files
+struct LaunchOptions
+{
+  bool help = false;
+  bool headless = false;
+  int width = 1600;
+  int height = 900;
+  // "default", or comma separated items: "cubes:N" and "spheres:N" for grids, paths of model files
+  std::string scene = "default";
+  std::optional<glm::vec3> camera_position;
+  std::optional<glm::vec3> camera_target;
+  // "orbit" around the scene or file of CameraPath keyframes, camera moves along it in headless mode
+  std::string camera_path;
+  int frames = 1;
+  float frame_time = 1.f / 60.f;  // seconds, animation step of headless frames
+  std::string output = "frame.png";
+  // every n-th frame is written as <output stem>_<frame>.png, 0 writes only the last frame to output
+  int output_every = 0;
+  // frames rendered before measurements start
+  int warmup_frames = 0;
+  // JSON with distribution of frame times, draw calls and uploads of headless frames after warmup
+  std::string report;
+  // Chrome trace of CPU zones written at exit, builds with OPENGL_ENGINE_TRACING only
+  std::string trace;
+  // headless run fails when frame after warmup does more heap allocations, -1 doesn't check.
+  // builds with OPENGL_ENGINE_MEMORY_TRACKING only
+  int max_frame_allocations = -1;
+  // normals and bounding boxes of all objects are drawn
+  bool helper_lines = false;
+  // directory of binary copies of imported models, empty disables the cache
+  std::string mesh_cache = "cache/meshes";
+  // headless window gets no context, caller has already pointed GL functions to its own backend (recording backend
+  // of tests). not set from command line
+  bool external_gl = false;
+
+  // returns error message, std::nullopt on success
+  std::optional<std::string> parse(int argc, const char* const* argv);
+  // path of image for frame when it is written, empty otherwise
+  std::string output_path(int frame) const;
+  static const char* usage();
+  // items of comma separated scene option
+  std::vector<std::string> scene_items() const;
+};
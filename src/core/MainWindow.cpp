@@ -3,6 +3,7 @@
 #include "CursorPositionHandler.hpp"
 #include "MouseInputHandler.hpp"
 #include "Debug.hpp"
+#include <stdexcept>
 
 extern int ignore_frames = 3;
 
@@ -14,28 +15,47 @@ static void window_focus_callback(GLFWwindow* window, int focused)
   }
 }
 
-MainWindow::MainWindow(int width, int height, const char* title) :
-  m_width(width), m_height(height), m_title(title)
+MainWindow::MainWindow(int width, int height, const char* title, bool headless, bool external_gl) :
+  m_width(width), m_height(height), m_title(title), m_headless(headless)
 {
   // Tell GLFW what version of OpenGL we are using 
   glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
   glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 4);
   // Tell GLFW we are using the CORE profile (only modern functions)
   glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+  // surfaceless EGL context, runs on Mesa llvmpipe without display or GPU
+  if (headless)
+    glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+  if (external_gl)
+    glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
   m_window = glfwCreateWindow(width, height, title, nullptr, nullptr);
+  if (m_window == nullptr && headless && !external_gl)
+  {
+    // Mesa without EGL still may have OSMesa
+    glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+    m_window = glfwCreateWindow(width, height, title, nullptr, nullptr);
+  }
   if (m_window == nullptr) {
     DEBUG("Failed to create GLFW window" << std::endl);
     glfwTerminate();
+    throw ContextError(headless ? "Failed to create headless OpenGL context" : "Failed to create GLFW window");
+  }
+  if (!headless)
+  {
+    glfwSetInputMode(m_window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+    glfwSetCursorPos(m_window, m_width / 2., m_height / 2.);
   }
-  glfwSetInputMode(m_window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
-  glfwSetCursorPos(m_window, m_width / 2., m_height / 2.);
   m_input_handlers.push_back(std::make_unique<KeyboardHandler>(this));
   m_input_handlers.push_back(std::make_unique<CursorPositionHandler>(this));
   m_input_handlers.push_back(std::make_unique<MouseInputHandler>(this));
-  glfwMakeContextCurrent(m_window);
-  glfwSetWindowSizeLimits(m_window, 1600, 900, GLFW_DONT_CARE, GLFW_DONT_CARE);
+  if (!external_gl)
+    glfwMakeContextCurrent(m_window);
+  // images of headless mode may have any size
+  if (!headless)
+    glfwSetWindowSizeLimits(m_window, 1600, 900, GLFW_DONT_CARE, GLFW_DONT_CARE);
   glfwSetWindowFocusCallback(m_window, window_focus_callback);
-  gladLoadGL();
+  if (!external_gl)
+    gladLoadGL();
   glViewport(0, 0, m_width, m_height);
 }
 
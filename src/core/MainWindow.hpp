@@ -1,16 +1,25 @@
 #pragma once
 
 #include <glad/glad.h>
-#include <GLFW\glfw3.h>
+#include <GLFW/glfw3.h>
 #include <map>
 #include <vector>
 #include <memory>
+#include <stdexcept>
 #include "UserInputHandler.hpp"
 
+// OpenGL 4.4 context can't be created, e.g. machine without display or GPU driver
+struct ContextError : std::runtime_error
+{
+  using std::runtime_error::runtime_error;
+};
+
 class MainWindow
 {
 public:
-  MainWindow(int width, int height, const char* title);
+  // headless window has no surface, it needs GLFW initialized with null platform. with external_gl it has no
+  // context either and GL functions aren't loaded, they are whatever caller installed
+  MainWindow(int width, int height, const char* title, bool headless = false, bool external_gl = false);
   ~MainWindow();
   GLFWwindow* gl_window() const { return m_window; }
   std::vector<std::unique_ptr<UserInputHandler>>& input_handlers() { return m_input_handlers; }
@@ -21,10 +30,12 @@ public:
   int width() const { return m_width; }
   int height() const { return m_height; }
   const char* title() const { return m_title; }
+  bool headless() const { return m_headless; }
 private:
   const char* m_title;
   int m_width;
   int m_height;
+  bool m_headless;
   GLFWwindow* m_window;
   std::vector<std::unique_ptr<UserInputHandler>> m_input_handlers;
 };
@@ -0,0 +1,69 @@
+#include "MappedFile.hpp"
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& filename)
+{
+  HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+    return;
+  m_file = file;
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+    return;
+  m_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!m_mapping)
+    return;
+  m_data = static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+  if (m_data)
+    m_size = (size_t)size.QuadPart;
+}
+
+MappedFile::~MappedFile()
+{
+  if (m_data)
+    UnmapViewOfFile(m_data);
+  if (m_mapping)
+    CloseHandle(m_mapping);
+  if (m_file)
+    CloseHandle(m_file);
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& filename)
+{
+  const int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    return;
+  struct stat st;
+  if (fstat(fd, &st) == 0 && st.st_size > 0)
+  {
+    void* data = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data != MAP_FAILED)
+    {
+      m_data = static_cast<const uint8_t*>(data);
+      m_size = (size_t)st.st_size;
+    }
+  }
+  // mapping keeps its own reference to file
+  close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+  if (m_data)
+    munmap(const_cast<uint8_t*>(m_data), m_size);
+}
+
+#endif
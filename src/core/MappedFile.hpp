@@ -0,0 +1,26 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+// Read only mapping of whole file. OS reads pages on first access and may drop them under memory pressure,
+// so parts of file which are never touched cost nothing. Empty or missing files are not opened.
+class MappedFile
+{
+public:
+  explicit MappedFile(const std::string& filename);
+  ~MappedFile();
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  bool is_open() const { return m_data != nullptr; }
+  const uint8_t* data() const { return m_data; }
+  size_t size() const { return m_size; }
+private:
+  const uint8_t* m_data = nullptr;
+  size_t m_size = 0;
+#ifdef _WIN32
+  void* m_file = nullptr;
+  void* m_mapping = nullptr;
+#endif
+};
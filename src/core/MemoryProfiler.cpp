@@ -1,45 +1,252 @@
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <new>
 #include "MemoryProfiler.hpp"
 
-_CrtMemState MemoryProfiler::m_first;
-_CrtMemState MemoryProfiler::m_second;
+namespace
+{
+  // plain atomics are constant initialized, so allocations of static constructors are counted too
+  struct AtomicCounters
+  {
+    std::atomic<uint64_t> allocations;
+    std::atomic<uint64_t> frees;
+    std::atomic<uint64_t> allocated_bytes;
+    std::atomic<uint64_t> freed_bytes;
+    std::atomic<uint64_t> peak_bytes;
+  };
+
+  AtomicCounters g_tags[(size_t)MemoryTag::COUNT];
+  AtomicCounters g_total;
+  thread_local MemoryTag t_tag = MemoryTag::GENERAL;
+
+  MemoryProfiler::Snapshot g_snapshots[2];
+  int g_snapshot_count = 0;
+
+  MemoryProfiler::Counters load(const AtomicCounters& c)
+  {
+    MemoryProfiler::Counters out;
+    out.allocations = c.allocations.load(std::memory_order_relaxed);
+    out.frees = c.frees.load(std::memory_order_relaxed);
+    out.allocated_bytes = c.allocated_bytes.load(std::memory_order_relaxed);
+    out.freed_bytes = c.freed_bytes.load(std::memory_order_relaxed);
+    out.peak_bytes = c.peak_bytes.load(std::memory_order_relaxed);
+    return out;
+  }
+
+  MemoryProfiler::Counters difference(const MemoryProfiler::Counters& from, const MemoryProfiler::Counters& to)
+  {
+    MemoryProfiler::Counters out;
+    out.allocations = to.allocations - from.allocations;
+    out.frees = to.frees - from.frees;
+    out.allocated_bytes = to.allocated_bytes - from.allocated_bytes;
+    out.freed_bytes = to.freed_bytes - from.freed_bytes;
+    out.peak_bytes = to.peak_bytes;
+    return out;
+  }
+
+#if OPENGL_ENGINE_MEMORY_TRACKING
+  // precedes every tracked allocation
+  struct alignas(std::max_align_t) Header
+  {
+    size_t size;
+    uint32_t offset;  // from start of malloc block to user pointer
+    MemoryTag tag;
+  };
+
+  void update_peak(AtomicCounters& c)
+  {
+    const uint64_t live = c.allocated_bytes.load(std::memory_order_relaxed) - c.freed_bytes.load(std::memory_order_relaxed);
+    uint64_t peak = c.peak_bytes.load(std::memory_order_relaxed);
+    while (live > peak && !c.peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+      ;
+  }
+
+  void count_allocation(MemoryTag tag, size_t size)
+  {
+    for (AtomicCounters* c : { &g_tags[(size_t)tag], &g_total })
+    {
+      c->allocations.fetch_add(1, std::memory_order_relaxed);
+      c->allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+      update_peak(*c);
+    }
+  }
 
-void MemoryProfiler::make_memory_snapshot() {
-  if (!m_first.pBlockHeader) {
-    init();
-    _CrtMemCheckpoint(&m_first);
+  void count_free(MemoryTag tag, size_t size)
+  {
+    for (AtomicCounters* c : { &g_tags[(size_t)tag], &g_total })
+    {
+      c->frees.fetch_add(1, std::memory_order_relaxed);
+      c->freed_bytes.fetch_add(size, std::memory_order_relaxed);
+    }
   }
-  else if (!m_second.pBlockHeader) {
-    _CrtMemCheckpoint(&m_second);
+
+  Header* header(void* ptr)
+  {
+    return static_cast<Header*>(ptr) - 1;
   }
-  else {
-    m_first = m_second;
-    _CrtMemCheckpoint(&m_second);
+
+  // nullptr when out of memory
+  void* tracked_alloc(size_t size, size_t alignment)
+  {
+    alignment = alignment < alignof(Header) ? alignof(Header) : alignment;
+    // header ends right before user pointer, padding before it aligns user pointer
+    const size_t extra = sizeof(Header) + alignment - alignof(Header);
+    char* block = static_cast<char*>(std::malloc(size + extra));
+    if (!block)
+      return nullptr;
+    const uintptr_t first = reinterpret_cast<uintptr_t>(block + sizeof(Header));
+    char* user = reinterpret_cast<char*>((first + alignment - 1) & ~(uintptr_t)(alignment - 1));
+    Header* h = header(user);
+    h->size = size;
+    h->offset = (uint32_t)(user - block);
+    h->tag = t_tag;
+    count_allocation(h->tag, size);
+    return user;
   }
+
+  void tracked_free(void* ptr)
+  {
+    if (!ptr)
+      return;
+    Header* h = header(ptr);
+    count_free(h->tag, h->size);
+    std::free(static_cast<char*>(ptr) - h->offset);
+  }
+
+  void* tracked_new(size_t size, size_t alignment)
+  {
+    // new of zero bytes returns unique pointer
+    if (void* ptr = tracked_alloc(size ? size : 1, alignment))
+      return ptr;
+    throw std::bad_alloc();
+  }
+#endif
+}
+
+MemoryTagScope::MemoryTagScope(MemoryTag tag) : m_previous(t_tag)
+{
+  t_tag = tag;
 }
 
-void MemoryProfiler::init() {
-  // Send all reports to STDOUT
-  _CrtSetReportMode(_CRT_WARN, _CRTDBG_MODE_FILE);
-  _CrtSetReportFile(_CRT_WARN, _CRTDBG_FILE_STDOUT);
-  _CrtSetReportMode(_CRT_ERROR, _CRTDBG_MODE_FILE);
-  _CrtSetReportFile(_CRT_ERROR, _CRTDBG_FILE_STDOUT);
-  _CrtSetReportMode(_CRT_ASSERT, _CRTDBG_MODE_FILE);
-  _CrtSetReportFile(_CRT_ASSERT, _CRTDBG_FILE_STDOUT);
+MemoryTagScope::~MemoryTagScope()
+{
+  t_tag = m_previous;
 }
 
-MemoryProfiler::DumpResult MemoryProfiler::dump() {
-  if (!m_first.pBlockHeader || !m_second.pBlockHeader)
+MemoryProfiler::Snapshot MemoryProfiler::snapshot()
+{
+  Snapshot s;
+  for (size_t i = 0; i < s.tags.size(); i++)
+    s.tags[i] = load(g_tags[i]);
+  s.total = load(g_total);
+  return s;
+}
+
+MemoryProfiler::Snapshot MemoryProfiler::difference(const Snapshot& from, const Snapshot& to)
+{
+  Snapshot s;
+  for (size_t i = 0; i < s.tags.size(); i++)
+    s.tags[i] = ::difference(from.tags[i], to.tags[i]);
+  s.total = ::difference(from.total, to.total);
+  return s;
+}
+
+const char* MemoryProfiler::tag_name(MemoryTag tag)
+{
+  switch (tag)
+  {
+  case MemoryTag::GENERAL: return "general";
+  case MemoryTag::MESHES: return "meshes";
+  case MemoryTag::TEXTURES: return "textures";
+  case MemoryTag::UI: return "ui";
+  case MemoryTag::LOADER: return "loader";
+  default: return "unknown";
+  }
+}
+
+void MemoryProfiler::make_memory_snapshot()
+{
+  if (g_snapshot_count == 2)
+    g_snapshots[0] = g_snapshots[1];
+  else
+    g_snapshot_count++;
+  g_snapshots[g_snapshot_count - 1] = snapshot();
+}
+
+MemoryProfiler::DumpResult MemoryProfiler::dump(std::ostream& os)
+{
+  if (g_snapshot_count < 2)
     return DumpResult::eNoMemorySnapshot;
-  _CrtMemState diff;
-  if (_CrtMemDifference(&diff, &m_first, &m_second)) // if there is a difference
+  const Snapshot diff = difference(g_snapshots[0], g_snapshots[1]);
+  if (diff.total.live_bytes() == 0 && diff.total.allocations == diff.total.frees)
+    return DumpResult::eNoMemoryLeaks;
+  os << "Memory between snapshots, tag: allocations, frees, live bytes change, peak bytes\n";
+  for (size_t i = 0; i < diff.tags.size(); i++)
   {
-    DEBUG("-----------_CrtMemDumpStatistics ---------\n");
-    _CrtMemDumpStatistics(&diff);
-    DEBUG("-----------_CrtMemDumpAllObjectsSince ---------\n");
-    _CrtMemDumpAllObjectsSince(&m_first);
-    DEBUG("-----------_CrtDumpMemoryLeaks ---------\n");
-    _CrtDumpMemoryLeaks();
-    return DumpResult::eExistMemoryLeaks;
+    const Counters& c = diff.tags[i];
+    if (c.allocations || c.frees)
+      os << "  " << tag_name((MemoryTag)i) << ": " << c.allocations << ", " << c.frees << ", " << c.live_bytes() << ", " << c.peak_bytes << '\n';
   }
-  return DumpResult::eNoMemoryLeaks;
+  os << "  total: " << diff.total.allocations << ", " << diff.total.frees << ", " << diff.total.live_bytes() << ", " << diff.total.peak_bytes << '\n';
+  return DumpResult::eExistMemoryLeaks;
+}
+
+void* MemoryProfiler::malloc(size_t size)
+{
+#if OPENGL_ENGINE_MEMORY_TRACKING
+  return tracked_alloc(size, alignof(std::max_align_t));
+#else
+  return std::malloc(size);
+#endif
 }
+
+void* MemoryProfiler::realloc(void* ptr, size_t size)
+{
+#if OPENGL_ENGINE_MEMORY_TRACKING
+  if (!ptr)
+    return malloc(size);
+  void* out = tracked_alloc(size, alignof(std::max_align_t));
+  if (!out)
+    return nullptr;
+  const size_t old_size = header(ptr)->size;
+  std::memcpy(out, ptr, old_size < size ? old_size : size);
+  tracked_free(ptr);
+  return out;
+#else
+  return std::realloc(ptr, size);
+#endif
+}
+
+void MemoryProfiler::free(void* ptr)
+{
+#if OPENGL_ENGINE_MEMORY_TRACKING
+  tracked_free(ptr);
+#else
+  std::free(ptr);
+#endif
+}
+
+#if OPENGL_ENGINE_MEMORY_TRACKING
+// replaceable global allocation functions, every other overload forwards to these
+void* operator new(size_t size) { return tracked_new(size, alignof(std::max_align_t)); }
+void* operator new[](size_t size) { return tracked_new(size, alignof(std::max_align_t)); }
+void* operator new(size_t size, std::align_val_t al) { return tracked_new(size, (size_t)al); }
+void* operator new[](size_t size, std::align_val_t al) { return tracked_new(size, (size_t)al); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return tracked_alloc(size ? size : 1, alignof(std::max_align_t)); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return tracked_alloc(size ? size : 1, alignof(std::max_align_t)); }
+void* operator new(size_t size, std::align_val_t al, const std::nothrow_t&) noexcept { return tracked_alloc(size ? size : 1, (size_t)al); }
+void* operator new[](size_t size, std::align_val_t al, const std::nothrow_t&) noexcept { return tracked_alloc(size ? size : 1, (size_t)al); }
+void operator delete(void* ptr) noexcept { tracked_free(ptr); }
+void operator delete[](void* ptr) noexcept { tracked_free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { tracked_free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { tracked_free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { tracked_free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { tracked_free(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { tracked_free(ptr); }
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { tracked_free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { tracked_free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { tracked_free(ptr); }
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { tracked_free(ptr); }
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { tracked_free(ptr); }
+#endif
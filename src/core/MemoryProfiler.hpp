@@ -1,26 +1,79 @@
 #pragma once
 
-#include <Windows.h>
-#include <crtdbg.h>
-#include "Debug.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <iostream>
 
-#define _CRTDBG_MAP_ALLOC
-#ifdef _DEBUG
-#define DEBUG_NEW new(_NORMAL_BLOCK, __FILE__, __LINE__)
-#define new DEBUG_NEW
-#endif
+// Subsystem which allocations are attributed to, set for a scope with MemoryTagScope
+enum class MemoryTag : uint8_t
+{
+  GENERAL,
+  MESHES,
+  TEXTURES,
+  UI,
+  LOADER,
+  COUNT
+};
 
-class MemoryProfiler {
+// Counts allocations of global operator new/delete per memory tag. Hooks are compiled only with
+// OPENGL_ENGINE_MEMORY_TRACKING (cmake option of the same name), otherwise every counter stays zero.
+// Every allocation gets small header with its size and tag, so freed bytes are returned to the tag which
+// allocated them. C libraries with custom allocator hooks (stb_image) are routed to malloc/realloc/free below.
+class MemoryProfiler
+{
 public:
   enum DumpResult {
-    eNoMemoryLeaks = 1, 
+    eNoMemoryLeaks = 1,
     eExistMemoryLeaks,
     eNoMemorySnapshot
   };
+  struct Counters
+  {
+    uint64_t allocations = 0;
+    uint64_t frees = 0;
+    uint64_t allocated_bytes = 0;
+    uint64_t freed_bytes = 0;
+    uint64_t peak_bytes = 0;  // of live bytes since start
+    int64_t live_bytes() const { return (int64_t)(allocated_bytes - freed_bytes); }
+  };
+  struct Snapshot
+  {
+    std::array<Counters, (size_t)MemoryTag::COUNT> tags;
+    Counters total;
+    const Counters& operator[](MemoryTag tag) const { return tags[(size_t)tag]; }
+  };
+public:
+  static constexpr bool enabled()
+  {
+#if OPENGL_ENGINE_MEMORY_TRACKING
+    return true;
+#else
+    return false;
+#endif
+  }
+  static Snapshot snapshot();
+  // counts between snapshots, peaks are the ones of later snapshot
+  static Snapshot difference(const Snapshot& from, const Snapshot& to);
+  static const char* tag_name(MemoryTag tag);
+  // keeps two latest snapshots, dump reports what changed between them
   static void make_memory_snapshot();
-  static DumpResult dump();
+  static DumpResult dump(std::ostream& os = std::cout);
+  // tracked under current tag when tracking is enabled
+  static void* malloc(size_t size);
+  static void* realloc(void* ptr, size_t size);
+  static void free(void* ptr);
+};
+
+// Allocations of this thread are attributed to tag until scope ends. Scopes nest, inner one wins
+class MemoryTagScope
+{
+public:
+  explicit MemoryTagScope(MemoryTag tag);
+  ~MemoryTagScope();
+  MemoryTagScope(const MemoryTagScope&) = delete;
+  MemoryTagScope& operator=(const MemoryTagScope&) = delete;
 private:
-  static void init();
-  static _CrtMemState m_first;
-  static _CrtMemState m_second;
-};
\ No newline at end of file
+  MemoryTag m_previous;
+};
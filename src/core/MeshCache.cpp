@@ -0,0 +1,317 @@
+#include "MeshCache.hpp"
+#include "MappedFile.hpp"
+#include "Tracer.hpp"
+#include "MemoryProfiler.hpp"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <thread>
+#include <cstring>
+#include <cstddef>
+#include <type_traits>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+  static_assert(std::is_trivially_copyable_v<Vertex>, "vertices are copied into cache as bytes");
+
+  struct Header
+  {
+    char magic[4];
+    uint32_t version;
+    uint32_t vertex_size;    // entries written with other layout of Vertex are invalid
+    uint32_t flags;          // of import
+    uint64_t source_size;
+    int64_t source_mtime;
+    uint64_t source_hash;
+    uint64_t file_size;      // truncated entries are invalid
+    uint32_t path_length;
+    uint32_t mesh_count;
+    uint32_t lod_count;
+    uint32_t padding;
+  };
+
+  struct MeshRecord
+  {
+    uint64_t vertex_offset;
+    uint64_t vertex_count;
+    uint32_t face_size;
+    uint32_t first_lod;
+    uint32_t lod_count;
+    uint32_t padding;
+    float bbox_min[3];
+    float bbox_max[3];
+  };
+
+  struct LodRecord
+  {
+    uint64_t index_offset;
+    uint64_t index_count;
+    float error;  // of simplified mesh in model space, 0 for full mesh
+    uint32_t padding;
+  };
+
+  constexpr char magic[4] = { 'O', 'E', 'M', 'C' };
+
+  size_t align(size_t offset, size_t alignment)
+  {
+    return (offset + alignment - 1) / alignment * alignment;
+  }
+
+  int64_t modification_time(const fs::path& path, std::error_code& error)
+  {
+    return (int64_t)fs::last_write_time(path, error).time_since_epoch().count();
+  }
+
+  // all faces of mesh have this size, 0 if they differ
+  uint32_t uniform_face_size(const Mesh& mesh)
+  {
+    if (mesh.faces().empty())
+      return 3;
+    const int size = mesh.faces()[0].size;
+    for (const Face& face : mesh.faces())
+    {
+      if (face.size != size)
+        return 0;
+    }
+    return (uint32_t)size;
+  }
+
+  // checked before anything is read from entry, mapped data may be anything
+  bool valid_blob(const MappedFile& entry, uint64_t offset, uint64_t count, size_t element_size)
+  {
+    return offset % MeshCache::blob_alignment == 0 && offset <= entry.size() && count <= (entry.size() - offset) / element_size;
+  }
+}
+
+MeshCache::MeshCache(const std::string& directory) : m_directory(directory)
+{
+}
+
+std::string MeshCache::entry_path(const std::string& source, unsigned int flags) const
+{
+  std::error_code error;
+  std::string key = fs::absolute(source, error).lexically_normal().string();
+  key += '|' + std::to_string(flags);
+  std::ostringstream name;
+  name << std::hex << std::setw(16) << std::setfill('0') << hash(reinterpret_cast<const uint8_t*>(key.data()), key.size()) << ".mesh";
+  return (fs::path(m_directory) / name.str()).string();
+}
+
+uint64_t MeshCache::hash(const uint8_t* data, size_t size)
+{
+  // FNV-1a over 8 byte words, byte by byte version reads sources of hundreds of MB too slowly
+  constexpr uint64_t prime = 0x100000001b3ull;
+  uint64_t h = 0xcbf29ce484222325ull ^ size;
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8)
+  {
+    uint64_t word;
+    std::memcpy(&word, data + i, 8);
+    h = (h ^ word) * prime;
+    h ^= h >> 29;
+  }
+  for (; i < size; i++)
+  {
+    h = (h ^ data[i]) * prime;
+  }
+  return h;
+}
+
+std::optional<ComplexModel> MeshCache::load(const std::string& source, unsigned int flags) const
+{
+  TRACE_ZONE("MeshCache::load");
+  MemoryTagScope memory_tag(MemoryTag::LOADER);
+  std::error_code error;
+  const uint64_t source_size = fs::file_size(source, error);
+  if (error)
+    return std::nullopt;
+  const int64_t source_mtime = modification_time(source, error);
+  if (error)
+    return std::nullopt;
+  const std::string path = entry_path(source, flags);
+  const std::string absolute_source = fs::absolute(source, error).lexically_normal().string();
+
+  ComplexModel model;
+  bool touched = false;
+  {
+    MappedFile entry(path);
+    if (!entry.is_open() || entry.size() < sizeof(Header))
+      return std::nullopt;
+    Header header;
+    std::memcpy(&header, entry.data(), sizeof(Header));
+    if (std::memcmp(header.magic, magic, sizeof(magic)) != 0 || header.version != version || header.vertex_size != sizeof(Vertex) ||
+      header.flags != flags || header.file_size != entry.size() || header.source_size != source_size)
+      return std::nullopt;
+    // different path with the same hash of key
+    size_t offset = sizeof(Header);
+    if (header.path_length != absolute_source.size() || header.path_length > entry.size() - offset ||
+      std::memcmp(entry.data() + offset, absolute_source.data(), header.path_length) != 0)
+      return std::nullopt;
+    if (header.source_mtime != source_mtime)
+    {
+      MappedFile source_file(source);
+      if (!source_file.is_open() || hash(source_file.data(), source_file.size()) != header.source_hash)
+        return std::nullopt;
+      touched = true;
+    }
+    offset = align(offset + header.path_length, 8);
+    const uint64_t records_size = (uint64_t)header.mesh_count * sizeof(MeshRecord) + (uint64_t)header.lod_count * sizeof(LodRecord);
+    if (offset > entry.size() || records_size > entry.size() - offset)
+      return std::nullopt;
+    const uint8_t* meshes = entry.data() + offset;
+    const uint8_t* lods = meshes + header.mesh_count * sizeof(MeshRecord);
+
+    // contains single mesh by default
+    model.meshes().clear();
+    model.meshes().reserve(header.mesh_count);
+    for (uint32_t i = 0; i < header.mesh_count; i++)
+    {
+      MeshRecord record;
+      std::memcpy(&record, meshes + i * sizeof(MeshRecord), sizeof(MeshRecord));
+      if (record.lod_count == 0 || record.first_lod >= header.lod_count || record.face_size == 0 ||
+        !valid_blob(entry, record.vertex_offset, record.vertex_count, sizeof(Vertex)))
+        return std::nullopt;
+      LodRecord lod;
+      std::memcpy(&lod, lods + record.first_lod * sizeof(LodRecord), sizeof(LodRecord));
+      if (lod.index_count % record.face_size != 0 || !valid_blob(entry, lod.index_offset, lod.index_count, sizeof(GLuint)))
+        return std::nullopt;
+
+      Mesh& mesh = model.meshes().emplace_back();
+      const Vertex* vertices = reinterpret_cast<const Vertex*>(entry.data() + record.vertex_offset);
+      mesh.vertices().assign(vertices, vertices + record.vertex_count);
+      const GLuint* indices = reinterpret_cast<const GLuint*>(entry.data() + lod.index_offset);
+      const size_t face_count = lod.index_count / record.face_size;
+      mesh.faces().resize(face_count);
+      for (size_t f = 0; f < face_count; f++)
+      {
+        Face& face = mesh.faces()[f];
+        face.resize((int)record.face_size);
+        std::memcpy(face.data, indices + f * record.face_size, sizeof(GLuint) * record.face_size);
+        // damaged index would make every later use of mesh read past its vertices
+        for (int k = 0; k < face.size; k++)
+        {
+          if (face.data[k] >= record.vertex_count)
+            return std::nullopt;
+        }
+      }
+      mesh.bbox() = BoundingBox(glm::vec3(record.bbox_min[0], record.bbox_min[1], record.bbox_min[2]),
+        glm::vec3(record.bbox_max[0], record.bbox_max[1], record.bbox_max[2]));
+    }
+  }
+  // same content with new time, entry is updated so source isn't hashed on every load
+  if (touched)
+  {
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(offsetof(Header, source_mtime));
+    file.write(reinterpret_cast<const char*>(&source_mtime), sizeof(source_mtime));
+  }
+  return model;
+}
+
+bool MeshCache::store(const std::string& source, unsigned int flags, const ComplexModel& model) const
+{
+  TRACE_ZONE("MeshCache::store");
+  MemoryTagScope memory_tag(MemoryTag::LOADER);
+  std::error_code error;
+  Header header = {};
+  std::memcpy(header.magic, magic, sizeof(magic));
+  header.version = version;
+  header.vertex_size = sizeof(Vertex);
+  header.flags = flags;
+  header.source_mtime = modification_time(source, error);
+  if (error)
+    return false;
+  {
+    MappedFile source_file(source);
+    if (!source_file.is_open())
+      return false;
+    header.source_size = source_file.size();
+    header.source_hash = hash(source_file.data(), source_file.size());
+  }
+  const std::string absolute_source = fs::absolute(source, error).lexically_normal().string();
+  header.path_length = (uint32_t)absolute_source.size();
+  header.mesh_count = (uint32_t)model.meshes().size();
+  header.lod_count = header.mesh_count;
+
+  // layout of blobs
+  std::vector<MeshRecord> meshes(model.meshes().size());
+  std::vector<LodRecord> lods(model.meshes().size());
+  size_t offset = align(sizeof(Header) + header.path_length, 8) + meshes.size() * sizeof(MeshRecord) + lods.size() * sizeof(LodRecord);
+  for (size_t i = 0; i < meshes.size(); i++)
+  {
+    const Mesh& mesh = model.mesh(i);
+    MeshRecord& record = meshes[i] = {};
+    record.face_size = uniform_face_size(mesh);
+    if (record.face_size == 0)
+      return false;
+    record.first_lod = (uint32_t)i;
+    record.lod_count = 1;
+    glm::vec3 min(0.f), max(0.f);
+    if (!mesh.vertices().empty())
+      min = max = mesh.vertices()[0].position;
+    for (const Vertex& v : mesh.vertices())
+    {
+      min = glm::min(min, v.position);
+      max = glm::max(max, v.position);
+    }
+    for (int c = 0; c < 3; c++)
+    {
+      record.bbox_min[c] = min[c];
+      record.bbox_max[c] = max[c];
+    }
+    offset = align(offset, blob_alignment);
+    record.vertex_offset = offset;
+    record.vertex_count = mesh.vertices().size();
+    offset += mesh.vertices().size() * sizeof(Vertex);
+    offset = align(offset, blob_alignment);
+    lods[i] = {};
+    lods[i].index_offset = offset;
+    lods[i].index_count = mesh.index_count();
+    offset += lods[i].index_count * sizeof(GLuint);
+  }
+  header.file_size = offset;
+
+  fs::create_directories(m_directory, error);
+  const std::string path = entry_path(source, flags);
+  // several imports of the same file may write at once, last rename wins
+  const std::string temp_path = path + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+  {
+    std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+    if (!file)
+      return false;
+    const char zeros[blob_alignment] = {};
+    auto pad_to = [&](size_t position) { file.write(zeros, (std::streamsize)(position - (size_t)file.tellp())); };
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(absolute_source.data(), absolute_source.size());
+    pad_to(align(sizeof(Header) + header.path_length, 8));
+    file.write(reinterpret_cast<const char*>(meshes.data()), meshes.size() * sizeof(MeshRecord));
+    file.write(reinterpret_cast<const char*>(lods.data()), lods.size() * sizeof(LodRecord));
+    std::vector<GLuint> indices;
+    for (size_t i = 0; i < meshes.size(); i++)
+    {
+      const Mesh& mesh = model.mesh(i);
+      pad_to(meshes[i].vertex_offset);
+      file.write(reinterpret_cast<const char*>(mesh.vertices().data()), mesh.vertices().size() * sizeof(Vertex));
+      pad_to(lods[i].index_offset);
+      indices.resize(lods[i].index_count);
+      mesh.write_indices(indices.data());
+      file.write(reinterpret_cast<const char*>(indices.data()), indices.size() * sizeof(GLuint));
+    }
+    if (!file)
+    {
+      file.close();
+      fs::remove(temp_path, error);
+      return false;
+    }
+  }
+  fs::rename(temp_path, path, error);
+  if (error)
+  {
+    fs::remove(temp_path, error);
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+#include <optional>
+#include <cstdint>
+#include "ge/ComplexModel.hpp"
+
+// Binary copies of imported models, so opening the same file again skips assimp parsing and conversion of vertices.
+// Entry is keyed by absolute source path and import flags. It's valid while source has the same size and modification
+// time, or the same content hash when only time changed (e.g. file was copied or touched).
+// Entry file (native byte order, not meant to be shared between machines):
+//   header | source path | mesh records | lod records | vertex and index blobs aligned to blob_alignment
+// Blobs are in layout of Vertex and GLuint, entry is mapped and each blob is copied into mesh at once.
+// Every mesh has at least one lod, the first one is the full mesh.
+class MeshCache
+{
+public:
+  static constexpr uint32_t version = 1;
+  static constexpr size_t blob_alignment = 64;
+public:
+  explicit MeshCache(const std::string& directory);
+  const std::string& directory() const { return m_directory; }
+  // model of source imported with flags, std::nullopt if there is no valid entry
+  std::optional<ComplexModel> load(const std::string& source, unsigned int flags) const;
+  // writes entry of model imported from source, replacing older one. meshes must have faces of equal size.
+  // entry is renamed into place once complete, so readers never see partial entries
+  bool store(const std::string& source, unsigned int flags, const ComplexModel& model) const;
+  std::string entry_path(const std::string& source, unsigned int flags) const;
+  static uint64_t hash(const uint8_t* data, size_t size);
+private:
+  std::string m_directory;
+};
@@ -0,0 +1,81 @@
+#include "ModelImporter.hpp"
+#include "Tracer.hpp"
+#include <algorithm>
+#include <thread>
+
+static int worker_count(int threads)
+{
+  // imports are few and each of them uses whole thread, more workers than cores only compete for them
+  if (threads > 0)
+    return threads;
+  return std::clamp((int)std::thread::hardware_concurrency() - 1, 1, 4);
+}
+
+ModelImporter::ModelImporter(int threads, const MeshCache* cache, std::function<void()> on_finished)
+  : m_cache(cache), m_on_finished(std::move(on_finished)), m_pool(worker_count(threads), "ModelImporter")
+{
+}
+
+ModelImporter::~ModelImporter()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (auto& import : m_imports)
+  {
+    import->progress.cancel = true;
+  }
+}
+
+void ModelImporter::import(const std::string& filename, unsigned int flags)
+{
+  auto import = std::make_shared<Import>();
+  import->filename = filename;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_imports.push_back(import);
+  }
+  m_pool.submit([this, import, flags]()
+    {
+      TRACE_ZONE("ModelImporter::import");
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        import->running = true;
+      }
+      ModelLoader loader(m_cache);
+      std::optional<ComplexModel> model = loader.load(import->filename, flags, &import->progress);
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_imports.erase(std::find(m_imports.begin(), m_imports.end(), import));
+        m_finished.push_back(Result{ import->filename, std::move(model) });
+        m_finished_count = (int)m_finished.size();
+      }
+      if (m_on_finished)
+        m_on_finished();
+    });
+}
+
+bool ModelImporter::take_finished(std::vector<Result>& results)
+{
+  results.clear();
+  // checked every frame, so the common case only reads atomic
+  if (m_finished_count == 0)
+    return false;
+  std::lock_guard<std::mutex> lock(m_mutex);
+  results.swap(m_finished);
+  m_finished_count = 0;
+  return true;
+}
+
+void ModelImporter::for_each_import(const std::function<void(const Import&)>& func)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (const auto& import : m_imports)
+  {
+    func(*import);
+  }
+}
+
+bool ModelImporter::busy()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return !m_imports.empty();
+}
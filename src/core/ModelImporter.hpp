@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <string>
+#include <mutex>
+#include <atomic>
+#include <optional>
+#include <functional>
+#include "ModelLoader.hpp"
+#include "ThreadPool.hpp"
+
+// Loads models with ModelLoader on worker threads, so render thread keeps drawing while assimp parses files.
+// Finished models wait in queue until render thread takes them, several imports may run at once.
+class ModelImporter
+{
+public:
+  struct Import
+  {
+    std::string filename;
+    ModelLoader::Progress progress;
+    bool running = false;  // false while waiting for free worker
+  };
+  struct Result
+  {
+    std::string filename;
+    std::optional<ComplexModel> model;  // empty if loading failed
+  };
+public:
+  // 0 threads picks number by hardware. cache, if any, must outlive importer. on_finished is called by worker
+  // after result is queued, e.g. to wake up render thread which waits for events
+  explicit ModelImporter(int threads = 0, const MeshCache* cache = nullptr, std::function<void()> on_finished = nullptr);
+  // cancels imports in progress and waits for them
+  ~ModelImporter();
+  ModelImporter(const ModelImporter&) = delete;
+  ModelImporter& operator=(const ModelImporter&) = delete;
+  void import(const std::string& filename, unsigned int flags);
+  // moves finished imports into results, which are cleared first. doesn't lock or allocate if nothing is finished
+  bool take_finished(std::vector<Result>& results);
+  // imports which are queued or running, progress may change while it's read
+  void for_each_import(const std::function<void(const Import&)>& func);
+  bool busy();
+private:
+  std::vector<std::shared_ptr<Import>> m_imports;
+  std::vector<Result> m_finished;
+  std::atomic<int> m_finished_count = 0;
+  std::mutex m_mutex;
+  const MeshCache* m_cache = nullptr;
+  std::function<void()> m_on_finished;
+  // last member, so workers are stopped before state they use is destroyed
+  ThreadPool m_pool;
+};
@@ -1,8 +1,54 @@
 #include "ModelLoader.hpp"
+#include "Tracer.hpp"
+#include "MemoryProfiler.hpp"
+#include <assimp/ProgressHandler.hpp>
+#include <filesystem>
+#include <algorithm>
+#include <chrono>
 
-std::optional<ComplexModel> ModelLoader::load(const std::string& filename, unsigned int flags)
+namespace
 {
+  // reading part of import reports steps of file, post processing reports only percentage of the whole import
+  struct ImportProgress : Assimp::ProgressHandler
+  {
+    explicit ImportProgress(ModelLoader::Progress& progress) : m_progress(progress) {}
+    bool Update(float) override { return !m_progress.cancel; }
+    void UpdateFileRead(int current_step, int number_of_steps) override
+    {
+      if (number_of_steps > 0)
+        m_progress.bytes_parsed = m_progress.bytes_total * std::min(current_step, number_of_steps) / number_of_steps;
+      Update(0.f);
+    }
+    ModelLoader::Progress& m_progress;
+  };
+}
+
+std::optional<ComplexModel> ModelLoader::load(const std::string& filename, unsigned int flags, Progress* progress)
+{
+  TRACE_ZONE("ModelLoader::load");
+  MemoryTagScope memory_tag(MemoryTag::LOADER);
+  const auto start = std::chrono::steady_clock::now();
+  auto elapsed_ms = [&start]() { return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count(); };
+  if (m_cache)
+  {
+    std::optional<ComplexModel> model = m_cache->load(filename, flags);
+    if (model)
+    {
+      if (progress)
+        progress->meshes_total = progress->meshes_converted = (int)model->meshes().size();
+      DEBUG("Loaded " << filename << " from mesh cache in " << elapsed_ms() << " ms\n");
+      return model;
+    }
+  }
   Assimp::Importer importer;
+  if (progress)
+  {
+    std::error_code error;
+    const uintmax_t size = std::filesystem::file_size(filename, error);
+    progress->bytes_total = error ? 0 : (uint64_t)size;
+    // importer owns and deletes handler
+    importer.SetProgressHandler(new ImportProgress(*progress));
+  }
   const aiScene* scene = importer.ReadFile(filename, flags);
 
   if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
@@ -17,12 +63,20 @@ std::optional<ComplexModel> ModelLoader::load(const std::string& filename, unsig
     model.meshes().pop_back();
     // calc extent to scale all vertices in range [-1, 1]
     calc_max_extent(scene->mRootNode, scene);
-    process(scene->mRootNode, scene, model);
+    if (progress)
+    {
+      progress->bytes_parsed = progress->bytes_total.load();
+      progress->meshes_total = count_meshes(scene->mRootNode);
+    }
+    process(scene->mRootNode, scene, model, progress);
+    DEBUG("Imported " << filename << " in " << elapsed_ms() << " ms\n");
+    if (m_cache && !m_cache->store(filename, flags, model))
+      DEBUG("Could not write " << filename << " to mesh cache\n");
     return model;
   }
 }
 
-void ModelLoader::process(const aiNode* root, const aiScene* scene, ComplexModel& model)
+void ModelLoader::process(const aiNode* root, const aiScene* scene, ComplexModel& model, Progress* progress)
 {
   for (unsigned int i = 0; i < root->mNumMeshes; i++)
   {
@@ -71,12 +125,25 @@ void ModelLoader::process(const aiNode* root, const aiScene* scene, ComplexModel
 
     // TODO: textures + materials
 
+    if (progress)
+      progress->meshes_converted++;
+  }
+
+  for (unsigned int i = 0; i < root->mNumChildren; i++)
+  {
+    process(root->mChildren[i], scene, model, progress);
   }
+}
 
+int ModelLoader::count_meshes(const aiNode* root)
+{
+  // meshes referenced by several nodes are converted for each of them
+  int count = (int)root->mNumMeshes;
   for (unsigned int i = 0; i < root->mNumChildren; i++)
   {
-    process(root->mChildren[i], scene, model);
+    count += count_meshes(root->mChildren[i]);
   }
+  return count;
 }
 
 void ModelLoader::calc_max_extent(const aiNode* root, const aiScene* scene)
@@ -4,16 +4,34 @@
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 #include <optional>
+#include <atomic>
+#include <cstdint>
 
 #include "ge/ComplexModel.hpp"
+#include "MeshCache.hpp"
 
 class ModelLoader
 {
 public:
-  std::optional<ComplexModel> load(const std::string& filename, unsigned int flags);
+  // written by loading thread, may be read by others while load runs
+  struct Progress
+  {
+    std::atomic<uint64_t> bytes_total = 0;
+    std::atomic<uint64_t> bytes_parsed = 0;
+    std::atomic<int> meshes_total = 0;      // set once file is parsed
+    std::atomic<int> meshes_converted = 0;
+    std::atomic<bool> cancel = false;       // set by others, load stops at next progress update and fails
+  };
+public:
+  ModelLoader() = default;
+  // models are read from cache when it has them, imported ones are stored there
+  explicit ModelLoader(const MeshCache* cache) : m_cache(cache) {}
+  std::optional<ComplexModel> load(const std::string& filename, unsigned int flags, Progress* progress = nullptr);
 private:
-  void process(const aiNode* root, const aiScene* scene, ComplexModel& model);
+  void process(const aiNode* root, const aiScene* scene, ComplexModel& model, Progress* progress);
+  int count_meshes(const aiNode* root);
   float get_max_extent(const aiVector3D& min, const aiVector3D& max);
   void calc_max_extent(const aiNode* root, const aiScene* scene);
   float m_max_extent = 0.f;
+  const MeshCache* m_cache = nullptr;
 };
@@ -29,22 +29,18 @@ void MouseInputHandler::left_btn_click_callback(GLFWwindow* window, int button,
       double xd, yd;
       glfwGetCursorPos(window, &xd, &yd);
       auto& scene = SceneRenderer::instance();
-      const int x = static_cast<int>(xd);
-      const int y = scene.m_window->height() - static_cast<int>(yd);
-      const auto& picking_fbo = scene.m_fbos["picking"];
-      picking_fbo.bind();
-      glBindTexture(GL_TEXTURE_2D, picking_fbo.texture()->id());
-      float id[4] = {};
-      glReadBuffer(GL_COLOR_ATTACHMENT0);
-      glReadPixels(x, y, 1, 1, GL_RGBA, GL_FLOAT, &id);
-      if (id[0] != 0)
+      if (scene.m_gpu_picking)
       {
-        std::cout << "Pixel " << x << ',' << y << " object id = " << id[0] << '\n';
-        int index = (int)id[0] - 1;
-        scene.select_object(index);
+        // result is delivered to the scene in one of next frames. window y axis points down, framebuffer's up
+        scene.m_gpu_picker->request(static_cast<int>(xd), scene.m_window->height() - static_cast<int>(yd) - 1);
+        return;
+      }
+      const PickResult pick = scene.pick_object(xd, yd);
+      if (pick.object >= 0)
+      {
+        std::cout << "Pixel " << (int)xd << ',' << (int)yd << " object id = " << pick.object << '\n';
+        scene.select_object(pick.object);
       }
-      glReadBuffer(0);
-      picking_fbo.unbind();
     }
   }
 }
@@ -59,13 +55,8 @@ void MouseInputHandler::window_size_change_callback(GLFWwindow* window, int widt
   s.m_window->set_height(height);
   s.m_projection_mat = glm::mat4(1.f);
   s.m_projection_mat = glm::perspective(glm::radians(45.f), (float)width / height, 0.1f, 100.f);
-  for (auto& [name, fbo] : s.m_fbos)
-  {
-    fbo.bind();
-    // resize texture and render buffer
-    fbo.attach_texture(width, height, fbo.texture()->internal_fmt(), fbo.texture()->format(), fbo.texture()->type());
-    fbo.attach_renderbuffer(width, height, fbo.rb_internal_format(), fbo.rb_attachment());
-    fbo.unbind();
-  }
+  s.m_render_graph.resize(width, height);
+  s.m_gpu_picker->resize(width, height);
+  s.m_visibility_buffer->resize(width, height);
   glViewport(0, 0, width, height);
 }
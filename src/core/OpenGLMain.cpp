@@ -1,8 +1,32 @@
+#include <iostream>
+#include <stdexcept>
 #include "./core/SceneRenderer.hpp"
+#include "./core/Tracer.hpp"
 
-int main() 
+int main(int argc, char** argv) 
 {
-  auto& scene = SceneRenderer::instance();
-  scene.render();
+  LaunchOptions& options = SceneRenderer::launch_options();
+  if (auto error = options.parse(argc, argv))
+  {
+    std::cerr << *error << '\n' << LaunchOptions::usage();
+    return 1;
+  }
+  if (options.help)
+  {
+    std::cout << LaunchOptions::usage();
+    return 0;
+  }
+  try
+  {
+    auto& scene = SceneRenderer::instance();
+    scene.render();
+    if (!options.trace.empty() && !Tracer::save(options.trace))
+      std::cerr << "Could not write trace " << options.trace << '\n';
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << e.what() << '\n';
+    return 1;
+  }
   return 0;
 }
@@ -0,0 +1,297 @@
+#include <cassert>
+#include <algorithm>
+#include "RenderGraph.hpp"
+#include "FrameProfiler.hpp"
+
+bool RenderGraph::TextureDesc::operator==(const TextureDesc& other) const
+{
+  return internal_format == other.internal_format && format == other.format && type == other.type;
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::read(Resource resource, Access access)
+{
+  m_graph.m_passes[m_pass].reads.push_back({ resource, access });
+  return *this;
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::write(Resource resource, Access access)
+{
+  m_graph.m_passes[m_pass].writes.push_back({ resource, access });
+  return *this;
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::side_effect()
+{
+  m_graph.m_passes[m_pass].side_effect = true;
+  return *this;
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::active_if(std::function<bool()> predicate)
+{
+  m_graph.m_passes[m_pass].active = std::move(predicate);
+  return *this;
+}
+
+RenderGraph::Resource RenderGraph::create_texture(const std::string& name, const TextureDesc& desc, bool persistent)
+{
+  ResourceData resource;
+  resource.name = name;
+  resource.type = ResourceType::TEXTURE;
+  resource.desc = desc;
+  resource.persistent = persistent;
+  m_resources.push_back(std::move(resource));
+  return (Resource)m_resources.size() - 1;
+}
+
+RenderGraph::Resource RenderGraph::import_resource(const std::string& name)
+{
+  ResourceData resource;
+  resource.name = name;
+  resource.type = ResourceType::IMPORTED;
+  m_resources.push_back(std::move(resource));
+  return (Resource)m_resources.size() - 1;
+}
+
+RenderGraph::PassBuilder RenderGraph::add_pass(const std::string& name, std::function<void()> execute)
+{
+  if (m_backbuffer < 0)
+  {
+    ResourceData backbuffer;
+    backbuffer.name = "backbuffer";
+    backbuffer.type = ResourceType::BACKBUFFER;
+    m_resources.push_back(std::move(backbuffer));
+    m_backbuffer = (Resource)m_resources.size() - 1;
+  }
+  PassData pass;
+  pass.name = name;
+  pass.execute = std::move(execute);
+  m_passes.push_back(std::move(pass));
+  return PassBuilder(*this, (Pass)m_passes.size() - 1);
+}
+
+void RenderGraph::bind_to_backbuffer(Resource resource, bool bind)
+{
+  assert(m_resources[resource].type == ResourceType::TEXTURE);
+  m_resources[resource].bound_to_backbuffer = bind;
+}
+
+RenderGraph::Resource RenderGraph::resolve(Resource resource) const
+{
+  return m_resources[resource].bound_to_backbuffer ? m_backbuffer : resource;
+}
+
+void RenderGraph::resize(int w, int h)
+{
+  m_width = w;
+  m_height = h;
+  // attachments of framebuffers stay valid, storage of the same texture objects is reallocated
+  for (PhysicalTexture& physical : m_physical)
+  {
+    if (physical.texture)
+      physical.texture->resize(w, h, physical.desc.internal_format, physical.desc.format, physical.desc.type);
+  }
+}
+
+void RenderGraph::compile()
+{
+  for (ResourceData& resource : m_resources)
+  {
+    resource.first_use = resource.last_use = -1;
+    resource.physical = -1;
+  }
+  // backwards from passes whose results are visible outside of graph: pass is needed if something
+  // needed later reads what it writes
+  std::vector<uint8_t>& needed = m_needed;
+  needed.assign(m_resources.size(), 0);
+  for (int p = (int)m_passes.size() - 1; p >= 0; p--)
+  {
+    PassData& pass = m_passes[p];
+    pass.alive = false;
+    pass.barriers = 0;
+    if (pass.active && !pass.active())
+      continue;
+    bool alive = pass.side_effect;
+    for (const Use& use : pass.writes)
+    {
+      const Resource resource = resolve(use.resource);
+      alive = alive || needed[resource] || m_resources[resource].persistent || resource == m_backbuffer;
+    }
+    if (!alive)
+      continue;
+    pass.alive = true;
+    for (const Use& use : pass.reads)
+      needed[resolve(use.resource)] = 1;
+  }
+
+  // lifetimes and barriers. barrier is needed only when shader storage writes are consumed, writes to
+  // attachments are synchronized with later reads by OpenGL itself
+  std::vector<StorageWrite>& storage_writes = m_storage_writes;
+  storage_writes.assign(m_resources.size(), StorageWrite());
+  for (int p = 0; p < (int)m_passes.size(); p++)
+  {
+    PassData& pass = m_passes[p];
+    if (!pass.alive)
+      continue;
+    for (const std::vector<Use>* uses : { &pass.reads, &pass.writes })
+    {
+      for (const Use& use : *uses)
+      {
+        const Resource resource = resolve(use.resource);
+        ResourceData& data = m_resources[resource];
+        if (data.first_use < 0)
+          data.first_use = p;
+        data.last_use = p;
+        StorageWrite& write = storage_writes[resource];
+        if (!write.pending)
+          continue;
+        GLbitfield bit = 0;
+        switch (use.access)
+        {
+        case ATTACHMENT: bit = GL_FRAMEBUFFER_BARRIER_BIT; break;
+        case SAMPLED: bit = GL_TEXTURE_FETCH_BARRIER_BIT; break;
+        case STORAGE: bit = GL_SHADER_STORAGE_BARRIER_BIT; break;
+        case INDIRECT: bit = GL_COMMAND_BARRIER_BIT; break;
+        }
+        if (!(write.issued & bit))
+        {
+          pass.barriers |= bit;
+          write.issued |= bit;
+        }
+      }
+    }
+    for (const Use& use : pass.writes)
+    {
+      if (use.access == STORAGE)
+        storage_writes[resolve(use.resource)] = { true, 0 };
+    }
+  }
+
+  // persistent textures own their textures, indices don't change between compiles
+  int npersistent = 0;
+  for (ResourceData& resource : m_resources)
+  {
+    if (resource.type != ResourceType::TEXTURE || !resource.persistent)
+      continue;
+    if (npersistent == (int)m_physical.size())
+      m_physical.push_back({ resource.desc, -1, std::nullopt });
+    resource.physical = npersistent++;
+  }
+  for (int i = npersistent; i < (int)m_physical.size(); i++)
+    m_physical[i].busy_until = -1;
+  // transient textures in order of first use take free texture of the same format, new one only if there is none
+  std::vector<Resource>& transient = m_transient;
+  transient.clear();
+  for (Resource r = 0; r < (Resource)m_resources.size(); r++)
+  {
+    const ResourceData& resource = m_resources[r];
+    if (resource.type == ResourceType::TEXTURE && !resource.persistent && resource.first_use >= 0)
+      transient.push_back(r);
+  }
+  std::sort(transient.begin(), transient.end(), [this](Resource a, Resource b)
+    {
+      return m_resources[a].first_use < m_resources[b].first_use;
+    });
+  for (Resource r : transient)
+  {
+    ResourceData& resource = m_resources[r];
+    int slot = -1;
+    for (int i = npersistent; i < (int)m_physical.size() && slot < 0; i++)
+    {
+      if (m_physical[i].desc == resource.desc && m_physical[i].busy_until < resource.first_use)
+        slot = i;
+    }
+    if (slot < 0)
+    {
+      m_physical.push_back({ resource.desc, -1, std::nullopt });
+      slot = (int)m_physical.size() - 1;
+    }
+    m_physical[slot].busy_until = resource.last_use;
+    resource.physical = slot;
+  }
+}
+
+const Texture2D& RenderGraph::texture(Resource resource) const
+{
+  const int physical = m_resources[resource].physical;
+  assert(physical >= 0 && m_physical[physical].texture);
+  return *m_physical[physical].texture;
+}
+
+void RenderGraph::execute(FrameProfiler* profiler)
+{
+  for (PhysicalTexture& physical : m_physical)
+  {
+    if (!physical.texture)
+      physical.texture = Texture2D(m_width, m_height, physical.desc.internal_format, physical.desc.format, physical.desc.type);
+  }
+  for (int p = 0; p < (int)m_passes.size(); p++)
+  {
+    PassData& pass = m_passes[p];
+    if (!pass.alive)
+      continue;
+    if (profiler)
+      profiler->begin_pass(p, pass.name);
+    if (pass.barriers)
+      glMemoryBarrier(pass.barriers);
+    bind_target(pass);
+    pass.execute();
+    if (profiler)
+      profiler->end_pass(p);
+  }
+}
+
+void RenderGraph::bind_target(PassData& pass)
+{
+  // pass may both read and write attachment (depth test, blending), it's attached once
+  m_attachments.clear();
+  bool backbuffer = false;
+  for (const std::vector<Use>* uses : { &pass.writes, &pass.reads })
+  {
+    for (const Use& use : *uses)
+    {
+      const Resource resource = resolve(use.resource);
+      if (use.access != ATTACHMENT)
+        continue;
+      if (resource == m_backbuffer)
+        backbuffer = true;
+      else if (std::find(m_attachments.begin(), m_attachments.end(), resource) == m_attachments.end())
+        m_attachments.push_back(resource);
+    }
+  }
+  if (backbuffer)
+  {
+    // default framebuffer can't be combined with textures
+    assert(m_attachments.empty());
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    return;
+  }
+  // passes without attachments (compute, readbacks) bind what they need themselves
+  if (m_attachments.empty())
+    return;
+  m_attachment_ids.clear();
+  for (Resource resource : m_attachments)
+    m_attachment_ids.push_back(texture(resource).id());
+  if (!pass.fbo)
+    pass.fbo = FrameBufferObject();
+  pass.fbo->bind();
+  if (pass.attached == m_attachment_ids)
+    return;
+  // first use or aliasing gave pass different textures than last time
+  GLenum draw_buffers[8];
+  GLsizei ndraw_buffers = 0;
+  for (Resource resource : m_attachments)
+  {
+    const ResourceData& data = m_resources[resource];
+    GLenum attachment = GL_COLOR_ATTACHMENT0 + ndraw_buffers;
+    if (data.desc.format == GL_DEPTH_STENCIL)
+      attachment = GL_DEPTH_STENCIL_ATTACHMENT;
+    else if (data.desc.format == GL_DEPTH_COMPONENT)
+      attachment = GL_DEPTH_ATTACHMENT;
+    else
+      draw_buffers[ndraw_buffers++] = attachment;
+    pass.fbo->attach(texture(resource), attachment);
+  }
+  glDrawBuffers(ndraw_buffers, draw_buffers);
+  assert(pass.fbo->is_complete());
+  pass.attached = m_attachment_ids;
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <optional>
+#include <functional>
+#include <glad/glad.h>
+#include "FrameBufferObject.hpp"
+#include "Texture2D.hpp"
+
+class FrameProfiler;
+
+// Passes of a frame with resources they read and write. Every frame graph is compiled: passes which are inactive
+// or whose results nobody uses are culled, transient textures whose lifetimes don't overlap share one texture,
+// and memory barriers are placed before passes which consume results of shader storage writes. Passes run in
+// order they were added. Textures are sized to window and reallocated in one place on resize.
+// Compilation doesn't touch OpenGL, textures and framebuffers are created by execute.
+class RenderGraph
+{
+public:
+  using Resource = int;
+  using Pass = int;
+  enum Access
+  {
+    ATTACHMENT,  // rendered to, or its content is kept when pass reads it as attachment (blending, depth test)
+    SAMPLED,     // texture fetch
+    STORAGE,     // shader storage buffer or image load/store
+    INDIRECT     // indirect draw commands
+  };
+  struct TextureDesc
+  {
+    GLint internal_format;
+    GLint format;
+    GLint type;
+    bool operator==(const TextureDesc& other) const;
+  };
+  class PassBuilder
+  {
+  public:
+    PassBuilder& read(Resource resource, Access access);
+    PassBuilder& write(Resource resource, Access access);
+    // pass has effects outside of graph (readback, present), it's culled only when inactive
+    PassBuilder& side_effect();
+    // pass runs only while predicate returns true
+    PassBuilder& active_if(std::function<bool()> predicate);
+    Pass pass() const { return m_pass; }
+  private:
+    friend class RenderGraph;
+    PassBuilder(RenderGraph& graph, Pass pass) : m_graph(graph), m_pass(pass) {}
+    RenderGraph& m_graph;
+    Pass m_pass;
+  };
+public:
+  OnlyMovable(RenderGraph)
+  RenderGraph() = default;
+  // transient textures live only during frame, persistent ones keep content between frames.
+  // all resources are created before first compile
+  Resource create_texture(const std::string& name, const TextureDesc& desc, bool persistent = false);
+  // resource which graph doesn't allocate (buffers owned elsewhere), used for ordering and barriers only
+  Resource import_resource(const std::string& name);
+  // default framebuffer
+  Resource backbuffer() const { return m_backbuffer; }
+  // attachments of passes are framebuffer bound before pass runs
+  PassBuilder add_pass(const std::string& name, std::function<void()> execute);
+  // texture resource becomes default framebuffer, e.g. scene is drawn straight to window when there is no
+  // post processing. passes which sample it must be inactive meanwhile
+  void bind_to_backbuffer(Resource resource, bool bind);
+  void resize(int w, int h);
+  void compile();
+  // profiler measures every pass which runs, including its barriers and framebuffer binding
+  void execute(FrameProfiler* profiler = nullptr);
+public:
+  // state of last compile
+  bool is_culled(Pass pass) const { return !m_passes[pass].alive; }
+  GLbitfield barriers(Pass pass) const { return m_passes[pass].barriers; }
+  // index of texture which backs resource, -1 for culled, imported and backbuffer resources
+  int physical_index(Resource resource) const { return m_resources[resource].physical; }
+  int physical_count() const { return (int)m_physical.size(); }
+  // texture of resource, allocated by execute
+  const Texture2D& texture(Resource resource) const;
+  const std::string& name(Pass pass) const { return m_passes[pass].name; }
+  int pass_count() const { return (int)m_passes.size(); }
+private:
+  enum class ResourceType
+  {
+    TEXTURE,
+    IMPORTED,
+    BACKBUFFER
+  };
+  struct ResourceData
+  {
+    std::string name;
+    ResourceType type;
+    TextureDesc desc = {};
+    bool persistent = false;
+    bool bound_to_backbuffer = false;
+    int physical = -1;
+    int first_use = -1;  // pass indices, within lifetime texture can't be shared
+    int last_use = -1;
+  };
+  struct Use
+  {
+    Resource resource;
+    Access access;
+  };
+  struct PassData
+  {
+    std::string name;
+    std::function<void()> execute;
+    std::function<bool()> active;
+    std::vector<Use> reads;
+    std::vector<Use> writes;
+    bool side_effect = false;
+    bool alive = false;
+    GLbitfield barriers = 0;
+    std::optional<FrameBufferObject> fbo;
+    std::vector<GLuint> attached;  // textures attached to fbo, reattached when aliasing changes
+  };
+  struct StorageWrite
+  {
+    bool pending = false;  // written in shader storage and not every consumer synchronized yet
+    GLbitfield issued = 0;
+  };
+  struct PhysicalTexture
+  {
+    TextureDesc desc;
+    int busy_until = -1;  // last pass which uses it in current compile
+    std::optional<Texture2D> texture;
+  };
+private:
+  // backbuffer if resource is bound to it
+  Resource resolve(Resource resource) const;
+  void bind_target(PassData& pass);
+private:
+  std::vector<ResourceData> m_resources;
+  std::vector<PassData> m_passes;
+  std::vector<PhysicalTexture> m_physical;  // kept between frames, so aliasing doesn't reallocate
+  // scratch of compile and execute, reused so frames don't allocate
+  std::vector<uint8_t> m_needed;
+  std::vector<StorageWrite> m_storage_writes;
+  std::vector<Resource> m_transient;
+  std::vector<Resource> m_attachments;      // of pass being bound
+  std::vector<GLuint> m_attachment_ids;
+  Resource m_backbuffer = -1;
+  int m_width = 1;
+  int m_height = 1;
+};
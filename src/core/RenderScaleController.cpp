@@ -0,0 +1,45 @@
+#include <algorithm>
+#include <cmath>
+#include "RenderScaleController.hpp"
+
+bool RenderScaleController::update(float cpu_ms, float gpu_ms)
+{
+  const float frame_ms = std::max(cpu_ms, gpu_ms);
+  m_frame_ms = m_frame_ms < 0.f ? frame_ms : m_frame_ms + (frame_ms - m_frame_ms) * 0.2f;
+  // both current frame and average have to agree, so a spike (e.g. shader compilation) which lingers
+  // in average doesn't change scale
+  const float slow = m_settings.target_frame_ms * m_settings.slow_ratio;
+  const float fast = m_settings.target_frame_ms * m_settings.fast_ratio;
+  m_slow_frames = frame_ms > slow && m_frame_ms > slow ? m_slow_frames + 1 : 0;
+  m_fast_frames = frame_ms < fast && m_frame_ms < fast ? m_fast_frames + 1 : 0;
+
+  float scale = m_scale;
+  if (m_slow_frames >= m_settings.frames_to_lower)
+    scale = m_scale - m_settings.step;
+  else if (m_fast_frames >= m_settings.frames_to_raise)
+    scale = m_scale + m_settings.step;
+  scale = std::clamp(scale, m_settings.min_scale, m_settings.max_scale);
+  if (scale == m_scale)
+    return false;
+  // frames measured at previous scale say nothing about the new one
+  m_scale = scale;
+  m_frame_ms = -1.f;
+  m_slow_frames = 0;
+  m_fast_frames = 0;
+  return true;
+}
+
+void RenderScaleController::reset()
+{
+  m_scale = m_settings.max_scale;
+  m_frame_ms = -1.f;
+  m_slow_frames = 0;
+  m_fast_frames = 0;
+}
+
+glm::ivec2 RenderScaleController::render_size(const glm::ivec2& window_size) const
+{
+  return glm::ivec2(
+    std::max((int)std::lround(window_size.x * m_scale), 1),
+    std::max((int)std::lround(window_size.y * m_scale), 1));
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+// Chooses internal resolution of the scene so frame time stays within budget. Frame time is the slower of
+// CPU and GPU time, smoothed over several frames. Scale is lowered in coarse steps when frames are too slow
+// for a while, and raised back only after a longer period with enough headroom, so it doesn't oscillate.
+class RenderScaleController
+{
+public:
+  struct Settings
+  {
+    float target_frame_ms = 1000.f / 60.f;
+    float min_scale = 0.5f;
+    float max_scale = 1.f;
+    float step = 0.125f;
+    float slow_ratio = 1.05f;  // frame is too slow above target * slow_ratio
+    float fast_ratio = 0.75f;  // there is headroom below target * fast_ratio
+    int frames_to_lower = 10;
+    int frames_to_raise = 45;
+  };
+public:
+  RenderScaleController() = default;
+  explicit RenderScaleController(const Settings& settings) : m_settings(settings) { reset(); }
+  Settings& settings() { return m_settings; }
+  const Settings& settings() const { return m_settings; }
+  // returns true if scale changed. negative gpu time means it isn't known yet
+  bool update(float cpu_ms, float gpu_ms);
+  // back to max scale, forgets measured frames
+  void reset();
+  float scale() const { return m_scale; }
+  float smoothed_frame_ms() const { return m_frame_ms; }
+  // scaled size, at least one pixel
+  glm::ivec2 render_size(const glm::ivec2& window_size) const;
+private:
+  Settings m_settings;
+  float m_scale = 1.f;
+  float m_frame_ms = -1.f;
+  int m_slow_frames = 0;
+  int m_fast_frames = 0;
+};
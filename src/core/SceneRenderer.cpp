@@ -9,6 +9,12 @@
 #include <glm/gtx/matrix_decompose.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <sstream>
+#include <cstring>
+#include <chrono>
+#include <limits>
+#include <iostream>
+#include <fstream>
+#include <stb_image_write.h>
 
 #include "SceneRenderer.hpp"
 #include "Ui.hpp"
@@ -24,6 +30,10 @@
 #include "CursorPositionHandler.hpp"
 #include "MouseInputHandler.hpp"
 #include "ShaderStorage.hpp"
+#include "ModelLoader.hpp"
+#include "FrameRecorder.hpp"
+#include "Tracer.hpp"
+#include "MemoryProfiler.hpp"
 #include "./ge/Cube.hpp"
 #include "./ge/Icosahedron.hpp"
 #include "./ge/Polyline.hpp"
@@ -38,57 +48,112 @@ using namespace GlobalState;
 
 SceneRenderer::SceneRenderer()
 {
+  TRACE_THREAD_NAME("main");
+  const LaunchOptions& options = launch_options();
+  // null platform has no display, windows there are only sizes and context comes from EGL
+  if (options.headless)
+    glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
   glfwInit();
-  int w = 1600, h = 900;
+  int w = options.width, h = options.height;
   //get_desktop_resolution(w, h);
 
   // fullscreen window
-  m_window = std::make_unique<MainWindow>(w, h, "MainWindow");
+  m_window = std::make_unique<MainWindow>(w, h, "MainWindow", options.headless, options.headless && options.external_gl);
   m_gpu_buffers = std::make_unique<GPUBuffers>();
-  m_ui = std::make_unique<Ui>(*this, m_window.get());
-  m_camera.set_position(glm::vec3(-4.f, 2.f, 3.f));
-  m_camera.look_at(glm::vec3(2.f, 0.5f, 0.5f));
+  if (!options.headless)
+    m_ui = std::make_unique<Ui>(*this, m_window.get());
+  m_camera.set_position(options.camera_position.value_or(glm::vec3(-4.f, 2.f, 3.f)));
+  m_camera.look_at(options.camera_target.value_or(glm::vec3(2.f, 0.5f, 0.5f)));
   m_projection_mat = glm::mat4(1.f);
   m_projection_mat = glm::perspective(glm::radians(45.f), (float)m_window->width() / m_window->height(), 0.1f, 100.f);
 
   ShaderStorage::init();
 
-  auto main_scene_fbo = FrameBufferObject();
-  main_scene_fbo.bind();
-  main_scene_fbo.attach_texture(w, h, GL_RGB, GL_RGB, GL_UNSIGNED_BYTE);
-  main_scene_fbo.attach_renderbuffer(w, h, GL_DEPTH24_STENCIL8, GL_DEPTH_STENCIL_ATTACHMENT);
-  main_scene_fbo.unbind();
-  m_fbos["main"] = std::move(main_scene_fbo);
-
-  auto picking_fbo = FrameBufferObject();
-  picking_fbo.bind();
-  picking_fbo.attach_texture(w, h, GL_RGBA32F, GL_RGBA, GL_FLOAT);
-  picking_fbo.attach_renderbuffer(w, h, GL_DEPTH_COMPONENT, GL_DEPTH_ATTACHMENT);
-  picking_fbo.unbind();
-  m_fbos["picking"] = std::move(picking_fbo);
+  m_render_graph.resize(w, h);
+  m_gpu_picker = std::make_unique<GPUPicker>(w, h);
+  m_indirect_renderer = std::make_unique<IndirectRenderer>();
+  m_visibility_buffer = std::make_unique<VisibilityBuffer>(w, h);
+  m_gpu_culler = std::make_unique<GPUCuller>();
+  m_gpu_frame_timer = std::make_unique<GPUTimer>();
+  m_profiler = std::make_unique<FrameProfiler>();
+  // window waiting for events in render on demand mode wakes up to add finished model
+  std::function<void()> on_import_finished;
+  if (!options.headless)
+    on_import_finished = []() { glfwPostEmptyEvent(); };
+  if (!options.mesh_cache.empty())
+    m_mesh_cache = std::make_unique<MeshCache>(options.mesh_cache);
+  m_importer = std::make_unique<ModelImporter>(0, m_mesh_cache.get(), std::move(on_import_finished));
 }
 
 SceneRenderer::~SceneRenderer()
 {
+  // context goes away with window
+  ShaderStorage::release();
 }
 
 void SceneRenderer::render()
 {
   GLFWwindow* gl_window = m_window->gl_window();
-  ::setup_opengl();
-  create_scene();
+  prepare_render();
+
+  if (m_window->headless())
+  {
+    render_headless();
+    return;
+  }
+
+  // idle loop wakes up this often to present previous image even if there was no input
+  constexpr double idle_timeout = 0.5;
 
-  for (const auto& [name, fbo] : m_fbos)
+  while (!glfwWindowShouldClose(gl_window))
   {
-    fbo.bind();
-    assert(fbo.is_complete());
-    fbo.unbind();
+    if (m_render_on_demand && !needs_redraw())
+    {
+      const double wait_start = glfwGetTime();
+      glfwWaitEventsTimeout(idle_timeout);
+      if (glfwGetTime() - wait_start < idle_timeout)
+      {
+        // woken up by event, few frames are drawn so ui can react to it
+        request_redraw();
+      }
+      else
+      {
+        m_gpu_buffers->stream->begin_frame();
+        present_scene(*m_screen_quad);
+        m_ui->render_last_frame();
+        m_gpu_buffers->stream->end_frame();
+        glfwSwapBuffers(gl_window);
+        m_stats.frames_skipped++;
+        continue;
+      }
+    }
+    else
+    {
+      glfwPollEvents();
+    }
+    m_redraw_frames = std::max(m_redraw_frames - 1, 0);
+    render_frame();
+    if (m_dynamic_resolution)
+    {
+      if (m_render_scale.update(m_stats.cpu_frame_ms, m_stats.gpu_frame_ms))
+        request_redraw();
+    }
+    else
+      m_render_scale.reset();
+    glfwSwapBuffers(gl_window);
   }
-  const auto& main_fbo = m_fbos.at("main");
-  const auto& picking_fbo = m_fbos.at("picking");
-  ScreenQuad screen_quad(main_fbo.texture()->id());
+}
+
+void SceneRenderer::prepare_render()
+{
+  ::setup_opengl();
+  create_scene();
+
+  // textures are assigned by passes of render graph
+  m_screen_quad = std::make_unique<ScreenQuad>(0);
+  m_outline_quad = std::make_unique<ScreenQuad>(0);
 
-  const std::string skybox_folder = ".\\.\\src\\textures\\skybox\\";
+  const std::string skybox_folder = "./src/textures/skybox/";
   std::array<std::string, 6> skybox_faces =
   { 
     skybox_folder + "right.jpg",
@@ -98,83 +163,336 @@ void SceneRenderer::render()
     skybox_folder + "front.jpg",
     skybox_folder + "back.jpg" 
   };
-  Skybox skybox(Cubemap(std::move(skybox_faces)));
+  m_skybox = std::make_unique<Skybox>(Cubemap(std::move(skybox_faces)));
+  build_render_graph(*m_skybox, *m_screen_quad, *m_outline_quad);
+}
 
-  Shader& picking_shader = ShaderStorage::get(ShaderStorage::PICKING);
-  Shader& main_shader = ShaderStorage::get(ShaderStorage::MAIN);
-  Shader& skybox_shader = ShaderStorage::get(ShaderStorage::SKYBOX);
-  Shader& fbo_default_shader = ShaderStorage::get(ShaderStorage::FBO_DEFAULT);
+void SceneRenderer::render_frame()
+{
+  TRACE_ZONE("SceneRenderer::render_frame");
+  const auto frame_start = std::chrono::steady_clock::now();
+  const MemoryProfiler::Snapshot memory_start = MemoryProfiler::snapshot();
+  m_gpu_frame_timer->begin();
+  m_profiler->begin_frame();
+  m_gpu_buffers->stream->begin_frame();
+  add_imported_models();
+  new_frame_update();
+  handle_input();
+  update_bvh();
+  update_static_geometry();
+  cull_scene();
+  glPolygonMode(GL_FRONT_AND_BACK, m_polygon_mode);
 
-  while (!glfwWindowShouldClose(gl_window))
+  // result of picking requested in one of previous frames
+  if (auto pick = m_gpu_picker->poll(); pick && pick->object >= 0 && pick->object < (int)m_drawables.size())
   {
-    glfwPollEvents();
-    new_frame_update();
-    handle_input();
-    glPolygonMode(GL_FRONT_AND_BACK, m_polygon_mode);
-
-    picking_fbo.bind();
-    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
-    glEnable(GL_DEPTH_TEST);
-    picking_shader.bind();
-    render_scene(picking_shader, /*assignIndices*/true);
-    picking_fbo.unbind();
-
-    // render to a custom framebuffer
-    main_fbo.bind();
-    glClearColor(0.07f, 0.13f, 0.17f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
-    glEnable(GL_DEPTH_TEST);
-    main_shader.bind();
-    // render scene before gui to make sure that imgui window always will be on top of drawn entities
-    render_scene(main_shader);
-    // render skybox
-    glDepthFunc(GL_LEQUAL);
-    skybox_shader.bind();
-    skybox_shader.set_matrix4f("viewMatrix", m_camera.view_matrix());
-    skybox_shader.set_matrix4f("projectionMatrix", m_projection_mat);
-    skybox.render(m_gpu_buffers.get());
-    skybox_shader.unbind();
-    glDepthFunc(GL_LESS);
-    m_ui->render();
-    main_fbo.unbind();
-
-    // set GL_FILL mode because next we are rendering texture
-    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-    glDisable(GL_DEPTH_TEST);
-    fbo_default_shader.bind();
-    screen_quad.render(m_gpu_buffers.get());
+    select_object(pick->object);
+  }
+  // scene is drawn straight into window when its image isn't scaled or kept for idle frames
+  m_scene_in_backbuffer = render_size() == glm::ivec2(m_window->width(), m_window->height()) && !m_render_on_demand && !m_window->headless();
+  m_render_graph.bind_to_backbuffer(m_scene_color, m_scene_in_backbuffer);
+  m_render_graph.bind_to_backbuffer(m_scene_depth, m_scene_in_backbuffer);
+  m_render_graph.compile();
+  m_render_graph.execute(m_profiler.get());
 
-    glfwSwapBuffers(gl_window);
+  m_gpu_buffers->stream->end_frame();
+  m_profiler->end_frame();
+  m_gpu_frame_timer->end();
+  m_stats.cpu_frame_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - frame_start).count();
+  m_stats.gpu_frame_ms = m_gpu_frame_timer->last_ms();
+  const MemoryProfiler::Snapshot memory_end = MemoryProfiler::snapshot();
+  const MemoryProfiler::Counters frame_memory = MemoryProfiler::difference(memory_start, memory_end).total;
+  m_stats.frame_allocations = frame_memory.allocations;
+  m_stats.frame_allocated_bytes = frame_memory.allocated_bytes;
+  m_stats.live_bytes = memory_end.total.live_bytes();
+  m_stats.peak_bytes = memory_end.total.peak_bytes;
+}
+
+void SceneRenderer::render_headless()
+{
+  const LaunchOptions& options = launch_options();
+  std::optional<CameraPath> camera_path;
+  if (options.camera_path == "orbit")
+    camera_path = orbit_camera_path(options.frames * options.frame_time);
+  else if (!options.camera_path.empty())
+  {
+    camera_path = CameraPath::load(options.camera_path);
+    if (!camera_path)
+      throw std::runtime_error("Could not load camera path from file " + options.camera_path);
+  }
+  if (options.max_frame_allocations >= 0 && !MemoryProfiler::enabled())
+    throw std::runtime_error("Allocations of frames are counted in builds with OPENGL_ENGINE_MEMORY_TRACKING only");
+  FrameRecorder recorder;
+  int gpu_measurements = m_gpu_frame_timer->measurements();
+  for (int frame = 0; frame < options.frames; frame++)
+  {
+    if (camera_path)
+    {
+      const float time = frame * options.frame_time;
+      m_camera.set_position(camera_path->position(time));
+      m_camera.look_at(camera_path->target(time));
+    }
+    render_frame();
+    if (frame >= options.warmup_frames)
+    {
+      recorder.record("cpu_frame_ms", m_stats.cpu_frame_ms);
+      // results arrive few frames late and not necessarily one per frame, each is recorded once
+      if (m_gpu_frame_timer->measurements() != gpu_measurements)
+        recorder.record("gpu_frame_ms", m_stats.gpu_frame_ms);
+      recorder.record("draw_calls", m_stats.draw_calls);
+      recorder.record("uploaded_bytes", (double)m_gpu_buffers->stream->last_frame_size());
+      if (MemoryProfiler::enabled())
+        recorder.record("allocations", (double)m_stats.frame_allocations);
+      // steady state frames are expected to reuse memory of previous ones
+      if (options.max_frame_allocations >= 0 && m_stats.frame_allocations > (uint64_t)options.max_frame_allocations)
+      {
+        throw std::runtime_error("Frame " + std::to_string(frame) + " did " + std::to_string(m_stats.frame_allocations) +
+          " heap allocations, at most " + std::to_string(options.max_frame_allocations) + " expected");
+      }
+    }
+    gpu_measurements = m_gpu_frame_timer->measurements();
+    const std::string path = options.output_path(frame);
+    if (!path.empty())
+    {
+      save_scene_image(path);
+      std::cout << "Frame " << frame << " written to " << path << '\n';
+    }
+  }
+  if (!options.report.empty())
+  {
+    recorder.set_info("scene", options.scene);
+    recorder.set_info("camera_path", options.camera_path);
+    recorder.set_info("width", options.width);
+    recorder.set_info("height", options.height);
+    recorder.set_info("frames", options.frames);
+    recorder.set_info("warmup_frames", options.warmup_frames);
+    recorder.set_info("frame_time", options.frame_time);
+    recorder.set_info("objects", (double)m_drawables.size());
+    recorder.set_info("renderer", reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+    std::ofstream report(options.report);
+    recorder.write_json(report);
+    if (!report)
+      throw std::runtime_error("Could not write report " + options.report);
+    std::cout << "Report written to " << options.report << '\n';
   }
 }
 
-void SceneRenderer::render_scene(Shader& shader, bool assignIndices)
+CameraPath SceneRenderer::orbit_camera_path(float duration) const
 {
+  BoundingBox bounds;
+  for (const auto& obj : m_drawables)
+  {
+    const BoundingBox bbox = obj->world_bbox();
+    if (bbox.is_empty())
+      continue;
+    bounds = bounds.is_empty() ? bbox : BoundingBox(glm::min(bounds.min(), bbox.min()), glm::max(bounds.max(), bbox.max()));
+  }
+  const glm::vec3 center = bounds.is_empty() ? glm::vec3(0.f) : bounds.center();
+  const glm::vec3 extents = bounds.is_empty() ? glm::vec3(1.f) : bounds.extents();
+  const float radius = std::max(extents.x, extents.z) * 1.5f + 2.f;
+  return CameraPath::orbit(center, radius, extents.y + radius * 0.3f, duration);
+}
+
+void SceneRenderer::save_scene_image(const std::string& path) const
+{
+  const glm::ivec2 size = render_size();
+  std::vector<unsigned char> pixels(size.x * size.y * 3);
+  GLint prev_fbo = 0;
+  glGetIntegerv(GL_FRAMEBUFFER_BINDING, &prev_fbo);
+  FrameBufferObject fbo;
+  fbo.bind();
+  fbo.attach(m_render_graph.texture(m_scene_color), GL_COLOR_ATTACHMENT0);
+  // rows of RGB image aren't aligned to 4 bytes
+  glPixelStorei(GL_PACK_ALIGNMENT, 1);
+  glReadPixels(0, 0, size.x, size.y, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+  glPixelStorei(GL_PACK_ALIGNMENT, 4);
+  glBindFramebuffer(GL_FRAMEBUFFER, prev_fbo);
+  // OpenGL rows go from bottom to top
+  stbi_flip_vertically_on_write(1);
+  if (!stbi_write_png(path.c_str(), size.x, size.y, 3, pixels.data(), size.x * 3))
+    throw std::runtime_error("Could not write image " + path);
+}
+
+void SceneRenderer::build_render_graph(Skybox& skybox, ScreenQuad& screen_quad, ScreenQuad& outline_quad)
+{
+  RenderGraph& graph = m_render_graph;
+  // scene outlives frame, idle frames of render on demand present it again
+  m_scene_color = graph.create_texture("scene_color", { GL_RGB, GL_RGB, GL_UNSIGNED_BYTE }, true);
+  m_scene_depth = graph.create_texture("scene_depth", { GL_DEPTH24_STENCIL8, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8 });
+  const RenderGraph::Resource outline_mask = graph.create_texture("outline_mask", { GL_R8, GL_RED, GL_UNSIGNED_BYTE });
+  const RenderGraph::Resource cull_commands = graph.import_resource("cull_commands");
+
+  graph.add_pass("gpu_cull", [this]
+    {
+      m_gpu_culler->cull(m_projection_mat * m_camera.view_matrix());
+    })
+    .write(cull_commands, RenderGraph::STORAGE)
+    .active_if([this] { return gpu_culling_active(); });
+
+  graph.add_pass("picking", [this]
+    {
+      // ids of visibility buffer are at render resolution, picker needs them at window resolution
+      const glm::ivec2 window_size(m_window->width(), m_window->height());
+      const bool shared_ids = m_visibility_draw && !gpu_culling_active() && render_size() == window_size;
+      m_gpu_picker->render(m_drawables, m_visible, m_camera.view_matrix(), m_projection_mat, m_gpu_buffers.get(),
+        shared_ids ? m_visibility_buffer.get() : nullptr);
+    })
+    .side_effect()
+    .active_if([this] { return m_gpu_picker->has_request(); });
+
+  graph.add_pass("scene", [this]
+    {
+      const glm::ivec2 scene_size = render_size();
+      glViewport(0, 0, scene_size.x, scene_size.y);
+      glClearColor(0.07f, 0.13f, 0.17f, 1.0f);
+      glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+      glEnable(GL_DEPTH_TEST);
+      update_lights();
+      Shader& main_shader = ShaderStorage::get(ShaderStorage::MAIN);
+      main_shader.bind();
+      render_scene(main_shader);
+    })
+    .read(cull_commands, RenderGraph::INDIRECT)
+    .write(m_scene_color, RenderGraph::ATTACHMENT)
+    .write(m_scene_depth, RenderGraph::ATTACHMENT);
+
+  graph.add_pass("skybox", [this, &skybox]
+    {
+      glDepthFunc(GL_LEQUAL);
+      Shader& skybox_shader = ShaderStorage::get(ShaderStorage::SKYBOX);
+      skybox_shader.bind();
+      skybox_shader.set_matrix4f("viewMatrix", m_camera.view_matrix());
+      skybox_shader.set_matrix4f("projectionMatrix", m_projection_mat);
+      skybox.render(m_gpu_buffers.get());
+      skybox_shader.unbind();
+      glDepthFunc(GL_LESS);
+    })
+    .read(m_scene_depth, RenderGraph::ATTACHMENT)
+    .write(m_scene_color, RenderGraph::ATTACHMENT);
+
+  graph.add_pass("outline_mask", [this]
+    {
+      render_outline_mask();
+    })
+    .write(outline_mask, RenderGraph::ATTACHMENT)
+    .active_if([this] { return !m_selected_objects.empty(); });
+
+  graph.add_pass("outline_composite", [this, &outline_quad, outline_mask]
+    {
+      outline_quad.m_tex_id = m_render_graph.texture(outline_mask).id();
+      composite_outline(outline_quad);
+    })
+    .read(outline_mask, RenderGraph::SAMPLED)
+    .write(m_scene_color, RenderGraph::ATTACHMENT)
+    .active_if([this] { return !m_selected_objects.empty(); });
+
+  graph.add_pass("present", [this, &screen_quad]
+    {
+      screen_quad.m_tex_id = m_render_graph.texture(m_scene_color).id();
+      present_scene(screen_quad);
+    })
+    .read(m_scene_color, RenderGraph::SAMPLED)
+    .write(graph.backbuffer(), RenderGraph::ATTACHMENT)
+    .active_if([this] { return !m_scene_in_backbuffer && !m_window->headless(); });
+
+  // ui is drawn over upscaled scene at full resolution
+  graph.add_pass("ui", [this]
+    {
+      glViewport(0, 0, m_window->width(), m_window->height());
+      m_ui->render();
+    })
+    .read(graph.backbuffer(), RenderGraph::ATTACHMENT)
+    .write(graph.backbuffer(), RenderGraph::ATTACHMENT)
+    .side_effect()
+    .active_if([this] { return m_ui != nullptr; });
+}
+
+void SceneRenderer::present_scene(ScreenQuad& screen_quad)
+{
+  const glm::ivec2 window_size(m_window->width(), m_window->height());
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  glViewport(0, 0, window_size.x, window_size.y);
+  // set GL_FILL mode because next we are rendering texture
+  glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+  glDisable(GL_DEPTH_TEST);
+  Shader& fbo_default_shader = ShaderStorage::get(ShaderStorage::FBO_DEFAULT);
+  fbo_default_shader.bind();
+  fbo_default_shader.set_vec2("uvScale", glm::vec2(render_size()) / glm::vec2(window_size));
+  screen_quad.render(m_gpu_buffers.get());
+}
+
+void SceneRenderer::request_redraw(int frames)
+{
+  m_redraw_frames = std::max(m_redraw_frames, frames);
+}
+
+bool SceneRenderer::needs_redraw() const
+{
+  const KeyboardHandler* kh = static_cast<const KeyboardHandler*>(m_window->input_handlers()[0].get());
+  // camera moves while key is held, though no new events arrive.
+  // image drawn straight into window isn't kept anywhere to present it again
+  if (m_redraw_frames > 0 || m_scene_in_backbuffer || m_gpu_picker->busy() || (!kh->disabled() && kh->has_pressed_keys()))
+    return true;
+  // progress of imports is shown and geometry of new models is still being uploaded
+  if (m_pending_uploads > 0 || m_importer->busy())
+    return true;
+  for (const auto& obj : m_drawables)
+  {
+    if (obj->is_rotating())
+      return true;
+  }
+  return false;
+}
+
+void SceneRenderer::render_scene(Shader& shader)
+{
+  TRACE_ZONE("SceneRenderer::render_scene");
   shader.set_vec3("viewPos", m_camera.position());
   shader.set_matrix4f("viewMatrix", m_camera.view_matrix());
   shader.set_matrix4f("projectionMatrix", m_projection_mat);
+  set_light_uniforms(shader);
+  m_stats.objects_batched = 0;
+  m_stats.multi_draw_calls = 0;
+  int draw_calls = 0;
+  const bool gpu_culling = gpu_culling_active();
+  if (m_indirect_draw)
+  {
+    m_indirect_renderer->begin_frame();
+  }
   for (int i = 0; i < (int)m_drawables.size(); i++)
   {
     Object3D* pobj = m_drawables[i].get();
     IDrawable* pdrawable = static_cast<IDrawable*>(pobj);
-    shader.set_matrix4f("modelMatrix", pobj->model_matrix());
-    shader.set_bool("applyTexture", pobj->has_active_texture());
-    shader.set_bool("applyShading", pobj->m_shading_mode != Object3D::ShadingMode::NO_SHADING && !pobj->is_light_source());
     if (pobj->is_rotating())
     {
       pobj->rotate(pobj->m_rotation_angle, pobj->m_rotation_axis);
     }
-    if (pobj->is_light_source())
+    // culled by compute shader and drawn after the loop
+    if (gpu_culling && m_gpu_static[i])
+    {
+      continue;
+    }
+    // rotation has to be updated even if object itself is out of view
+    if (i < (int)m_visible.size() && !m_visible[i])
     {
-      // center in world space
-      shader.set_vec3("lightPos", pobj->center() + glm::vec3(pobj->m_model_mat[3]));
-      shader.set_vec3("lightColor", glm::vec3(1.f));
+      continue;
     }
-    if (assignIndices)
+    // waits for its first upload, streaming whole geometry of large model meanwhile would cost more than the upload
+    if (m_indirect_draw && IndirectRenderer::is_batchable(*pobj) && !m_indirect_renderer->has_geometry(i) &&
+      pobj->get_flag(Object3D::GEOMETRY_CHANGED))
     {
-      shader.set_uint("objectIndex", i + 1);
+      continue;
     }
+    // drawn all at once after the loop
+    if (m_indirect_draw && IndirectRenderer::is_batchable(*pobj) && m_indirect_renderer->has_geometry(i))
+    {
+      m_indirect_renderer->submit(i, *pobj);
+      m_stats.objects_batched++;
+      continue;
+    }
+    shader.set_matrix4f("modelMatrix", pobj->model_matrix());
+    shader.set_bool("applyTexture", pobj->has_active_texture());
+    shader.set_bool("applyShading", pobj->m_shading_mode != Object3D::ShadingMode::NO_SHADING && !pobj->is_light_source());
     // setup shader for drawing lines
     if (pobj->is_bbox_visible() || pobj->is_normals_visible())
     {
@@ -186,53 +504,459 @@ void SceneRenderer::render_scene(Shader& shader, bool assignIndices)
       sh.unbind();
       shader.bind();
     }
-    // !assignIndices is a temp workaround to avoid crash when selecting same object twice,
-    // because render outlining color to the picking FBO will overwrite assigned object index before
-    // TODO: fix this
-    // TODO: outlining for objects without surface (e.g. polylines)
-    if (pobj->is_selected() && pobj->has_surface() && !assignIndices)
-    {
-      // first pass, fill stencil buffer
-      glStencilFunc(GL_ALWAYS, 1, 0xFF);
-      // enable writing to stencil buffer
-      glStencilMask(0xFF);
-      pdrawable->render(m_gpu_buffers.get());
-
-      // second pass, discard fragments
-      glStencilFunc(GL_NOTEQUAL, 1, 0xFF);
-      // disable writing to stencil buffer
-      glStencilMask(0x00);
-      glEnable(GL_DEPTH_TEST);
-      // apply smooth shading to correctly draw outlining by moving all vertices along normal direction
-      auto shading_mode = pobj->shading_mode();
-      bool visible_normals = pobj->is_normals_visible();
-      if (shading_mode != Object3D::ShadingMode::SMOOTH_SHADING)
-        pobj->apply_shading(Object3D::ShadingMode::SMOOTH_SHADING);
-      pobj->visible_normals(false);
-
-      Shader& outlining_shader = ShaderStorage::get(ShaderStorage::OUTLINING);
-      outlining_shader.bind();
-      outlining_shader.set_matrix4f("viewMatrix", m_camera.view_matrix());
-      outlining_shader.set_matrix4f("projectionMatrix", m_projection_mat);
-      outlining_shader.set_matrix4f("modelMatrix", pobj->model_matrix());
-      pdrawable->render(m_gpu_buffers.get());
-
-      glStencilFunc(GL_ALWAYS, 0, 0xFF);
-      glStencilMask(0xFF);
-
-      // activate previous shader and set variables
-      shader.bind();
-      pobj->apply_shading(shading_mode);
-      pobj->visible_normals(visible_normals);
+    pdrawable->render(m_gpu_buffers.get());
+    draw_calls += (int)pobj->meshes().size();
+  }
+  // visibility buffer ids cover only draws submitted on CPU
+  if (m_indirect_draw && m_visibility_draw && !gpu_culling && VisibilityBuffer::can_encode(*m_indirect_renderer))
+  {
+    const glm::mat4& view = m_camera.view_matrix();
+    m_stats.multi_draw_calls = m_visibility_buffer->render(*m_indirect_renderer, *m_gpu_buffers->stream, view, m_projection_mat);
+    Shader& resolve_shader = ShaderStorage::get(ShaderStorage::VISIBILITY_RESOLVE);
+    resolve_shader.bind();
+    resolve_shader.set_vec3("viewPos", m_camera.position());
+    resolve_shader.set_matrix4f("viewMatrix", view);
+    resolve_shader.set_matrix4f("projectionMatrix", m_projection_mat);
+    set_light_uniforms(resolve_shader);
+    m_visibility_buffer->resolve(*m_indirect_renderer, resolve_shader);
+    shader.bind();
+  }
+  else
+  {
+    m_visibility_buffer->invalidate();
+    if (m_indirect_draw)
+      m_stats.multi_draw_calls = m_indirect_renderer->draw(shader, *m_gpu_buffers->stream);
+    if (gpu_culling)
+      m_stats.multi_draw_calls += m_gpu_culler->draw(shader, *m_indirect_renderer);
+  }
+  m_stats.draw_calls = draw_calls + m_stats.multi_draw_calls;
+}
+
+void SceneRenderer::update_lights()
+{
+  // matches Light in lighting.glsl (std430)
+  struct GPULight
+  {
+    glm::vec4 position_range;
+    glm::vec4 color_intensity;
+    glm::vec4 direction_type;
+    glm::vec4 spot_cos;
+  };
+  static GLint storage_alignment = 0;
+  if (storage_alignment == 0)
+  {
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &storage_alignment);
+    storage_alignment = std::max(storage_alignment, 16);
+  }
+
+  const glm::mat4& view = m_camera.view_matrix();
+  m_lights.clear();
+  for (int i = 0; i < (int)m_drawables.size(); i++)
+  {
+    if (m_drawables[i]->is_light_source())
+      m_lights.push_back(i);
+  }
+  StreamingBuffer& stream = *m_gpu_buffers->stream;
+  // empty ranges can't be bound, so there is always at least one element
+  const size_t lights_size = sizeof(GPULight) * std::max<size_t>(m_lights.size(), 1);
+  const StreamingBuffer::Allocation lights = stream.allocate(lights_size, storage_alignment);
+  GPULight* gpu_lights = static_cast<GPULight*>(lights.data);
+  m_light_spheres.resize(m_lights.size());
+  for (size_t i = 0; i < m_lights.size(); i++)
+  {
+    Object3D& obj = *m_drawables[m_lights[i]];
+    const Light& light = obj.light();
+    const BoundingBox bbox = obj.world_bbox();
+    const glm::vec3 pos = bbox.is_empty() ? glm::vec3(obj.model_matrix()[3]) : bbox.center();
+    const glm::vec3 dir = glm::mat3(obj.model_matrix()) * light.direction;
+    const glm::vec3 direction = glm::dot(dir, dir) > 0.f ? glm::normalize(dir) : glm::vec3(0.f, -1.f, 0.f);
+    gpu_lights[i].position_range = glm::vec4(pos, light.range);
+    gpu_lights[i].color_intensity = glm::vec4(light.color, light.intensity);
+    gpu_lights[i].direction_type = glm::vec4(direction, light.type == Light::SPOT ? 1.f : 0.f);
+    gpu_lights[i].spot_cos = glm::vec4(std::cos(glm::radians(light.inner_angle)), std::cos(glm::radians(light.outer_angle)), 0.f, 0.f);
+    // spot lights are bound by sphere of their range as well, cone is cut in shader
+    m_light_spheres[i] = glm::vec4(glm::vec3(view * glm::vec4(pos, 1.f)), light.range);
+  }
+  m_light_clusters.set_projection(m_projection_mat);
+  m_light_clusters.build(m_light_spheres);
+  m_stats.lights = (int)m_lights.size();
+  m_stats.light_indices = (int)m_light_clusters.light_indices().size();
+
+  const auto& clusters = m_light_clusters.clusters();
+  const auto& indices = m_light_clusters.light_indices();
+  const StreamingBuffer::Allocation gpu_clusters = stream.upload(clusters.data(), sizeof(LightClusters::Cluster) * clusters.size(), storage_alignment);
+  const size_t indices_size = sizeof(uint32_t) * std::max<size_t>(indices.size(), 1);
+  const StreamingBuffer::Allocation gpu_indices = stream.allocate(indices_size, storage_alignment);
+  if (!indices.empty())
+    memcpy(gpu_indices.data, indices.data(), sizeof(uint32_t) * indices.size());
+  glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 1, lights.buffer, lights.offset, lights_size);
+  glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 2, gpu_clusters.buffer, gpu_clusters.offset, sizeof(LightClusters::Cluster) * clusters.size());
+  glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 3, gpu_indices.buffer, gpu_indices.offset, indices_size);
+}
+
+void SceneRenderer::set_light_uniforms(Shader& shader)
+{
+  shader.set_vec3("clusterGrid", glm::vec3(LightClusters::grid_x, LightClusters::grid_y, LightClusters::grid_z));
+  shader.set_vec2("screenSize", glm::vec2(render_size()));
+  shader.set_float("sliceScale", m_light_clusters.slice_scale());
+  shader.set_float("sliceBias", m_light_clusters.slice_bias());
+}
+
+glm::ivec2 SceneRenderer::render_size() const
+{
+  // framebuffers are never bigger than window
+  const glm::ivec2 window_size(m_window->width(), m_window->height());
+  return glm::min(m_render_scale.render_size(window_size), window_size);
+}
+
+void SceneRenderer::render_outline_mask()
+{
+  // silhouettes of selected objects into mask. cost of outline then doesn't depend on meshes
+  glClearColor(0.f, 0.f, 0.f, 0.f);
+  glClear(GL_COLOR_BUFFER_BIT);
+  glDisable(GL_DEPTH_TEST);
+  glDisable(GL_BLEND);
+  glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+  Shader& mask_shader = ShaderStorage::get(ShaderStorage::OUTLINING);
+  mask_shader.bind();
+  mask_shader.set_matrix4f("viewMatrix", m_camera.view_matrix());
+  mask_shader.set_matrix4f("projectionMatrix", m_projection_mat);
+  for (int idx : m_selected_objects)
+  {
+    mask_shader.set_matrix4f("modelMatrix", m_drawables[idx]->model_matrix());
+    m_drawables[idx]->render(m_gpu_buffers.get(), Object3D::RenderPass::OUTLINE_MASK);
+  }
+  mask_shader.unbind();
+  glEnable(GL_BLEND);
+}
+
+void SceneRenderer::composite_outline(ScreenQuad& outline_quad)
+{
+  // edges of mask are blended over the scene
+  glDisable(GL_DEPTH_TEST);
+  glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+  Shader& composite_shader = ShaderStorage::get(ShaderStorage::OUTLINE_COMPOSITE);
+  composite_shader.bind();
+  composite_shader.set_vec2("uvScale", glm::vec2(render_size()) / glm::vec2(m_window->width(), m_window->height()));
+  outline_quad.render(m_gpu_buffers.get());
+  composite_shader.unbind();
+  glPolygonMode(GL_FRONT_AND_BACK, m_polygon_mode);
+  glEnable(GL_DEPTH_TEST);
+}
+
+void SceneRenderer::cull_scene()
+{
+  m_frustum.update(m_projection_mat * m_camera.view_matrix());
+  m_visible.assign(m_drawables.size(), 0);
+  for (size_t i = 0; i < m_drawables.size(); i++)
+  {
+    // objects without bounds yet (e.g. curve before its first render) are always drawn
+    if (m_bvh_proxies[i] == DynamicBVH::null_node)
+      m_visible[i] = 1;
+  }
+  // subtrees completely inside of frustum are accepted as is,
+  // leaves which cross frustum planes are tested afterwards with precise world bounds
+  m_cull_candidates.clear();
+  m_cull_candidates_bounds.clear();
+  // every object may become candidate as camera moves, reserved at once so later frames don't grow the lists
+  m_cull_candidates.reserve(m_drawables.size());
+  m_cull_candidates_bounds.reserve(m_drawables.size());
+  m_cull_candidates_visible.reserve(m_drawables.size());
+  m_bvh.query(m_frustum, [this](int index, bool fully_inside)
+    {
+      if (fully_inside)
+      {
+        m_visible[index] = 1;
+      }
+      else
+      {
+        m_cull_candidates.push_back(index);
+        m_cull_candidates_bounds.push_back(m_drawables[index]->world_bbox());
+      }
+    });
+  m_frustum.cull(m_cull_candidates_bounds, m_cull_candidates_visible);
+  for (size_t i = 0; i < m_cull_candidates.size(); i++)
+  {
+    m_visible[m_cull_candidates[i]] = m_cull_candidates_visible[i];
+  }
+  m_stats.objects_occluded = 0;
+  if (m_occlusion_culling)
+  {
+    cull_occluded();
+  }
+  int nculled = 0;
+  for (uint8_t visible : m_visible)
+  {
+    nculled += !visible;
+  }
+  m_stats.objects_total = (int)m_drawables.size();
+  m_stats.objects_culled = nculled;
+  m_stats.gpu_culled_draws = 0;
+  if (gpu_culling_active())
+  {
+    update_gpu_culling();
+    m_stats.gpu_culled_draws = (int)m_gpu_culler->draw_count();
+  }
+}
+
+void SceneRenderer::cull_occluded()
+{
+  m_occlusion_culler.begin_frame(m_projection_mat * m_camera.view_matrix());
+  for (size_t i = 0; i < m_drawables.size(); i++)
+  {
+    const Object3D& obj = *m_drawables[i];
+    if (!m_visible[i] || !obj.is_occluder() || !obj.has_surface())
+      continue;
+    for (const Mesh& mesh : obj.meshes())
+      m_occlusion_culler.add_occluder(mesh, obj.model_matrix());
+  }
+  if (m_occlusion_culler.polygon_count() == 0)
+    return;
+  m_occlusion_culler.finish_occluders();
+  for (size_t i = 0; i < m_drawables.size(); i++)
+  {
+    // objects without bounds are always drawn
+    if (!m_visible[i] || m_bvh_proxies[i] == DynamicBVH::null_node)
+      continue;
+    if (!m_occlusion_culler.is_visible(m_drawables[i]->world_bbox()))
+    {
+      m_visible[i] = 0;
+      m_stats.objects_occluded++;
+    }
+  }
+}
+
+bool SceneRenderer::gpu_culling_active() const
+{
+  return m_gpu_culling && m_indirect_draw && m_gpu_culler->is_supported();
+}
+
+void SceneRenderer::update_gpu_culling()
+{
+  if (!m_gpu_cull_dirty && m_gpu_culler->arena_version() == m_indirect_renderer->arena().version())
+    return;
+  // objects which move every frame stay on CPU, uploading them again every frame would cost more than it saves
+  m_gpu_static.assign(m_drawables.size(), 0);
+  m_indirect_renderer->begin_frame();
+  for (int i = 0; i < (int)m_drawables.size(); i++)
+  {
+    Object3D* pobj = m_drawables[i].get();
+    if (pobj->is_rotating() || m_bvh_proxies[i] == DynamicBVH::null_node || !IndirectRenderer::is_batchable(*pobj) ||
+      !m_indirect_renderer->has_geometry(i))
+      continue;
+    m_indirect_renderer->submit(i, *pobj);
+    m_gpu_static[i] = 1;
+  }
+  m_gpu_culler->build(*m_indirect_renderer, m_drawables);
+  m_gpu_cull_dirty = false;
+}
+
+void SceneRenderer::update_bvh()
+{
+  // refit leaves of objects which were moved (by gizmo, ui, rotation) or changed their geometry
+  for (int i = 0; i < (int)m_drawables.size(); i++)
+  {
+    Object3D* pobj = m_drawables[i].get();
+    if (!pobj->get_flag(Object3D::BOUNDS_CHANGED))
+      continue;
+    const BoundingBox world_bbox = pobj->world_bbox();
+    // no vertices yet, try again next frame
+    if (world_bbox.is_empty())
+      continue;
+    if (m_bvh_proxies[i] == DynamicBVH::null_node)
+    {
+      m_bvh_proxies[i] = m_bvh.create_proxy(world_bbox, i);
     }
     else
     {
-      pdrawable->render(m_gpu_buffers.get());
+      m_bvh.move_proxy(m_bvh_proxies[i], world_bbox);
     }
+    // rotating objects are not part of static content, object which started rotating has to leave it
+    const bool gpu_static = i < (int)m_gpu_static.size() && m_gpu_static[i];
+    if (!pobj->is_rotating() || gpu_static)
+      m_gpu_cull_dirty = true;
+    pobj->clear_flag(Object3D::BOUNDS_CHANGED);
+  }
+  m_bvh.optimize();
+}
+
+void SceneRenderer::update_static_geometry()
+{
+  m_pending_uploads = 0;
+  if (!m_indirect_draw)
+    return;
+  // copying several large models into arena at once would stall one frame. the first object is uploaded
+  // whatever its size is, so objects larger than budget get there too. headless frames are measured and
+  // compared, so their scene is complete from the first frame
+  const size_t upload_budget = m_window->headless() ? std::numeric_limits<size_t>::max() : 16 << 20;
+  size_t uploaded = 0;
+  for (int i = 0; i < (int)m_drawables.size(); i++)
+  {
+    Object3D* pobj = m_drawables[i].get();
+    // objects which are drawn one by one keep the flag until they can be batched again
+    if (!pobj->get_flag(Object3D::GEOMETRY_CHANGED) || !IndirectRenderer::is_batchable(*pobj))
+      continue;
+    if (uploaded >= upload_budget)
+    {
+      m_pending_uploads++;
+      continue;
+    }
+    for (const Mesh& mesh : pobj->meshes())
+    {
+      uploaded += mesh.vertices().size() * sizeof(Vertex) + mesh.index_count() * sizeof(GLuint);
+    }
+    m_indirect_renderer->upload(i, *pobj);
+    pobj->clear_flag(Object3D::GEOMETRY_CHANGED);
+    m_gpu_cull_dirty = true;
+  }
+  m_indirect_renderer->arena().maintain();
+}
+
+void SceneRenderer::add_object(std::unique_ptr<Object3D> obj)
+{
+  // proxy in BVH is created in update_bvh once object has bounds
+  obj->set_flag(Object3D::BOUNDS_CHANGED);
+  m_drawables.push_back(std::move(obj));
+  m_bvh_proxies.push_back(DynamicBVH::null_node);
+  m_indirect_renderer->add_object();
+  m_gpu_picker->cancel();
+  m_gpu_cull_dirty = true;
+  request_redraw();
+}
+
+void SceneRenderer::import_model(const std::string& filename)
+{
+  m_importer->import(filename, aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_GenBoundingBoxes);
+  request_redraw();
+}
+
+void SceneRenderer::add_imported_models()
+{
+  if (!m_importer->take_finished(m_imported))
+    return;
+  for (ModelImporter::Result& result : m_imported)
+  {
+    if (result.model)
+      add_object(std::make_unique<ComplexModel>(std::move(*result.model)));
+    else
+      std::cerr << "Could not load model from file " << result.filename << '\n';
+  }
+  m_imported.clear();
+}
+
+void SceneRenderer::remove_object(int index)
+{
+  assert(index >= 0 && index < (int)m_drawables.size());
+  if (m_bvh_proxies[index] != DynamicBVH::null_node)
+  {
+    m_bvh.destroy_proxy(m_bvh_proxies[index]);
+  }
+  m_drawables.erase(m_drawables.begin() + index);
+  m_bvh_proxies.erase(m_bvh_proxies.begin() + index);
+  m_indirect_renderer->remove_object(index);
+  m_gpu_picker->cancel();
+  m_gpu_cull_dirty = true;
+  request_redraw();
+  if (index < (int)m_visible.size())
+  {
+    m_visible.erase(m_visible.begin() + index);
+  }
+  // objects after removed one are shifted by one
+  for (int i = index; i < (int)m_drawables.size(); i++)
+  {
+    if (m_bvh_proxies[i] != DynamicBVH::null_node)
+      m_bvh.set_user_data(m_bvh_proxies[i], i);
+  }
+  for (auto it = m_selected_objects.begin(); it != m_selected_objects.end();)
+  {
+    if (*it == index)
+    {
+      it = m_selected_objects.erase(it);
+      continue;
+    }
+    if (*it > index)
+      --(*it);
+    ++it;
   }
 }
 
 void SceneRenderer::create_scene()
+{
+  const LaunchOptions& options = launch_options();
+  for (const std::string& item : options.scene_items())
+  {
+    const size_t colon = item.find(':');
+    const std::string kind = item.substr(0, colon);
+    if (item == "default")
+    {
+      create_default_scene();
+    }
+    else if (kind == "cubes")
+    {
+      create_grid_scene(std::stoi(item.substr(colon + 1)), 0.f, [](int i)
+        {
+          std::unique_ptr<Cube> cube = std::make_unique<Cube>();
+          cube->set_color(glm::vec4(0.3f + 0.7f * (i % 7) / 6.f, 0.5f, 1.f - 0.7f * (i % 5) / 4.f, 1.f));
+          cube->apply_shading(Object3D::ShadingMode::FLAT_SHADING);
+          return cube;
+        });
+    }
+    else if (kind == "spheres")
+    {
+      // above grid of cubes if there is one
+      create_grid_scene(std::stoi(item.substr(colon + 1)), 2.f, [](int i)
+        {
+          std::unique_ptr<Icosahedron> sphere = std::make_unique<Icosahedron>();
+          sphere->set_color(glm::vec4(1.f - 0.7f * (i % 5) / 4.f, 0.4f + 0.6f * (i % 3) / 2.f, 0.3f, 1.f));
+          sphere->subdivide_triangles(2);
+          sphere->project_points_on_sphere();
+          sphere->scale(glm::vec3(0.5f));
+          sphere->apply_shading(Object3D::ShadingMode::SMOOTH_SHADING);
+          return sphere;
+        });
+    }
+    else
+    {
+      ModelLoader loader(m_mesh_cache.get());
+      std::optional<ComplexModel> model = loader.load(item, aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_GenBoundingBoxes);
+      if (!model)
+        throw std::runtime_error("Could not load model from file " + item);
+      add_object(std::make_unique<ComplexModel>(std::move(*model)));
+    }
+  }
+  if (options.helper_lines)
+  {
+    for (auto& obj : m_drawables)
+    {
+      obj->visible_normals(true);
+      obj->visible_bbox(true);
+    }
+  }
+}
+
+void SceneRenderer::create_grid_scene(int count, float height, const std::function<std::unique_ptr<Object3D>(int)>& make)
+{
+  // square grid on xz plane, starting at origin
+  const int side = (int)std::ceil(std::sqrt((float)count));
+  constexpr float spacing = 1.5f;
+  for (int i = 0; i < count; i++)
+  {
+    std::unique_ptr<Object3D> obj = make(i);
+    obj->translate(glm::vec3((i % side) * spacing, height, (i / side) * spacing));
+    add_object(std::move(obj));
+  }
+  std::unique_ptr<Icosahedron> sun = std::make_unique<Icosahedron>();
+  sun->light_source(true);
+  sun->light().range = side * spacing * 2.f;
+  sun->translate(glm::vec3(side * spacing * 0.5f, height + 4.f, side * spacing * 0.5f));
+  sun->set_color(glm::vec4(1.f, 1.f, 0.f, 1.f));
+  sun->scale(glm::vec3(0.3f));
+  sun->subdivide_triangles(4);
+  sun->project_points_on_sphere();
+  add_object(std::move(sun));
+}
+
+void SceneRenderer::create_default_scene()
 {
   Vertex arr[6];
   arr[0].position = glm::vec3(0.f, 1.f, 0.f), arr[0].color = glm::vec4(0.f, 1.f, 0.f, 1.f);
@@ -245,16 +969,17 @@ void SceneRenderer::create_scene()
   for (int i = 0; i < 6; i++) {
     origin->add(arr[i]);
   }
-  m_drawables.push_back(std::move(origin));
+  add_object(std::move(origin));
 
   std::unique_ptr<Icosahedron> sun = std::make_unique<Icosahedron>();
   sun->light_source(true);
+  sun->light().range = 30.f;
   sun->translate(glm::vec3(0.f, 0.5f, 2.f));
   sun->set_color(glm::vec4(1.f, 1.f, 0.f, 1.f));
   sun->scale(glm::vec3(0.3f));
   sun->subdivide_triangles(4);
   sun->project_points_on_sphere();
-  m_drawables.push_back(std::move(sun));
+  add_object(std::move(sun));
 
   std::unique_ptr<Icosahedron> sphere = std::make_unique<Icosahedron>();
   sphere->translate(glm::vec3(2.5f, 0.5f, 2.f));
@@ -263,41 +988,54 @@ void SceneRenderer::create_scene()
   sphere->project_points_on_sphere();
   sphere->scale(glm::vec3(0.3f));
   sphere->apply_shading(Object3D::ShadingMode::SMOOTH_SHADING);
-  m_drawables.push_back(std::move(sphere));
+  add_object(std::move(sphere));
 
   std::unique_ptr<Cube> c = std::make_unique<Cube>();
   c->translate(glm::vec3(0.25f));
   c->scale(glm::vec3(0.5f));
   c->apply_shading(Object3D::ShadingMode::FLAT_SHADING);
-  c->set_texture(".\\.\\src\\textures\\brick.jpg");
-  m_drawables.push_back(std::move(c));
+  c->set_texture("./src/textures/brick.jpg");
+  add_object(std::move(c));
 
   std::unique_ptr<Cube> c2 = std::make_unique<Cube>();
   c2->translate(glm::vec3(1.25f, 1.f, 1.f));
   c2->set_color(glm::vec4(0.4f, 1.f, 0.4f, 1.f));
   c2->apply_shading(Object3D::ShadingMode::FLAT_SHADING);
   c2->visible_normals(true);
-  m_drawables.push_back(std::move(c2));
+  add_object(std::move(c2));
 
   std::unique_ptr<Pyramid> pyr = std::make_unique<Pyramid>();
   pyr->translate(glm::vec3(0.75f, 0.65f, 2.25f));
   pyr->scale(glm::vec3(0.5f));
   pyr->set_color(glm::vec4(0.976f, 0.212f, 0.98f, 1.f));
   pyr->apply_shading(Object3D::ShadingMode::FLAT_SHADING);
-  m_drawables.push_back(std::move(pyr));
+  add_object(std::move(pyr));
 
   std::unique_ptr<BezierCurve> bc = std::make_unique<BezierCurve>(BezierCurve::Type::Quadratic);
   bc->set_start_point(Vertex());
   bc->set_end_point(Vertex(2.5f, 0.f, 0.f));
   bc->set_control_points({ Vertex(1.25f, 2.f, 0.f) });
   bc->set_color(glm::vec4(1.f, 0.f, 0.f, 1.f));
-  m_drawables.push_back(std::move(bc));
+  add_object(std::move(bc));
 
   std::unique_ptr<BezierCurve> bc2 = std::make_unique<BezierCurve>(BezierCurve::Type::Cubic);
   bc2->set_start_point(Vertex());
   bc2->set_end_point(Vertex(0.f, 0.f, -2.5f));
   bc2->set_control_points({ Vertex(0.f, 2.f, -1.25f), Vertex {0.f, -2.f, -1.75} });
-  m_drawables.push_back(std::move(bc2));
+  add_object(std::move(bc2));
+}
+
+PickResult SceneRenderer::pick_object(double cursor_x, double cursor_y)
+{
+  // line objects can be picked if cursor is within few pixels from them
+  constexpr float line_pick_pixels = 4.f;
+  const glm::vec2 ndc(
+    (float)cursor_x / m_window->width() * 2.f - 1.f,
+    1.f - (float)cursor_y / m_window->height() * 2.f);
+  float max_t;
+  const Ray ray = ray_from_ndc(m_projection_mat * m_camera.view_matrix(), ndc, max_t);
+  const float tolerance = line_pick_tolerance(m_projection_mat, m_window->height(), line_pick_pixels);
+  return ::pick_object(m_bvh, m_drawables, ray, max_t, tolerance);
 }
 
 void SceneRenderer::select_object(int index)
@@ -317,11 +1055,18 @@ void SceneRenderer::select_object(int index)
 
 void SceneRenderer::new_frame_update()
 {
-  ImGuiIO& io = ImGui::GetIO();
-  m_camera.scale_speed(io.DeltaTime);
+  const StreamingBuffer& stream = *m_gpu_buffers->stream;
+  m_stats.stream_stalls = stream.stalls();
+  m_stats.stream_reallocations = stream.reallocations();
+  m_stats.stream_frame_bytes = stream.last_frame_size();
+
+  // first frame after idle waiting would otherwise move camera by whole time spent waiting.
+  // headless frames advance by fixed step, so they are the same on every machine
+  const float delta_time = m_ui ? std::min(ImGui::GetIO().DeltaTime, 0.1f) : launch_options().frame_time;
+  m_camera.scale_speed(delta_time);
   for (auto& obj : m_drawables) 
   {
-    obj->set_delta_time(io.DeltaTime);
+    obj->set_delta_time(delta_time);
   }
 
   double x, y;
@@ -366,6 +1111,16 @@ void SceneRenderer::handle_input()
       m_drawables[idx]->select(false);
     }
   }
+  if (kh->get_keystate(InputKey::DEL) == KeyboardHandler::PRESSED)
+  {
+    // key belongs to ui while it's typed into text field
+    const bool ui_input = m_ui && ImGui::GetIO().WantCaptureKeyboard;
+    if (!m_selected_objects.empty() && !ui_input)
+    {
+      remove_object(m_selected_objects.back());
+    }
+    kh->reset_state(InputKey::DEL);
+  }
   if (kh->get_keystate(InputKey::SPACE) == KeyboardHandler::PRESSED)
   {
     m_camera.move(Camera::Direction::UP);
@@ -391,16 +1146,15 @@ void SceneRenderer::handle_input()
 void ScreenQuad::render(GPUBuffers* gpu_buffers)
 {
   auto& vao = gpu_buffers->vao;
-  auto& vbo = gpu_buffers->vbo;
   vao->bind();
-  vbo->bind();
-  vbo->set_data(quadVertices, sizeof(quadVertices));
-  vao->link_attrib(0, 2, GL_FLOAT, sizeof(float) * 4, nullptr);
-  vao->link_attrib(1, 2, GL_FLOAT, sizeof(float) * 4, (void*)(sizeof(float) * 2));
+  const size_t stride = sizeof(float) * 4;
+  const GLint first_vertex = gpu_buffers->stream_vertices(quadVertices, 6, stride).first_element(stride);
+  vao->link_attrib(0, 2, GL_FLOAT, stride, nullptr);
+  vao->link_attrib(1, 2, GL_FLOAT, stride, (void*)(sizeof(float) * 2));
   glActiveTexture(GL_TEXTURE0);
   glBindTexture(GL_TEXTURE_2D, m_tex_id);
-  glDrawArrays(GL_TRIANGLES, 0, 6);
-  vbo->unbind();
+  glDrawArrays(GL_TRIANGLES, first_vertex, 6);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
   vao->unbind();
 }
 
@@ -408,8 +1162,6 @@ static void setup_opengl()
 {
   glEnable(GL_DEPTH_TEST);
   glEnable(GL_BLEND);
-  glEnable(GL_STENCIL_TEST);
-  glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
   glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 }
 
@@ -2,46 +2,177 @@
 
 #include <vector>
 #include <memory>
-#include <map>
+#include <functional>
 #include "Shader.hpp"
 #include "Camera.hpp"
 #include "FrameBufferObject.hpp"
 #include "GPUBuffers.hpp"
+#include "GPUPicker.hpp"
+#include "IndirectRenderer.hpp"
+#include "VisibilityBuffer.hpp"
+#include "GPUCuller.hpp"
+#include "GPUTimer.hpp"
+#include "FrameProfiler.hpp"
+#include "RenderGraph.hpp"
+#include "RenderScaleController.hpp"
 #include "MainWindow.hpp"
+#include "LaunchOptions.hpp"
+#include "CameraPath.hpp"
+#include "ModelImporter.hpp"
 #include "./utils/Singleton.hpp"
 #include "./ge/Object3D.hpp"
+#include "./ge/Frustum.hpp"
+#include "./ge/BVH.hpp"
+#include "./ge/Picking.hpp"
+#include "./ge/LightClusters.hpp"
+#include "./ge/OcclusionCuller.hpp"
 
 class MouseInputHandler;
 class CursorPositionHandler;
 class Ui;
+class Skybox;
+struct ScreenQuad;
 
 class SceneRenderer
 {
+public:
+  struct RenderStats
+  {
+    int objects_total = 0;
+    int objects_culled = 0;
+    int objects_occluded = 0;  // part of culled objects which were hidden by occluders
+    int objects_batched = 0;   // drawn by multi draw indirect
+    int gpu_culled_draws = 0;  // static meshes culled by compute shader, not part of counts above
+    int multi_draw_calls = 0;
+    int draw_calls = 0;        // of scene pass, per mesh drawn separately and per multi draw call
+    int stream_stalls = 0;          // frames which waited for GPU to release streaming buffer region
+    int stream_reallocations = 0;
+    size_t stream_frame_bytes = 0;  // streamed by previous frame
+    // heap of last frame, counted only with OPENGL_ENGINE_MEMORY_TRACKING
+    uint64_t frame_allocations = 0;
+    uint64_t frame_allocated_bytes = 0;
+    int64_t live_bytes = 0;
+    uint64_t peak_bytes = 0;
+    int lights = 0;
+    int light_indices = 0;          // sum of lights over clusters
+    float cpu_frame_ms = 0.f;       // until swap, doesn't include waiting for vsync
+    float gpu_frame_ms = 0.f;
+    int frames_skipped = 0;         // idle frames which only presented previous image
+  };
 public:
   static SceneRenderer& instance() { return Singleton<SceneRenderer>::instance(); }
+  // read by constructor, so they are set before first call of instance()
+  static LaunchOptions& launch_options() { static LaunchOptions options; return options; }
   ~SceneRenderer();
   void render();
+  void add_object(std::unique_ptr<Object3D> obj);
+  void remove_object(int index);
+  // loads model on worker thread, it's added to scene at start of a frame after loading finished
+  void import_model(const std::string& filename);
 private:
   SceneRenderer();
+  // GL state, scene of launch options and passes of render graph, before the first frame
+  void prepare_render();
+  // one frame of all passes, without swapping buffers
+  void render_frame();
+  // renders frames of launch options, writes them and benchmark report to disk
+  void render_headless();
+  // whole scene in the middle of camera path
+  CameraPath orbit_camera_path(float duration) const;
+  void save_scene_image(const std::string& path) const;
   void handle_input();
-  void render_scene(Shader& shader, bool assignIndices = false);
+  void render_scene(Shader& shader);
+  void cull_scene();
+  // hides objects which passed frustum culling but are behind occluders
+  void cull_occluded();
+  bool gpu_culling_active() const;
+  // collects static batched meshes for compute culling when they changed
+  void update_gpu_culling();
+  // passes of frame, executed in order they are added
+  void build_render_graph(Skybox& skybox, ScreenQuad& screen_quad, ScreenQuad& outline_quad);
+  void render_outline_mask();
+  // blends edges of outline mask over the scene
+  void composite_outline(ScreenQuad& outline_quad);
+  // upscales scene texture to window
+  void present_scene(ScreenQuad& screen_quad);
+  // scene is drawn for at least given number of next frames, even in render on demand mode
+  void request_redraw(int frames = 3);
+  bool needs_redraw() const;
+  void update_bvh();
+  // uploads changed geometry of batched objects, spread over frames when there is a lot of it
+  void update_static_geometry();
+  void add_imported_models();
+  // assigns light sources to clusters and uploads them for shaders which include lighting.glsl
+  void update_lights();
+  void set_light_uniforms(Shader& shader);
+  // resolution of scene passes. scene textures of render graph are allocated at window size and scene is drawn
+  // into their lower left part, so changes of render scale don't reallocate anything
+  glm::ivec2 render_size() const;
+  // scene of launch options
   void create_scene();
+  void create_default_scene();
+  // grid of count objects on xz plane, created by make
+  void create_grid_scene(int count, float height, const std::function<std::unique_ptr<Object3D>(int)>& make);
+  // cursor position in window coordinates
+  PickResult pick_object(double cursor_x, double cursor_y);
   void select_object(int index);  // temporary function. remove when selection of multiple elements is supported
   void new_frame_update();
   friend class MouseInputHandler;
   friend class CursorPositionHandler;
   friend class Singleton<SceneRenderer>;
   friend class Ui;
+  friend struct SceneRendererFixture;  // tests run frames on recording GL backend
 private:
   std::vector<std::unique_ptr<Object3D>> m_drawables;
   std::vector<int> m_selected_objects;
   std::unique_ptr<MainWindow> m_window;
   std::unique_ptr<GPUBuffers> m_gpu_buffers;
+  std::unique_ptr<GPUPicker> m_gpu_picker;
+  bool m_gpu_picking = false;    // pick by rendering ids instead of casting ray on CPU
+  std::unique_ptr<IndirectRenderer> m_indirect_renderer;
+  bool m_indirect_draw = true;   // draw static meshes from geometry arena with multi draw indirect
+  std::unique_ptr<VisibilityBuffer> m_visibility_buffer;
+  bool m_visibility_draw = false;  // shade batched meshes from visibility buffer instead of forward
+  std::unique_ptr<GPUCuller> m_gpu_culler;
+  bool m_gpu_culling = false;      // cull and draw static batched meshes without per object work on CPU
+  bool m_gpu_cull_dirty = true;    // static content has to be collected again
+  std::vector<uint8_t> m_gpu_static;  // per object in m_drawables, drawn by m_gpu_culler
   std::unique_ptr<Ui> m_ui;
+  std::unique_ptr<MeshCache> m_mesh_cache;  // null if disabled by launch options
+  std::unique_ptr<ModelImporter> m_importer;
+  std::vector<ModelImporter::Result> m_imported;  // reused between frames
+  int m_pending_uploads = 0;  // batched objects whose changed geometry didn't fit into upload budget of last frame
   Camera m_camera;
-  std::map<std::string, FrameBufferObject> m_fbos;
+  RenderGraph m_render_graph;
+  // drawn by passes of render graph
+  std::unique_ptr<Skybox> m_skybox;
+  std::unique_ptr<ScreenQuad> m_screen_quad;
+  std::unique_ptr<ScreenQuad> m_outline_quad;
+  RenderGraph::Resource m_scene_color = -1;
+  RenderGraph::Resource m_scene_depth = -1;
+  bool m_scene_in_backbuffer = false;  // scene of last frame was drawn without main framebuffer
   glm::mat4 m_projection_mat;
   GLint m_polygon_mode = GL_FILL;
+  Frustum m_frustum;
+  DynamicBVH m_bvh;
+  std::vector<int> m_bvh_proxies;  // per object in m_drawables, null_node until object has bounds
+  std::vector<uint8_t> m_visible;  // per object in m_drawables, filled by cull_scene
+  // objects whose BVH leaf crosses frustum planes, tested precisely in a batch
+  std::vector<int> m_cull_candidates;
+  std::vector<uint8_t> m_cull_candidates_visible;
+  BoundsSoA m_cull_candidates_bounds;
+  OcclusionCuller m_occlusion_culler;
+  bool m_occlusion_culling = false;
+  RenderScaleController m_render_scale;
+  bool m_dynamic_resolution = false;
+  bool m_render_on_demand = false;  // wait for input instead of drawing unchanged scene again
+  int m_redraw_frames = 0;
+  std::unique_ptr<GPUTimer> m_gpu_frame_timer;
+  std::unique_ptr<FrameProfiler> m_profiler;  // per render graph pass
+  LightClusters m_light_clusters;
+  std::vector<glm::vec4> m_light_spheres;  // view space, per light in m_lights
+  std::vector<int> m_lights;               // indices of light sources in m_drawables
+  RenderStats m_stats;
 };
 
 struct ScreenQuad : IDrawable
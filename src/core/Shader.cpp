@@ -1,5 +1,6 @@
 #include <string>
 #include <fstream>
+#include <algorithm>
 #include <exception>
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
@@ -22,6 +23,31 @@ static bool read_shader_file_content(const char* const file, std::string& conten
   return false;
 }
 
+// replaces lines '#include "file"' with content of file, path is relative to directory of including file
+static bool expand_includes(const std::string& file, std::string& content, int depth = 0)
+{
+  if (depth > 8)
+    return false;
+  const size_t slash = file.find_last_of("/\\");
+  const std::string dir = slash == std::string::npos ? std::string() : file.substr(0, slash + 1);
+  size_t pos = 0;
+  while ((pos = content.find("#include", pos)) != std::string::npos)
+  {
+    const size_t line_end = std::min(content.find('\n', pos), content.size());
+    const size_t open = content.find('"', pos);
+    const size_t close = open < line_end ? content.find('"', open + 1) : std::string::npos;
+    if (close == std::string::npos || close > line_end)
+      return false;
+    const std::string included_file = dir + content.substr(open + 1, close - open - 1);
+    std::string included;
+    if (!read_shader_file_content(included_file.c_str(), included) || !expand_includes(included_file, included, depth + 1))
+      return false;
+    content.replace(pos, line_end - pos, included);
+    pos += included.size();
+  }
+  return true;
+}
+
 GLuint Shader::last_bind = 0;
 
 Shader::Shader(const char* vertex_file, const char* fragment_file) 
@@ -36,9 +62,9 @@ void Shader::load(const char* vertex_file, const char* fragment_file)
     glDeleteProgram(m_id);
   }
   std::string vertex_shader_source, fragment_shader_source;
-  if (!read_shader_file_content(vertex_file, vertex_shader_source))
+  if (!read_shader_file_content(vertex_file, vertex_shader_source) || !expand_includes(vertex_file, vertex_shader_source))
     throw std::runtime_error("Error reading vertex shader file");
-  if (!read_shader_file_content(fragment_file, fragment_shader_source))
+  if (!read_shader_file_content(fragment_file, fragment_shader_source) || !expand_includes(fragment_file, fragment_shader_source))
     throw std::runtime_error("Error reading fragment shader file");
 
   const char* vss = vertex_shader_source.c_str();
@@ -68,21 +94,66 @@ void Shader::load(const char* vertex_file, const char* fragment_file)
   glDeleteShader(m_fragment_shader);
 }
 
+void Shader::load_compute(const char* compute_file)
+{
+  if (m_id != 0)
+  {
+    glDeleteProgram(m_id);
+  }
+  std::string compute_shader_source;
+  if (!read_shader_file_content(compute_file, compute_shader_source) || !expand_includes(compute_file, compute_shader_source))
+    throw std::runtime_error("Error reading compute shader file");
+
+  const char* css = compute_shader_source.c_str();
+  GLuint compute_shader = glCreateShader(GL_COMPUTE_SHADER);
+  glShaderSource(compute_shader, 1, &css, NULL);
+  glCompileShader(compute_shader);
+
+  *id_ref() = glCreateProgram();
+  glAttachShader(m_id, compute_shader);
+  glLinkProgram(m_id);
+  glDeleteShader(compute_shader);
+}
+
+bool Shader::is_linked() const
+{
+  if (m_id == 0)
+    return false;
+  GLint status = GL_FALSE;
+  glGetProgramiv(m_id, GL_LINK_STATUS, &status);
+  return status == GL_TRUE;
+}
+
 void Shader::set_matrix4f(const char* uniform_name, const glm::mat4& value) 
 {
   glUniformMatrix4fv(glGetUniformLocation(m_id, uniform_name), 1, GL_FALSE, glm::value_ptr(value));
 }
 
+void Shader::set_vec2(const char* uniform_name, const glm::vec2& value) 
+{
+  glUniform2fv(glGetUniformLocation(m_id, uniform_name), 1, glm::value_ptr(value));
+}
+
 void Shader::set_vec3(const char* uniform_name, const glm::vec3& value) 
 {
   glUniform3fv(glGetUniformLocation(m_id, uniform_name), 1, glm::value_ptr(value));
 }
 
+void Shader::set_vec4_array(const char* uniform_name, const glm::vec4* values, int count)
+{
+  glUniform4fv(glGetUniformLocation(m_id, uniform_name), count, glm::value_ptr(*values));
+}
+
 void Shader::set_bool(const char* uniform_name, bool value) 
 {
   glUniform1i(glGetUniformLocation(m_id, uniform_name), value);
 }
 
+void Shader::set_int(const char* uniform_name, int value)
+{
+  glUniform1i(glGetUniformLocation(m_id, uniform_name), value);
+}
+
 void Shader::set_uint(const char* uniform_name, unsigned int value)
 {
   glUniform1ui(glGetUniformLocation(m_id, uniform_name), value);
@@ -106,5 +177,7 @@ void Shader::unbind() const
 
 Shader::~Shader() 
 {
-  glDeleteProgram(m_id);
+  // shaders of storage which was never initialized are destroyed at exit, possibly without GL loaded
+  if (m_id != 0)
+    glDeleteProgram(m_id);
 }
@@ -15,9 +15,15 @@ public:
   Shader(const char* vertex_file, const char* fragment_file);
   ~Shader();
   void load(const char* vertex_file, const char* fragment_file);
+  void load_compute(const char* compute_file);
+  // false if program failed to compile or link
+  bool is_linked() const;
   void set_matrix4f(const char* uniform_name, const glm::mat4& value);
+  void set_vec2(const char* uniform_name, const glm::vec2& value);
   void set_vec3(const char* uniform_name, const glm::vec3& value);
+  void set_vec4_array(const char* uniform_name, const glm::vec4* values, int count);
   void set_bool(const char* uniform_name, bool value);
+  void set_int(const char* uniform_name, int value);
   void set_uint(const char* uniform_name, unsigned int value);
   void set_float(const char* uniform_name, float value);
   void bind() const override;
@@ -1,41 +1,56 @@
 #include "ShaderStorage.hpp"
+#include "Tracer.hpp"
 #include <vector>
 #include <utility>
 #include <string>
 
 namespace GlobalState
 {
-  std::map<ShaderStorage::ShaderType, Shader> ShaderStorage::m_shaders;
+  std::array<Shader, ShaderStorage::LAST_ITEM> ShaderStorage::m_shaders;
+  bool ShaderStorage::m_initialized = false;
 
   void ShaderStorage::init()
   {
-    static bool once = true;
-    if (once)
+    TRACE_ZONE("ShaderStorage::init");
+    if (!m_initialized)
     {
       std::vector<std::pair<std::string, std::string>> sources = {
         {"./src/glsl/shader.vert", "./src/glsl/shader.frag"},
         {"./src/glsl/outlining.vert", "./src/glsl/outlining.frag"},
         {"./src/glsl/skybox.vert", "./src/glsl/skybox.frag"},
         {"./src/glsl/fbo_default_shader.vert", "./src/glsl/fbo_default_shader.frag"},
-        {"./src/glsl/picking_fbo.vert", "./src/glsl/picking_fbo.frag"},
-        {"./src/glsl/lines.vert", "./src/glsl/lines.frag"}
+        {"./src/glsl/picking.vert", "./src/glsl/picking.frag"},
+        {"./src/glsl/lines.vert", "./src/glsl/lines.frag"},
+        {"./src/glsl/fbo_default_shader.vert", "./src/glsl/outline_composite.frag"},
+        {"./src/glsl/visibility.vert", "./src/glsl/visibility.frag"},
+        {"./src/glsl/visibility_resolve.vert", "./src/glsl/visibility_resolve.frag"}
       };
       for (int i = 0; i < ShaderStorage::LAST_ITEM; i++)
       {
         Shader s;
         s.load(sources[i].first.data(), sources[i].second.data());
-        m_shaders[static_cast<ShaderType>(i)] = std::move(s);
+        m_shaders[i] = std::move(s);
       }
-      once = false;
+      m_initialized = true;
     }
   }
 
+  void ShaderStorage::release()
+  {
+    for (Shader& shader : m_shaders)
+    {
+      // program is deleted with temporary it's moved into
+      Shader released(std::move(shader));
+    }
+    m_initialized = false;
+  }
+
   Shader* ShaderStorage::get(unsigned int id)
   {
-    for (auto& item : m_shaders)
+    for (Shader& shader : m_shaders)
     {
-      if (item.second.id() == id)
-        return &(item.second);
+      if (shader.id() == id)
+        return &shader;
     }
     return nullptr;
   }
@@ -1,6 +1,6 @@
 #pragma once
 
-#include <map>
+#include <array>
 #include "./core/Shader.hpp"
 
 namespace GlobalState
@@ -16,12 +16,18 @@ namespace GlobalState
       FBO_DEFAULT,
       PICKING,
       LINES,
+      OUTLINE_COMPOSITE,
+      VISIBILITY,
+      VISIBILITY_RESOLVE,
       LAST_ITEM
     };
     static void init();
+    // deletes programs while GL is still there, next init loads them again
+    static void release();
     static Shader& get(ShaderType type) { return m_shaders[type]; }
     static Shader* get(unsigned int id);
   private:
-    static std::map<ShaderType, Shader> m_shaders;
+    static std::array<Shader, LAST_ITEM> m_shaders;
+    static bool m_initialized;
   };
 }
@@ -0,0 +1,122 @@
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+#include "StreamingBuffer.hpp"
+
+// every region starts at offset which satisfies any alignment required by buffer bindings
+static constexpr size_t region_alignment = 256;
+
+StreamingBuffer::StreamingBuffer(size_t frame_capacity)
+{
+  create(frame_capacity);
+}
+
+StreamingBuffer::~StreamingBuffer()
+{
+  for (GLsync fence : m_fences)
+  {
+    if (fence)
+      glDeleteSync(fence);
+  }
+  for (const RetiredBuffer& retired : m_retired)
+    glDeleteBuffers(1, &retired.id);
+  // deletion unmaps buffer
+  glDeleteBuffers(1, &m_buffer.id);
+}
+
+void StreamingBuffer::create(size_t frame_capacity)
+{
+  m_frame_capacity = (frame_capacity + region_alignment - 1) / region_alignment * region_alignment;
+  const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+  glGenBuffers(1, &m_buffer.id);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+  glBufferStorage(GL_COPY_WRITE_BUFFER, m_frame_capacity * frames_in_flight, nullptr, flags);
+  m_mapped = static_cast<uint8_t*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, m_frame_capacity * frames_in_flight, flags));
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+  assert(m_mapped);
+}
+
+void StreamingBuffer::retire()
+{
+  // draws of this and previous frames may still read old buffer. it's deleted after the fence of this frame
+  // was waited for, i.e. when this frame's region comes around again
+  m_retired.push_back({ m_buffer.id, frames_in_flight });
+  m_buffer.id = 0;
+  m_mapped = nullptr;
+  for (GLsync& fence : m_fences)
+  {
+    if (fence)
+      glDeleteSync(fence);
+    fence = nullptr;
+  }
+}
+
+void StreamingBuffer::begin_frame()
+{
+  GLsync& fence = m_fences[m_frame];
+  if (fence)
+  {
+    GLenum status = glClientWaitSync(fence, 0, 0);
+    if (status == GL_TIMEOUT_EXPIRED)
+    {
+      // GPU is more than frames_in_flight frames behind
+      m_stalls++;
+      constexpr GLuint64 timeout_ns = 1000000000;
+      do
+      {
+        status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout_ns);
+      } while (status == GL_TIMEOUT_EXPIRED);
+    }
+    glDeleteSync(fence);
+    fence = nullptr;
+  }
+  for (auto it = m_retired.begin(); it != m_retired.end();)
+  {
+    if (--it->frames_left <= 0)
+    {
+      glDeleteBuffers(1, &it->id);
+      it = m_retired.erase(it);
+      continue;
+    }
+    ++it;
+  }
+  m_offset = 0;
+}
+
+void StreamingBuffer::end_frame()
+{
+  assert(m_fences[m_frame] == nullptr);
+  m_fences[m_frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  m_last_frame_size = m_offset;
+  m_frame = (m_frame + 1) % frames_in_flight;
+}
+
+StreamingBuffer::Allocation StreamingBuffer::allocate(size_t size, size_t alignment)
+{
+  assert(alignment > 0);
+  size_t region_begin = m_frame_capacity * m_frame;
+  // align absolute offset, otherwise stride aligned allocations wouldn't map to whole vertex indices
+  size_t offset = (region_begin + m_offset + alignment - 1) / alignment * alignment;
+  if (offset + size > region_begin + m_frame_capacity)
+  {
+    retire();
+    create(std::max(m_frame_capacity * 2, size + alignment));
+    m_reallocations++;
+    region_begin = m_frame_capacity * m_frame;
+    offset = (region_begin + alignment - 1) / alignment * alignment;
+  }
+  m_offset = offset + size - region_begin;
+  Allocation alloc;
+  alloc.buffer = m_buffer;
+  alloc.offset = offset;
+  alloc.data = m_mapped + offset;
+  return alloc;
+}
+
+StreamingBuffer::Allocation StreamingBuffer::upload(const void* data, size_t size, size_t alignment)
+{
+  Allocation alloc = allocate(size, alignment);
+  if (data)
+    memcpy(alloc.data, data, size);
+  return alloc;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <glad/glad.h>
+#include "OpenGLObject.hpp"
+
+// Ring buffer for data which is written every frame (helper lines, screen quad, per draw parameters ...).
+// Buffer is persistently and coherently mapped and split into regions, one per frame in flight. Region is
+// reused only after fence of the frame which wrote it was signaled, so CPU never overwrites data which GPU
+// still reads and driver never has to orphan or synchronize buffer implicitly.
+class StreamingBuffer
+{
+public:
+  struct Allocation
+  {
+    GLuint buffer = 0;
+    size_t offset = 0;       // in bytes from the beginning of buffer
+    void* data = nullptr;    // mapped memory, writes are visible to GPU without flushing
+    // first vertex for base vertex or first vertex draws. allocation has to be aligned to stride
+    GLint first_element(size_t stride) const { return (GLint)(offset / stride); }
+  };
+  static constexpr int frames_in_flight = 3;
+public:
+  OnlyMovable(StreamingBuffer)
+  explicit StreamingBuffer(size_t frame_capacity = 4 << 20);
+  ~StreamingBuffer();
+  // waits until GPU finished with region of this frame. must be called before first allocation in frame
+  void begin_frame();
+  // inserts fence after all commands which use data of this frame
+  void end_frame();
+  // alignment doesn't have to be power of two, e.g. it can be vertex stride.
+  // if frame region is full, buffer is recreated bigger and previous one is deleted once GPU is done with it
+  Allocation allocate(size_t size, size_t alignment = 16);
+  // allocates and copies data
+  Allocation upload(const void* data, size_t size, size_t alignment = 16);
+  GLuint id() const { return m_buffer; }
+  size_t frame_capacity() const { return m_frame_capacity; }
+  size_t last_frame_size() const { return m_last_frame_size; }
+  // how many times begin_frame had to wait for GPU since creation
+  int stalls() const { return m_stalls; }
+  int reallocations() const { return m_reallocations; }
+private:
+  void create(size_t frame_capacity);
+  void retire();
+private:
+  struct RetiredBuffer
+  {
+    GLuint id;
+    int frames_left;
+  };
+  OpenGLIdWrapper<GLuint> m_buffer;
+  uint8_t* m_mapped = nullptr;
+  size_t m_frame_capacity = 0;
+  size_t m_offset = 0;            // used bytes of current frame region
+  size_t m_last_frame_size = 0;
+  int m_frame = 0;                // region of current frame
+  std::array<GLsync, frames_in_flight> m_fences{};
+  std::vector<RetiredBuffer> m_retired;
+  int m_stalls = 0;
+  int m_reallocations = 0;
+};
@@ -1,4 +1,6 @@
 #include "Texture.hpp"
+#include "Tracer.hpp"
+#include "MemoryProfiler.hpp"
 #include <stdexcept>
 #include <memory>
 
@@ -14,6 +16,8 @@ Texture::~Texture()
 
 std::unique_ptr<unsigned char, StbDeleter> Texture::load(const std::string& filename)
 {
+  TRACE_ZONE("Texture::load");
+  MemoryTagScope memory_tag(MemoryTag::TEXTURES);
   StbDeleter deleter;
   std::unique_ptr<unsigned char, StbDeleter> data(stbi_load(filename.c_str(), &m_width, &m_height, &m_nchannels, 0), deleter);
   if (!data)
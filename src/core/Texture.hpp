@@ -8,7 +8,7 @@
 
 struct StbDeleter
 {
-  void operator()(unsigned char* data) { free(data); }
+  void operator()(unsigned char* data) { stbi_image_free(data); }
 };
 
 class Texture : public OpenGLObject
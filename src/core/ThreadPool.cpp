@@ -0,0 +1,53 @@
+#include "ThreadPool.hpp"
+#include "Tracer.hpp"
+#include <algorithm>
+
+ThreadPool::ThreadPool(int threads, const std::string& name)
+{
+  m_workers.reserve(std::max(threads, 1));
+  for (int i = 0; i < std::max(threads, 1); i++)
+  {
+    m_workers.emplace_back(&ThreadPool::work, this, i, name);
+  }
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+    m_tasks.clear();
+  }
+  m_wake.notify_all();
+  for (std::thread& worker : m_workers)
+  {
+    worker.join();
+  }
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_tasks.push_back(std::move(task));
+  }
+  m_wake.notify_one();
+}
+
+void ThreadPool::work([[maybe_unused]] int index, [[maybe_unused]] const std::string& name)
+{
+  TRACE_THREAD_NAME(name + " " + std::to_string(index));
+  while (true)
+  {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_wake.wait(lock, [this]() { return m_stop || !m_tasks.empty(); });
+      if (m_stop)
+        return;
+      task = std::move(m_tasks.front());
+      m_tasks.pop_front();
+    }
+    task();
+  }
+}
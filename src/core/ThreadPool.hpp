@@ -0,0 +1,31 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <functional>
+#include <condition_variable>
+
+// Fixed number of worker threads which run submitted tasks in order of submission.
+// Destructor waits for running tasks, tasks which haven't started yet are dropped.
+class ThreadPool
+{
+public:
+  // name of workers shown in trace, followed by their index
+  ThreadPool(int threads, const std::string& name);
+  ~ThreadPool();
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+  void submit(std::function<void()> task);
+  int size() const { return (int)m_workers.size(); }
+private:
+  void work(int index, const std::string& name);
+private:
+  std::vector<std::thread> m_workers;
+  std::deque<std::function<void()>> m_tasks;
+  std::mutex m_mutex;
+  std::condition_variable m_wake;
+  bool m_stop = false;
+};
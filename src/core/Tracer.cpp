@@ -0,0 +1,149 @@
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "Tracer.hpp"
+
+// buffers live until exit, so zones of finished threads can be exported too
+struct Tracer::Registry
+{
+  std::mutex mutex;
+  std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+  // ticks are converted with rate measured between start and export
+  const int64_t start = now();
+  const int64_t start_ns = steady_ns();
+};
+
+namespace
+{
+  void write_json_string(std::ostream& os, const char* str)
+  {
+    os << '"';
+    for (; *str; str++)
+    {
+      if (*str == '"' || *str == '\\')
+        os << '\\';
+      os << *str;
+    }
+    os << '"';
+  }
+}
+
+Tracer::Registry& Tracer::registry()
+{
+  static Registry r;
+  return r;
+}
+
+Tracer::ThreadBuffer& Tracer::thread_buffer()
+{
+  thread_local ThreadBuffer* buffer = nullptr;
+  if (!buffer)
+  {
+    Registry& r = registry();
+    std::lock_guard lock(r.mutex);
+    r.buffers.push_back(std::make_unique<ThreadBuffer>());
+    buffer = r.buffers.back().get();
+    buffer->thread_index = (uint32_t)r.buffers.size() - 1;
+  }
+  return *buffer;
+}
+
+void Tracer::record(const char* name, int64_t begin, int64_t end)
+{
+  ThreadBuffer& buffer = thread_buffer();
+  // only this thread writes. slot is marked as being written before its fields change, so exporter which
+  // read any of new values sees the mark after its acquire fence
+  const uint64_t written = buffer.written.load(std::memory_order_relaxed);
+  Slot& slot = buffer.slots[written % events_per_thread];
+  slot.sequence.store(2 * written + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.name.store(name, std::memory_order_relaxed);
+  slot.begin.store(begin, std::memory_order_relaxed);
+  slot.end.store(end, std::memory_order_relaxed);
+  slot.sequence.store(2 * written + 2, std::memory_order_release);
+  buffer.written.store(written + 1, std::memory_order_release);
+}
+
+void Tracer::set_thread_name(const std::string& name)
+{
+  ThreadBuffer& buffer = thread_buffer();
+  std::lock_guard lock(registry().mutex);
+  buffer.name = name;
+}
+
+void Tracer::clear()
+{
+  Registry& r = registry();
+  std::lock_guard lock(r.mutex);
+  for (auto& buffer : r.buffers)
+    buffer->cleared.store(buffer->written.load(std::memory_order_acquire), std::memory_order_relaxed);
+}
+
+void Tracer::write_chrome_trace(std::ostream& os)
+{
+  Registry& r = registry();
+  std::lock_guard lock(r.mutex);
+  std::vector<Event> events;
+  const int64_t ticks = now() - r.start;
+  const double us_per_tick = ticks > 0 ? (steady_ns() - r.start_ns) / 1000.0 / ticks : 0.001;
+  const std::ios::fmtflags flags = os.flags();
+  const std::streamsize precision = os.precision();
+  os << std::fixed << std::setprecision(3);
+  os << "{\"traceEvents\":[";
+  bool first = true;
+  auto separator = [&first, &os]()
+    {
+      os << (first ? "\n" : ",\n");
+      first = false;
+    };
+  for (const auto& buffer : r.buffers)
+  {
+    if (!buffer->name.empty())
+    {
+      separator();
+      os << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->thread_index << ",\"args\":{\"name\":";
+      write_json_string(os, buffer->name.c_str());
+      os << "}}";
+    }
+    // oldest slot is the one owner thread writes next
+    const uint64_t end = buffer->written.load(std::memory_order_acquire);
+    const uint64_t kept = events_per_thread - 1;
+    const uint64_t begin = std::max(buffer->cleared.load(std::memory_order_relaxed), end > kept ? end - kept : 0);
+    events.clear();
+    for (uint64_t i = begin; i < end; i++)
+    {
+      // owner thread may have lapped the ring meanwhile, slot then holds later event or is being written
+      const Slot& slot = buffer->slots[i % events_per_thread];
+      const uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+      if (sequence != 2 * i + 2)
+        continue;
+      const Event e = { slot.name.load(std::memory_order_relaxed), slot.begin.load(std::memory_order_relaxed),
+        slot.end.load(std::memory_order_relaxed) };
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (slot.sequence.load(std::memory_order_relaxed) == sequence)
+        events.push_back(e);
+    }
+    for (const Event& e : events)
+    {
+      separator();
+      // microseconds since start of tracer
+      os << "{\"name\":";
+      write_json_string(os, e.name);
+      os << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->thread_index << ",\"ts\":" << (e.begin - r.start) * us_per_tick
+        << ",\"dur\":" << (e.end - e.begin) * us_per_tick << "}";
+    }
+  }
+  os << "\n],\"displayTimeUnit\":\"ms\"}\n";
+  os.flags(flags);
+  os.precision(precision);
+}
+
+bool Tracer::save(const std::string& filename)
+{
+  std::ofstream file(filename);
+  write_chrome_trace(file);
+  return (bool)file;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#if defined(_M_X64) || defined(__x86_64__)
+#define OPENGL_ENGINE_TRACE_TSC 1
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#else
+#define OPENGL_ENGINE_TRACE_TSC 0
+#endif
+
+// CPU zones recorded while OPENGL_ENGINE_TRACING is enabled (cmake option of the same name), exported as Chrome
+// trace_event JSON which chrome://tracing and Perfetto open. Without it zone macros expand to nothing.
+// Zone names must outlive the tracer, string literals are fine.
+#if OPENGL_ENGINE_TRACING
+#define OPENGL_ENGINE_TRACE_CONCAT_IMPL(a, b) a##b
+#define OPENGL_ENGINE_TRACE_CONCAT(a, b) OPENGL_ENGINE_TRACE_CONCAT_IMPL(a, b)
+#define TRACE_ZONE(name) Tracer::Zone OPENGL_ENGINE_TRACE_CONCAT(trace_zone_, __LINE__)(name)
+#define TRACE_THREAD_NAME(name) Tracer::set_thread_name(name)
+#else
+#define TRACE_ZONE(name) ((void)0)
+#define TRACE_THREAD_NAME(name) ((void)0)
+#endif
+
+// Every thread writes zones to its own ring buffer, which keeps the last events_per_thread - 1 zones. Recording
+// doesn't lock or allocate, so zone costs reading clock twice and one store. On x64 clock is time stamp counter,
+// which is several times cheaper to read than steady_clock, its ticks are converted to time on export. Export may run while other threads
+// record, every slot of ring has a sequence number and zones whose slot gets overwritten while being copied are dropped.
+class Tracer
+{
+public:
+  static constexpr uint32_t events_per_thread = 1 << 16;
+  struct Event
+  {
+    const char* name;
+    int64_t begin;  // ticks of now()
+    int64_t end;
+  };
+  class Zone
+  {
+  public:
+    explicit Zone(const char* name) : m_name(name), m_begin(now()) {}
+    ~Zone() { record(m_name, m_begin, now()); }
+    Zone(const Zone&) = delete;
+    Zone& operator=(const Zone&) = delete;
+  private:
+    const char* m_name;
+    int64_t m_begin;
+  };
+public:
+  static int64_t now()
+  {
+#if OPENGL_ENGINE_TRACE_TSC
+    return (int64_t)__rdtsc();
+#else
+    return steady_ns();
+#endif
+  }
+  static int64_t steady_ns()
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+  static void record(const char* name, int64_t begin, int64_t end);
+  // shown in trace instead of thread index
+  static void set_thread_name(const std::string& name);
+  // zones of every thread which recorded any, in Chrome trace_event format
+  static void write_chrome_trace(std::ostream& os);
+  static bool save(const std::string& filename);
+  // drops recorded zones of all threads
+  static void clear();
+private:
+  // fields are atomic, so exporter may read slot which owner thread is writing. sequence is odd while event
+  // with index (sequence - 1) / 2 is written and 2 * (index + 1) when it's complete
+  struct Slot
+  {
+    std::atomic<uint64_t> sequence = 0;
+    std::atomic<const char*> name = nullptr;
+    std::atomic<int64_t> begin = 0;
+    std::atomic<int64_t> end = 0;
+  };
+  struct ThreadBuffer
+  {
+    std::array<Slot, events_per_thread> slots;
+    std::atomic<uint64_t> written = 0;  // total, ring index is written % events_per_thread
+    std::atomic<uint64_t> cleared = 0;  // events before it are not exported
+    uint32_t thread_index = 0;
+    std::string name;
+  };
+  struct Registry;
+private:
+  static Registry& registry();
+  static ThreadBuffer& thread_buffer();
+};
@@ -16,11 +16,14 @@
 #include "ModelLoader.hpp"
 #include "./ge/Object3D.hpp"
 #include "KeyboardHandler.hpp"
+#include "Tracer.hpp"
+#include "MemoryProfiler.hpp"
 
 #include <vector>
 #include <string>
+#include <cstdio>
 
-static std::string shading_mode_to_str(Object3D::ShadingMode mode);
+static const char* shading_mode_to_str(Object3D::ShadingMode mode);
 static bool once = true;
 static glm::vec3 g_translation = {};
 static glm::vec3 g_scale = {};
@@ -28,6 +31,10 @@ static glm::vec3 g_scale = {};
 Ui::Ui(SceneRenderer& scene, MainWindow* window) : m_scene(scene), m_window(window)
 {
   IMGUI_CHECKVERSION();
+  // ImGui allocates with malloc, these hooks count its allocations in frame statistics under ui tag
+  ImGui::SetAllocatorFunctions(
+    [](size_t size, void*) { MemoryTagScope memory_tag(MemoryTag::UI); return MemoryProfiler::malloc(size); },
+    [](void* ptr, void*) { MemoryProfiler::free(ptr); });
   ImGui::CreateContext();
   ImGuiIO& io = ImGui::GetIO();
   io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;     // Enable Keyboard Controls
@@ -50,6 +57,7 @@ Ui::~Ui()
 
 void Ui::render()
 {
+  MemoryTagScope memory_tag(MemoryTag::UI);
   ImGui_ImplOpenGL3_NewFrame();
   ImGui_ImplGlfw_NewFrame();
   ImGui::NewFrame();
@@ -103,13 +111,8 @@ void Ui::render()
     {
       if (ImGuiFileDialog::Instance()->IsOk())
       {
-        std::string selected_file = dlg.GetFilePathName();
-        ModelLoader loader;
-        std::optional<ComplexModel> m = loader.load(selected_file, aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_GenBoundingBoxes /*| aiProcess_GenSmoothNormals*/);
-        if (m)
-        {
-          scene.m_drawables.push_back(std::make_unique<ComplexModel>(std::move(*m)));
-        }
+        // loaded in background, model shows up once it's ready
+        scene.import_model(dlg.GetFilePathName());
       }
 
       // close
@@ -205,17 +208,20 @@ void Ui::render()
           obj->m_rotation_angle = glm::degrees(glm::angle(rotation));
           //obj->m_rotation_axis = glm::axis(rotation);
         }
-        obj->m_model_mat = model_mat;
+        obj->set_model_matrix(model_mat);
       }
     }
 
     if (ImGui::BeginListBox("##ListBox"))
     {
       int idx = 0;
+      // label is formatted on stack, list is drawn every frame
+      char label[64];
       for (const auto& obj : scene.m_drawables)
       {
         bool selected = obj->is_selected();
-        if (ImGui::Selectable((obj->name() + std::to_string(idx + 1)).c_str(), &selected))
+        std::snprintf(label, sizeof(label), "%s%d", obj->name().c_str(), idx + 1);
+        if (ImGui::Selectable(label, &selected))
         {
           scene.select_object(idx);
         }
@@ -238,23 +244,166 @@ void Ui::render()
         else
           scene.m_polygon_mode = GL_LINE;
       }
+      ImGui::Checkbox("Pick objects on GPU", &scene.m_gpu_picking);
+      ImGui::Checkbox("Cull occluded objects", &scene.m_occlusion_culling);
+      ImGui::Checkbox("Batch static meshes", &scene.m_indirect_draw);
+      if (scene.m_indirect_draw)
+      {
+        ImGui::Checkbox("Shade batched meshes from visibility buffer", &scene.m_visibility_draw);
+        if (scene.m_gpu_culler->is_supported())
+          ImGui::Checkbox("Cull static meshes on GPU", &scene.m_gpu_culling);
+      }
+      ImGui::Checkbox("Render only on changes", &scene.m_render_on_demand);
+      ImGui::Checkbox("Dynamic resolution", &scene.m_dynamic_resolution);
+      if (scene.m_dynamic_resolution)
+      {
+        RenderScaleController::Settings& settings = scene.m_render_scale.settings();
+        float target_fps = 1000.f / settings.target_frame_ms;
+        if (ImGui::SliderFloat("Target FPS", &target_fps, 20.f, 144.f, "%.0f"))
+          settings.target_frame_ms = 1000.f / target_fps;
+        ImGui::SliderFloat("Min render scale", &settings.min_scale, 0.25f, settings.max_scale, "%.2f");
+      }
+    }
+
+    if (ImGui::CollapsingHeader("Profiler"))
+    {
+      render_profiler();
     }
 
     if (scene.m_selected_objects.size())
     {
       const int idx = scene.m_selected_objects.back();
-      render_object_properties(*scene.m_drawables[idx]);
+      Object3D& obj = *scene.m_drawables[idx];
+      // edits which change how object is batched (rotation, helper lines, shading) show up in flags
+      const int flags = obj.m_flags;
+      const Object3D::ShadingMode shading_mode = obj.shading_mode();
+      render_object_properties(obj);
+      if (obj.m_flags != flags || obj.shading_mode() != shading_mode)
+        scene.m_gpu_cull_dirty = true;
     }
 
     ImGuiIO& io = ImGui::GetIO();
     ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / io.Framerate, io.Framerate);
+    ImGui::Text("Objects culled %d / %d (occluded %d)", scene.m_stats.objects_culled, scene.m_stats.objects_total, scene.m_stats.objects_occluded);
+    ImGui::Text("Objects batched %d in %d multi draw calls", scene.m_stats.objects_batched, scene.m_stats.multi_draw_calls);
+    if (scene.m_stats.gpu_culled_draws)
+      ImGui::Text("Static meshes culled on GPU %d", scene.m_stats.gpu_culled_draws);
+    ImGui::Text("Streamed %.1f KB per frame, stalls %d, reallocations %d", scene.m_stats.stream_frame_bytes / 1024.f,
+      scene.m_stats.stream_stalls, scene.m_stats.stream_reallocations);
+    ImGui::Text("Lights %d, %d light references in clusters", scene.m_stats.lights, scene.m_stats.light_indices);
+    const glm::ivec2 render_size = scene.render_size();
+    ImGui::Text("Render scale %.2f (%dx%d), CPU %.2f ms, GPU %.2f ms", scene.m_render_scale.scale(), render_size.x, render_size.y,
+      scene.m_stats.cpu_frame_ms, scene.m_stats.gpu_frame_ms);
+    // skipped frames replay this window as it was drawn, so count is shown up to date only once scene changes
+    if (scene.m_render_on_demand)
+      ImGui::Text("Frames skipped %d (updated on next redraw)", scene.m_stats.frames_skipped);
+    if (MemoryProfiler::enabled())
+    {
+      ImGui::Text("Heap allocations per frame %llu (%.1f KB), live %.1f MB, peak %.1f MB", (unsigned long long)scene.m_stats.frame_allocations,
+        scene.m_stats.frame_allocated_bytes / 1024.f, scene.m_stats.live_bytes / (1024.f * 1024.f), scene.m_stats.peak_bytes / (1024.f * 1024.f));
+    }
     ImGui::End();
   }
 
+  render_imports();
+
   ImGui::Render();
   ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 }
 
+void Ui::render_last_frame()
+{
+  if (ImDrawData* draw_data = ImGui::GetDrawData())
+    ImGui_ImplOpenGL3_RenderDrawData(draw_data);
+}
+
+void Ui::render_imports()
+{
+  if (!m_scene.m_importer->busy())
+    return;
+  // corner overlay which doesn't take focus or input, so scene can be used meanwhile
+  constexpr float padding = 10.f;
+  ImGui::SetNextWindowPos(ImVec2(m_window->width() - padding, m_window->height() - padding), ImGuiCond_Always, ImVec2(1.f, 1.f));
+  ImGui::SetNextWindowBgAlpha(0.6f);
+  const ImGuiWindowFlags flags = ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoInputs |
+    ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoNav | ImGuiWindowFlags_NoSavedSettings;
+  if (ImGui::Begin("Imports", nullptr, flags))
+  {
+    m_scene.m_importer->for_each_import([](const ModelImporter::Import& import)
+      {
+        const ModelLoader::Progress& progress = import.progress;
+        const size_t name_start = import.filename.find_last_of("/\\");
+        ImGui::TextUnformatted(name_start == std::string::npos ? import.filename.c_str() : import.filename.c_str() + name_start + 1);
+        char label[64];
+        float fraction = 0.f;
+        const int meshes_total = progress.meshes_total;
+        if (!import.running)
+        {
+          std::snprintf(label, sizeof(label), "waiting");
+        }
+        else if (meshes_total == 0)
+        {
+          const uint64_t total = progress.bytes_total, parsed = progress.bytes_parsed;
+          fraction = total ? (float)parsed / total : 0.f;
+          std::snprintf(label, sizeof(label), "parsing %.1f / %.1f MB", parsed / (1024.f * 1024.f), total / (1024.f * 1024.f));
+        }
+        else
+        {
+          const int converted = progress.meshes_converted;
+          fraction = (float)converted / meshes_total;
+          std::snprintf(label, sizeof(label), "converting %d / %d meshes", converted, meshes_total);
+        }
+        ImGui::ProgressBar(fraction, ImVec2(260.f, 0.f), label);
+      });
+  }
+  ImGui::End();
+}
+
+void Ui::render_profiler()
+{
+  const FrameProfiler& profiler = *m_scene.m_profiler;
+  ImGui::TextDisabled("Pass times in ms, min / avg / max of last %d frames", FrameProfiler::history_size);
+  ImGui::TextDisabled("CPU time is time of submitting commands");
+#if OPENGL_ENGINE_TRACING
+  if (ImGui::Button("Save CPU trace"))
+    Tracer::save("trace.json");
+  ImGui::SameLine();
+  ImGui::TextDisabled("trace.json, open in chrome://tracing or Perfetto");
+#endif
+  for (const FrameProfiler::PassTimes& pass : profiler.passes())
+  {
+    // culled since start
+    if (pass.cpu_ms.count == 0)
+      continue;
+    ImGui::PushID(pass.name.c_str());
+    ImGui::SeparatorText(pass.name.c_str());
+    const FrameProfiler::History* histories[] = { &pass.cpu_ms, &pass.gpu_ms };
+    const char* labels[] = { "CPU", "GPU" };
+    for (int i = 0; i < 2; i++)
+    {
+      const FrameProfiler::History& history = *histories[i];
+      if (i > 0)
+        ImGui::SameLine();
+      ImGui::BeginGroup();
+      if (history.count)
+      {
+        ImGui::Text("%s %.3f / %.3f / %.3f", labels[i], history.min(), history.average(), history.max());
+        char overlay[32];
+        std::snprintf(overlay, sizeof(overlay), "%.3f", history.last());
+        // oldest value is at next once history is full
+        const int offset = history.count == FrameProfiler::history_size ? history.next : 0;
+        ImGui::PlotLines(labels[i], history.values.data(), history.count, offset, overlay, 0.f, history.max() * 1.2f, ImVec2(200.f, 40.f));
+      }
+      else
+        ImGui::Text("%s waiting for results", labels[i]);
+      if (i > 0 && pass.gpu_dropped)
+        ImGui::TextDisabled("%d dropped, GPU was behind", pass.gpu_dropped);
+      ImGui::EndGroup();
+    }
+    ImGui::PopID();
+  }
+}
+
 void Ui::render_object_properties(Object3D& drawable)
 {
   ImGui::SetNextItemOpen(true, ImGuiCond_::ImGuiCond_Once);
@@ -367,11 +516,33 @@ void Ui::render_object_properties(Object3D& drawable)
       drawable.set_color(drawable.m_color);
     ImGui::PopItemWidth();
 
+    if (drawable.is_light_source())
+    {
+      ImGui::Separator();
+      ImGui::Text("Light");
+      Light& light = drawable.light();
+      int type = light.type;
+      if (ImGui::Combo("Type", &type, "Point\0Spot\0"))
+        light.type = static_cast<Light::Type>(type);
+      ImGui::ColorEdit3("Light color", &light.color.x);
+      ImGui::SliderFloat("Intensity", &light.intensity, 0.f, 10.f);
+      ImGui::SliderFloat("Range", &light.range, 0.1f, 100.f);
+      if (light.type == Light::SPOT)
+      {
+        ImGui::SliderFloat3("Direction", &light.direction.x, -1.f, 1.f);
+        ImGui::SliderFloat("Inner angle", &light.inner_angle, 0.f, light.outer_angle);
+        ImGui::SliderFloat("Outer angle", &light.outer_angle, light.inner_angle, 90.f);
+      }
+    }
+
     ImGui::Separator();
     ImGui::Text("Miscellaneous");
     bool is_bbox_visible = drawable.is_bbox_visible();
     if (ImGui::Checkbox("Show bounding box", &is_bbox_visible))
       drawable.visible_bbox(is_bbox_visible);
+    bool is_occluder = drawable.is_occluder();
+    if (ImGui::Checkbox("Occluder", &is_occluder))
+      drawable.occluder(is_occluder);
 
     // TODO: rewrite later as e.g. 2D Circle has surface but it won't be derived from Model class
     if (drawable.has_surface())
@@ -398,21 +569,15 @@ void Ui::render_object_properties(Object3D& drawable)
         drawable.visible_normals(is_normals_visible);
 
       // shading modes
-      std::vector<std::pair<Object3D::ShadingMode, std::string>> modes(3);
-      for (int i = 0; i < 3; i++)
-      {
-        Object3D::ShadingMode mode = static_cast<Object3D::ShadingMode>(i);
-        modes[i] = std::make_pair(mode, ::shading_mode_to_str(mode));
-      }
-      std::string current_mode = ::shading_mode_to_str(drawable.shading_mode());
       ImGui::SetNextItemWidth(win_space_for_items_x / 2);
-      if (ImGui::BeginCombo("Shading mode", current_mode.c_str()))
+      if (ImGui::BeginCombo("Shading mode", ::shading_mode_to_str(drawable.shading_mode())))
       {
         for (int i = 0; i < 3; i++)
         {
-          bool selected = (current_mode == modes[i].second);
-          if (ImGui::Selectable(modes[i].second.c_str(), &selected))
-            drawable.apply_shading(modes[i].first);
+          const Object3D::ShadingMode mode = static_cast<Object3D::ShadingMode>(i);
+          bool selected = (drawable.shading_mode() == mode);
+          if (ImGui::Selectable(::shading_mode_to_str(mode), &selected))
+            drawable.apply_shading(mode);
           if (selected)
             ImGui::SetItemDefaultFocus();
         }
@@ -437,7 +602,7 @@ void Ui::render_xyz_markers(float offset_from_left, float width)
   }
 }
 
-static std::string shading_mode_to_str(Object3D::ShadingMode mode)
+static const char* shading_mode_to_str(Object3D::ShadingMode mode)
 {
   switch (mode)
   {
@@ -12,7 +12,13 @@ public:
   Ui(SceneRenderer& scene, MainWindow* window);
   ~Ui();
   void render();
+  // draws ui of previous render again without processing it
+  void render_last_frame();
 private:
+  // per pass timings with rolling graphs
+  void render_profiler();
+  // progress of models which are loaded in background
+  void render_imports();
   void render_object_properties(Object3D& drawable);
   void render_xyz_markers(float offset_from_left, float width);
 private:
@@ -0,0 +1,102 @@
+#include <cassert>
+#include "VisibilityBuffer.hpp"
+#include "ShaderStorage.hpp"
+
+using namespace GlobalState;
+
+bool VisibilityBuffer::can_encode(const IndirectRenderer& renderer)
+{
+  size_t draws = 0;
+  for (const IndirectRenderer::Bucket& bucket : renderer.buckets())
+  {
+    draws += bucket.commands.size();
+    for (const IndirectRenderer::DrawCommand& cmd : bucket.commands)
+    {
+      if (cmd.count / 3 > max_triangles_per_draw)
+        return false;
+    }
+  }
+  return draws <= max_draws;
+}
+
+VisibilityBuffer::VisibilityBuffer(int w, int h)
+{
+  resize(w, h);
+}
+
+void VisibilityBuffer::resize(int w, int h)
+{
+  m_fbo.bind();
+  m_fbo.attach_texture(w, h, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT);
+  // depth is sampled by resolve pass, so it is a texture instead of render buffer
+  if (!m_depth)
+    m_depth = Texture2D(w, h, GL_DEPTH_COMPONENT32F, GL_DEPTH_COMPONENT, GL_FLOAT);
+  else
+    m_depth->resize(w, h, GL_DEPTH_COMPONENT32F, GL_DEPTH_COMPONENT, GL_FLOAT);
+  // integer textures are incomplete with linear filtering, both are read only by texelFetch anyway
+  for (GLuint tex : { m_fbo.texture()->id(), m_depth->id() })
+  {
+    glBindTexture(GL_TEXTURE_2D, tex);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  }
+  glBindTexture(GL_TEXTURE_2D, 0);
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_depth->id(), 0);
+  assert(m_fbo.is_complete());
+  m_fbo.unbind();
+  m_has_frame = false;
+}
+
+int VisibilityBuffer::render(IndirectRenderer& renderer, StreamingBuffer& stream, const glm::mat4& view, const glm::mat4& projection)
+{
+  GLint prev_fbo = 0;
+  glGetIntegerv(GL_FRAMEBUFFER_BINDING, &prev_fbo);
+  m_fbo.bind();
+  const GLuint background = 0;
+  glClearBufferuiv(GL_COLOR, 0, &background);
+  glClear(GL_DEPTH_BUFFER_BIT);
+  Shader& shader = ShaderStorage::get(ShaderStorage::VISIBILITY);
+  shader.bind();
+  shader.set_matrix4f("viewMatrix", view);
+  shader.set_matrix4f("projectionMatrix", projection);
+  const int ndraws = renderer.draw(shader, stream);
+  shader.unbind();
+  glBindFramebuffer(GL_FRAMEBUFFER, prev_fbo);
+  m_draw_sources = renderer.draw_sources();
+  m_has_frame = true;
+  return ndraws;
+}
+
+void VisibilityBuffer::resolve(IndirectRenderer& renderer, Shader& shader)
+{
+  if (m_draw_sources.empty())
+    return;
+  // draw parameters stay bound at binding 0 since geometry pass
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, renderer.arena().vertex_buffer());
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, renderer.arena().index_buffer());
+  shader.set_int("_texture", 0);
+  shader.set_int("visibilityIds", 1);
+  shader.set_int("visibilityDepth", 2);
+  glActiveTexture(GL_TEXTURE1);
+  glBindTexture(GL_TEXTURE_2D, m_fbo.texture()->id());
+  glActiveTexture(GL_TEXTURE2);
+  glBindTexture(GL_TEXTURE_2D, m_depth->id());
+  glActiveTexture(GL_TEXTURE0);
+  GLint polygon_mode[2];
+  glGetIntegerv(GL_POLYGON_MODE, polygon_mode);
+  glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+  m_empty_vao.bind();
+  for (const IndirectRenderer::Bucket& bucket : renderer.buckets())
+  {
+    if (bucket.commands.empty())
+      continue;
+    // pixels of draws from other buckets are discarded, so every pixel is shaded once
+    shader.set_uint("firstDraw", bucket.commands.front().base_instance);
+    shader.set_uint("drawCount", (GLuint)bucket.commands.size());
+    glBindTexture(GL_TEXTURE_2D, bucket.texture);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+  }
+  m_empty_vao.unbind();
+  glBindTexture(GL_TEXTURE_2D, 0);
+  glPolygonMode(GL_FRONT_AND_BACK, polygon_mode[0]);
+}
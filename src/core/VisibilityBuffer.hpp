@@ -0,0 +1,47 @@
+#pragma once
+
+#include <vector>
+#include <optional>
+#include <cstdint>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "FrameBufferObject.hpp"
+#include "IndirectRenderer.hpp"
+#include "StreamingBuffer.hpp"
+#include "VertexArrayObject.hpp"
+
+// Alternative to forward shading of meshes batched by IndirectRenderer. Geometry pass writes only depth and
+// packed (draw, triangle) id into R32UI target. Resolve pass then shades every covered pixel once: it fetches
+// vertices of the triangle from geometry arena and interpolates them, so shading cost doesn't depend on
+// overdraw or triangle density. Ids are laid out so GPUPicker can read them instead of rendering its own.
+class VisibilityBuffer
+{
+public:
+  static constexpr int triangle_bits = 20;
+  static constexpr uint32_t max_triangles_per_draw = 1u << triangle_bits;
+  // draw index + 1 is stored, so 0 is left for background
+  static constexpr uint32_t max_draws = (1u << (32 - triangle_bits)) - 1;
+  static GLuint first_id(int draw) { return (GLuint)(draw + 1) << triangle_bits; }
+  // false if submitted draws don't fit into ids, such frame has to be drawn forward
+  static bool can_encode(const IndirectRenderer& renderer);
+public:
+  OnlyMovable(VisibilityBuffer)
+  VisibilityBuffer(int w, int h);
+  void resize(int w, int h);
+  // geometry pass of draws submitted to renderer. returns number of multi draw calls
+  int render(IndirectRenderer& renderer, StreamingBuffer& stream, const glm::mat4& view, const glm::mat4& projection);
+  // shades ids into currently bound framebuffer and writes their depth, one full screen pass per texture.
+  // lights and their uniforms have to be set up for resolve shader
+  void resolve(IndirectRenderer& renderer, Shader& shader);
+  // ids and draw sources stay valid until next render
+  bool has_frame() const { return m_has_frame; }
+  void invalidate() { m_has_frame = false; }
+  const FrameBufferObject& fbo() const { return m_fbo; }
+  const std::vector<IndirectRenderer::DrawSource>& draw_sources() const { return m_draw_sources; }
+private:
+  FrameBufferObject m_fbo;
+  std::optional<Texture2D> m_depth;
+  VertexArrayObject m_empty_vao;  // full screen triangle is generated from vertex id
+  std::vector<IndirectRenderer::DrawSource> m_draw_sources;
+  bool m_has_frame = false;
+};
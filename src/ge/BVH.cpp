@@ -0,0 +1,476 @@
+#include <cassert>
+#include <algorithm>
+#include "BVH.hpp"
+
+float DynamicBVH::AABB::area() const
+{
+  const glm::vec3 d = max - min;
+  return 2.f * (d.x * d.y + d.y * d.z + d.z * d.x);
+}
+
+bool DynamicBVH::AABB::contains(const AABB& other) const
+{
+  return min.x <= other.min.x && min.y <= other.min.y && min.z <= other.min.z &&
+    max.x >= other.max.x && max.y >= other.max.y && max.z >= other.max.z;
+}
+
+bool DynamicBVH::AABB::overlaps(const AABB& other) const
+{
+  return min.x <= other.max.x && max.x >= other.min.x &&
+    min.y <= other.max.y && max.y >= other.min.y &&
+    min.z <= other.max.z && max.z >= other.min.z;
+}
+
+DynamicBVH::AABB DynamicBVH::AABB::merge(const AABB& a, const AABB& b)
+{
+  return AABB(glm::min(a.min, b.min), glm::max(a.max, b.max));
+}
+
+DynamicBVH::DynamicBVH(float margin) : m_margin(margin)
+{
+}
+
+int DynamicBVH::allocate_node()
+{
+  if (m_free_list == null_node)
+  {
+    m_nodes.emplace_back();
+    return (int)m_nodes.size() - 1;
+  }
+  const int node = m_free_list;
+  m_free_list = m_nodes[node].parent;
+  m_nodes[node] = Node();
+  return node;
+}
+
+void DynamicBVH::free_node(int node)
+{
+  m_nodes[node].parent = m_free_list;
+  m_nodes[node].child1 = m_nodes[node].child2 = null_node;
+  m_nodes[node].height = -1;
+  m_free_list = node;
+}
+
+int DynamicBVH::create_proxy(const BoundingBox& bbox, int user_data)
+{
+  const int proxy = allocate_node();
+  const glm::vec3 margin(m_margin);
+  m_nodes[proxy].aabb = AABB(bbox.min() - margin, bbox.max() + margin);
+  m_nodes[proxy].user_data = user_data;
+  m_nodes[proxy].height = 0;
+  insert_leaf(proxy);
+  ++m_proxy_count;
+  ++m_changes_since_check;
+  return proxy;
+}
+
+void DynamicBVH::destroy_proxy(int proxy)
+{
+  assert(proxy >= 0 && proxy < (int)m_nodes.size() && m_nodes[proxy].is_leaf());
+  remove_leaf(proxy);
+  free_node(proxy);
+  --m_proxy_count;
+  ++m_changes_since_check;
+}
+
+bool DynamicBVH::move_proxy(int proxy, const BoundingBox& bbox)
+{
+  assert(proxy >= 0 && proxy < (int)m_nodes.size() && m_nodes[proxy].is_leaf());
+  const glm::vec3 margin(m_margin);
+  const AABB tight(bbox);
+  const AABB fat(bbox.min() - margin, bbox.max() + margin);
+  const AABB& current = m_nodes[proxy].aabb;
+  // keep proxy if it still fits and its fat box hasn't become too loose (e.g. after downscaling)
+  if (current.contains(tight) && current.area() <= 4.f * fat.area())
+    return false;
+  remove_leaf(proxy);
+  m_nodes[proxy].aabb = fat;
+  insert_leaf(proxy);
+  ++m_changes_since_check;
+  return true;
+}
+
+void DynamicBVH::insert_leaf(int leaf)
+{
+  if (m_root == null_node)
+  {
+    m_root = leaf;
+    m_nodes[leaf].parent = null_node;
+    return;
+  }
+
+  // descend to the best sibling by surface area heuristic
+  const AABB leaf_aabb = m_nodes[leaf].aabb;
+  int index = m_root;
+  while (!m_nodes[index].is_leaf())
+  {
+    const Node& node = m_nodes[index];
+    const float area = node.aabb.area();
+    const float combined_area = AABB::merge(node.aabb, leaf_aabb).area();
+    // cost of creating new parent for this node and the new leaf
+    const float cost = 2.f * combined_area;
+    // minimum cost of pushing the leaf further down the tree
+    const float inheritance_cost = 2.f * (combined_area - area);
+    auto child_cost = [&](int child)
+      {
+        const Node& c = m_nodes[child];
+        const float merged = AABB::merge(c.aabb, leaf_aabb).area();
+        return (c.is_leaf() ? merged : merged - c.aabb.area()) + inheritance_cost;
+      };
+    const float cost1 = child_cost(node.child1);
+    const float cost2 = child_cost(node.child2);
+    if (cost < cost1 && cost < cost2)
+      break;
+    index = cost1 < cost2 ? node.child1 : node.child2;
+  }
+
+  const int sibling = index;
+  const int old_parent = m_nodes[sibling].parent;
+  const int new_parent = allocate_node();
+  m_nodes[new_parent].parent = old_parent;
+  m_nodes[new_parent].aabb = AABB::merge(leaf_aabb, m_nodes[sibling].aabb);
+  m_nodes[new_parent].height = m_nodes[sibling].height + 1;
+  m_nodes[new_parent].child1 = sibling;
+  m_nodes[new_parent].child2 = leaf;
+  if (old_parent != null_node)
+  {
+    if (m_nodes[old_parent].child1 == sibling)
+      m_nodes[old_parent].child1 = new_parent;
+    else
+      m_nodes[old_parent].child2 = new_parent;
+  }
+  else
+  {
+    m_root = new_parent;
+  }
+  m_nodes[sibling].parent = new_parent;
+  m_nodes[leaf].parent = new_parent;
+  refit_ancestors(m_nodes[leaf].parent);
+}
+
+void DynamicBVH::remove_leaf(int leaf)
+{
+  if (leaf == m_root)
+  {
+    m_root = null_node;
+    return;
+  }
+  const int parent = m_nodes[leaf].parent;
+  const int grand_parent = m_nodes[parent].parent;
+  const int sibling = m_nodes[parent].child1 == leaf ? m_nodes[parent].child2 : m_nodes[parent].child1;
+  if (grand_parent != null_node)
+  {
+    // connect sibling to grand parent and drop the parent
+    if (m_nodes[grand_parent].child1 == parent)
+      m_nodes[grand_parent].child1 = sibling;
+    else
+      m_nodes[grand_parent].child2 = sibling;
+    m_nodes[sibling].parent = grand_parent;
+    free_node(parent);
+    refit_ancestors(grand_parent);
+  }
+  else
+  {
+    m_root = sibling;
+    m_nodes[sibling].parent = null_node;
+    free_node(parent);
+  }
+  m_nodes[leaf].parent = null_node;
+}
+
+void DynamicBVH::refit_ancestors(int index)
+{
+  while (index != null_node)
+  {
+    index = balance(index);
+    Node& node = m_nodes[index];
+    const Node& c1 = m_nodes[node.child1];
+    const Node& c2 = m_nodes[node.child2];
+    node.height = 1 + std::max(c1.height, c2.height);
+    node.aabb = AABB::merge(c1.aabb, c2.aabb);
+    index = node.parent;
+  }
+}
+
+// single left or right tree rotation if subtree of iA is imbalanced. returns index of subtree root
+int DynamicBVH::balance(int iA)
+{
+  Node& A = m_nodes[iA];
+  if (A.is_leaf() || A.height < 2)
+    return iA;
+
+  const int iB = A.child1;
+  const int iC = A.child2;
+  Node& B = m_nodes[iB];
+  Node& C = m_nodes[iC];
+  const int balance = C.height - B.height;
+
+  auto replace_in_parent = [this](int parent, int old_child, int new_child)
+    {
+      if (parent == null_node)
+      {
+        m_root = new_child;
+      }
+      else if (m_nodes[parent].child1 == old_child)
+      {
+        m_nodes[parent].child1 = new_child;
+      }
+      else
+      {
+        m_nodes[parent].child2 = new_child;
+      }
+    };
+
+  // rotate C up
+  if (balance > 1)
+  {
+    const int iF = C.child1;
+    const int iG = C.child2;
+    Node& F = m_nodes[iF];
+    Node& G = m_nodes[iG];
+    C.child1 = iA;
+    C.parent = A.parent;
+    A.parent = iC;
+    replace_in_parent(C.parent, iA, iC);
+    if (F.height > G.height)
+    {
+      C.child2 = iF;
+      A.child2 = iG;
+      G.parent = iA;
+      A.aabb = AABB::merge(B.aabb, G.aabb);
+      C.aabb = AABB::merge(A.aabb, F.aabb);
+      A.height = 1 + std::max(B.height, G.height);
+      C.height = 1 + std::max(A.height, F.height);
+    }
+    else
+    {
+      C.child2 = iG;
+      A.child2 = iF;
+      F.parent = iA;
+      A.aabb = AABB::merge(B.aabb, F.aabb);
+      C.aabb = AABB::merge(A.aabb, G.aabb);
+      A.height = 1 + std::max(B.height, F.height);
+      C.height = 1 + std::max(A.height, G.height);
+    }
+    return iC;
+  }
+
+  // rotate B up
+  if (balance < -1)
+  {
+    const int iD = B.child1;
+    const int iE = B.child2;
+    Node& D = m_nodes[iD];
+    Node& E = m_nodes[iE];
+    B.child1 = iA;
+    B.parent = A.parent;
+    A.parent = iB;
+    replace_in_parent(B.parent, iA, iB);
+    if (D.height > E.height)
+    {
+      B.child2 = iD;
+      A.child1 = iE;
+      E.parent = iA;
+      A.aabb = AABB::merge(C.aabb, E.aabb);
+      B.aabb = AABB::merge(A.aabb, D.aabb);
+      A.height = 1 + std::max(C.height, E.height);
+      B.height = 1 + std::max(A.height, D.height);
+    }
+    else
+    {
+      B.child2 = iE;
+      A.child1 = iD;
+      D.parent = iA;
+      A.aabb = AABB::merge(C.aabb, D.aabb);
+      B.aabb = AABB::merge(A.aabb, E.aabb);
+      A.height = 1 + std::max(C.height, D.height);
+      B.height = 1 + std::max(A.height, E.height);
+    }
+    return iB;
+  }
+  return iA;
+}
+
+void DynamicBVH::optimize()
+{
+  // evaluating cost is O(n), so do it only after considerable amount of changes
+  if (m_changes_since_check < std::max(16, m_proxy_count / 8))
+    return;
+  m_changes_since_check = 0;
+  if (m_cost_after_build == 0.f || sah_cost() > m_rebuild_threshold * m_cost_after_build)
+  {
+    rebuild();
+  }
+}
+
+void DynamicBVH::rebuild()
+{
+  std::vector<int> leaves;
+  leaves.reserve(m_proxy_count);
+  for (int i = 0; i < (int)m_nodes.size(); i++)
+  {
+    if (m_nodes[i].height < 0)
+      continue;
+    if (m_nodes[i].is_leaf())
+      leaves.push_back(i);
+    else
+      free_node(i);
+  }
+  m_root = null_node;
+  if (leaves.empty())
+    return;
+  m_root = build(leaves, 0, (int)leaves.size());
+  m_nodes[m_root].parent = null_node;
+  m_cost_after_build = sah_cost();
+  m_changes_since_check = 0;
+}
+
+int DynamicBVH::build(std::vector<int>& leaves, int begin, int end)
+{
+  const int count = end - begin;
+  if (count == 1)
+    return leaves[begin];
+
+  AABB centroid_bounds(glm::vec3(std::numeric_limits<float>::max()), glm::vec3(-std::numeric_limits<float>::max()));
+  for (int i = begin; i < end; i++)
+  {
+    const AABB& b = m_nodes[leaves[i]].aabb;
+    const glm::vec3 c = (b.min + b.max) * 0.5f;
+    centroid_bounds.min = glm::min(centroid_bounds.min, c);
+    centroid_bounds.max = glm::max(centroid_bounds.max, c);
+  }
+  const glm::vec3 extent = centroid_bounds.max - centroid_bounds.min;
+  int axis = 0;
+  if (extent.y > extent[axis])
+    axis = 1;
+  if (extent.z > extent[axis])
+    axis = 2;
+
+  int mid = begin + count / 2;
+  if (extent[axis] > 0.f)
+  {
+    constexpr int nbins = 16;
+    struct Bin
+    {
+      AABB bounds = AABB(glm::vec3(std::numeric_limits<float>::max()), glm::vec3(-std::numeric_limits<float>::max()));
+      int count = 0;
+    } bins[nbins];
+    const float scale = nbins / extent[axis];
+    auto bin_index = [&](int leaf)
+      {
+        const AABB& b = m_nodes[leaf].aabb;
+        const float c = (b.min[axis] + b.max[axis]) * 0.5f;
+        return std::min(nbins - 1, (int)((c - centroid_bounds.min[axis]) * scale));
+      };
+    for (int i = begin; i < end; i++)
+    {
+      Bin& bin = bins[bin_index(leaves[i])];
+      bin.bounds = AABB::merge(bin.bounds, m_nodes[leaves[i]].aabb);
+      ++bin.count;
+    }
+    // sweep from right to get area/count of everything to the right of each split plane
+    float right_area[nbins];
+    int right_count[nbins];
+    AABB acc = bins[nbins - 1].bounds;
+    int acc_count = 0;
+    for (int i = nbins - 1; i > 0; i--)
+    {
+      acc = AABB::merge(acc, bins[i].bounds);
+      acc_count += bins[i].count;
+      right_area[i] = acc_count ? acc.area() : 0.f;
+      right_count[i] = acc_count;
+    }
+    float best_cost = std::numeric_limits<float>::max();
+    int best_split = -1;
+    acc = bins[0].bounds;
+    acc_count = 0;
+    for (int i = 0; i < nbins - 1; i++)
+    {
+      acc = AABB::merge(acc, bins[i].bounds);
+      acc_count += bins[i].count;
+      if (acc_count == 0 || right_count[i + 1] == 0)
+        continue;
+      const float cost = acc.area() * acc_count + right_area[i + 1] * right_count[i + 1];
+      if (cost < best_cost)
+      {
+        best_cost = cost;
+        best_split = i;
+      }
+    }
+    if (best_split >= 0)
+    {
+      auto it = std::partition(leaves.begin() + begin, leaves.begin() + end, [&](int leaf) { return bin_index(leaf) <= best_split; });
+      mid = (int)(it - leaves.begin());
+    }
+  }
+  if (mid == begin || mid == end)
+  {
+    mid = begin + count / 2;
+  }
+
+  const int node = allocate_node();
+  const int child1 = build(leaves, begin, mid);
+  const int child2 = build(leaves, mid, end);
+  Node& n = m_nodes[node];
+  n.child1 = child1;
+  n.child2 = child2;
+  n.aabb = AABB::merge(m_nodes[child1].aabb, m_nodes[child2].aabb);
+  n.height = 1 + std::max(m_nodes[child1].height, m_nodes[child2].height);
+  m_nodes[child1].parent = node;
+  m_nodes[child2].parent = node;
+  return node;
+}
+
+void DynamicBVH::clear()
+{
+  m_nodes.clear();
+  m_root = null_node;
+  m_free_list = null_node;
+  m_proxy_count = 0;
+  m_cost_after_build = 0.f;
+  m_changes_since_check = 0;
+}
+
+float DynamicBVH::sah_cost() const
+{
+  if (m_root == null_node)
+    return 0.f;
+  const float root_area = m_nodes[m_root].aabb.area();
+  if (root_area <= 0.f)
+    return 0.f;
+  float total = 0.f;
+  for (const auto& node : m_nodes)
+  {
+    if (node.height > 0)
+      total += node.aabb.area();
+  }
+  return total / root_area;
+}
+
+bool DynamicBVH::validate() const
+{
+  if (m_root == null_node)
+    return m_proxy_count == 0;
+  if (m_nodes[m_root].parent != null_node)
+    return false;
+  return validate(m_root, null_node) == m_proxy_count;
+}
+
+// returns number of leaves in subtree or -1 if structure is broken
+int DynamicBVH::validate(int index, int parent) const
+{
+  const Node& node = m_nodes[index];
+  if (node.parent != parent || node.height < 0)
+    return -1;
+  if (node.is_leaf())
+    return node.height == 0 ? 1 : -1;
+  const Node& c1 = m_nodes[node.child1];
+  const Node& c2 = m_nodes[node.child2];
+  if (node.height != 1 + std::max(c1.height, c2.height))
+    return -1;
+  if (!node.aabb.contains(c1.aabb) || !node.aabb.contains(c2.aabb))
+    return -1;
+  const int n1 = validate(node.child1, index);
+  const int n2 = validate(node.child2, index);
+  return (n1 < 0 || n2 < 0) ? -1 : n1 + n2;
+}
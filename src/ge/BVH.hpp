@@ -0,0 +1,262 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <glm/glm.hpp>
+#include "./ge/BoundingBox.hpp"
+#include "./ge/Frustum.hpp"
+#include "./ge/Ray.hpp"
+
+// Incrementally updated bounding volume hierarchy over object bounds.
+// Leaves store enlarged ("fat") boxes, so small movements don't touch the tree at all. Insertion picks sibling
+// by surface area heuristic and tree is kept balanced by rotations. When SAH cost degrades too much compared to
+// the last full build, tree is rebuilt from scratch with binned SAH.
+class DynamicBVH
+{
+public:
+  static constexpr int null_node = -1;
+  struct AABB
+  {
+    AABB() = default;
+    AABB(const glm::vec3& min, const glm::vec3& max) : min(min), max(max) {}
+    explicit AABB(const BoundingBox& bbox) : min(bbox.min()), max(bbox.max()) {}
+    float area() const;
+    bool contains(const AABB& other) const;
+    bool overlaps(const AABB& other) const;
+    static AABB merge(const AABB& a, const AABB& b);
+    glm::vec3 min = glm::vec3(0.f);
+    glm::vec3 max = glm::vec3(0.f);
+  };
+public:
+  explicit DynamicBVH(float margin = 0.1f);
+  int create_proxy(const BoundingBox& bbox, int user_data);
+  void destroy_proxy(int proxy);
+  // returns true if proxy had to be reinserted, i.e. new box doesn't fit into fat box anymore
+  bool move_proxy(int proxy, const BoundingBox& bbox);
+  void set_user_data(int proxy, int user_data) { m_nodes[proxy].user_data = user_data; }
+  int user_data(int proxy) const { return m_nodes[proxy].user_data; }
+  const AABB& fat_bbox(int proxy) const { return m_nodes[proxy].aabb; }
+  // rebuilds tree if its quality degraded. cheap to call every frame
+  void optimize();
+  void rebuild();
+  void clear();
+  int height() const { return m_root == null_node ? 0 : m_nodes[m_root].height; }
+  int proxy_count() const { return m_proxy_count; }
+  // sum of areas of internal nodes relative to root area
+  float sah_cost() const;
+  bool validate() const;
+  void set_rebuild_threshold(float ratio) { m_rebuild_threshold = ratio; }
+
+  // callback: bool(int user_data), return false to stop the query
+  template<typename Callback>
+  void query(const BoundingBox& bbox, Callback callback) const;
+  template<typename Callback>
+  void query(const glm::vec3& center, float radius, Callback callback) const;
+  // callback: void(int user_data, bool fully_inside). fully_inside is true if fat box of proxy is completely inside frustum
+  template<typename Callback>
+  void query(const Frustum& frustum, Callback callback) const;
+  // callback: float(int user_data, const Ray& ray, float max_t), returns new max distance.
+  // return max_t to continue without clipping, or 0 to stop.
+  // boxes are inflated by radius, so geometry which is hit with some tolerance is not missed
+  template<typename Callback>
+  void raycast(const Ray& ray, float max_t, Callback callback, float radius = 0.f) const;
+private:
+  struct Node
+  {
+    bool is_leaf() const { return child1 == null_node; }
+    AABB aabb;
+    int parent = null_node;  // next free node when node is not in use
+    int child1 = null_node;
+    int child2 = null_node;
+    int height = 0;          // leaf = 0, free = -1
+    int user_data = -1;
+  };
+  int allocate_node();
+  void free_node(int node);
+  void insert_leaf(int leaf);
+  void remove_leaf(int leaf);
+  int balance(int node);
+  void refit_ancestors(int node);
+  int build(std::vector<int>& leaves, int begin, int end);
+  int validate(int node, int parent) const;
+private:
+  std::vector<Node> m_nodes;
+  int m_root = null_node;
+  int m_free_list = null_node;
+  int m_proxy_count = 0;
+  float m_margin;
+  float m_rebuild_threshold = 1.5f;
+  float m_cost_after_build = 0.f;
+  int m_changes_since_check = 0;
+  // traversal stacks reused between queries, so queries must not be nested
+  mutable std::vector<int> m_stack;
+  mutable std::vector<std::pair<int, int>> m_frustum_stack;
+};
+
+template<typename Callback>
+void DynamicBVH::query(const BoundingBox& bbox, Callback callback) const
+{
+  const AABB box(bbox);
+  if (m_root == null_node)
+    return;
+  m_stack.clear();
+  m_stack.push_back(m_root);
+  while (!m_stack.empty())
+  {
+    const Node& node = m_nodes[m_stack.back()];
+    m_stack.pop_back();
+    if (!node.aabb.overlaps(box))
+      continue;
+    if (node.is_leaf())
+    {
+      if (!callback(node.user_data))
+        return;
+    }
+    else
+    {
+      m_stack.push_back(node.child1);
+      m_stack.push_back(node.child2);
+    }
+  }
+}
+
+template<typename Callback>
+void DynamicBVH::query(const glm::vec3& center, float radius, Callback callback) const
+{
+  if (m_root == null_node)
+    return;
+  const float r2 = radius * radius;
+  m_stack.clear();
+  m_stack.push_back(m_root);
+  while (!m_stack.empty())
+  {
+    const Node& node = m_nodes[m_stack.back()];
+    m_stack.pop_back();
+    // distance from sphere center to closest point of box
+    const glm::vec3 closest = glm::clamp(center, node.aabb.min, node.aabb.max);
+    const glm::vec3 d = closest - center;
+    if (glm::dot(d, d) > r2)
+      continue;
+    if (node.is_leaf())
+    {
+      if (!callback(node.user_data))
+        return;
+    }
+    else
+    {
+      m_stack.push_back(node.child1);
+      m_stack.push_back(node.child2);
+    }
+  }
+}
+
+template<typename Callback>
+void DynamicBVH::query(const Frustum& frustum, Callback callback) const
+{
+  if (m_root == null_node)
+    return;
+  constexpr int all_planes = (1 << Frustum::PLANE_COUNT) - 1;
+  // node index and mask of planes which still have to be tested for its subtree
+  auto& stack = m_frustum_stack;
+  stack.clear();
+  stack.emplace_back(m_root, all_planes);
+  while (!stack.empty())
+  {
+    auto [index, mask] = stack.back();
+    stack.pop_back();
+    const Node& node = m_nodes[index];
+    const glm::vec3 c = (node.aabb.min + node.aabb.max) * 0.5f;
+    const glm::vec3 e = (node.aabb.max - node.aabb.min) * 0.5f;
+    bool outside = false;
+    for (int p = 0; p < Frustum::PLANE_COUNT && !outside; p++)
+    {
+      if (!(mask & (1 << p)))
+        continue;
+      const glm::vec4& plane = frustum.plane(static_cast<Frustum::Plane>(p));
+      const float d = plane.x * c.x + plane.y * c.y + plane.z * c.z + plane.w;
+      const float r = e.x * std::abs(plane.x) + e.y * std::abs(plane.y) + e.z * std::abs(plane.z);
+      if (d + r < 0.f)
+        outside = true;
+      else if (d - r >= 0.f)
+        mask &= ~(1 << p);  // box is in front of this plane, children are too
+    }
+    if (outside)
+      continue;
+    if (mask == 0)
+    {
+      // whole subtree is inside, no more plane tests needed
+      m_stack.clear();
+      m_stack.push_back(index);
+      while (!m_stack.empty())
+      {
+        const Node& n = m_nodes[m_stack.back()];
+        m_stack.pop_back();
+        if (n.is_leaf())
+        {
+          callback(n.user_data, true);
+        }
+        else
+        {
+          m_stack.push_back(n.child1);
+          m_stack.push_back(n.child2);
+        }
+      }
+    }
+    else if (node.is_leaf())
+    {
+      callback(node.user_data, false);
+    }
+    else
+    {
+      stack.emplace_back(node.child1, mask);
+      stack.emplace_back(node.child2, mask);
+    }
+  }
+}
+
+template<typename Callback>
+void DynamicBVH::raycast(const Ray& ray, float max_t, Callback callback, float radius) const
+{
+  if (m_root == null_node)
+    return;
+  const glm::vec3 inv_dir = safe_inverse(ray.direction);
+  const glm::vec3 r(radius);
+  m_stack.clear();
+  m_stack.push_back(m_root);
+  while (!m_stack.empty())
+  {
+    const Node& node = m_nodes[m_stack.back()];
+    m_stack.pop_back();
+    float tmin;
+    if (!intersect_aabb(ray, inv_dir, node.aabb.min - r, node.aabb.max + r, max_t, tmin))
+      continue;
+    if (node.is_leaf())
+    {
+      max_t = callback(node.user_data, ray, max_t);
+      if (max_t <= 0.f)
+        return;
+    }
+    else
+    {
+      // visit closer child first, so hits found early clip the rest of traversal
+      const Node& c1 = m_nodes[node.child1];
+      const Node& c2 = m_nodes[node.child2];
+      float t1 = max_t, t2 = max_t;
+      const bool hit1 = intersect_aabb(ray, inv_dir, c1.aabb.min - r, c1.aabb.max + r, max_t, t1);
+      const bool hit2 = intersect_aabb(ray, inv_dir, c2.aabb.min - r, c2.aabb.max + r, max_t, t2);
+      if (hit1 && hit2)
+      {
+        m_stack.push_back(t1 <= t2 ? node.child2 : node.child1);
+        m_stack.push_back(t1 <= t2 ? node.child1 : node.child2);
+      }
+      else if (hit1)
+      {
+        m_stack.push_back(node.child1);
+      }
+      else if (hit2)
+      {
+        m_stack.push_back(node.child2);
+      }
+    }
+  }
+}
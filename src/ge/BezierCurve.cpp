@@ -1,4 +1,5 @@
 #include "BezierCurve.hpp"
+#include <stdexcept>
 
 BezierCurve::BezierCurve(Type type, const Vertex& start_pnt, const Vertex& end_pnt)
   : Curve(start_pnt, end_pnt)
@@ -13,20 +14,20 @@ void BezierCurve::set_control_points(const std::vector<Vertex>& c_points)
   {
   case BezierCurve::Type::Quadratic:
     if (c_points.size() != 1)
-      throw std::exception("For quadratic Bezier curve n of control points must be 1");
+      throw std::invalid_argument("For quadratic Bezier curve n of control points must be 1");
     break;
   case BezierCurve::Type::Cubic:
     if (c_points.size() != 2)
-      throw std::exception("For qubic Bezier curve n of control points must be 2");
+      throw std::invalid_argument("For qubic Bezier curve n of control points must be 2");
     break;
   default:
-    throw std::exception("Unsupported Bezier curve type");
+    throw std::invalid_argument("Unsupported Bezier curve type");
     break;
   }
   m_control_points = c_points;
 }
 
-void BezierCurve::render(GPUBuffers* buffers)
+void BezierCurve::tessellate()
 {
   auto& mesh = m_meshes[0];
   if (!mesh.vertices().size())
@@ -81,8 +82,14 @@ void BezierCurve::render(GPUBuffers* buffers)
       return;
     }
   }
+}
+
+void BezierCurve::render(GPUBuffers* buffers, RenderPass pass)
+{
+  tessellate();
   RenderConfig cfg;
   cfg.mode = GL_LINE_STRIP;
   cfg.use_indices = false;
+  cfg.pass = pass;
   Object3D::render(buffers, cfg);
 }
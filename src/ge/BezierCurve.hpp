@@ -17,7 +17,10 @@ public:
   std::vector<Vertex>& control_points() { return m_control_points; }
   const std::vector<Vertex>& control_points() const { return m_control_points; }
   Type type() const { return m_type; }
-  void render(GPUBuffers* buffers) override; 
+  void render(GPUBuffers* buffers, RenderPass pass) override;
+  using Object3D::render;
+  // generates points of line strip if they are not generated yet
+  void tessellate();
 private:
   Type m_type; 
 };
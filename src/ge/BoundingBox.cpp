@@ -1,3 +1,4 @@
+#include <cmath>
 #include "utils/Constants.hpp"
 #include "BoundingBox.hpp"
 #include "Vertex.hpp"
@@ -21,7 +22,6 @@ void BoundingBox::render(GPUBuffers* buffers)
   // BoundingBox::render must be called only inside Object3D::render, 
   // thus all buffers must be already bound
   auto& vao = buffers->vao;
-  auto& vbo = buffers->vbo;
   std::array<glm::vec3, 8> bbox_points = points();
   std::array<Vertex, 8> converted;
   for (size_t i = 0; i < 8; i++)
@@ -29,13 +29,12 @@ void BoundingBox::render(GPUBuffers* buffers)
     converted[i] = Vertex(bbox_points[i]);
     converted[i].color = glm::vec4(0.f, 1.f, 0.f, 1.f);
   }
-  auto indices = lines_indices();
-  auto& ebo = buffers->ebo;
-  vbo->set_data(converted.data(), sizeof(Vertex) * 8);
+  const auto& indices = lines_indices();
+  const GLint first_vertex = buffers->stream_vertices(converted.data(), converted.size(), sizeof(Vertex)).first_element(sizeof(Vertex));
   vao->link_attrib(0, 3, GL_FLOAT, sizeof(Vertex), nullptr);                      // position
   vao->link_attrib(1, 4, GL_FLOAT, sizeof(Vertex), (void*)(sizeof(GLfloat) * 6)); // color
-  ebo->set_data(indices.data(), sizeof(GLuint) * indices.size());
-  glDrawElements(GL_LINES, (GLsizei)indices.size(), GL_UNSIGNED_INT, nullptr);
+  const size_t indices_offset = buffers->stream_indices(indices.data(), indices.size()).offset;
+  glDrawElementsBaseVertex(GL_LINES, (GLsizei)indices.size(), GL_UNSIGNED_INT, (void*)indices_offset, first_vertex);
 }
 
 bool BoundingBox::contains(const glm::vec3& point) const
@@ -45,6 +44,19 @@ bool BoundingBox::contains(const glm::vec3& point) const
     (point.z >= m_min.z && point.z <= m_max.z);
 }
 
+BoundingBox BoundingBox::transformed(const glm::mat4& mat) const
+{
+  // transform center and project extents on world axes (J. Arvo, "Transforming Axis-Aligned Bounding Boxes")
+  const glm::vec3 c = glm::vec3(mat * glm::vec4(center(), 1.f));
+  const glm::vec3 e = extents();
+  glm::vec3 world_e;
+  for (int i = 0; i < 3; i++)
+  {
+    world_e[i] = std::abs(mat[0][i]) * e.x + std::abs(mat[1][i]) * e.y + std::abs(mat[2][i]) * e.z;
+  }
+  return BoundingBox(c - world_e, c + world_e);
+}
+
 std::array<glm::vec3, 8> BoundingBox::points() const
 {
   std::array<glm::vec3, 8> points;
@@ -62,12 +74,12 @@ std::array<glm::vec3, 8> BoundingBox::points() const
   return points;
 }
 
-std::vector<GLuint> BoundingBox::lines_indices() const
+const std::array<GLuint, 24>& BoundingBox::lines_indices()
 {
-  std::vector<GLuint> v = {
+  static constexpr std::array<GLuint, 24> indices = {
     0, 1, 1, 2, 2, 3, 3, 0, // front
     4, 5, 5, 6, 6, 7, 7, 4, // back
     0, 4, 3, 7, 1, 5, 2, 6
   };
-  return v;
+  return indices;
 }
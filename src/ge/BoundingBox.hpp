@@ -14,9 +14,14 @@ public:
   bool has_surface() const override { return false; }
   std::string name() const { return "Bounding box"; }
   std::array<glm::vec3, 8> points() const;
-  std::vector<GLuint> lines_indices() const;
+  // same for every box, GL_LINES pairs of points()
+  static const std::array<GLuint, 24>& lines_indices();
   bool is_empty() const;
   bool contains(const glm::vec3& point) const;
+  // axis aligned box which covers this box after transformation
+  BoundingBox transformed(const glm::mat4& mat) const;
+  glm::vec3 center() const { return (m_min + m_max) * 0.5f; }
+  glm::vec3 extents() const { return (m_max - m_min) * 0.5f; }
   void set_min(const glm::vec3& min) { m_min = min; }
   void set_max(const glm::vec3& max) { m_max = max; }
   glm::vec3 min() const { return m_min; }
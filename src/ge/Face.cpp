@@ -1,4 +1,5 @@
 #include "Face.hpp"
+#include <cstring>
 
 Face::Face(const Face& other) {
   size = other.size;
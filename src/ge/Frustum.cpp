@@ -0,0 +1,114 @@
+#include <cmath>
+#include "Frustum.hpp"
+#include "./utils/Simd.hpp"
+
+void BoundsSoA::clear()
+{
+  for (auto* v : { &cx, &cy, &cz, &ex, &ey, &ez })
+    v->clear();
+}
+
+void BoundsSoA::reserve(size_t n)
+{
+  for (auto* v : { &cx, &cy, &cz, &ex, &ey, &ez })
+    v->reserve(n);
+}
+
+void BoundsSoA::push_back(const BoundingBox& bbox)
+{
+  const glm::vec3 c = bbox.center();
+  const glm::vec3 e = bbox.extents();
+  cx.push_back(c.x), cy.push_back(c.y), cz.push_back(c.z);
+  ex.push_back(e.x), ey.push_back(e.y), ez.push_back(e.z);
+}
+
+void Frustum::update(const glm::mat4& m)
+{
+  // Gribb/Hartmann plane extraction. glm matrices are column major, so row i is (m[0][i], m[1][i], m[2][i], m[3][i])
+  auto row = [&m](int i) { return glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]); };
+  const glm::vec4 r0 = row(0), r1 = row(1), r2 = row(2), r3 = row(3);
+  m_planes[PLANE_LEFT] = r3 + r0;
+  m_planes[PLANE_RIGHT] = r3 - r0;
+  m_planes[PLANE_BOTTOM] = r3 + r1;
+  m_planes[PLANE_TOP] = r3 - r1;
+  m_planes[PLANE_NEAR] = r3 + r2;
+  m_planes[PLANE_FAR] = r3 - r2;
+  for (auto& p : m_planes)
+  {
+    p /= glm::length(glm::vec3(p));
+  }
+}
+
+bool Frustum::intersects(const BoundingBox& aabb) const
+{
+  const glm::vec3 c = aabb.center();
+  const glm::vec3 e = aabb.extents();
+  for (const auto& p : m_planes)
+  {
+    // projection radius of box onto plane normal
+    const float r = e.x * std::abs(p.x) + e.y * std::abs(p.y) + e.z * std::abs(p.z);
+    if (glm::dot(glm::vec3(p), c) + p.w + r < 0.f)
+      return false;
+  }
+  return true;
+}
+
+bool Frustum::intersects(const glm::vec3& center, float radius) const
+{
+  for (const auto& p : m_planes)
+  {
+    if (glm::dot(glm::vec3(p), center) + p.w + radius < 0.f)
+      return false;
+  }
+  return true;
+}
+
+size_t Frustum::cull(const BoundsSoA& b, std::vector<uint8_t>& visible) const
+{
+  const size_t n = b.size();
+  visible.resize(n);
+  size_t nvisible = 0;
+  size_t i = 0;
+#if OPENGL_ENGINE_SSE
+  const __m128 sign_mask = _mm_set1_ps(-0.f);
+  __m128 px[PLANE_COUNT], py[PLANE_COUNT], pz[PLANE_COUNT], pw[PLANE_COUNT];
+  __m128 ax[PLANE_COUNT], ay[PLANE_COUNT], az[PLANE_COUNT];
+  for (int p = 0; p < PLANE_COUNT; p++)
+  {
+    px[p] = _mm_set1_ps(m_planes[p].x);
+    py[p] = _mm_set1_ps(m_planes[p].y);
+    pz[p] = _mm_set1_ps(m_planes[p].z);
+    pw[p] = _mm_set1_ps(m_planes[p].w);
+    ax[p] = _mm_andnot_ps(sign_mask, px[p]);
+    ay[p] = _mm_andnot_ps(sign_mask, py[p]);
+    az[p] = _mm_andnot_ps(sign_mask, pz[p]);
+  }
+  for (; i + 4 <= n; i += 4)
+  {
+    const __m128 cx = _mm_loadu_ps(&b.cx[i]), cy = _mm_loadu_ps(&b.cy[i]), cz = _mm_loadu_ps(&b.cz[i]);
+    const __m128 ex = _mm_loadu_ps(&b.ex[i]), ey = _mm_loadu_ps(&b.ey[i]), ez = _mm_loadu_ps(&b.ez[i]);
+    __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+    for (int p = 0; p < PLANE_COUNT; p++)
+    {
+      __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px[p], cx), _mm_mul_ps(py[p], cy)), _mm_add_ps(_mm_mul_ps(pz[p], cz), pw[p]));
+      __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax[p], ex), _mm_mul_ps(ay[p], ey)), _mm_mul_ps(az[p], ez));
+      inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(d, r), _mm_setzero_ps()));
+    }
+    const int mask = _mm_movemask_ps(inside);
+    for (size_t k = 0; k < 4; k++)
+    {
+      visible[i + k] = (mask >> k) & 1;
+      nvisible += visible[i + k];
+    }
+  }
+#endif
+  // remainder (or everything when SSE is not available)
+  for (; i < n; i++)
+  {
+    const glm::vec3 c(b.cx[i], b.cy[i], b.cz[i]);
+    const glm::vec3 e(b.ex[i], b.ey[i], b.ez[i]);
+    visible[i] = intersects(BoundingBox(c - e, c + e));
+    nvisible += visible[i];
+  }
+  return nvisible;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "./ge/BoundingBox.hpp"
+
+// structure of arrays of axis aligned boxes (center + half extents), so frustum tests can be done 4 boxes at a time
+struct BoundsSoA
+{
+  void clear();
+  void reserve(size_t n);
+  void push_back(const BoundingBox& bbox);
+  size_t size() const { return cx.size(); }
+  std::vector<float> cx, cy, cz;
+  std::vector<float> ex, ey, ez;
+};
+
+class Frustum
+{
+public:
+  enum Plane
+  {
+    PLANE_LEFT,
+    PLANE_RIGHT,
+    PLANE_BOTTOM,
+    PLANE_TOP,
+    PLANE_NEAR,
+    PLANE_FAR,
+    PLANE_COUNT
+  };
+public:
+  Frustum() = default;
+  explicit Frustum(const glm::mat4& view_projection) { update(view_projection); }
+  void update(const glm::mat4& view_projection);
+  bool intersects(const BoundingBox& aabb) const;
+  bool intersects(const glm::vec3& center, float radius) const;
+  // writes 1 to visible[i] for every box that intersects frustum and 0 otherwise. returns count of visible boxes
+  size_t cull(const BoundsSoA& bounds, std::vector<uint8_t>& visible) const;
+  const glm::vec4& plane(Plane p) const { return m_planes[p]; }
+private:
+  // xyz - normal pointing inside of frustum, w - distance
+  std::array<glm::vec4, PLANE_COUNT> m_planes;
+};
@@ -53,6 +53,10 @@ void Icosahedron::project_points_on_sphere() {
   for (Vertex& v : mesh.vertices()) {
     v.position = glm::normalize(v.position);
   }
+  mesh.invalidate_bvh();
+  m_bbox = BoundingBox();
+  set_flag(BOUNDS_CHANGED);
+  set_flag(GEOMETRY_CHANGED);
 }
 
 void Icosahedron::subdivide_triangles(int subdivision_level, const Vertex& a, const Vertex& b, const Vertex& c) {
@@ -92,6 +96,8 @@ void Icosahedron::allocate_memory_before_subdivision(int subdivision_depth, int
   auto& mesh = m_meshes[0];
   mesh.vertices().clear();
   mesh.faces().clear();
+  mesh.invalidate_bvh();
+  set_flag(GEOMETRY_CHANGED);
   size_t new_face_count = face_count * (size_t)std::pow(4, subdivision_depth);
   size_t new_vert_count = new_face_count* 3;
   mesh.vertices().reserve(new_vert_count);
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+// light emitted by object marked as light source. position is center of object
+struct Light
+{
+  enum Type
+  {
+    POINT,
+    SPOT
+  };
+  Type type = POINT;
+  glm::vec3 color = glm::vec3(1.f);
+  float intensity = 1.f;
+  float range = 10.f;                                // no light reaches farther than this
+  glm::vec3 direction = glm::vec3(0.f, -1.f, 0.f);   // of spot light, in object space
+  float inner_angle = 20.f;                          // degrees from direction, full intensity inside
+  float outer_angle = 30.f;                          // no light outside
+};
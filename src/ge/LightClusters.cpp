@@ -0,0 +1,179 @@
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+#include <future>
+#include <thread>
+#include "LightClusters.hpp"
+#include "./utils/Simd.hpp"
+
+void LightClusters::set_projection(const glm::mat4& projection)
+{
+  if (projection == m_projection)
+    return;
+  m_projection = projection;
+  // planes and field of view of glm::perspective
+  m_znear = projection[3][2] / (projection[2][2] - 1.f);
+  m_zfar = projection[3][2] / (projection[2][2] + 1.f);
+  const float tan_x = 1.f / projection[0][0];
+  const float tan_y = 1.f / projection[1][1];
+  const float log_ratio = std::log(m_zfar / m_znear);
+  m_slice_scale = grid_z / log_ratio;
+  m_slice_bias = -grid_z * std::log(m_znear) / log_ratio;
+
+  m_slice_near.resize(grid_z);
+  m_slice_far.resize(grid_z);
+  m_tile_min_x.resize(grid_z * tiles_per_slice);
+  m_tile_max_x.resize(grid_z * tiles_per_slice);
+  m_tile_min_y.resize(grid_z * tiles_per_slice);
+  m_tile_max_y.resize(grid_z * tiles_per_slice);
+  for (int z = 0; z < grid_z; z++)
+  {
+    const float dn = m_znear * std::pow(m_zfar / m_znear, (float)z / grid_z);
+    const float df = m_znear * std::pow(m_zfar / m_znear, (float)(z + 1) / grid_z);
+    m_slice_near[z] = dn;
+    m_slice_far[z] = df;
+    for (int y = 0; y < grid_y; y++)
+    {
+      const float y0 = -1.f + 2.f * y / grid_y, y1 = -1.f + 2.f * (y + 1) / grid_y;
+      for (int x = 0; x < grid_x; x++)
+      {
+        const float x0 = -1.f + 2.f * x / grid_x, x1 = -1.f + 2.f * (x + 1) / grid_x;
+        // side planes of tile are linear in depth, so extremes are at near or far side of slice
+        const int i = z * tiles_per_slice + x + grid_x * y;
+        m_tile_min_x[i] = tan_x * std::min(x0 * dn, x0 * df);
+        m_tile_max_x[i] = tan_x * std::max(x1 * dn, x1 * df);
+        m_tile_min_y[i] = tan_y * std::min(y0 * dn, y0 * df);
+        m_tile_max_y[i] = tan_y * std::max(y1 * dn, y1 * df);
+      }
+    }
+  }
+}
+
+int LightClusters::slice(float depth) const
+{
+  if (depth <= m_znear)
+    return 0;
+  const int z = (int)std::floor(std::log(depth) * m_slice_scale + m_slice_bias);
+  return std::clamp(z, 0, grid_z - 1);
+}
+
+void LightClusters::cluster_bounds(int x, int y, int z, glm::vec3& bmin, glm::vec3& bmax) const
+{
+  const int i = z * tiles_per_slice + x + grid_x * y;
+  bmin = glm::vec3(m_tile_min_x[i], m_tile_min_y[i], -m_slice_far[z]);
+  bmax = glm::vec3(m_tile_max_x[i], m_tile_max_y[i], -m_slice_near[z]);
+}
+
+void LightClusters::build(const std::vector<glm::vec4>& view_spheres, int nthreads)
+{
+  assert(m_slice_near.size() == grid_z && "set_projection must be called first");
+  const int nlights = (int)view_spheres.size();
+  m_counts.assign(cluster_count, 0);
+  m_cluster_lights.resize((size_t)cluster_count * max_lights_per_cluster);
+  m_light_first_slice.resize(nlights);
+  m_light_last_slice.resize(nlights);
+  size_t work = 0;
+  for (int i = 0; i < nlights; i++)
+  {
+    const float depth = -view_spheres[i].z;
+    const float radius = view_spheres[i].w;
+    if (depth + radius < m_znear || depth - radius > m_zfar)
+    {
+      m_light_first_slice[i] = 1;
+      m_light_last_slice[i] = 0;
+      continue;
+    }
+    m_light_first_slice[i] = slice(std::max(depth - radius, m_znear));
+    m_light_last_slice[i] = slice(std::min(depth + radius, m_zfar));
+    work += m_light_last_slice[i] - m_light_first_slice[i] + 1;
+  }
+
+  if (nthreads <= 0)
+  {
+    // testing slice against a light is ~40 SIMD iterations, threads pay off only for many lights
+    constexpr size_t work_per_thread = 256;
+    const int hw = std::max(1, (int)std::thread::hardware_concurrency());
+    nthreads = (int)std::min<size_t>(std::min(hw, 8), work / work_per_thread + 1);
+  }
+  nthreads = std::clamp(nthreads, 1, grid_z);
+  std::vector<std::future<void>> futures;
+  for (int t = 1; t < nthreads; t++)
+  {
+    const int first = grid_z * t / nthreads, last = grid_z * (t + 1) / nthreads;
+    futures.push_back(std::async(std::launch::async, [this, &view_spheres, first, last]() { build_slices(view_spheres, first, last); }));
+  }
+  build_slices(view_spheres, 0, grid_z / nthreads);
+  for (auto& f : futures)
+    f.get();
+
+  // compact fixed size lists into single array
+  m_clusters.resize(cluster_count);
+  uint32_t offset = 0;
+  for (int c = 0; c < cluster_count; c++)
+  {
+    m_clusters[c].offset = offset;
+    m_clusters[c].count = m_counts[c];
+    offset += m_counts[c];
+  }
+  // room for every light in every cluster, so moving camera doesn't grow the list frame by frame
+  m_light_indices.reserve((size_t)cluster_count * std::min(nlights, max_lights_per_cluster));
+  m_light_indices.resize(offset);
+  for (int c = 0; c < cluster_count; c++)
+  {
+    std::copy_n(m_cluster_lights.begin() + (size_t)c * max_lights_per_cluster, m_counts[c], m_light_indices.begin() + m_clusters[c].offset);
+  }
+}
+
+void LightClusters::build_slices(const std::vector<glm::vec4>& view_spheres, int first_slice, int last_slice)
+{
+  for (int z = first_slice; z < last_slice; z++)
+  {
+    const float zmin = -m_slice_far[z], zmax = -m_slice_near[z];
+    const float* tile_min_x = &m_tile_min_x[z * tiles_per_slice];
+    const float* tile_max_x = &m_tile_max_x[z * tiles_per_slice];
+    const float* tile_min_y = &m_tile_min_y[z * tiles_per_slice];
+    const float* tile_max_y = &m_tile_max_y[z * tiles_per_slice];
+    uint32_t* counts = &m_counts[(size_t)z * tiles_per_slice];
+    uint32_t* lights = &m_cluster_lights[(size_t)z * tiles_per_slice * max_lights_per_cluster];
+    auto append = [counts, lights](int tile, uint32_t light)
+      {
+        if (counts[tile] < max_lights_per_cluster)
+          lights[(size_t)tile * max_lights_per_cluster + counts[tile]++] = light;
+      };
+    for (int i = 0; i < (int)view_spheres.size(); i++)
+    {
+      if (z < m_light_first_slice[i] || z > m_light_last_slice[i])
+        continue;
+      const glm::vec4& s = view_spheres[i];
+      // squared distance from sphere center to slab of slice, the rest of radius is left for x and y
+      const float dz = std::max(std::max(zmin - s.z, s.z - zmax), 0.f);
+      const float r2 = s.w * s.w - dz * dz;
+      if (r2 < 0.f)
+        continue;
+      int t = 0;
+#if OPENGL_ENGINE_SSE
+      const __m128 cx = _mm_set1_ps(s.x), cy = _mm_set1_ps(s.y), vr2 = _mm_set1_ps(r2), zero = _mm_setzero_ps();
+      for (; t + 4 <= tiles_per_slice; t += 4)
+      {
+        const __m128 dx = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(tile_min_x + t), cx), _mm_sub_ps(cx, _mm_loadu_ps(tile_max_x + t))), zero);
+        const __m128 dy = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(tile_min_y + t), cy), _mm_sub_ps(cy, _mm_loadu_ps(tile_max_y + t))), zero);
+        int mask = _mm_movemask_ps(_mm_cmple_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), vr2));
+        while (mask)
+        {
+          const int k = mask & 1 ? 0 : mask & 2 ? 1 : mask & 4 ? 2 : 3;
+          append(t + k, (uint32_t)i);
+          mask &= mask - 1;
+        }
+      }
+#endif
+      // remainder (or everything when SSE is not available)
+      for (; t < tiles_per_slice; t++)
+      {
+        const float dx = std::max(std::max(tile_min_x[t] - s.x, s.x - tile_max_x[t]), 0.f);
+        const float dy = std::max(std::max(tile_min_y[t] - s.y, s.y - tile_max_y[t]), 0.f);
+        if (dx * dx + dy * dy <= r2)
+          append(t, (uint32_t)i);
+      }
+    }
+  }
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+// Assigns lights to clusters of view frustum (froxels) for clustered forward shading.
+// Frustum is split into tiles on screen and into slices along depth, slices grow exponentially with
+// distance, so near and far clusters have similar proportions. Lights are bounded by spheres.
+// Every slice is tested independently, so slices are distributed between threads.
+class LightClusters
+{
+public:
+  static constexpr int grid_x = 16;
+  static constexpr int grid_y = 9;
+  static constexpr int grid_z = 24;
+  static constexpr int cluster_count = grid_x * grid_y * grid_z;
+  // lights beyond this count are dropped from cluster, keeps per fragment cost bounded
+  static constexpr int max_lights_per_cluster = 128;
+  struct Cluster
+  {
+    uint32_t offset;  // first light in light_indices
+    uint32_t count;
+  };
+public:
+  // perspective projection matrix, cluster bounds are recomputed only if it changed
+  void set_projection(const glm::mat4& projection);
+  // spheres in view space (xyz - center, w - radius), camera looks along -z.
+  // nthreads == 0 selects number of threads by amount of work
+  void build(const std::vector<glm::vec4>& view_spheres, int nthreads = 0);
+  const std::vector<Cluster>& clusters() const { return m_clusters; }
+  const std::vector<uint32_t>& light_indices() const { return m_light_indices; }
+  static int cluster_index(int x, int y, int z) { return x + grid_x * (y + grid_y * z); }
+  // slice of positive view space depth. log(depth) * slice_scale() + slice_bias() gives the same in shader
+  int slice(float depth) const;
+  float slice_scale() const { return m_slice_scale; }
+  float slice_bias() const { return m_slice_bias; }
+  float znear() const { return m_znear; }
+  float zfar() const { return m_zfar; }
+  // bounds of cluster in view space
+  void cluster_bounds(int x, int y, int z, glm::vec3& bmin, glm::vec3& bmax) const;
+private:
+  void build_slices(const std::vector<glm::vec4>& view_spheres, int first_slice, int last_slice);
+private:
+  glm::mat4 m_projection = glm::mat4(0.f);
+  float m_znear = 0.1f;
+  float m_zfar = 100.f;
+  float m_slice_scale = 0.f;
+  float m_slice_bias = 0.f;
+  // tile bounds per slice, structure of arrays so 4 tiles are tested at once. z bounds are shared by slice
+  static constexpr int tiles_per_slice = grid_x * grid_y;
+  std::vector<float> m_tile_min_x, m_tile_max_x, m_tile_min_y, m_tile_max_y;  // grid_z * tiles_per_slice
+  std::vector<float> m_slice_near, m_slice_far;                               // positive depth
+  // light range in slices, computed before slices are distributed between threads
+  std::vector<int> m_light_first_slice, m_light_last_slice;
+  std::vector<uint32_t> m_counts;         // per cluster
+  std::vector<uint32_t> m_cluster_lights; // max_lights_per_cluster per cluster
+  std::vector<Cluster> m_clusters;
+  std::vector<uint32_t> m_light_indices;
+};
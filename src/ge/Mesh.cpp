@@ -1,4 +1,5 @@
 #include "Mesh.hpp"
+#include <cstring>
 
 Mesh::Mesh(const std::vector<Vertex>& vertices, const std::vector<Face>& faces) {
   m_vertices = vertices;
@@ -7,30 +8,47 @@ Mesh::Mesh(const std::vector<Vertex>& vertices, const std::vector<Face>& faces)
 
 size_t Mesh::append_vertex(const Vertex& vertex) {
   m_vertices.push_back(vertex);
+  m_bvh.reset();
   return m_vertices.size() - 1;
 }
 
 size_t Mesh::append_face(const Face& face) {
   m_faces.push_back(face);
+  m_bvh.reset();
   return m_faces.size() - 1;
 }
 
 size_t Mesh::append_face(Face&& face) {
   m_faces.push_back(std::move(face));
+  m_bvh.reset();
   return m_faces.size() - 1;
 }
 
+const MeshBVH& Mesh::bvh() const {
+  if (!m_bvh) {
+    m_bvh = std::make_shared<const MeshBVH>(m_vertices, m_faces);
+  }
+  return *m_bvh;
+}
+
 std::vector<GLuint> Mesh::faces_as_indices() const {
-  std::vector<GLuint> buffer;
+  std::vector<GLuint> buffer(index_count());
+  write_indices(buffer.data());
+  return buffer;
+}
+
+size_t Mesh::index_count() const {
   size_t n_indices = 0;
   for (size_t i = 0; i < m_faces.size(); ++i) {
     n_indices += m_faces[i].size;
   }
-  buffer.resize(n_indices);
-  n_indices = 0;
+  return n_indices;
+}
+
+void Mesh::write_indices(GLuint* dst) const {
+  size_t n_indices = 0;
   for (size_t i = 0; i < m_faces.size(); ++i) {
-    memcpy(buffer.data() + n_indices, m_faces[i].data, sizeof(GLuint) * m_faces[i].size);
+    memcpy(dst + n_indices, m_faces[i].data, sizeof(GLuint) * m_faces[i].size);
     n_indices += m_faces[i].size;
   }
-  return buffer;
 }
@@ -7,6 +7,7 @@
 #include "ge/Vertex.hpp"
 #include "ge/Face.hpp"
 #include "ge/BoundingBox.hpp"
+#include "ge/MeshBVH.hpp"
 #include "core/Texture2D.hpp"
 
 class Mesh {
@@ -18,6 +19,9 @@ public:
   std::vector<Face>& faces() { return m_faces; }
   const std::vector<Face>& faces() const { return m_faces; }
   std::vector<GLuint> faces_as_indices() const;
+  size_t index_count() const;
+  // same as faces_as_indices, but into preallocated memory of index_count() elements, e.g. mapped buffer
+  void write_indices(GLuint* dst) const;
   std::shared_ptr<Texture2D>& texture() { return m_texture; }
   const std::shared_ptr<Texture2D>& texture() const { return m_texture; }
   BoundingBox& bbox() { return m_bbox; }
@@ -25,6 +29,10 @@ public:
   size_t append_vertex(const Vertex& vertex);
   size_t append_face(const Face& face);
   size_t append_face(Face&& face);
+  // triangle BVH, built on first access. must be invalidated after vertices or faces were changed directly
+  const MeshBVH& bvh() const;
+  void set_bvh(std::shared_ptr<const MeshBVH> bvh) { m_bvh = std::move(bvh); }
+  void invalidate_bvh() { m_bvh.reset(); }
   friend class Object3D;
 private:
   std::vector<Vertex> m_vertices;
@@ -32,4 +40,5 @@ private:
   std::shared_ptr<Texture2D> m_texture;
   std::vector<Vertex> m_cached_normals;     // normal lines
   BoundingBox m_bbox;
+  mutable std::shared_ptr<const MeshBVH> m_bvh;  // shared between copies, e.g. meshes cached for other shading modes
 };
@@ -0,0 +1,589 @@
+#include <cassert>
+#include <algorithm>
+#include <future>
+#include <thread>
+#include <istream>
+#include <ostream>
+#include "MeshBVH.hpp"
+#include "./utils/Simd.hpp"
+
+namespace
+{
+  constexpr int bins_count = 16;
+  // subtrees with more triangles are built on separate thread
+  constexpr uint32_t parallel_build_threshold = 32 * 1024;
+  // deeper than that nodes are split by object median, which bounds depth of tree and traversal stack
+  constexpr int median_split_depth = 48;
+  constexpr int stack_size = 96;
+  constexpr uint32_t serialization_magic = 0x4856424d;  // "MBVH"
+  constexpr uint32_t serialization_version = 1;
+
+  struct Bounds
+  {
+    void grow(const glm::vec3& p) { min = glm::min(min, p); max = glm::max(max, p); }
+    void grow(const Bounds& b) { min = glm::min(min, b.min); max = glm::max(max, b.max); }
+    float area() const
+    {
+      if (min.x > max.x)
+        return 0.f;
+      const glm::vec3 d = max - min;
+      return 2.f * (d.x * d.y + d.y * d.z + d.z * d.x);
+    }
+    glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+    glm::vec3 max = glm::vec3(-std::numeric_limits<float>::max());
+  };
+
+  // inverse direction without infinities, so 0 * inf NaNs can't appear in vectorized slab tests
+  glm::vec3 finite_inverse(const glm::vec3& dir)
+  {
+    auto inv = [](float d) { return std::abs(d) > 1e-20f ? 1.f / d : (d < 0.f ? -1e30f : 1e30f); };
+    return glm::vec3(inv(dir.x), inv(dir.y), inv(dir.z));
+  }
+
+  float box_distance2(const MeshBVH::Node& node, const glm::vec3& p)
+  {
+    const glm::vec3 d = glm::clamp(p, node.bmin, node.bmax) - p;
+    return glm::dot(d, d);
+  }
+
+  // Ericson, Real-Time Collision Detection 5.1.5
+  glm::vec3 closest_point_on_triangle(const glm::vec3& p, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c)
+  {
+    const glm::vec3 ab = b - a, ac = c - a, ap = p - a;
+    const float d1 = glm::dot(ab, ap), d2 = glm::dot(ac, ap);
+    if (d1 <= 0.f && d2 <= 0.f)
+      return a;
+    const glm::vec3 bp = p - b;
+    const float d3 = glm::dot(ab, bp), d4 = glm::dot(ac, bp);
+    if (d3 >= 0.f && d4 <= d3)
+      return b;
+    const float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.f && d1 >= 0.f && d3 <= 0.f)
+      return a + ab * (d1 / (d1 - d3));
+    const glm::vec3 cp = p - c;
+    const float d5 = glm::dot(ab, cp), d6 = glm::dot(ac, cp);
+    if (d6 >= 0.f && d5 <= d6)
+      return c;
+    const float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.f && d2 >= 0.f && d6 <= 0.f)
+      return a + ac * (d2 / (d2 - d6));
+    const float va = d3 * d6 - d5 * d4;
+    if (va <= 0.f && (d4 - d3) >= 0.f && (d5 - d6) >= 0.f)
+      return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+    const float denom = 1.f / (va + vb + vc);
+    return a + ab * (vb * denom) + ac * (vc * denom);
+  }
+
+#if OPENGL_ENGINE_SSE
+  struct Float4
+  {
+    static constexpr int width = 4;
+    Float4() = default;
+    Float4(__m128 v) : v(v) {}
+    explicit Float4(float s) : v(_mm_set1_ps(s)) {}
+    static Float4 load(const float* p) { return _mm_loadu_ps(p); }
+    void store(float* p) const { _mm_storeu_ps(p, v); }
+    friend Float4 operator+(Float4 a, Float4 b) { return _mm_add_ps(a.v, b.v); }
+    friend Float4 operator-(Float4 a, Float4 b) { return _mm_sub_ps(a.v, b.v); }
+    friend Float4 operator*(Float4 a, Float4 b) { return _mm_mul_ps(a.v, b.v); }
+    friend Float4 operator&(Float4 a, Float4 b) { return _mm_and_ps(a.v, b.v); }
+    friend Float4 operator<(Float4 a, Float4 b) { return _mm_cmplt_ps(a.v, b.v); }
+    friend Float4 operator<=(Float4 a, Float4 b) { return _mm_cmple_ps(a.v, b.v); }
+    friend Float4 operator>=(Float4 a, Float4 b) { return _mm_cmpge_ps(a.v, b.v); }
+    friend Float4 min(Float4 a, Float4 b) { return _mm_min_ps(a.v, b.v); }
+    friend Float4 max(Float4 a, Float4 b) { return _mm_max_ps(a.v, b.v); }
+    friend Float4 rcp(Float4 a) { return _mm_div_ps(_mm_set1_ps(1.f), a.v); }
+    friend Float4 abs(Float4 a) { return _mm_andnot_ps(_mm_set1_ps(-0.f), a.v); }
+    friend Float4 select(Float4 mask, Float4 a, Float4 b) { return _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v)); }
+    friend int movemask(Float4 a) { return _mm_movemask_ps(a.v); }
+    __m128 v;
+  };
+#endif
+
+#if OPENGL_ENGINE_AVX
+  struct Float8
+  {
+    static constexpr int width = 8;
+    Float8() = default;
+    Float8(__m256 v) : v(v) {}
+    explicit Float8(float s) : v(_mm256_set1_ps(s)) {}
+    static Float8 load(const float* p) { return _mm256_loadu_ps(p); }
+    void store(float* p) const { _mm256_storeu_ps(p, v); }
+    friend Float8 operator+(Float8 a, Float8 b) { return _mm256_add_ps(a.v, b.v); }
+    friend Float8 operator-(Float8 a, Float8 b) { return _mm256_sub_ps(a.v, b.v); }
+    friend Float8 operator*(Float8 a, Float8 b) { return _mm256_mul_ps(a.v, b.v); }
+    friend Float8 operator&(Float8 a, Float8 b) { return _mm256_and_ps(a.v, b.v); }
+    friend Float8 operator<(Float8 a, Float8 b) { return _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ); }
+    friend Float8 operator<=(Float8 a, Float8 b) { return _mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ); }
+    friend Float8 operator>=(Float8 a, Float8 b) { return _mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ); }
+    friend Float8 min(Float8 a, Float8 b) { return _mm256_min_ps(a.v, b.v); }
+    friend Float8 max(Float8 a, Float8 b) { return _mm256_max_ps(a.v, b.v); }
+    friend Float8 rcp(Float8 a) { return _mm256_div_ps(_mm256_set1_ps(1.f), a.v); }
+    friend Float8 abs(Float8 a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.f), a.v); }
+    friend Float8 select(Float8 mask, Float8 a, Float8 b) { return _mm256_blendv_ps(b.v, a.v, mask.v); }
+    friend int movemask(Float8 a) { return _mm256_movemask_ps(a.v); }
+    __m256 v;
+  };
+#endif
+}
+
+struct MeshBVH::BuildData
+{
+  std::vector<Bounds> bounds;        // per triangle
+  std::vector<glm::vec3> centroids;  // per triangle
+  std::vector<uint32_t> indices;     // partitioned in place during build
+};
+
+MeshBVH::MeshBVH(const std::vector<Vertex>& vertices, const std::vector<Face>& faces)
+{
+  if (faces.empty())
+    return;
+  BuildData data;
+  data.bounds.resize(faces.size());
+  data.centroids.resize(faces.size());
+  data.indices.resize(faces.size());
+  for (size_t i = 0; i < faces.size(); i++)
+  {
+    assert(faces[i].size == 3);
+    for (int k = 0; k < 3; k++)
+      data.bounds[i].grow(vertices[faces[i].data[k]].position);
+    data.centroids[i] = (data.bounds[i].min + data.bounds[i].max) * 0.5f;
+    data.indices[i] = (uint32_t)i;
+  }
+  m_nodes.reserve(faces.size() * 2);
+  build_recursive(data, 0, (uint32_t)faces.size(), m_nodes, 0);
+
+  // copy triangles in leaf order
+  m_triangles = std::move(data.indices);
+  m_positions.resize(m_triangles.size() * 3);
+  for (size_t i = 0; i < m_triangles.size(); i++)
+  {
+    const Face& face = faces[m_triangles[i]];
+    for (int k = 0; k < 3; k++)
+      m_positions[i * 3 + k] = vertices[face.data[k]].position;
+  }
+}
+
+void MeshBVH::build_recursive(BuildData& data, uint32_t begin, uint32_t end, std::vector<Node>& out, int depth)
+{
+  const uint32_t node_index = (uint32_t)out.size();
+  out.emplace_back();
+  Bounds bounds, centroid_bounds;
+  for (uint32_t i = begin; i < end; i++)
+  {
+    bounds.grow(data.bounds[data.indices[i]]);
+    centroid_bounds.grow(data.centroids[data.indices[i]]);
+  }
+  out[node_index].bmin = bounds.min;
+  out[node_index].bmax = bounds.max;
+  const uint32_t count = end - begin;
+  auto make_leaf = [&]()
+    {
+      out[node_index].offset = begin;
+      out[node_index].count = (uint16_t)count;
+      out[node_index].axis = 0;
+    };
+  if (count <= 1)
+  {
+    make_leaf();
+    return;
+  }
+
+  // pick split with the lowest SAH cost among bin boundaries of all axes
+  int best_axis = -1, best_split = 0;
+  float best_cost = std::numeric_limits<float>::max();
+  const glm::vec3 extent = centroid_bounds.max - centroid_bounds.min;
+  if (depth < median_split_depth)
+  {
+    for (int axis = 0; axis < 3; axis++)
+    {
+      if (extent[axis] <= 0.f)
+        continue;
+      Bounds bins[bins_count];
+      uint32_t counts[bins_count] = {};
+      const float scale = bins_count / extent[axis];
+      for (uint32_t i = begin; i < end; i++)
+      {
+        const uint32_t tri = data.indices[i];
+        const int bin = std::min(bins_count - 1, (int)((data.centroids[tri][axis] - centroid_bounds.min[axis]) * scale));
+        bins[bin].grow(data.bounds[tri]);
+        counts[bin]++;
+      }
+      // sweep from the right to get cost of right sides, then from the left
+      float right_area[bins_count - 1];
+      uint32_t right_count[bins_count - 1];
+      Bounds acc;
+      uint32_t n = 0;
+      for (int b = bins_count - 1; b > 0; b--)
+      {
+        acc.grow(bins[b]);
+        n += counts[b];
+        right_area[b - 1] = acc.area();
+        right_count[b - 1] = n;
+      }
+      acc = Bounds();
+      n = 0;
+      for (int b = 0; b < bins_count - 1; b++)
+      {
+        acc.grow(bins[b]);
+        n += counts[b];
+        if (n == 0 || right_count[b] == 0)
+          continue;
+        const float cost = acc.area() * n + right_area[b] * right_count[b];
+        if (cost < best_cost)
+        {
+          best_cost = cost;
+          best_axis = axis;
+          best_split = b;
+        }
+      }
+    }
+  }
+
+  uint32_t mid;
+  int axis;
+  if (best_axis >= 0)
+  {
+    // splitting is worth it only if it's cheaper than intersecting all triangles of node
+    const float leaf_cost = bounds.area() * count;
+    if (count <= max_leaf_size && best_cost >= leaf_cost)
+    {
+      make_leaf();
+      return;
+    }
+    const float scale = bins_count / extent[best_axis];
+    const float split_min = centroid_bounds.min[best_axis];
+    auto it = std::partition(data.indices.begin() + begin, data.indices.begin() + end, [&](uint32_t tri)
+      {
+        return std::min(bins_count - 1, (int)((data.centroids[tri][best_axis] - split_min) * scale)) <= best_split;
+      });
+    mid = (uint32_t)(it - data.indices.begin());
+    axis = best_axis;
+  }
+  else
+  {
+    if (count <= max_leaf_size)
+    {
+      make_leaf();
+      return;
+    }
+    // all centroids coincide or tree became too deep, split by object median along the largest extent
+    axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+    mid = begin + count / 2;
+    std::nth_element(data.indices.begin() + begin, data.indices.begin() + mid, data.indices.begin() + end,
+      [&data, axis](uint32_t a, uint32_t b) { return data.centroids[a][axis] < data.centroids[b][axis]; });
+  }
+  assert(mid > begin && mid < end);
+  out[node_index].count = 0;
+  out[node_index].axis = (uint16_t)axis;
+
+  if (count >= parallel_build_threshold && depth < 8)
+  {
+    // right subtree is built into separate array, then appended after the left one
+    std::vector<Node> right;
+    auto future = std::async(std::launch::async, [this, &data, mid, end, &right, depth]()
+      {
+        build_recursive(data, mid, end, right, depth + 1);
+      });
+    build_recursive(data, begin, mid, out, depth + 1);
+    future.get();
+    const uint32_t right_index = (uint32_t)out.size();
+    for (Node node : right)
+    {
+      if (!node.is_leaf())
+        node.offset += right_index;
+      out.push_back(node);
+    }
+    out[node_index].offset = right_index;
+  }
+  else
+  {
+    build_recursive(data, begin, mid, out, depth + 1);
+    out[node_index].offset = (uint32_t)out.size();
+    build_recursive(data, mid, end, out, depth + 1);
+  }
+}
+
+BoundingBox MeshBVH::bounds() const
+{
+  return empty() ? BoundingBox() : BoundingBox(m_nodes[0].bmin, m_nodes[0].bmax);
+}
+
+bool MeshBVH::raycast(const Ray& ray, float max_t, Hit& hit) const
+{
+  if (empty())
+    return false;
+  const glm::vec3 inv_dir = safe_inverse(ray.direction);
+  bool result = false;
+  uint32_t stack[stack_size];
+  int sp = 0;
+  stack[sp++] = 0;
+  while (sp > 0)
+  {
+    const Node& node = m_nodes[stack[--sp]];
+    float tmin;
+    if (!intersect_aabb(ray, inv_dir, node.bmin, node.bmax, max_t, tmin))
+      continue;
+    if (node.is_leaf())
+    {
+      for (uint32_t i = node.offset; i < node.offset + node.count; i++)
+      {
+        float t, u, v;
+        if (intersect_triangle(ray, m_positions[i * 3], m_positions[i * 3 + 1], m_positions[i * 3 + 2], max_t, t, u, v))
+        {
+          max_t = t;
+          hit.triangle = (int)m_triangles[i];
+          hit.t = t;
+          hit.barycentric = glm::vec2(u, v);
+          result = true;
+        }
+      }
+    }
+    else
+    {
+      // visit child on the side where ray comes from first
+      const uint32_t left = (uint32_t)(&node - m_nodes.data()) + 1;
+      if (ray.direction[node.axis] < 0.f)
+      {
+        stack[sp++] = left;
+        stack[sp++] = node.offset;
+      }
+      else
+      {
+        stack[sp++] = node.offset;
+        stack[sp++] = left;
+      }
+    }
+  }
+  return result;
+}
+
+template<typename Packet>
+void MeshBVH::raycast_packet(const Ray* rays, const float* max_t, Hit* hits) const
+{
+  constexpr int W = Packet::width;
+  float buf[6][W];
+  for (int k = 0; k < W; k++)
+  {
+    const glm::vec3 inv_dir = finite_inverse(rays[k].direction);
+    for (int c = 0; c < 3; c++)
+    {
+      buf[c][k] = rays[k].origin[c];
+      buf[3 + c][k] = inv_dir[c];
+    }
+    hits[k] = Hit();
+  }
+  const Packet ox = Packet::load(buf[0]), oy = Packet::load(buf[1]), oz = Packet::load(buf[2]);
+  const Packet ix = Packet::load(buf[3]), iy = Packet::load(buf[4]), iz = Packet::load(buf[5]);
+  for (int k = 0; k < W; k++)
+  {
+    for (int c = 0; c < 3; c++)
+      buf[c][k] = rays[k].direction[c];
+  }
+  const Packet dx = Packet::load(buf[0]), dy = Packet::load(buf[1]), dz = Packet::load(buf[2]);
+  Packet best_t = Packet::load(max_t);
+  // triangle index is kept as float, exact for up to 2^24 triangles
+  Packet best_tri(-1.f), best_u(0.f), best_v(0.f);
+  const Packet zero(0.f), one(1.f), eps(1e-12f);
+  // direction of the first ray decides traversal order, rays of packet are expected to be coherent
+  const glm::vec3 order_dir = rays[0].direction;
+
+  uint32_t stack[stack_size];
+  int sp = 0;
+  stack[sp++] = 0;
+  while (sp > 0)
+  {
+    const uint32_t index = stack[--sp];
+    const Node& node = m_nodes[index];
+    const Packet tx0 = (Packet(node.bmin.x) - ox) * ix, tx1 = (Packet(node.bmax.x) - ox) * ix;
+    const Packet ty0 = (Packet(node.bmin.y) - oy) * iy, ty1 = (Packet(node.bmax.y) - oy) * iy;
+    const Packet tz0 = (Packet(node.bmin.z) - oz) * iz, tz1 = (Packet(node.bmax.z) - oz) * iz;
+    const Packet tnear = max(max(max(min(tx0, tx1), min(ty0, ty1)), min(tz0, tz1)), zero);
+    const Packet tfar = min(min(min(max(tx0, tx1), max(ty0, ty1)), max(tz0, tz1)), best_t);
+    if (movemask(tnear <= tfar) == 0)
+      continue;
+    if (node.is_leaf())
+    {
+      for (uint32_t i = node.offset; i < node.offset + node.count; i++)
+      {
+        const glm::vec3& a = m_positions[i * 3];
+        const glm::vec3 e1 = m_positions[i * 3 + 1] - a;
+        const glm::vec3 e2 = m_positions[i * 3 + 2] - a;
+        const Packet e1x(e1.x), e1y(e1.y), e1z(e1.z);
+        const Packet e2x(e2.x), e2y(e2.y), e2z(e2.z);
+        // p = cross(d, e2)
+        const Packet px = dy * e2z - dz * e2y, py = dz * e2x - dx * e2z, pz = dx * e2y - dy * e2x;
+        const Packet det = e1x * px + e1y * py + e1z * pz;
+        const Packet inv_det = rcp(det);
+        const Packet sx = ox - Packet(a.x), sy = oy - Packet(a.y), sz = oz - Packet(a.z);
+        const Packet u = (sx * px + sy * py + sz * pz) * inv_det;
+        // q = cross(s, e1)
+        const Packet qx = sy * e1z - sz * e1y, qy = sz * e1x - sx * e1z, qz = sx * e1y - sy * e1x;
+        const Packet v = (dx * qx + dy * qy + dz * qz) * inv_det;
+        const Packet t = (e2x * qx + e2y * qy + e2z * qz) * inv_det;
+        const Packet mask = (eps < abs(det)) & (u >= zero) & (v >= zero) & (u + v <= one) & (t >= zero) & (t < best_t);
+        if (movemask(mask) == 0)
+          continue;
+        best_t = select(mask, t, best_t);
+        best_u = select(mask, u, best_u);
+        best_v = select(mask, v, best_v);
+        best_tri = select(mask, Packet((float)m_triangles[i]), best_tri);
+      }
+    }
+    else
+    {
+      if (order_dir[node.axis] < 0.f)
+      {
+        stack[sp++] = index + 1;
+        stack[sp++] = node.offset;
+      }
+      else
+      {
+        stack[sp++] = node.offset;
+        stack[sp++] = index + 1;
+      }
+    }
+  }
+  float t_out[W], u_out[W], v_out[W], tri_out[W];
+  best_t.store(t_out);
+  best_u.store(u_out);
+  best_v.store(v_out);
+  best_tri.store(tri_out);
+  for (int k = 0; k < W; k++)
+  {
+    hits[k].triangle = (int)tri_out[k];
+    if (hits[k].triangle >= 0)
+    {
+      hits[k].t = t_out[k];
+      hits[k].barycentric = glm::vec2(u_out[k], v_out[k]);
+    }
+  }
+}
+
+void MeshBVH::raycast_scalar(const Ray* rays, const float* max_t, Hit* hits, int count) const
+{
+  for (int k = 0; k < count; k++)
+  {
+    hits[k] = Hit();
+    raycast(rays[k], max_t[k], hits[k]);
+  }
+}
+
+void MeshBVH::raycast4(const Ray* rays, const float* max_t, Hit* hits) const
+{
+  if (empty())
+  {
+    std::fill(hits, hits + 4, Hit());
+    return;
+  }
+#if OPENGL_ENGINE_SSE
+  raycast_packet<Float4>(rays, max_t, hits);
+#else
+  raycast_scalar(rays, max_t, hits, 4);
+#endif
+}
+
+void MeshBVH::raycast8(const Ray* rays, const float* max_t, Hit* hits) const
+{
+  if (empty())
+  {
+    std::fill(hits, hits + 8, Hit());
+    return;
+  }
+#if OPENGL_ENGINE_AVX
+  raycast_packet<Float8>(rays, max_t, hits);
+#else
+  raycast4(rays, max_t, hits);
+  raycast4(rays + 4, max_t + 4, hits + 4);
+#endif
+}
+
+bool MeshBVH::closest_point(const glm::vec3& point, float max_distance, ClosestPoint& result) const
+{
+  if (empty())
+    return false;
+  float best_d2 = max_distance * max_distance;
+  bool found = false;
+  uint32_t stack[stack_size];
+  int sp = 0;
+  stack[sp++] = 0;
+  while (sp > 0)
+  {
+    const uint32_t index = stack[--sp];
+    const Node& node = m_nodes[index];
+    if (box_distance2(node, point) > best_d2)
+      continue;
+    if (node.is_leaf())
+    {
+      for (uint32_t i = node.offset; i < node.offset + node.count; i++)
+      {
+        const glm::vec3 p = closest_point_on_triangle(point, m_positions[i * 3], m_positions[i * 3 + 1], m_positions[i * 3 + 2]);
+        const glm::vec3 d = p - point;
+        const float d2 = glm::dot(d, d);
+        if (d2 <= best_d2)
+        {
+          best_d2 = d2;
+          result.triangle = (int)m_triangles[i];
+          result.point = p;
+          found = true;
+        }
+      }
+    }
+    else
+    {
+      // closer child goes on top of stack
+      const uint32_t left = index + 1, right = node.offset;
+      const bool left_first = box_distance2(m_nodes[left], point) <= box_distance2(m_nodes[right], point);
+      stack[sp++] = left_first ? right : left;
+      stack[sp++] = left_first ? left : right;
+    }
+  }
+  if (found)
+    result.distance = std::sqrt(best_d2);
+  return found;
+}
+
+void MeshBVH::serialize(std::ostream& os) const
+{
+  const uint32_t header[4] = { serialization_magic, serialization_version, (uint32_t)m_nodes.size(), (uint32_t)m_triangles.size() };
+  os.write(reinterpret_cast<const char*>(header), sizeof(header));
+  os.write(reinterpret_cast<const char*>(m_nodes.data()), sizeof(Node) * m_nodes.size());
+  os.write(reinterpret_cast<const char*>(m_triangles.data()), sizeof(uint32_t) * m_triangles.size());
+  os.write(reinterpret_cast<const char*>(m_positions.data()), sizeof(glm::vec3) * m_positions.size());
+}
+
+bool MeshBVH::deserialize(std::istream& is)
+{
+  *this = MeshBVH();
+  uint32_t header[4] = {};
+  if (!is.read(reinterpret_cast<char*>(header), sizeof(header)) || header[0] != serialization_magic || header[1] != serialization_version)
+    return false;
+  std::vector<Node> nodes(header[2]);
+  std::vector<uint32_t> triangles(header[3]);
+  std::vector<glm::vec3> positions(triangles.size() * 3);
+  is.read(reinterpret_cast<char*>(nodes.data()), sizeof(Node) * nodes.size());
+  is.read(reinterpret_cast<char*>(triangles.data()), sizeof(uint32_t) * triangles.size());
+  is.read(reinterpret_cast<char*>(positions.data()), sizeof(glm::vec3) * positions.size());
+  if (!is)
+    return false;
+  // reject data which would make traversal read out of bounds or overflow its stack.
+  // children always follow parent, so depths are final by the time node is visited
+  std::vector<uint32_t> depths(nodes.size(), 0);
+  for (size_t i = 0; i < nodes.size(); i++)
+  {
+    const Node& node = nodes[i];
+    const bool valid = node.is_leaf() ? (size_t)node.offset + node.count <= triangles.size() : (node.offset > i + 1 && node.offset < nodes.size());
+    // stack holds one pending sibling per level above node, plus both children of it
+    if (!valid || depths[i] + 2 > stack_size)
+      return false;
+    if (!node.is_leaf())
+    {
+      depths[i + 1] = std::max(depths[i + 1], depths[i] + 1);
+      depths[node.offset] = std::max(depths[node.offset], depths[i] + 1);
+    }
+  }
+  m_nodes = std::move(nodes);
+  m_triangles = std::move(triangles);
+  m_positions = std::move(positions);
+  return true;
+}
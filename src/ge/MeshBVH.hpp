@@ -0,0 +1,70 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <iosfwd>
+#include <glm/glm.hpp>
+#include "./ge/Vertex.hpp"
+#include "./ge/Face.hpp"
+#include "./ge/BoundingBox.hpp"
+#include "./ge/Ray.hpp"
+
+// Static bounding volume hierarchy over triangles of a single mesh.
+// Built with binned SAH, nodes are stored in depth first order, so left child always follows its parent
+// and traversal mostly walks memory forward. Triangle positions are copied in leaf order next to the nodes,
+// so queries don't touch mesh vertices at all.
+class MeshBVH
+{
+public:
+  struct Node
+  {
+    bool is_leaf() const { return count != 0; }
+    glm::vec3 bmin;
+    uint32_t offset;  // leaf - first triangle, internal node - index of right child
+    glm::vec3 bmax;
+    uint16_t count;   // triangles in leaf, 0 for internal node
+    uint16_t axis;    // split axis of internal node
+  };
+  static_assert(sizeof(Node) == 32, "node must fit in half of a cache line");
+  struct Hit
+  {
+    int triangle = -1;                       // index of face in mesh, -1 if nothing was hit
+    float t = 0.f;
+    glm::vec2 barycentric = glm::vec2(0.f);  // weights of second and third vertex of face
+  };
+  struct ClosestPoint
+  {
+    int triangle = -1;
+    glm::vec3 point = glm::vec3(0.f);
+    float distance = 0.f;
+  };
+  static constexpr int max_leaf_size = 4;
+public:
+  MeshBVH() = default;
+  // faces must be triangles. large meshes are built on several threads
+  MeshBVH(const std::vector<Vertex>& vertices, const std::vector<Face>& faces);
+  bool empty() const { return m_nodes.empty(); }
+  BoundingBox bounds() const;
+  size_t triangle_count() const { return m_triangles.size(); }
+  const std::vector<Node>& nodes() const { return m_nodes; }
+  bool raycast(const Ray& ray, float max_t, Hit& hit) const;
+  // packets of coherent rays (e.g. neighbouring pixels) share single traversal.
+  // rays which miss get triangle = -1. 8-wide version needs AVX, otherwise it's split into two 4-wide packets
+  void raycast4(const Ray* rays, const float* max_t, Hit* hits) const;
+  void raycast8(const Ray* rays, const float* max_t, Hit* hits) const;
+  // closest point of mesh surface not farther than max_distance
+  bool closest_point(const glm::vec3& point, float max_distance, ClosestPoint& result) const;
+  void serialize(std::ostream& os) const;
+  // returns false if stream doesn't contain valid BVH, object stays empty then
+  bool deserialize(std::istream& is);
+private:
+  struct BuildData;
+  void build_recursive(BuildData& data, uint32_t begin, uint32_t end, std::vector<Node>& out, int depth);
+  template<typename Packet>
+  void raycast_packet(const Ray* rays, const float* max_t, Hit* hits) const;
+  void raycast_scalar(const Ray* rays, const float* max_t, Hit* hits, int count) const;
+private:
+  std::vector<Node> m_nodes;
+  std::vector<uint32_t> m_triangles;   // face index in mesh, in leaf order
+  std::vector<glm::vec3> m_positions;  // 3 vertices per triangle, in leaf order
+};
@@ -1,4 +1,6 @@
 #include "Object3D.hpp"
+#include "./core/Tracer.hpp"
+#include "./core/MemoryProfiler.hpp"
 
 Object3D::Object3D()
 {
@@ -7,21 +9,29 @@ Object3D::Object3D()
 
 void Object3D::render(GPUBuffers* gpu_buffers, const RenderConfig& cfg)
 {
+  TRACE_ZONE("Object3D::render");
   assert(gpu_buffers != nullptr);
   gpu_buffers->bind_all();
-  if (m_bbox.is_empty())
-  {
-    m_bbox = calculate_bbox();
-  }
+  bbox();
+  // picking pass needs to tell primitives of different meshes apart. neither it nor outline mask need helper lines
+  const bool picking = cfg.pass == RenderPass::PICKING;
+  const bool helper_lines = cfg.pass == RenderPass::SHADED;
+  Shader& picking_shader = GlobalState::ShaderStorage::get(GlobalState::ShaderStorage::PICKING);
+  uint32_t primitive_offset = 0;
 
-  for (const auto& mesh : m_meshes)
+  for (size_t mesh_index = 0; mesh_index < m_meshes.size(); mesh_index++)
   {
+    const Mesh& mesh = m_meshes[mesh_index];
+    if (picking)
+    {
+      picking_shader.set_uint("meshPrimitiveOffset", primitive_offset);
+      primitive_offset += primitive_count(mesh_index);
+    }
     auto& vao = gpu_buffers->vao;
-    auto& vbo = gpu_buffers->vbo;
     const std::vector<Vertex>& vertices = mesh.vertices();
     const auto& texture = mesh.texture();
     const GLuint tex_id = texture ? texture->id() : 0;
-    vbo->set_data(vertices.data(), sizeof(Vertex) * vertices.size());
+    const GLint first_vertex = gpu_buffers->stream_vertices(vertices.data(), vertices.size(), sizeof(Vertex)).first_element(sizeof(Vertex));
     vao->link_attrib(0, 3, GL_FLOAT, sizeof(Vertex), nullptr);                         // position
     vao->link_attrib(1, 3, GL_FLOAT, sizeof(Vertex), (void*)(sizeof(GLfloat) * 3));    // normal
     vao->link_attrib(2, 4, GL_FLOAT, sizeof(Vertex), (void*)(sizeof(GLfloat) * 6));    // color
@@ -30,24 +40,24 @@ void Object3D::render(GPUBuffers* gpu_buffers, const RenderConfig& cfg)
     glBindTexture(GL_TEXTURE_2D, tex_id);
     if (cfg.use_indices)
     {
-      std::vector<GLuint> indices = mesh.faces_as_indices();
-      auto& ebo = gpu_buffers->ebo;
-      ebo->set_data(indices.data(), sizeof(GLuint) * indices.size());
-      glDrawElements(cfg.mode, (GLsizei)(indices.size()), GL_UNSIGNED_INT, nullptr);
+      const size_t nindices = mesh.index_count();
+      const StreamingBuffer::Allocation indices = gpu_buffers->stream_indices(nullptr, nindices);
+      mesh.write_indices(static_cast<GLuint*>(indices.data));
+      glDrawElementsBaseVertex(cfg.mode, (GLsizei)nindices, GL_UNSIGNED_INT, (void*)indices.offset, first_vertex);
     }
     else
     {
-      glDrawArrays(cfg.mode, 0, (GLsizei)vertices.size());
+      glDrawArrays(cfg.mode, first_vertex, (GLsizei)vertices.size());
     }
     glBindTexture(GL_TEXTURE_2D, 0);
 
-    if (is_normals_visible())
+    if (is_normals_visible() && helper_lines)
     {
       render_lines_and_reset_shader(&Object3D::render_normals, this, gpu_buffers, mesh);
     }
   }
 
-  if (is_bbox_visible())
+  if (is_bbox_visible() && helper_lines)
   {
     render_lines_and_reset_shader(&BoundingBox::render, &m_bbox, gpu_buffers);
   }
@@ -67,6 +77,7 @@ void Object3D::rotate(float angle, const glm::vec3& axis)
     return;
   constexpr float rotation_speed = 10.f;
   set_flag(RESET_CACHED_NORMALS, true);
+  set_flag(BOUNDS_CHANGED);
   m_rotation_angle = angle;
   m_rotation_axis = axis;
   m_model_mat = glm::rotate(m_model_mat, glm::radians(angle * m_delta_time * rotation_speed), glm::normalize(axis));
@@ -78,11 +89,13 @@ void Object3D::scale(const glm::vec3& scale)
   for (int i = 0; i < 3; i++)
     m_model_mat[i] = glm::normalize(m_model_mat[i]);
   m_model_mat = glm::scale(m_model_mat, scale);
+  set_flag(BOUNDS_CHANGED);
 }
 
 void Object3D::translate(const glm::vec3& translation)
 {
   m_model_mat = glm::translate(m_model_mat, translation);
+  set_flag(BOUNDS_CHANGED);
 }
 
 void Object3D::set_texture(const std::string& filename)
@@ -101,12 +114,13 @@ void Object3D::set_texture(const std::string& filename)
       }
     }
   }
+  set_flag(GEOMETRY_CHANGED);
 }
 
-std::vector<Vertex> Object3D::normals_as_lines(const Mesh& mesh)
+void Object3D::normals_as_lines(const Mesh& mesh, std::vector<Vertex>& normals)
 {
   // Too slow to call every frame if object has a lot of vertices
-  std::vector<Vertex> normals(mesh.vertices().size() * 2);
+  normals.resize(mesh.vertices().size() * 2);
   constexpr float len_scaler = 3.f;
   size_t index = 0;
   for (const auto& vertex : mesh.vertices())
@@ -116,7 +130,6 @@ std::vector<Vertex> Object3D::normals_as_lines(const Mesh& mesh)
     normals[index].color = normals[index + 1].color = glm::vec4(0.f, 1.f, 1.f, 1.f);
     index += 2;
   }
-  return normals;
 }
 
 BoundingBox Object3D::calculate_bbox()
@@ -147,6 +160,70 @@ BoundingBox Object3D::calculate_bbox()
   return bbox;
 }
 
+const BoundingBox& Object3D::bbox()
+{
+  if (m_bbox.is_empty())
+  {
+    const bool has_vertices = std::any_of(m_meshes.begin(), m_meshes.end(), [](const Mesh& mesh) { return !mesh.vertices().empty(); });
+    if (has_vertices)
+    {
+      m_bbox = calculate_bbox();
+    }
+  }
+  return m_bbox;
+}
+
+bool Object3D::intersect(const Ray& ray, float max_t, float line_tolerance, float& t) const
+{
+  bool hit = false;
+  if (has_surface())
+  {
+    // test triangles in local space. direction is not normalized, so distances stay in world units
+    const glm::mat4 inv_model = glm::inverse(m_model_mat);
+    const Ray local_ray(inv_model * glm::vec4(ray.origin, 1.f), inv_model * glm::vec4(ray.direction, 0.f));
+    for (const auto& mesh : m_meshes)
+    {
+      MeshBVH::Hit mesh_hit;
+      if (mesh.bvh().raycast(local_ray, max_t, mesh_hit))
+      {
+        max_t = t = mesh_hit.t;
+        hit = true;
+      }
+    }
+  }
+  else
+  {
+    // lines are drawn as line strip. test them in world space, so tolerance isn't affected by scale
+    for (const auto& mesh : m_meshes)
+    {
+      const std::vector<Vertex>& vertices = mesh.vertices();
+      glm::vec3 prev = m_model_mat * glm::vec4(vertices.empty() ? glm::vec3(0.f) : vertices[0].position, 1.f);
+      for (size_t i = 1; i < vertices.size(); i++)
+      {
+        const glm::vec3 cur = m_model_mat * glm::vec4(vertices[i].position, 1.f);
+        float tt;
+        const float dist2 = closest_ray_segment(ray, prev, cur, max_t, tt);
+        const float tolerance = line_tolerance * tt;
+        if (tt > 0.f && tt < max_t && dist2 <= tolerance * tolerance)
+        {
+          max_t = t = tt;
+          hit = true;
+        }
+        prev = cur;
+      }
+    }
+  }
+  return hit;
+}
+
+uint32_t Object3D::primitive_count(size_t mesh_index) const
+{
+  const Mesh& mesh = m_meshes[mesh_index];
+  if (has_surface())
+    return (uint32_t)mesh.faces().size();
+  return mesh.vertices().size() > 1 ? (uint32_t)mesh.vertices().size() - 1 : 0;
+}
+
 bool Object3D::has_active_texture() const
 {
   return std::find_if(m_meshes.begin(), m_meshes.end(), 
@@ -172,6 +249,7 @@ void Object3D::set_color(const glm::vec4& color)
 
   // set color of current mesh
   apply_color(m_meshes, color);
+  set_flag(GEOMETRY_CHANGED);
 
   // set color of cached meshes
   for (auto& cached_meshes : m_cached_meshes)
@@ -207,16 +285,21 @@ glm::vec3 Object3D::center()
   return glm::vec3((max_x + min_x) * 0.5f, (max_y + min_y) * 0.5f, (max_z + min_z) * 0.5f);
 }
 
-void Object3D::render(GPUBuffers* gpu_buffers)
+void Object3D::render(GPUBuffers* gpu_buffers, RenderPass pass)
 {
-  render(gpu_buffers, RenderConfig::default());
+  RenderConfig cfg;
+  cfg.pass = pass;
+  render(gpu_buffers, cfg);
 }
 
 void Object3D::apply_shading(Object3D::ShadingMode mode)
 {
+  TRACE_ZONE("Object3D::apply_shading");
+  MemoryTagScope memory_tag(MemoryTag::MESHES);
   if (mode != m_shading_mode)
   {
     set_flag(RESET_CACHED_NORMALS, true);
+    set_flag(GEOMETRY_CHANGED);
     // if meshes with current shading mode are not cached yet
     if (m_cached_meshes.count(m_shading_mode) == 0)
     {
@@ -317,6 +400,8 @@ void Object3D::apply_shading(Object3D::ShadingMode mode)
 
 void Object3D::calc_normals(Mesh& mesh, ShadingMode mode)
 {
+  TRACE_ZONE("Object3D::calc_normals");
+  MemoryTagScope memory_tag(MemoryTag::MESHES);
   if (mode == ShadingMode::NO_SHADING)
     return;
   std::vector<Vertex>& vertices = mesh.vertices();
@@ -357,21 +442,15 @@ void Object3D::calc_normals(Mesh& mesh, ShadingMode mode)
 
 void Object3D::render_normals(GPUBuffers* buffers, const Mesh& mesh)
 {
-  auto& vbo = buffers->vbo;
   auto& vao = buffers->vao;
-  std::vector<Vertex> normals;
   if (get_flag(RESET_CACHED_NORMALS))
   {
-    normals = normals_as_lines(mesh);
-    const_cast<Mesh&>(mesh).m_cached_normals = normals;
-  }
-  else
-  {
-    normals = mesh.m_cached_normals;
+    normals_as_lines(mesh, const_cast<Mesh&>(mesh).m_cached_normals);
   }
-  vbo->set_data(normals.data(), sizeof(Vertex) * normals.size());
+  const std::vector<Vertex>& normals = mesh.m_cached_normals;
+  const GLint first_vertex = buffers->stream_vertices(normals.data(), normals.size(), sizeof(Vertex)).first_element(sizeof(Vertex));
   vao->link_attrib(0, 3, GL_FLOAT, sizeof(Vertex), nullptr);                      // position
   vao->link_attrib(1, 4, GL_FLOAT, sizeof(Vertex), (void*)(sizeof(GLfloat) * 6)); // color
-  glDrawArrays(GL_LINES, 0, (GLsizei)normals.size());
+  glDrawArrays(GL_LINES, first_vertex, (GLsizei)normals.size());
 }
 
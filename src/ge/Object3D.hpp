@@ -6,6 +6,7 @@
 #include <optional>
 #include <list>
 #include <map>
+#include <cassert>
 #include "./core/Shader.hpp"
 #include "./core/GPUBuffers.hpp"
 #include "./core/Texture2D.hpp"
@@ -13,6 +14,8 @@
 #include "./ge/IDrawable.hpp"
 #include "./ge/Mesh.hpp"
 #include "./ge/BoundingBox.hpp"
+#include "./ge/Ray.hpp"
+#include "./ge/Light.hpp"
 
 class Object3D : public IDrawable
 {
@@ -23,8 +26,16 @@ public:
     FLAT_SHADING,
     SMOOTH_SHADING
   };
+  // pass which draws the object. shader of pass is bound by caller
+  enum class RenderPass
+  {
+    SHADED,
+    PICKING,       // ids of primitives, offsets of meshes go to bound picking shader
+    OUTLINE_MASK   // silhouette of selected object
+  };
 public:
-  virtual void render(GPUBuffers*) override;
+  void render(GPUBuffers* gpu_buffers) override { render(gpu_buffers, RenderPass::SHADED); }
+  virtual void render(GPUBuffers*, RenderPass pass);
   virtual void apply_shading(ShadingMode mode);
   virtual void set_color(const glm::vec4& color);
   virtual void set_texture(const std::string& filename);
@@ -34,27 +45,44 @@ public:
   void rotate(float angle, const glm::vec3& axis);
   void scale(const glm::vec3& scale);
   void translate(const glm::vec3& translation);
-  std::vector<Vertex> normals_as_lines(const Mesh& mesh);
+  void set_model_matrix(const glm::mat4& mat) { m_model_mat = mat; set_flag(BOUNDS_CHANGED); }
+  // overwrites normals, keeping their capacity
+  void normals_as_lines(const Mesh& mesh, std::vector<Vertex>& normals);
   BoundingBox calculate_bbox();
+  // cached bounding box in local space. stays empty while object has no vertices
+  const BoundingBox& bbox();
+  BoundingBox world_bbox() { return bbox().is_empty() ? BoundingBox() : bbox().transformed(m_model_mat); }
+  // closest hit of world space ray not farther than max_t. objects without surface are hit
+  // if ray passes closer than line_tolerance * distance along the ray, i.e. within constant angle
+  bool intersect(const Ray& ray, float max_t, float line_tolerance, float& t) const;
+  // triangles of surface or segments of line strip, i.e. range of gl_PrimitiveID when mesh is drawn
+  uint32_t primitive_count(size_t mesh_index) const;
   float rotation_angle() const { return m_rotation_angle; }
   glm::vec3 rotation_axis() const { return m_rotation_axis; }
   glm::vec3 translation() const { return m_model_mat[3]; }
   glm::vec3 scale() const { return glm::vec3(glm::length(m_model_mat[0]), glm::length(m_model_mat[1]), glm::length(m_model_mat[2])); }
   void light_source(bool val) { set_flag(LIGHT_SOURCE, val); }
-  void rotating(bool val) { set_flag(ROTATE_EACH_FRAME, val); }
+  // object which starts or stops rotating moves between static and per frame content of scene
+  void rotating(bool val) { if (val != is_rotating()) set_flag(BOUNDS_CHANGED); set_flag(ROTATE_EACH_FRAME, val); }
   void visible_normals(bool val) { set_flag(VISIBLE_NORMALS, val); }
   void visible_bbox(bool val) { return set_flag(VISIBLE_BBOX, val); }
   void select(bool val) { return set_flag(IS_SELECTED, val); }
+  // occluders are rasterized for occlusion culling of other objects, so they should be large and solid
+  void occluder(bool val) { set_flag(OCCLUDER, val); }
   bool is_normals_visible() const { return get_flag(VISIBLE_NORMALS); }
   bool is_rotating() const { return get_flag(ROTATE_EACH_FRAME); }
   bool is_light_source() const { return get_flag(LIGHT_SOURCE); }
   bool is_bbox_visible() const { return get_flag(VISIBLE_BBOX); }
   bool is_selected() const { return get_flag(IS_SELECTED); }
+  bool is_occluder() const { return get_flag(OCCLUDER); }
   bool has_active_texture() const;
   ShadingMode shading_mode() const { return m_shading_mode; }
   const glm::mat4& model_matrix() const { return m_model_mat; }
   glm::mat4& model_matrix() { return m_model_mat; }
   const glm::vec4& color() const { return m_color; }
+  // used only if object is light source
+  Light& light() { return m_light; }
+  const Light& light() const { return m_light; }
   Mesh& mesh(size_t index) { return m_meshes[index]; }
   const Mesh& mesh(size_t index) const { return m_meshes[index]; }
   std::vector<Mesh>& meshes() { return m_meshes; }
@@ -69,18 +97,16 @@ protected:
     LIGHT_SOURCE = (1 << 2),
     VISIBLE_BBOX = (1 << 3),
     IS_SELECTED = (1 << 4),
-    RESET_CACHED_NORMALS = (1 << 5)
+    RESET_CACHED_NORMALS = (1 << 5),
+    BOUNDS_CHANGED = (1 << 6),      // world space bounds have to be updated in scene BVH
+    GEOMETRY_CHANGED = (1 << 7),    // vertices or faces changed, copy in geometry arena has to be updated
+    OCCLUDER = (1 << 8)
   };
   struct RenderConfig
   {
-    static RenderConfig& default() {
-      static RenderConfig cfgdef;
-      cfgdef.mode = GL_TRIANGLES;
-      cfgdef.use_indices = true;
-      return cfgdef;
-    }
-    int mode;
-    bool use_indices;
+    int mode = GL_TRIANGLES;
+    bool use_indices = true;
+    RenderPass pass = RenderPass::SHADED;
   };
   struct WrappedVertex {
     explicit WrappedVertex(const Vertex& vertex) {
@@ -128,10 +154,11 @@ protected:
   float m_rotation_angle = 0.f;
   float m_delta_time = 0.f;
   glm::vec3 m_rotation_axis = glm::vec3(0.f);
-  int m_flags = RESET_CACHED_NORMALS;
+  int m_flags = RESET_CACHED_NORMALS | BOUNDS_CHANGED | GEOMETRY_CHANGED;
   ShadingMode m_shading_mode = ShadingMode::NO_SHADING;
   VertexFinder m_vertex_finder;
   BoundingBox m_bbox;             // bounding box which covers all meshes
+  Light m_light;
   std::map<ShadingMode, std::vector<Mesh>> m_cached_meshes;
 };
 
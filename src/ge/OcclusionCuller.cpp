@@ -0,0 +1,389 @@
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include "OcclusionCuller.hpp"
+#include "./utils/Simd.hpp"
+
+OcclusionCuller::OcclusionCuller(int width, int height)
+{
+  m_tiles_x = std::max(1, (width + tile_width - 1) / tile_width);
+  m_tiles_y = std::max(1, (height + tile_height - 1) / tile_height);
+  m_width = m_tiles_x * tile_width;
+  m_height = m_tiles_y * tile_height;
+  m_bins.resize(m_tiles_x * m_tiles_y);
+  glm::ivec2 size(m_width, m_height);
+  while (true)
+  {
+    m_level_sizes.push_back(size);
+    m_levels.emplace_back(size.x * size.y, 1.f);
+    if (size.x == 1 && size.y == 1)
+      break;
+    size = glm::max((size + 1) / 2, glm::ivec2(1));
+  }
+}
+
+void OcclusionCuller::begin_frame(const glm::mat4& view_projection)
+{
+  m_view_projection = view_projection;
+  m_polygons.clear();
+  for (auto& bin : m_bins)
+    bin.clear();
+  std::fill(m_levels[0].begin(), m_levels[0].end(), 1.f);
+}
+
+void OcclusionCuller::add_occluder(const Mesh& mesh, const glm::mat4& model)
+{
+  const glm::mat4 mvp = m_view_projection * model;
+  const auto& vertices = mesh.vertices();
+  m_clip_vertices.resize(vertices.size());
+  for (size_t i = 0; i < vertices.size(); i++)
+    m_clip_vertices[i] = mvp * glm::vec4(vertices[i].position, 1.f);
+  const auto& faces = mesh.faces();
+  glm::vec4 polygon[Polygon::max_edges];
+  for (size_t f = 0; f < faces.size(); f++)
+  {
+    const Face& face = faces[f];
+    // quads are mostly stored as two triangles, as single polygon they leave no gap along the diagonal
+    GLuint quad[4];
+    if (f + 1 < faces.size() && quad_of_triangles(face, faces[f + 1], quad))
+    {
+      for (int k = 0; k < 4; k++)
+        polygon[k] = m_clip_vertices[quad[k]];
+      add_clip_polygon(polygon, 4);
+      f++;
+    }
+    else if (face.size <= Polygon::max_edges)
+    {
+      for (int k = 0; k < face.size; k++)
+        polygon[k] = m_clip_vertices[face.data[k]];
+      add_clip_polygon(polygon, face.size);
+    }
+    else
+    {
+      // larger polygons are split into triangle fans
+      for (int k = 1; k + 1 < face.size; k++)
+      {
+        polygon[0] = m_clip_vertices[face.data[0]];
+        polygon[1] = m_clip_vertices[face.data[k]];
+        polygon[2] = m_clip_vertices[face.data[k + 1]];
+        add_clip_polygon(polygon, 3);
+      }
+    }
+  }
+}
+
+void OcclusionCuller::add_occluder(const BoundingBox& world_box)
+{
+  if (world_box.is_empty())
+    return;
+  // bit 0 of corner index selects max x, bit 1 - max y, bit 2 - max z
+  glm::vec4 corners[8];
+  for (int i = 0; i < 8; i++)
+  {
+    const glm::vec3 p((i & 1) ? world_box.max().x : world_box.min().x, (i & 2) ? world_box.max().y : world_box.min().y, (i & 4) ? world_box.max().z : world_box.min().z);
+    corners[i] = m_view_projection * glm::vec4(p, 1.f);
+  }
+  static constexpr int quads[6][4] = { {0, 2, 6, 4}, {1, 5, 7, 3}, {0, 4, 5, 1}, {2, 3, 7, 6}, {0, 1, 3, 2}, {4, 6, 7, 5} };
+  for (const auto& q : quads)
+  {
+    const glm::vec4 polygon[4] = { corners[q[0]], corners[q[1]], corners[q[2]], corners[q[3]] };
+    add_clip_polygon(polygon, 4);
+  }
+}
+
+bool OcclusionCuller::quad_of_triangles(const Face& a, const Face& b, GLuint quad[4])
+{
+  if (a.size != 3 || b.size != 3)
+    return false;
+  // the same edge goes in opposite directions in triangles with consistent winding
+  for (int i = 0; i < 3; i++)
+  {
+    for (int j = 0; j < 3; j++)
+    {
+      if (a.data[i] == b.data[(j + 1) % 3] && a.data[(i + 1) % 3] == b.data[j])
+      {
+        quad[0] = a.data[(i + 1) % 3];
+        quad[1] = a.data[(i + 2) % 3];
+        quad[2] = a.data[i];
+        quad[3] = b.data[(j + 2) % 3];
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+void OcclusionCuller::add_clip_polygon(const glm::vec4* vertices, int count)
+{
+  // clip against near plane (z >= -w), the rest is handled by clamping to screen.
+  // every crossing of the plane adds a vertex, concave polygons may cross it more than twice
+  glm::vec4 out[2 * Polygon::max_edges];
+  int nout = 0;
+  for (int i = 0; i < count; i++)
+  {
+    const glm::vec4& a = vertices[i];
+    const glm::vec4& b = vertices[(i + 1) % count];
+    const float da = a.z + a.w, db = b.z + b.w;
+    if (da >= 0.f)
+      out[nout++] = a;
+    if ((da >= 0.f) != (db >= 0.f))
+      out[nout++] = a + (b - a) * (da / (da - db));
+  }
+  if (nout < 3)
+    return;
+  glm::vec3 screen[2 * Polygon::max_edges];
+  for (int i = 0; i < nout; i++)
+  {
+    const float inv_w = 1.f / out[i].w;
+    screen[i] = glm::vec3((out[i].x * inv_w * 0.5f + 0.5f) * m_width, (out[i].y * inv_w * 0.5f + 0.5f) * m_height, out[i].z * inv_w * 0.5f + 0.5f);
+  }
+  setup_polygon(screen, nout);
+}
+
+void OcclusionCuller::setup_polygon(const glm::vec3* points, int count)
+{
+  if (count > Polygon::max_edges)
+  {
+    for (int k = 1; k + 1 < count; k++)
+    {
+      const glm::vec3 triangle[3] = { points[0], points[k], points[k + 1] };
+      setup_polygon(triangle, 3);
+    }
+    return;
+  }
+  // both sides are drawn, counter clockwise order keeps edge functions positive inside
+  float area = 0.f;
+  for (int i = 0; i < count; i++)
+    area += points[i].x * points[(i + 1) % count].y - points[(i + 1) % count].x * points[i].y;
+  if (std::abs(area) < 1e-8f)
+    return;
+  glm::vec3 p[Polygon::max_edges];
+  for (int i = 0; i < count; i++)
+    p[i] = points[area > 0.f ? i : count - 1 - i];
+
+  Polygon poly;
+  poly.edge_count = count;
+  for (int k = 0; k < count; k++)
+  {
+    const glm::vec3& a = p[k];
+    const glm::vec3& b = p[(k + 1) % count];
+    poly.edge_a[k] = a.y - b.y;
+    poly.edge_b[k] = b.x - a.x;
+    poly.edge_c[k] = a.x * b.y - a.y * b.x;
+  }
+  // concave or self-intersecting polygons are drawn as triangle fans
+  for (int k = 0; count > 3 && k < count; k++)
+  {
+    for (int j = 0; j < count; j++)
+    {
+      if (j == k || j == (k + 1) % count || poly.edge_a[k] * p[j].x + poly.edge_b[k] * p[j].y + poly.edge_c[k] >= 0.f)
+        continue;
+      for (int t = 1; t + 1 < count; t++)
+      {
+        const glm::vec3 triangle[3] = { p[0], p[t], p[t + 1] };
+        setup_polygon(triangle, 3);
+      }
+      return;
+    }
+  }
+
+  // depth plane through the largest triangle of fan
+  int base = 1;
+  float base_area = 0.f;
+  for (int k = 1; k + 1 < count; k++)
+  {
+    const float a = (p[k].x - p[0].x) * (p[k + 1].y - p[0].y) - (p[k + 1].x - p[0].x) * (p[k].y - p[0].y);
+    if (a > base_area)
+    {
+      base_area = a;
+      base = k;
+    }
+  }
+  if (base_area < 1e-8f)
+    return;
+  const glm::vec3 e1 = p[base] - p[0], e2 = p[base + 1] - p[0];
+  const float depth_dx = (e1.z * e2.y - e2.z * e1.y) / base_area;
+  const float depth_dy = (e1.x * e2.z - e2.x * e1.z) / base_area;
+  float depth_c = p[0].z - depth_dx * p[0].x - depth_dy * p[0].y;
+  // merged triangles of mesh may be not planar, plane is moved back until no vertex is behind it
+  float behind = 0.f;
+  for (int k = 0; k < count; k++)
+    behind = std::max(behind, p[k].z - (depth_dx * p[k].x + depth_dy * p[k].y + depth_c));
+
+  // result must be conservative: only pixels which are completely inside are covered, and they get
+  // the farthest depth of polygon in them. pixel (x, y) spans [x, x + 1] x [y, y + 1], so both edge functions
+  // and depth plane are evaluated at integer coordinates and shifted to the pixel corner where they are extreme
+  for (int k = 0; k < count; k++)
+    poly.edge_c[k] += std::min(poly.edge_a[k], 0.f) + std::min(poly.edge_b[k], 0.f);
+  poly.depth_a = depth_dx;
+  poly.depth_b = depth_dy;
+  poly.depth_c = depth_c + behind + std::max(depth_dx, 0.f) + std::max(depth_dy, 0.f);
+
+  glm::vec2 lo(std::numeric_limits<float>::max()), hi(-std::numeric_limits<float>::max());
+  for (int k = 0; k < count; k++)
+  {
+    lo = glm::min(lo, glm::vec2(p[k]));
+    hi = glm::max(hi, glm::vec2(p[k]));
+  }
+  // clamped before conversion, vertices close to near plane project very far
+  const glm::vec2 size(m_width, m_height);
+  lo = glm::clamp(lo, glm::vec2(0.f), size);
+  hi = glm::clamp(hi, glm::vec2(0.f), size);
+  poly.min_x = (int)std::ceil(lo.x);
+  poly.min_y = (int)std::ceil(lo.y);
+  poly.max_x = (int)std::floor(hi.x) - 1;
+  poly.max_y = (int)std::floor(hi.y) - 1;
+  if (poly.min_x > poly.max_x || poly.min_y > poly.max_y)
+    return;
+
+  const uint32_t index = (uint32_t)m_polygons.size();
+  m_polygons.push_back(poly);
+  for (int ty = poly.min_y / tile_height; ty <= poly.max_y / tile_height; ty++)
+  {
+    for (int tx = poly.min_x / tile_width; tx <= poly.max_x / tile_width; tx++)
+      m_bins[ty * m_tiles_x + tx].push_back(index);
+  }
+}
+
+void OcclusionCuller::finish_occluders()
+{
+  // tiles don't share pixels, so they could be rasterized in parallel
+  for (int tile = 0; tile < (int)m_bins.size(); tile++)
+  {
+    if (!m_bins[tile].empty())
+      rasterize_tile(tile);
+  }
+  build_hierarchy();
+}
+
+void OcclusionCuller::rasterize_tile(int tile)
+{
+  const int tile_x0 = (tile % m_tiles_x) * tile_width;
+  const int tile_y0 = (tile / m_tiles_x) * tile_height;
+  float* depth = m_levels[0].data();
+  for (uint32_t index : m_bins[tile])
+  {
+    const Polygon& poly = m_polygons[index];
+    const int min_x = std::max(poly.min_x, tile_x0), max_x = std::min(poly.max_x, tile_x0 + tile_width - 1);
+    const int min_y = std::max(poly.min_y, tile_y0), max_y = std::min(poly.max_y, tile_y0 + tile_height - 1);
+    // spans start at multiple of 4, tile width is multiple of 4 too, so spans never leave the tile
+    const int start_x = min_x & ~3;
+#if OPENGL_ENGINE_SSE
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 offsets = _mm_setr_ps(0.f, 1.f, 2.f, 3.f);
+    const __m128 da = _mm_set1_ps(poly.depth_a);
+    __m128 ea[Polygon::max_edges];
+    for (int k = 0; k < poly.edge_count; k++)
+      ea[k] = _mm_set1_ps(poly.edge_a[k]);
+#endif
+    for (int y = min_y; y <= max_y; y++)
+    {
+      float* row = depth + y * m_width;
+      const float fy = (float)y;
+      int x = start_x;
+#if OPENGL_ENGINE_SSE
+      __m128 er[Polygon::max_edges];
+      for (int k = 0; k < poly.edge_count; k++)
+        er[k] = _mm_set1_ps(poly.edge_b[k] * fy + poly.edge_c[k]);
+      const __m128 rd = _mm_set1_ps(poly.depth_b * fy + poly.depth_c);
+      for (; x <= max_x; x += 4)
+      {
+        const __m128 fx = _mm_add_ps(_mm_set1_ps((float)x), offsets);
+        __m128 inside = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(ea[0], fx), er[0]), zero);
+        for (int k = 1; k < poly.edge_count; k++)
+          inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(ea[k], fx), er[k]), zero));
+        if (_mm_movemask_ps(inside) == 0)
+          continue;
+        const __m128 old_depth = _mm_loadu_ps(row + x);
+        const __m128 new_depth = _mm_min_ps(old_depth, _mm_add_ps(_mm_mul_ps(da, fx), rd));
+        _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, new_depth), _mm_andnot_ps(inside, old_depth)));
+      }
+#endif
+      // everything when SSE is not available
+      for (; x <= max_x; x++)
+      {
+        const float fx = (float)x;
+        bool inside = true;
+        for (int k = 0; k < poly.edge_count; k++)
+          inside &= poly.edge_a[k] * fx + poly.edge_b[k] * fy + poly.edge_c[k] >= 0.f;
+        if (inside)
+          row[x] = std::min(row[x], poly.depth_a * fx + poly.depth_b * fy + poly.depth_c);
+      }
+    }
+  }
+}
+
+void OcclusionCuller::build_hierarchy()
+{
+  for (size_t level = 1; level < m_levels.size(); level++)
+  {
+    const std::vector<float>& src = m_levels[level - 1];
+    std::vector<float>& dst = m_levels[level];
+    const glm::ivec2 src_size = m_level_sizes[level - 1];
+    const glm::ivec2 dst_size = m_level_sizes[level];
+    for (int y = 0; y < dst_size.y; y++)
+    {
+      // odd sizes repeat the last row and column
+      const float* row0 = &src[std::min(2 * y, src_size.y - 1) * src_size.x];
+      const float* row1 = &src[std::min(2 * y + 1, src_size.y - 1) * src_size.x];
+      float* out = &dst[y * dst_size.x];
+      int x = 0;
+#if OPENGL_ENGINE_SSE
+      for (; 2 * x + 8 <= src_size.x; x += 4)
+      {
+        const __m128 lo = _mm_max_ps(_mm_loadu_ps(row0 + 2 * x), _mm_loadu_ps(row1 + 2 * x));
+        const __m128 hi = _mm_max_ps(_mm_loadu_ps(row0 + 2 * x + 4), _mm_loadu_ps(row1 + 2 * x + 4));
+        // even and odd columns of both halves
+        const __m128 even = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0));
+        const __m128 odd = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1));
+        _mm_storeu_ps(out + x, _mm_max_ps(even, odd));
+      }
+#endif
+      for (; x < dst_size.x; x++)
+      {
+        const int x0 = std::min(2 * x, src_size.x - 1), x1 = std::min(2 * x + 1, src_size.x - 1);
+        out[x] = std::max(std::max(row0[x0], row0[x1]), std::max(row1[x0], row1[x1]));
+      }
+    }
+  }
+}
+
+bool OcclusionCuller::is_visible(const BoundingBox& world_box) const
+{
+  glm::vec2 ndc_min(std::numeric_limits<float>::max()), ndc_max(-std::numeric_limits<float>::max());
+  float min_depth = std::numeric_limits<float>::max();
+  for (int i = 0; i < 8; i++)
+  {
+    const glm::vec3 p((i & 1) ? world_box.max().x : world_box.min().x, (i & 2) ? world_box.max().y : world_box.min().y, (i & 4) ? world_box.max().z : world_box.min().z);
+    const glm::vec4 clip = m_view_projection * glm::vec4(p, 1.f);
+    // crosses near plane, projected bounds would be wrong
+    if (clip.z < -clip.w || clip.w <= 0.f)
+      return true;
+    const glm::vec3 ndc = glm::vec3(clip) / clip.w;
+    ndc_min = glm::min(ndc_min, glm::vec2(ndc));
+    ndc_max = glm::max(ndc_max, glm::vec2(ndc));
+    min_depth = std::min(min_depth, ndc.z * 0.5f + 0.5f);
+  }
+  const glm::vec2 size(m_width, m_height);
+  const glm::vec2 screen_min = (ndc_min * 0.5f + 0.5f) * size;
+  const glm::vec2 screen_max = (ndc_max * 0.5f + 0.5f) * size;
+  if (screen_max.x < 0.f || screen_max.y < 0.f || screen_min.x >= size.x || screen_min.y >= size.y)
+    return false;
+  // every pixel which rectangle touches
+  const int x0 = std::clamp((int)screen_min.x, 0, m_width - 1), x1 = std::clamp((int)screen_max.x, 0, m_width - 1);
+  const int y0 = std::clamp((int)screen_min.y, 0, m_height - 1), y1 = std::clamp((int)screen_max.y, 0, m_height - 1);
+  // the finest level where rectangle covers at most 2x2 texels
+  int level = 0;
+  while (level + 1 < (int)m_levels.size() && ((x1 >> level) - (x0 >> level) > 1 || (y1 >> level) - (y0 >> level) > 1))
+    level++;
+  for (int y = y0 >> level; y <= (y1 >> level); y++)
+  {
+    for (int x = x0 >> level; x <= (x1 >> level); x++)
+    {
+      if (min_depth <= depth(level, x, y))
+        return true;
+    }
+  }
+  return false;
+}
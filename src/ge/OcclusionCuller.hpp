@@ -0,0 +1,66 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "./ge/BoundingBox.hpp"
+#include "./ge/Mesh.hpp"
+
+// Software occlusion culling. Designated occluders are rasterized into small depth buffer on CPU, then
+// hierarchical depth (every level keeps the farthest depth of 2x2 texels of previous one) is built and screen
+// rectangles of object bounds are tested against it. Faces of occluders are binned into screen tiles as convex
+// polygons and rasterized tile by tile 4 pixels at a time. Result is conservative: only pixels which a polygon
+// covers completely are written, with its farthest depth there, so object is reported hidden only if occluders cover it.
+// Edges shared by polygons leave uncovered pixels, so occluders with few large faces (boxes, simplified meshes) work best.
+class OcclusionCuller
+{
+public:
+  static constexpr int tile_width = 32;
+  static constexpr int tile_height = 16;
+public:
+  // resolution of depth buffer, rounded up to whole tiles
+  OcclusionCuller(int width = 256, int height = 128);
+  // clears depth buffer and occluders of previous frame
+  void begin_frame(const glm::mat4& view_projection);
+  // occluders have to be solid, everything behind their triangles is considered hidden
+  void add_occluder(const Mesh& mesh, const glm::mat4& model);
+  void add_occluder(const BoundingBox& world_box);
+  // rasterizes added occluders and builds depth hierarchy. must be called before is_visible
+  void finish_occluders();
+  // boxes completely outside of screen are not visible as well
+  bool is_visible(const BoundingBox& world_box) const;
+  int width() const { return m_width; }
+  int height() const { return m_height; }
+  int level_count() const { return (int)m_levels.size(); }
+  glm::ivec2 level_size(int level) const { return m_level_sizes[level]; }
+  // depth in [0, 1], 1 where nothing was drawn. level 0 is rasterized depth buffer
+  float depth(int level, int x, int y) const { return m_levels[level][y * m_level_sizes[level].x + x]; }
+  size_t polygon_count() const { return m_polygons.size(); }
+private:
+  // screen space convex polygon prepared for rasterization
+  struct Polygon
+  {
+    static constexpr int max_edges = 6;
+    float edge_a[max_edges], edge_b[max_edges], edge_c[max_edges];  // edge functions a*x + b*y + c, non-negative if pixel is inside
+    int edge_count;
+    float depth_a, depth_b, depth_c;  // farthest depth in pixel
+    int min_x, min_y, max_x, max_y;   // pixel bounds, inclusive
+  };
+  // joins two triangles with shared edge into quad
+  static bool quad_of_triangles(const Face& a, const Face& b, GLuint quad[4]);
+  void add_clip_polygon(const glm::vec4* vertices, int count);
+  void setup_polygon(const glm::vec3* points, int count);
+  void rasterize_tile(int tile);
+  void build_hierarchy();
+private:
+  int m_width;
+  int m_height;
+  int m_tiles_x;
+  int m_tiles_y;
+  glm::mat4 m_view_projection = glm::mat4(1.f);
+  std::vector<Polygon> m_polygons;
+  std::vector<std::vector<uint32_t>> m_bins;  // polygons per tile, capacity is kept between frames
+  std::vector<glm::vec4> m_clip_vertices;     // vertices of current occluder mesh
+  std::vector<std::vector<float>> m_levels;
+  std::vector<glm::ivec2> m_level_sizes;
+};
@@ -0,0 +1,39 @@
+#include "Picking.hpp"
+
+Ray ray_from_ndc(const glm::mat4& view_projection, const glm::vec2& ndc, float& max_t)
+{
+  const glm::mat4 inv = glm::inverse(view_projection);
+  glm::vec4 near_pnt = inv * glm::vec4(ndc, -1.f, 1.f);
+  glm::vec4 far_pnt = inv * glm::vec4(ndc, 1.f, 1.f);
+  near_pnt /= near_pnt.w;
+  far_pnt /= far_pnt.w;
+  const glm::vec3 dir = glm::vec3(far_pnt) - glm::vec3(near_pnt);
+  max_t = glm::length(dir);
+  return Ray(glm::vec3(near_pnt), dir / max_t);
+}
+
+float line_pick_tolerance(const glm::mat4& projection, int viewport_height, float pixels)
+{
+  // projection[1][1] is 1 / tan(fov / 2), so height of screen at distance 1 is 2 / projection[1][1]
+  return pixels * 2.f / (viewport_height * projection[1][1]);
+}
+
+PickResult pick_object(const DynamicBVH& bvh, const std::vector<std::unique_ptr<Object3D>>& objects,
+  const Ray& ray, float max_t, float line_tolerance)
+{
+  PickResult result;
+  // lines may be hit slightly outside of their bounds
+  const float radius = line_tolerance * max_t;
+  bvh.raycast(ray, max_t, [&objects, &result, line_tolerance](int index, const Ray& ray, float max_t)
+    {
+      float t;
+      if (objects[index]->intersect(ray, max_t, line_tolerance, t))
+      {
+        result.object = index;
+        result.distance = t;
+        return t;
+      }
+      return max_t;
+    }, radius);
+  return result;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <glm/glm.hpp>
+#include "./ge/BVH.hpp"
+#include "./ge/Object3D.hpp"
+#include "./ge/Ray.hpp"
+
+struct PickResult
+{
+  int object = -1;      // index of object or -1 if nothing was hit
+  float distance = 0.f;
+};
+
+// ray through point on screen given in normalized device coordinates, starting at near plane.
+// max_t is set to distance to far plane
+Ray ray_from_ndc(const glm::mat4& view_projection, const glm::vec2& ndc, float& max_t);
+// angle which covers given number of pixels on screen, used as tolerance for picking lines
+float line_pick_tolerance(const glm::mat4& projection, int viewport_height, float pixels);
+// closest object hit by ray. proxies in BVH must store index of object as user data
+PickResult pick_object(const DynamicBVH& bvh, const std::vector<std::unique_ptr<Object3D>>& objects,
+  const Ray& ray, float max_t, float line_tolerance);
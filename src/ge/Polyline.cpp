@@ -1,15 +1,19 @@
 #include "Polyline.hpp"
 
-void Polyline::render(GPUBuffers* gpu_buffers) 
+void Polyline::render(GPUBuffers* gpu_buffers, RenderPass pass) 
 {
   assert(m_meshes[0].vertices().size() > 0);
   RenderConfig cfg;
   cfg.use_indices = false;
   cfg.mode = GL_LINE_STRIP;
+  cfg.pass = pass;
   Object3D::render(gpu_buffers, cfg);
 }
 
 void Polyline::add(const Vertex& point) 
 {
   m_meshes[0].append_vertex(point);
+  // recalculate on next access
+  m_bbox = BoundingBox();
+  set_flag(BOUNDS_CHANGED);
 }
@@ -11,6 +11,7 @@ public:
   Polyline() = default;
   std::string name() const override { return "Polyline"; }
   bool has_surface() const override { return false; }
-  void render(GPUBuffers*) override;
+  void render(GPUBuffers*, RenderPass pass) override;
+  using Object3D::render;
   void add(const Vertex& point);
 };
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include <glm/glm.hpp>
+
+struct Ray
+{
+  Ray() = default;
+  Ray(const glm::vec3& origin, const glm::vec3& direction) : origin(origin), direction(direction) {}
+  glm::vec3 at(float t) const { return origin + direction * t; }
+  glm::vec3 origin = glm::vec3(0.f);
+  glm::vec3 direction = glm::vec3(0.f, 0.f, -1.f);
+};
+
+// slab test. on hit tmin is the entry distance (0 if origin is inside of box)
+inline bool intersect_aabb(const Ray& ray, const glm::vec3& inv_dir, const glm::vec3& bmin, const glm::vec3& bmax, float max_t, float& tmin)
+{
+  float t0 = 0.f, t1 = max_t;
+  for (int i = 0; i < 3; i++)
+  {
+    float tnear = (bmin[i] - ray.origin[i]) * inv_dir[i];
+    float tfar = (bmax[i] - ray.origin[i]) * inv_dir[i];
+    if (tnear > tfar)
+      std::swap(tnear, tfar);
+    // NaN (0 * inf) comparisons are false, so parallel rays inside of slab don't affect interval
+    t0 = tnear > t0 ? tnear : t0;
+    t1 = tfar < t1 ? tfar : t1;
+    if (t0 > t1)
+      return false;
+  }
+  tmin = t0;
+  return true;
+}
+
+inline glm::vec3 safe_inverse(const glm::vec3& dir)
+{
+  constexpr float inf = std::numeric_limits<float>::infinity();
+  return glm::vec3(dir.x != 0.f ? 1.f / dir.x : inf, dir.y != 0.f ? 1.f / dir.y : inf, dir.z != 0.f ? 1.f / dir.z : inf);
+}
+
+// Moller-Trumbore, both sides of triangle are hit as with disabled face culling.
+// u and v are barycentric weights of v1 and v2
+inline bool intersect_triangle(const Ray& ray, const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2, float max_t, float& t, float& u, float& v)
+{
+  constexpr float eps = 1e-12f;
+  const glm::vec3 e1 = v1 - v0;
+  const glm::vec3 e2 = v2 - v0;
+  const glm::vec3 p = glm::cross(ray.direction, e2);
+  const float det = glm::dot(e1, p);
+  if (std::abs(det) < eps)
+    return false;
+  const float inv_det = 1.f / det;
+  const glm::vec3 s = ray.origin - v0;
+  const float uu = glm::dot(s, p) * inv_det;
+  if (uu < 0.f || uu > 1.f)
+    return false;
+  const glm::vec3 q = glm::cross(s, e1);
+  const float vv = glm::dot(ray.direction, q) * inv_det;
+  if (vv < 0.f || uu + vv > 1.f)
+    return false;
+  const float tt = glm::dot(e2, q) * inv_det;
+  if (tt < 0.f || tt > max_t)
+    return false;
+  t = tt;
+  u = uu;
+  v = vv;
+  return true;
+}
+
+inline bool intersect_triangle(const Ray& ray, const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2, float max_t, float& t)
+{
+  float u, v;
+  return intersect_triangle(ray, v0, v1, v2, max_t, t, u, v);
+}
+
+// closest points between ray (limited by max_t) and segment [a, b].
+// returns squared distance between them, t is distance along the ray to its closest point
+inline float closest_ray_segment(const Ray& ray, const glm::vec3& a, const glm::vec3& b, float max_t, float& t)
+{
+  const glm::vec3 d1 = ray.direction;
+  const glm::vec3 d2 = b - a;
+  const glm::vec3 r = ray.origin - a;
+  const float aa = glm::dot(d1, d1);
+  const float ee = glm::dot(d2, d2);
+  const float f = glm::dot(d2, r);
+  float s = 0.f, u = 0.f;
+  if (ee <= 1e-12f)
+  {
+    // degenerated segment
+    s = std::clamp(-glm::dot(d1, r) / aa, 0.f, max_t);
+  }
+  else
+  {
+    const float c = glm::dot(d1, r);
+    const float bb = glm::dot(d1, d2);
+    const float denom = aa * ee - bb * bb;
+    s = denom > 1e-12f ? std::clamp((bb * f - c * ee) / denom, 0.f, max_t) : 0.f;
+    u = (bb * s + f) / ee;
+    if (u < 0.f)
+    {
+      u = 0.f;
+      s = std::clamp(-c / aa, 0.f, max_t);
+    }
+    else if (u > 1.f)
+    {
+      u = 1.f;
+      s = std::clamp((bb - c) / aa, 0.f, max_t);
+    }
+  }
+  t = s;
+  const glm::vec3 diff = ray.at(s) - (a + d2 * u);
+  return glm::dot(diff, diff);
+}
@@ -3,14 +3,13 @@
 void Skybox::render(GPUBuffers* gpu_buffers)
 {
   auto& vao = gpu_buffers->vao;
-  auto& vbo = gpu_buffers->vbo;
   vao->bind();
-  vbo->bind();
   m_cubemap.bind();
-  vbo->set_data(skyboxVertices, sizeof(skyboxVertices));
-  vao->link_attrib(0, 3, GL_FLOAT, sizeof(float) * 3, nullptr);
-  glDrawArrays(GL_TRIANGLES, 0, 36);
+  const size_t stride = sizeof(float) * 3;
+  const GLint first_vertex = gpu_buffers->stream_vertices(skyboxVertices, 36, stride).first_element(stride);
+  vao->link_attrib(0, 3, GL_FLOAT, stride, nullptr);
+  glDrawArrays(GL_TRIANGLES, first_vertex, 36);
   m_cubemap.unbind();
-  vbo->unbind();
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
   vao->unbind();
 }
@@ -0,0 +1,13 @@
+// per draw data of multi draw indirect, see IndirectRenderer
+struct DrawParams
+{
+	mat4 modelMatrix;
+	uint flags;
+	uint firstIndex;   // of mesh in geometry arena
+	int baseVertex;
+	uint padding;
+};
+layout (std430, binding = 0) readonly buffer DrawParamsBuffer
+{
+	DrawParams drawParams[];
+};
@@ -5,8 +5,12 @@ out vec4 FragColor;
 in vec2 TexCoords;
 
 uniform sampler2D screenTexture;
+// part of texture covered by scene when it's rendered below window resolution
+uniform vec2 uvScale = vec2(1.0);
 
 void main()
 { 
-    FragColor = texture(screenTexture, TexCoords);
+    // half texel inside of covered part, so bilinear filter doesn't pull in texels outside of it
+    vec2 uv = min(TexCoords * uvScale, uvScale - 0.5 / vec2(textureSize(screenTexture, 0)));
+    FragColor = texture(screenTexture, uv);
 }
@@ -0,0 +1,73 @@
+// lights assigned to clusters of view frustum, see SceneRenderer::update_lights
+struct Light
+{
+	vec4 positionRange;    // world space
+	vec4 colorIntensity;
+	vec4 directionType;    // w - 0 point, 1 spot
+	vec4 spotCos;          // x - cos of inner angle, y - cos of outer angle
+};
+layout (std430, binding = 1) readonly buffer LightsBuffer
+{
+	Light lights[];
+};
+// offset and count of lights per cluster, see LightClusters
+layout (std430, binding = 2) readonly buffer ClustersBuffer
+{
+	uvec2 clusters[];
+};
+layout (std430, binding = 3) readonly buffer LightIndicesBuffer
+{
+	uint lightIndices[];
+};
+
+uniform vec3 viewPos;
+uniform mat4 viewMatrix;
+uniform vec3 clusterGrid;
+uniform vec2 screenSize;
+uniform float sliceScale;
+uniform float sliceBias;
+
+// Phong shading model, summed over lights of cluster which contains fragment. returns light reflected to viewer
+vec3 computeLighting(vec3 fragment, vec3 normal)
+{
+	ivec3 grid = ivec3(clusterGrid);
+	float viewDepth = -(viewMatrix * vec4(fragment, 1.0)).z;
+	ivec3 cell = ivec3(gl_FragCoord.xy / screenSize * vec2(grid.xy), floor(log(max(viewDepth, 1e-4)) * sliceScale + sliceBias));
+	cell = clamp(cell, ivec3(0), grid - 1);
+	uvec2 cluster = clusters[cell.x + grid.x * (cell.y + grid.y * cell.z)];
+
+	// ambient light
+	float ambientStrength = 0.2f;
+	vec3 lighting = vec3(ambientStrength);
+
+	vec3 norm = normalize(normal);
+	vec3 viewDir = normalize(viewPos - fragment);
+	float specularStrength = 0.5;
+	for (uint i = 0u; i < cluster.y; i++) {
+		Light light = lights[lightIndices[cluster.x + i]];
+		vec3 toLight = light.positionRange.xyz - fragment;
+		float dist = length(toLight);
+		float range = light.positionRange.w;
+		if (dist >= range)
+			continue;
+		vec3 lightDir = toLight / max(dist, 1e-4);
+		// smooth window, so light ends exactly at its range
+		float ratio = dist / range;
+		float attenuation = clamp(1.0 - ratio * ratio * ratio * ratio, 0.0, 1.0);
+		attenuation *= attenuation;
+		if (light.directionType.w > 0.5) {
+			attenuation *= smoothstep(light.spotCos.y, light.spotCos.x, dot(-lightDir, light.directionType.xyz));
+		}
+		vec3 radiance = light.colorIntensity.rgb * light.colorIntensity.w * attenuation;
+
+		//diffuse light
+		float diffuseValue = max(dot(norm, lightDir), 0.0);
+
+		// specular light
+		vec3 reflectedDir = reflect(-lightDir, norm);
+		float specValue = pow(max(dot(viewDir, reflectedDir), 0.0), 32);
+
+		lighting += (diffuseValue + specularStrength * specValue) * radiance;
+	}
+	return lighting;
+}
@@ -0,0 +1,36 @@
+#version 440 core
+
+out vec4 FragColor;
+
+in vec2 TexCoords;
+
+uniform sampler2D outlineMask;
+// part of mask covered by scene when it's rendered below window resolution
+uniform vec2 uvScale = vec2(1.0);
+
+const int outlineWidth = 3;
+const vec4 outlineColor = vec4(1.0, 0.0, 0.0, 1.0);
+
+void main()
+{
+    ivec2 size = ivec2(vec2(textureSize(outlineMask, 0)) * uvScale + 0.5);
+    ivec2 p = ivec2(TexCoords * vec2(size));
+    // inside of selected object stays as is
+    if (texelFetch(outlineMask, p, 0).r > 0.5)
+        discard;
+    for (int y = -outlineWidth; y <= outlineWidth; y++)
+    {
+        for (int x = -outlineWidth; x <= outlineWidth; x++)
+        {
+            if (x * x + y * y > outlineWidth * outlineWidth)
+                continue;
+            ivec2 q = clamp(p + ivec2(x, y), ivec2(0), size - 1);
+            if (texelFetch(outlineMask, q, 0).r > 0.5)
+            {
+                FragColor = outlineColor;
+                return;
+            }
+        }
+    }
+    discard;
+}
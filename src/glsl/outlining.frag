@@ -1,8 +1,9 @@
 #version 440 core
 
-out vec4 FragColor;
+// coverage of selected objects, outline is drawn around it by outline_composite.frag
+layout (location = 0) out float Mask;
 
 void main()
 {
-    FragColor = vec4(123, 0, 0, 1);
+    Mask = 1.0;
 }
@@ -0,0 +1,13 @@
+#version 440 core
+
+layout (location = 0) out uint FragId;
+
+// id of the first primitive of object, 0 is left for background
+uniform uint objectIdBase;
+// primitives of previous meshes of the same object, set by Object3D before drawing each mesh
+uniform uint meshPrimitiveOffset;
+
+void main()
+{
+    FragId = objectIdBase + meshPrimitiveOffset + uint(gl_PrimitiveID);
+}
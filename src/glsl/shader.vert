@@ -4,22 +4,39 @@ layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec4 aColor;
 layout (location = 3) in vec2 aTextCoord;
+layout (location = 4) in uint aDrawIndex;
+
+#include "draw_params.glsl"
 
 //uniform mat4 MVP;
 uniform mat4 modelMatrix;
 uniform mat4 viewMatrix;
 uniform mat4 projectionMatrix;
+uniform bool drawIndirect;
+uniform bool applyShading;
+uniform bool applyTexture;
 
 out vec3 normal;
 out vec4 color;
 out vec3 fragment;
 out vec2 textCoord;
+flat out int shadingEnabled;
+flat out int textureEnabled;
 
 void main()
 {
-	gl_Position = (projectionMatrix * viewMatrix * modelMatrix) * vec4(aPos, 1.0);
-	fragment = vec3(modelMatrix * vec4(aPos, 1.0f));
-	normal = transpose(inverse(mat3(modelMatrix))) * aNormal;
+	mat4 model = modelMatrix;
+	shadingEnabled = int(applyShading);
+	textureEnabled = int(applyTexture);
+	if (drawIndirect) {
+		DrawParams params = drawParams[aDrawIndex];
+		model = params.modelMatrix;
+		shadingEnabled = int((params.flags & 1u) != 0u);
+		textureEnabled = int((params.flags & 2u) != 0u);
+	}
+	gl_Position = (projectionMatrix * viewMatrix * model) * vec4(aPos, 1.0);
+	fragment = vec3(model * vec4(aPos, 1.0f));
+	normal = transpose(inverse(mat3(model))) * aNormal;
 	color = aColor;
 	textCoord = aTextCoord;
 }
\ No newline at end of file
@@ -0,0 +1,14 @@
+#version 440 core
+
+layout (location = 0) out uint VisibilityId;
+
+flat in uint drawIndex;
+
+// see VisibilityBuffer::triangle_bits
+const uint triangleBits = 20u;
+
+void main()
+{
+	// 0 is left for background
+	VisibilityId = ((drawIndex + 1u) << triangleBits) | uint(gl_PrimitiveID);
+}
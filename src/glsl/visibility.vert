@@ -0,0 +1,17 @@
+#version 440 core
+
+layout (location = 0) in vec3 aPos;
+layout (location = 4) in uint aDrawIndex;
+
+#include "draw_params.glsl"
+
+uniform mat4 viewMatrix;
+uniform mat4 projectionMatrix;
+
+flat out uint drawIndex;
+
+void main()
+{
+	gl_Position = (projectionMatrix * viewMatrix * drawParams[aDrawIndex].modelMatrix) * vec4(aPos, 1.0);
+	drawIndex = aDrawIndex;
+}
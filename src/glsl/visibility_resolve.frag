@@ -0,0 +1,91 @@
+#version 440 core
+
+out vec4 fragColor;
+
+#include "draw_params.glsl"
+#include "lighting.glsl"
+
+// geometry arena, see GeometryArena and Vertex
+layout (std430, binding = 4) readonly buffer VerticesBuffer
+{
+	float vertices[];
+};
+layout (std430, binding = 5) readonly buffer IndicesBuffer
+{
+	uint indices[];
+};
+
+uniform sampler2D _texture;
+uniform usampler2D visibilityIds;
+uniform sampler2D visibilityDepth;
+uniform mat4 projectionMatrix;
+// draws which use texture bound for this pass
+uniform uint firstDraw;
+uniform uint drawCount;
+
+// see VisibilityBuffer::triangle_bits
+const uint triangleBits = 20u;
+const int vertexSize = 12;
+
+vec3 readVec3(int offset) { return vec3(vertices[offset], vertices[offset + 1], vertices[offset + 2]); }
+
+// perspective correct barycentric coordinates of point in normalized device coordinates
+vec3 barycentrics(vec4 c0, vec4 c1, vec4 c2, vec2 p)
+{
+	vec2 p0 = c0.xy / c0.w, p1 = c1.xy / c1.w, p2 = c2.xy / c2.w;
+	float det = (p1.y - p2.y) * (p0.x - p2.x) + (p2.x - p1.x) * (p0.y - p2.y);
+	float l0 = ((p1.y - p2.y) * (p.x - p2.x) + (p2.x - p1.x) * (p.y - p2.y)) / det;
+	float l1 = ((p2.y - p0.y) * (p.x - p2.x) + (p0.x - p2.x) * (p.y - p2.y)) / det;
+	vec3 b = vec3(l0, l1, 1.0 - l0 - l1) / vec3(c0.w, c1.w, c2.w);
+	return b / (b.x + b.y + b.z);
+}
+
+void main()
+{
+	ivec2 pixel = ivec2(gl_FragCoord.xy);
+	uint id = texelFetch(visibilityIds, pixel, 0).r;
+	uint draw = (id >> triangleBits) - 1u;
+	if (id == 0u || draw < firstDraw || draw >= firstDraw + drawCount)
+		discard;
+	uint triangle = id & ((1u << triangleBits) - 1u);
+	DrawParams params = drawParams[draw];
+
+	int v[3];
+	vec4 clip[3];
+	for (int k = 0; k < 3; k++) {
+		v[k] = (params.baseVertex + int(indices[params.firstIndex + 3u * triangle + uint(k)])) * vertexSize;
+		clip[k] = projectionMatrix * viewMatrix * params.modelMatrix * vec4(readVec3(v[k]), 1.0);
+	}
+	vec2 ndc = gl_FragCoord.xy / screenSize * 2.0 - 1.0;
+	vec3 b = barycentrics(clip[0], clip[1], clip[2], ndc);
+
+	vec3 position = b.x * readVec3(v[0]) + b.y * readVec3(v[1]) + b.z * readVec3(v[2]);
+	vec3 fragment = vec3(params.modelMatrix * vec4(position, 1.0));
+	vec4 color = vec4(0.0);
+	for (int k = 0; k < 3; k++) {
+		color += b[k] * vec4(vertices[v[k] + 6], vertices[v[k] + 7], vertices[v[k] + 8], vertices[v[k] + 9]);
+	}
+
+	if ((params.flags & 1u) != 0u) {
+		vec3 normal = b.x * readVec3(v[0] + 3) + b.y * readVec3(v[1] + 3) + b.z * readVec3(v[2] + 3);
+		normal = transpose(inverse(mat3(params.modelMatrix))) * normal;
+		fragColor = vec4(computeLighting(fragment, normal) * color.rgb, color.a);
+	} else {
+		fragColor = color;
+	}
+	if ((params.flags & 2u) != 0u) {
+		// neighbouring pixels may belong to other triangles, so derivatives are taken analytically
+		vec2 uv[3];
+		for (int k = 0; k < 3; k++) {
+			uv[k] = vec2(vertices[v[k] + 10], vertices[v[k] + 11]);
+		}
+		vec2 pixelSize = 2.0 / screenSize;
+		vec3 bx = barycentrics(clip[0], clip[1], clip[2], ndc + vec2(pixelSize.x, 0.0));
+		vec3 by = barycentrics(clip[0], clip[1], clip[2], ndc + vec2(0.0, pixelSize.y));
+		vec2 textCoord = b.x * uv[0] + b.y * uv[1] + b.z * uv[2];
+		vec2 textCoordX = bx.x * uv[0] + bx.y * uv[1] + bx.z * uv[2];
+		vec2 textCoordY = by.x * uv[0] + by.y * uv[1] + by.z * uv[2];
+		fragColor *= textureGrad(_texture, textCoord, textCoordX - textCoord, textCoordY - textCoord);
+	}
+	gl_FragDepth = texelFetch(visibilityDepth, pixel, 0).r;
+}
@@ -0,0 +1,99 @@
+#include <cassert>
+#include <iterator>
+#include <algorithm>
+#include "RangeAllocator.hpp"
+
+void RangeAllocator::reset(uint32_t capacity)
+{
+  reset(capacity, 0);
+}
+
+void RangeAllocator::reset(uint32_t capacity, uint32_t used)
+{
+  assert(used <= capacity);
+  m_free.clear();
+  m_capacity = capacity;
+  m_used = used;
+  if (used < capacity)
+    m_free.emplace(used, capacity - used);
+}
+
+std::optional<uint32_t> RangeAllocator::allocate(uint32_t size)
+{
+  if (size == 0)
+    return std::nullopt;
+  auto best = m_free.end();
+  for (auto it = m_free.begin(); it != m_free.end(); ++it)
+  {
+    if (it->second >= size && (best == m_free.end() || it->second < best->second))
+    {
+      best = it;
+      if (best->second == size)
+        break;
+    }
+  }
+  if (best == m_free.end())
+    return std::nullopt;
+  const uint32_t offset = best->first;
+  const uint32_t remaining = best->second - size;
+  m_free.erase(best);
+  if (remaining)
+    m_free.emplace(offset + size, remaining);
+  m_used += size;
+  return offset;
+}
+
+void RangeAllocator::free(uint32_t offset, uint32_t size)
+{
+  if (size == 0)
+    return;
+  assert(offset + size <= m_capacity && size <= m_used);
+  m_used -= size;
+  auto next = m_free.lower_bound(offset);
+  assert(next == m_free.end() || next->first >= offset + size);
+  // merge with previous free range
+  if (next != m_free.begin())
+  {
+    auto prev = std::prev(next);
+    assert(prev->first + prev->second <= offset);
+    if (prev->first + prev->second == offset)
+    {
+      offset = prev->first;
+      size += prev->second;
+      m_free.erase(prev);
+    }
+  }
+  // merge with next free range
+  if (next != m_free.end() && next->first == offset + size)
+  {
+    size += next->second;
+    m_free.erase(next);
+  }
+  m_free.emplace(offset, size);
+}
+
+void RangeAllocator::grow(uint32_t new_capacity)
+{
+  assert(new_capacity >= m_capacity);
+  const uint32_t old_capacity = m_capacity;
+  m_capacity = new_capacity;
+  m_used += new_capacity - old_capacity;
+  // freeing the tail merges it with the last free range
+  free(old_capacity, new_capacity - old_capacity);
+}
+
+uint32_t RangeAllocator::largest_free_range() const
+{
+  uint32_t largest = 0;
+  for (const auto& [offset, size] : m_free)
+    largest = std::max(largest, size);
+  return largest;
+}
+
+float RangeAllocator::fragmentation() const
+{
+  const uint32_t free_total = m_capacity - m_used;
+  if (free_total == 0)
+    return 0.f;
+  return 1.f - (float)largest_free_range() / free_total;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <map>
+#include <optional>
+#include <cstdint>
+
+// Sub-allocates ranges of [0, capacity) units, e.g. elements of GPU buffer.
+// Free ranges are kept sorted by offset, so freed range is merged with its neighbours immediately.
+class RangeAllocator
+{
+public:
+  RangeAllocator() = default;
+  explicit RangeAllocator(uint32_t capacity) { reset(capacity); }
+  // everything becomes free
+  void reset(uint32_t capacity);
+  // makes [0, used) allocated and the rest free. used by compaction which packs all ranges to the beginning
+  void reset(uint32_t capacity, uint32_t used);
+  // best fit, so large free ranges aren't split by small allocations. returns offset
+  std::optional<uint32_t> allocate(uint32_t size);
+  void free(uint32_t offset, uint32_t size);
+  // extends capacity, new space is free
+  void grow(uint32_t new_capacity);
+  uint32_t capacity() const { return m_capacity; }
+  uint32_t used() const { return m_used; }
+  uint32_t largest_free_range() const;
+  // 0 when all free space is a single range, close to 1 when it's split into many small ones
+  float fragmentation() const;
+private:
+  std::map<uint32_t, uint32_t> m_free;  // offset, size
+  uint32_t m_capacity = 0;
+  uint32_t m_used = 0;
+};
@@ -0,0 +1,18 @@
+#pragma once
+
+// SSE is part of the x64 baseline for both MSVC and GCC/Clang, so it's used directly where available
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OPENGL_ENGINE_SSE 1
+#include <xmmintrin.h>
+#include <emmintrin.h>
+#else
+#define OPENGL_ENGINE_SSE 0
+#endif
+
+// AVX is not part of the baseline, so it's used only when compiler targets it (/arch:AVX or -mavx)
+#if defined(__AVX__)
+#define OPENGL_ENGINE_AVX 1
+#include <immintrin.h>
+#else
+#define OPENGL_ENGINE_AVX 0
+#endif
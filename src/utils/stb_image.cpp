@@ -1,2 +1,7 @@
+#include "./core/MemoryProfiler.hpp"
+// image data is counted by memory profiler
+#define STBI_MALLOC(size) MemoryProfiler::malloc(size)
+#define STBI_REALLOC(ptr, size) MemoryProfiler::realloc(ptr, size)
+#define STBI_FREE(ptr) MemoryProfiler::free(ptr)
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
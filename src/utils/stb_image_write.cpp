@@ -0,0 +1,6 @@
+#include "./core/MemoryProfiler.hpp"
+#define STBIW_MALLOC(size) MemoryProfiler::malloc(size)
+#define STBIW_REALLOC(ptr, size) MemoryProfiler::realloc(ptr, size)
+#define STBIW_FREE(ptr) MemoryProfiler::free(ptr)
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "stb_image_write.h"
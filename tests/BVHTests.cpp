@@ -0,0 +1,172 @@
+#include "ge/BVH.hpp"
+#include "gtest/gtest.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <random>
+#include <set>
+
+namespace
+{
+	std::vector<BoundingBox> random_boxes(int n, unsigned seed)
+	{
+		std::mt19937 rng(seed);
+		std::uniform_real_distribution<float> pos(-50.f, 50.f), ext(0.05f, 2.f);
+		std::vector<BoundingBox> boxes;
+		for (int i = 0; i < n; i++)
+		{
+			glm::vec3 c(pos(rng), pos(rng), pos(rng));
+			glm::vec3 e(ext(rng), ext(rng), ext(rng));
+			boxes.emplace_back(c - e, c + e);
+		}
+		return boxes;
+	}
+
+	bool overlaps(const BoundingBox& a, const BoundingBox& b)
+	{
+		return a.min().x <= b.max().x && a.max().x >= b.min().x &&
+			a.min().y <= b.max().y && a.max().y >= b.min().y &&
+			a.min().z <= b.max().z && a.max().z >= b.min().z;
+	}
+
+	struct BVHFixture : ::testing::Test
+	{
+		void SetUp() override
+		{
+			boxes = random_boxes(2000, 7);
+			for (int i = 0; i < (int)boxes.size(); i++)
+				proxies.push_back(bvh.create_proxy(boxes[i], i));
+		}
+		DynamicBVH bvh;
+		std::vector<BoundingBox> boxes;
+		std::vector<int> proxies;
+	};
+}
+
+TEST_F(BVHFixture, StructureIsValid)
+{
+	EXPECT_TRUE(bvh.validate());
+	EXPECT_EQ(bvh.proxy_count(), 2000);
+	// balanced by rotations
+	EXPECT_LT(bvh.height(), 40);
+	bvh.rebuild();
+	EXPECT_TRUE(bvh.validate());
+	EXPECT_EQ(bvh.proxy_count(), 2000);
+}
+
+TEST_F(BVHFixture, AABBQueryMatchesBruteForce)
+{
+	BoundingBox query(glm::vec3(-10.f, -5.f, -20.f), glm::vec3(15.f, 5.f, 0.f));
+	std::set<int> found;
+	bvh.query(query, [&found](int user) { found.insert(user); return true; });
+	for (int i = 0; i < (int)boxes.size(); i++)
+	{
+		// tree stores fat boxes, so it may report more, but never less
+		if (overlaps(boxes[i], query))
+		{
+			EXPECT_TRUE(found.count(i)) << i;
+		}
+	}
+	for (int user : found)
+		EXPECT_TRUE(overlaps(BoundingBox(bvh.fat_bbox(proxies[user]).min, bvh.fat_bbox(proxies[user]).max), query));
+}
+
+TEST_F(BVHFixture, SphereQueryMatchesBruteForce)
+{
+	const glm::vec3 center(3.f, -2.f, 7.f);
+	const float radius = 12.f;
+	std::set<int> found;
+	bvh.query(center, radius, [&found](int user) { found.insert(user); return true; });
+	for (int i = 0; i < (int)boxes.size(); i++)
+	{
+		const glm::vec3 closest = glm::clamp(center, boxes[i].min(), boxes[i].max());
+		if (glm::length(closest - center) <= radius)
+		{
+			EXPECT_TRUE(found.count(i)) << i;
+		}
+	}
+}
+
+TEST_F(BVHFixture, FrustumQueryMatchesBruteForce)
+{
+	glm::mat4 proj = glm::perspective(glm::radians(45.f), 16.f / 9.f, 0.1f, 60.f);
+	glm::mat4 view = glm::lookAt(glm::vec3(0.f, 0.f, 40.f), glm::vec3(10.f, 0.f, 0.f), glm::vec3(0.f, 1.f, 0.f));
+	Frustum frustum(proj * view);
+	std::set<int> found;
+	bvh.query(frustum, [&found](int user, bool) { found.insert(user); });
+	for (int i = 0; i < (int)boxes.size(); i++)
+	{
+		if (frustum.intersects(boxes[i]))
+		{
+			EXPECT_TRUE(found.count(i)) << i;
+		}
+	}
+	EXPECT_LT(found.size(), boxes.size());
+}
+
+TEST_F(BVHFixture, RaycastFindsClosestHit)
+{
+	std::mt19937 rng(3);
+	std::uniform_real_distribution<float> dir(-1.f, 1.f);
+	for (int r = 0; r < 50; r++)
+	{
+		Ray ray(glm::vec3(0.f), glm::normalize(glm::vec3(dir(rng), dir(rng), dir(rng))));
+		const glm::vec3 inv = safe_inverse(ray.direction);
+		float expected = 1000.f;
+		for (const auto& b : boxes)
+		{
+			float t;
+			if (intersect_aabb(ray, inv, b.min(), b.max(), expected, t))
+				expected = std::min(expected, t);
+		}
+		float closest = 1000.f;
+		bvh.raycast(ray, 1000.f, [&](int user, const Ray& ray, float max_t)
+			{
+				float t;
+				if (intersect_aabb(ray, safe_inverse(ray.direction), boxes[user].min(), boxes[user].max(), max_t, t))
+				{
+					closest = std::min(closest, t);
+					return t;
+				}
+				return max_t;
+			});
+		EXPECT_FLOAT_EQ(closest, expected);
+	}
+}
+
+TEST_F(BVHFixture, MoveAndDestroyProxies)
+{
+	// small movement stays inside of fat box
+	BoundingBox moved(boxes[0].min() + glm::vec3(0.01f), boxes[0].max() + glm::vec3(0.01f));
+	EXPECT_FALSE(bvh.move_proxy(proxies[0], moved));
+	// large movement reinserts
+	moved = BoundingBox(boxes[1].min() + glm::vec3(30.f), boxes[1].max() + glm::vec3(30.f));
+	EXPECT_TRUE(bvh.move_proxy(proxies[1], moved));
+	EXPECT_TRUE(bvh.validate());
+
+	for (int i = 0; i < 1000; i += 2)
+		bvh.destroy_proxy(proxies[i]);
+	EXPECT_EQ(bvh.proxy_count(), 1500);
+	EXPECT_TRUE(bvh.validate());
+
+	std::set<int> found;
+	bvh.query(BoundingBox(glm::vec3(-100.f), glm::vec3(100.f)), [&found](int user) { found.insert(user); return true; });
+	EXPECT_EQ(found.size(), 1500u);
+	EXPECT_EQ(found.count(0), 0u);
+}
+
+TEST_F(BVHFixture, RebuildWhenQualityDegrades)
+{
+	bvh.rebuild();
+	const float cost_after_build = bvh.sah_cost();
+	// scatter objects around, incremental updates make tree worse
+	std::mt19937 rng(11);
+	std::uniform_real_distribution<float> offset(-40.f, 40.f);
+	for (int i = 0; i < (int)boxes.size(); i++)
+	{
+		glm::vec3 d(offset(rng), offset(rng), offset(rng));
+		bvh.move_proxy(proxies[i], BoundingBox(boxes[i].min() + d, boxes[i].max() + d));
+	}
+	bvh.set_rebuild_threshold(1.f);
+	bvh.optimize();
+	EXPECT_TRUE(bvh.validate());
+	EXPECT_LE(bvh.sah_cost(), cost_after_build * 1.5f);
+}
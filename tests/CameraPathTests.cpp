@@ -0,0 +1,71 @@
+#include "core/CameraPath.hpp"
+#include "gtest/gtest.h"
+#include <fstream>
+#include <cstdio>
+
+namespace
+{
+	void expect_near(const glm::vec3& a, const glm::vec3& b)
+	{
+		EXPECT_NEAR(a.x, b.x, 1e-4f);
+		EXPECT_NEAR(a.y, b.y, 1e-4f);
+		EXPECT_NEAR(a.z, b.z, 1e-4f);
+	}
+}
+
+TEST(CameraPathTests, PassesThroughKeyframes)
+{
+	const CameraPath path({
+		{ 2.f, glm::vec3(4.f, 1.f, 0.f), glm::vec3(0.f) },
+		{ 0.f, glm::vec3(0.f, 1.f, 4.f), glm::vec3(0.f) },
+		{ 1.f, glm::vec3(3.f, 2.f, 3.f), glm::vec3(1.f, 0.f, 0.f) },
+	});
+	EXPECT_EQ(path.duration(), 2.f);
+	for (const CameraPath::Keyframe& key : path.keyframes())
+	{
+		expect_near(path.position(key.time), key.position);
+		expect_near(path.target(key.time), key.target);
+	}
+	// stays at end points outside of keyframes
+	expect_near(path.position(-1.f), glm::vec3(0.f, 1.f, 4.f));
+	expect_near(path.position(5.f), glm::vec3(4.f, 1.f, 0.f));
+}
+
+TEST(CameraPathTests, OrbitKeepsDistanceToCenter)
+{
+	const glm::vec3 center(1.f, 0.f, -2.f);
+	const CameraPath path = CameraPath::orbit(center, 10.f, 3.f, 6.f);
+	EXPECT_EQ(path.duration(), 6.f);
+	expect_near(path.position(0.f), path.position(6.f));
+	for (float t = 0.f; t <= 6.f; t += 0.1f)
+	{
+		const glm::vec3 offset = path.position(t) - center;
+		EXPECT_NEAR(glm::length(glm::vec2(offset.x, offset.z)), 10.f, 0.1f);
+		EXPECT_NEAR(offset.y, 3.f, 1e-4f);
+		expect_near(path.target(t), center);
+	}
+}
+
+TEST(CameraPathTests, LoadsKeyframesFromFile)
+{
+	const char* filename = "camera_path_test.txt";
+	{
+		std::ofstream file(filename);
+		file << "# time position target\n"
+			<< "0 0 1 5  0 0 0\n"
+			<< "\n"
+			<< "2.5 5 1 0  0 0.5 0  # end\n";
+	}
+	const std::optional<CameraPath> path = CameraPath::load(filename);
+	ASSERT_TRUE(path);
+	ASSERT_EQ(path->keyframes().size(), 2);
+	EXPECT_EQ(path->duration(), 2.5f);
+	expect_near(path->target(2.5f), glm::vec3(0.f, 0.5f, 0.f));
+	{
+		std::ofstream file(filename);
+		file << "0 0 1 5\n";
+	}
+	EXPECT_FALSE(CameraPath::load(filename));
+	std::remove(filename);
+	EXPECT_FALSE(CameraPath::load(filename));
+}
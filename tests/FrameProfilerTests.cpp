@@ -0,0 +1,82 @@
+#include "core/FrameProfiler.hpp"
+#include "support/HeadlessContext.hpp"
+#include "gtest/gtest.h"
+#include <memory>
+
+namespace
+{
+	// timer queries need real context, machines without OpenGL 4.4 skip these tests
+	struct FrameProfilerFixture : ::testing::Test
+	{
+		static void SetUpTestSuite()
+		{
+			context = std::make_unique<HeadlessContext>("FrameProfilerTests");
+		}
+
+		static void TearDownTestSuite()
+		{
+			context.reset();
+		}
+
+		void SetUp() override
+		{
+			if (!context->available())
+				GTEST_SKIP() << "OpenGL 4.4 context is not available";
+		}
+
+		static std::unique_ptr<HeadlessContext> context;
+	};
+
+	std::unique_ptr<HeadlessContext> FrameProfilerFixture::context;
+}
+
+TEST(FrameProfilerTests, HistoryKeepsLastValues)
+{
+	FrameProfiler::History history;
+	EXPECT_EQ(history.average(), 0.f);
+	for (int i = 1; i <= FrameProfiler::history_size + 10; i++)
+		history.push((float)i);
+	EXPECT_EQ(history.count, FrameProfiler::history_size);
+	EXPECT_EQ(history.last(), FrameProfiler::history_size + 10.f);
+	EXPECT_EQ(history.values[history.next], 11.f);
+	EXPECT_EQ(history.min(), 11.f);
+	EXPECT_EQ(history.max(), FrameProfiler::history_size + 10.f);
+	EXPECT_FLOAT_EQ(history.average(), (11.f + FrameProfiler::history_size + 10.f) * 0.5f);
+}
+
+TEST_F(FrameProfilerFixture, MeasuresPassesWhichRan)
+{
+	FrameProfiler profiler;
+	GLuint buffer;
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	constexpr int frames = 10;
+	for (int frame = 0; frame < frames; frame++)
+	{
+		profiler.begin_frame();
+		profiler.begin_pass(0, "upload");
+		glBufferData(GL_ARRAY_BUFFER, 1024, nullptr, GL_STREAM_DRAW);
+		profiler.end_pass(0);
+		// second pass runs every other frame only
+		if (frame % 2 == 0)
+		{
+			profiler.begin_pass(2, "clear");
+			glClearBufferData(GL_ARRAY_BUFFER, GL_R32F, GL_RED, GL_FLOAT, nullptr);
+			profiler.end_pass(2);
+		}
+		profiler.end_frame();
+	}
+	glFinish();
+	profiler.begin_frame();
+	ASSERT_EQ(profiler.passes().size(), 3);
+	EXPECT_EQ(profiler.passes()[0].name, "upload");
+	EXPECT_EQ(profiler.passes()[0].cpu_ms.count, frames);
+	// results of frames GPU was too far behind on are dropped, not waited for
+	EXPECT_EQ(profiler.passes()[0].gpu_ms.count + profiler.passes()[0].gpu_dropped, frames);
+	EXPECT_GE(profiler.passes()[0].gpu_ms.min(), 0.f);
+	EXPECT_EQ(profiler.passes()[1].cpu_ms.count, 0);
+	EXPECT_EQ(profiler.passes()[2].cpu_ms.count, frames / 2);
+	EXPECT_EQ(profiler.passes()[2].gpu_ms.count + profiler.passes()[2].gpu_dropped, frames / 2);
+	EXPECT_EQ(glGetError(), GL_NO_ERROR);
+	glDeleteBuffers(1, &buffer);
+}
@@ -0,0 +1,40 @@
+#include "core/FrameRecorder.hpp"
+#include "gtest/gtest.h"
+#include <sstream>
+
+TEST(FrameRecorderTests, SummarizesNearestRankPercentiles)
+{
+	std::vector<double> values;
+	for (int i = 100; i >= 1; i--)
+		values.push_back(i);
+	const FrameRecorder::Summary s = FrameRecorder::summarize(values);
+	EXPECT_EQ(s.count, 100);
+	EXPECT_DOUBLE_EQ(s.mean, 50.5);
+	EXPECT_EQ(s.p50, 50.0);
+	EXPECT_EQ(s.p95, 95.0);
+	EXPECT_EQ(s.p99, 99.0);
+	EXPECT_EQ(s.max, 100.0);
+	EXPECT_EQ(FrameRecorder::summarize({ 7.0 }).p99, 7.0);
+	EXPECT_EQ(FrameRecorder::summarize({}).count, 0);
+}
+
+TEST(FrameRecorderTests, WritesJson)
+{
+	FrameRecorder recorder;
+	recorder.set_info("scene", "models/\"a\".obj");
+	recorder.set_info("frames", 3);
+	recorder.record("gpu_frame_ms", 2.0);
+	recorder.record("cpu_frame_ms", 1.0);
+	recorder.record("gpu_frame_ms", 4.0);
+	ASSERT_TRUE(recorder.samples("gpu_frame_ms"));
+	EXPECT_EQ(recorder.samples("gpu_frame_ms")->size(), 2);
+	EXPECT_FALSE(recorder.samples("draw_calls"));
+	std::ostringstream os;
+	recorder.write_json(os);
+	const std::string json = os.str();
+	EXPECT_NE(json.find("\"scene\": \"models/\\\"a\\\".obj\""), std::string::npos);
+	EXPECT_NE(json.find("\"frames\": 3"), std::string::npos);
+	// in order of first record
+	EXPECT_LT(json.find("gpu_frame_ms"), json.find("cpu_frame_ms"));
+	EXPECT_NE(json.find("\"gpu_frame_ms\": { \"count\": 2, \"mean\": 3, \"p50\": 2, \"p95\": 4, \"p99\": 4, \"max\": 4 }"), std::string::npos);
+}
@@ -0,0 +1,79 @@
+#include "ge/Frustum.hpp"
+#include "gtest/gtest.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <random>
+
+namespace
+{
+	Frustum make_frustum()
+	{
+		// camera at origin looking down -z
+		glm::mat4 proj = glm::perspective(glm::radians(45.f), 16.f / 9.f, 0.1f, 100.f);
+		glm::mat4 view = glm::lookAt(glm::vec3(0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec3(0.f, 1.f, 0.f));
+		return Frustum(proj * view);
+	}
+}
+
+TEST(FrustumTest, AABBInsideAndOutside)
+{
+	Frustum f = make_frustum();
+	EXPECT_TRUE(f.intersects(BoundingBox(glm::vec3(-1.f, -1.f, -6.f), glm::vec3(1.f, 1.f, -4.f))));
+	// behind the camera
+	EXPECT_FALSE(f.intersects(BoundingBox(glm::vec3(-1.f, -1.f, 4.f), glm::vec3(1.f, 1.f, 6.f))));
+	// beyond far plane
+	EXPECT_FALSE(f.intersects(BoundingBox(glm::vec3(-1.f, -1.f, -200.f), glm::vec3(1.f, 1.f, -150.f))));
+	// far to the left
+	EXPECT_FALSE(f.intersects(BoundingBox(glm::vec3(-60.f, -1.f, -6.f), glm::vec3(-50.f, 1.f, -4.f))));
+	// intersects near plane
+	EXPECT_TRUE(f.intersects(BoundingBox(glm::vec3(-1.f, -1.f, -1.f), glm::vec3(1.f, 1.f, 1.f))));
+}
+
+TEST(FrustumTest, Sphere)
+{
+	Frustum f = make_frustum();
+	EXPECT_TRUE(f.intersects(glm::vec3(0.f, 0.f, -10.f), 1.f));
+	EXPECT_FALSE(f.intersects(glm::vec3(0.f, 0.f, 10.f), 1.f));
+	EXPECT_TRUE(f.intersects(glm::vec3(0.f, 0.f, 10.f), 11.f));
+}
+
+TEST(FrustumTest, BatchedCullMatchesSingleTests)
+{
+	Frustum f = make_frustum();
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> pos(-80.f, 80.f), ext(0.01f, 3.f);
+	std::vector<BoundingBox> boxes;
+	BoundsSoA soa;
+	// not a multiple of 4 to cover remainder
+	for (int i = 0; i < 1003; i++)
+	{
+		glm::vec3 c(pos(rng), pos(rng), pos(rng));
+		glm::vec3 e(ext(rng), ext(rng), ext(rng));
+		boxes.emplace_back(c - e, c + e);
+		soa.push_back(boxes.back());
+	}
+	std::vector<uint8_t> visible;
+	size_t nvisible = f.cull(soa, visible);
+	ASSERT_EQ(visible.size(), boxes.size());
+	size_t expected_visible = 0;
+	for (size_t i = 0; i < boxes.size(); i++)
+	{
+		EXPECT_EQ((bool)visible[i], f.intersects(boxes[i])) << "box " << i;
+		expected_visible += f.intersects(boxes[i]);
+	}
+	EXPECT_EQ(nvisible, expected_visible);
+	EXPECT_GT(nvisible, 0u);
+	EXPECT_LT(nvisible, boxes.size());
+}
+
+TEST(FrustumTest, TransformedBoundingBox)
+{
+	BoundingBox bbox(glm::vec3(-1.f), glm::vec3(1.f));
+	glm::mat4 m = glm::translate(glm::mat4(1.f), glm::vec3(10.f, 0.f, 0.f));
+	m = glm::rotate(m, glm::radians(45.f), glm::vec3(0.f, 1.f, 0.f));
+	BoundingBox world = bbox.transformed(m);
+	const float half_diag = std::sqrt(2.f);
+	EXPECT_NEAR(world.min().x, 10.f - half_diag, 1e-4f);
+	EXPECT_NEAR(world.max().x, 10.f + half_diag, 1e-4f);
+	EXPECT_NEAR(world.min().y, -1.f, 1e-4f);
+	EXPECT_NEAR(world.max().z, half_diag, 1e-4f);
+}
@@ -0,0 +1,142 @@
+#include "core/GPUCuller.hpp"
+#include "ge/Cube.hpp"
+#include "ge/Frustum.hpp"
+#include "support/HeadlessContext.hpp"
+#include "gtest/gtest.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <memory>
+#include <random>
+
+namespace
+{
+	// compute shaders need real context, machines without OpenGL 4.4 skip these tests
+	struct GPUCullerFixture : ::testing::Test
+	{
+		static void SetUpTestSuite()
+		{
+			context = std::make_unique<HeadlessContext>("GPUCullerTests");
+		}
+
+		static void TearDownTestSuite()
+		{
+			context.reset();
+		}
+
+		void SetUp() override
+		{
+			if (!context->available())
+				GTEST_SKIP() << "OpenGL 4.4 context is not available";
+			renderer = std::make_unique<IndirectRenderer>();
+			culler = std::make_unique<GPUCuller>();
+			if (!culler->is_supported())
+				GTEST_SKIP() << "compute shaders are not supported";
+		}
+
+		void TearDown() override
+		{
+			culler.reset();
+			renderer.reset();
+			objects.clear();
+		}
+
+		void add_cube(const glm::vec3& position, const glm::vec3& scale)
+		{
+			auto cube = std::make_unique<Cube>();
+			cube->translate(position);
+			cube->scale(scale);
+			renderer->add_object();
+			renderer->upload((int)objects.size(), *cube);
+			objects.push_back(std::move(cube));
+		}
+
+		void build()
+		{
+			renderer->begin_frame();
+			for (int i = 0; i < (int)objects.size(); i++)
+				renderer->submit(i, *objects[i]);
+			culler->build(*renderer, objects);
+		}
+
+		// smallest signed distance of box to frustum planes, negative if box is outside
+		static float frustum_margin(const Frustum& frustum, const BoundingBox& bbox)
+		{
+			float margin = 1e9f;
+			for (int i = 0; i < Frustum::PLANE_COUNT; i++)
+			{
+				const glm::vec4& p = frustum.plane(static_cast<Frustum::Plane>(i));
+				const glm::vec3 e = bbox.extents();
+				const float r = e.x * std::abs(p.x) + e.y * std::abs(p.y) + e.z * std::abs(p.z);
+				margin = std::min(margin, glm::dot(glm::vec3(p), bbox.center()) + p.w + r);
+			}
+			return margin;
+		}
+
+		inline static std::unique_ptr<HeadlessContext> context;
+		std::unique_ptr<IndirectRenderer> renderer;
+		std::unique_ptr<GPUCuller> culler;
+		std::vector<std::unique_ptr<Object3D>> objects;
+	};
+}
+
+TEST_F(GPUCullerFixture, MatchesCpuFrustumCulling)
+{
+	std::mt19937 rng(5);
+	std::uniform_real_distribution<float> pos(-60.f, 60.f), size(0.2f, 4.f);
+	for (int i = 0; i < 700; i++)
+		add_cube(glm::vec3(pos(rng), pos(rng), pos(rng)), glm::vec3(size(rng), size(rng), size(rng)));
+	build();
+	ASSERT_EQ(culler->draw_count(), objects.size());
+
+	const glm::mat4 projection = glm::perspective(glm::radians(45.f), 16.f / 9.f, 0.1f, 100.f);
+	const glm::vec3 targets[] = { glm::vec3(0.f), glm::vec3(30.f, 0.f, 0.f), glm::vec3(-10.f, 40.f, 5.f) };
+	for (const glm::vec3& target : targets)
+	{
+		const glm::mat4 view_projection = projection * glm::lookAt(glm::vec3(-20.f, 5.f, 50.f), target, glm::vec3(0.f, 1.f, 0.f));
+		culler->cull(view_projection);
+		std::vector<uint8_t> visible;
+		culler->read_visible(visible);
+		ASSERT_EQ(visible.size(), objects.size());
+
+		const Frustum frustum(view_projection);
+		int nvisible = 0;
+		for (size_t draw = 0; draw < visible.size(); draw++)
+		{
+			const BoundingBox bbox = objects[culler->draw_sources()[draw].object]->world_bbox();
+			nvisible += visible[draw];
+			// boxes touching planes may go either way because of float precision
+			if (std::abs(frustum_margin(frustum, bbox)) < 1e-3f)
+				continue;
+			EXPECT_EQ((bool)visible[draw], frustum.intersects(bbox)) << draw;
+		}
+		EXPECT_GT(nvisible, 0);
+		EXPECT_LT(nvisible, (int)objects.size());
+	}
+}
+
+TEST_F(GPUCullerFixture, RebuildPicksUpChanges)
+{
+	const glm::mat4 view_projection = glm::perspective(glm::radians(60.f), 1.f, 0.1f, 100.f);
+	build();
+	culler->cull(view_projection);
+	std::vector<uint8_t> visible;
+	culler->read_visible(visible);
+	EXPECT_TRUE(visible.empty());
+
+	// camera looks along -z
+	add_cube(glm::vec3(0.f, 0.f, -10.f), glm::vec3(1.f));
+	add_cube(glm::vec3(0.f, 0.f, 10.f), glm::vec3(1.f));
+	build();
+	culler->cull(view_projection);
+	culler->read_visible(visible);
+	ASSERT_EQ(visible.size(), 2u);
+	EXPECT_EQ(visible[0], 1);
+	EXPECT_EQ(visible[1], 0);
+
+	objects[0]->translate(glm::vec3(0.f, 0.f, 20.f));
+	build();
+	culler->cull(view_projection);
+	culler->read_visible(visible);
+	EXPECT_EQ(visible[0], 0);
+	EXPECT_EQ(visible[1], 0);
+}
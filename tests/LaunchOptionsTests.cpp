@@ -0,0 +1,95 @@
+#include "core/LaunchOptions.hpp"
+#include "gtest/gtest.h"
+#include <vector>
+
+namespace
+{
+	std::optional<std::string> parse(LaunchOptions& options, std::vector<const char*> args)
+	{
+		args.insert(args.begin(), "OpenGLEngine");
+		return options.parse((int)args.size(), args.data());
+	}
+}
+
+TEST(LaunchOptionsTests, Defaults)
+{
+	LaunchOptions options;
+	EXPECT_FALSE(parse(options, {}));
+	EXPECT_FALSE(options.headless);
+	EXPECT_EQ(options.scene, "default");
+	EXPECT_EQ(options.output_path(0), "frame.png");
+}
+
+TEST(LaunchOptionsTests, ParsesHeadlessRun)
+{
+	LaunchOptions options;
+	EXPECT_FALSE(parse(options, { "--headless", "--size", "320x200", "--scene", "cubes:64", "--camera", "-4,2.5,3",
+		"--look-at", "2,0.5,0.5", "--frames", "30", "--output", "out/thumb.png" }));
+	EXPECT_TRUE(options.headless);
+	EXPECT_EQ(options.width, 320);
+	EXPECT_EQ(options.height, 200);
+	EXPECT_EQ(options.scene, "cubes:64");
+	ASSERT_TRUE(options.camera_position);
+	EXPECT_EQ(*options.camera_position, glm::vec3(-4.f, 2.5f, 3.f));
+	ASSERT_TRUE(options.camera_target);
+	EXPECT_EQ(*options.camera_target, glm::vec3(2.f, 0.5f, 0.5f));
+	EXPECT_EQ(options.frames, 30);
+	// only the last frame is written
+	EXPECT_EQ(options.output_path(0), "");
+	EXPECT_EQ(options.output_path(29), "out/thumb.png");
+}
+
+TEST(LaunchOptionsTests, NumbersFramesWrittenPeriodically)
+{
+	LaunchOptions options;
+	EXPECT_FALSE(parse(options, { "--frames", "25", "--output", "out.v2/frame.png", "--output-every", "10" }));
+	EXPECT_EQ(options.output_path(0), "out.v2/frame_0000.png");
+	EXPECT_EQ(options.output_path(5), "");
+	EXPECT_EQ(options.output_path(20), "out.v2/frame_0020.png");
+	EXPECT_EQ(options.output_path(24), "out.v2/frame_0024.png");
+	options.output = "out.v2/frame";
+	EXPECT_EQ(options.output_path(10), "out.v2/frame_0010.png");
+}
+
+TEST(LaunchOptionsTests, ParsesAllocationCheck)
+{
+	LaunchOptions options;
+	EXPECT_EQ(options.max_frame_allocations, -1);
+	EXPECT_FALSE(parse(options, { "--helper-lines", "--warmup", "30", "--max-frame-allocations", "0" }));
+	EXPECT_TRUE(options.helper_lines);
+	EXPECT_EQ(options.warmup_frames, 30);
+	EXPECT_EQ(options.max_frame_allocations, 0);
+}
+
+TEST(LaunchOptionsTests, ParsesMeshCache)
+{
+	LaunchOptions options;
+	EXPECT_EQ(options.mesh_cache, "cache/meshes");
+	EXPECT_FALSE(parse(options, { "--mesh-cache", "/tmp/meshes" }));
+	EXPECT_EQ(options.mesh_cache, "/tmp/meshes");
+	EXPECT_FALSE(parse(options, { "--no-mesh-cache" }));
+	EXPECT_TRUE(options.mesh_cache.empty());
+}
+
+TEST(LaunchOptionsTests, RejectsInvalidArguments)
+{
+	const std::vector<std::vector<const char*>> invalid =
+	{
+		{ "--bogus" },
+		{ "--frames" },
+		{ "--frames", "0" },
+		{ "--frames", "ten" },
+		{ "--size", "320" },
+		{ "--size", "320x-1" },
+		{ "--camera", "1,2" },
+		{ "--scene", "cubes:x" },
+		{ "--output", "" },
+		{ "--max-frame-allocations", "-1" },
+		{ "--mesh-cache", "" },
+	};
+	for (const auto& args : invalid)
+	{
+		LaunchOptions options;
+		EXPECT_TRUE(parse(options, args)) << args[0];
+	}
+}
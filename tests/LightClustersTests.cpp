@@ -0,0 +1,120 @@
+#include "ge/LightClusters.hpp"
+#include "gtest/gtest.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace
+{
+	std::vector<glm::vec4> random_lights(int n, unsigned seed)
+	{
+		std::mt19937 rng(seed);
+		std::uniform_real_distribution<float> xy(-40.f, 40.f), depth(-5.f, 110.f), radius(0.5f, 8.f);
+		std::vector<glm::vec4> lights;
+		for (int i = 0; i < n; i++)
+			lights.emplace_back(xy(rng), xy(rng), -depth(rng), radius(rng));
+		return lights;
+	}
+
+	bool sphere_intersects_box(const glm::vec4& s, const glm::vec3& bmin, const glm::vec3& bmax)
+	{
+		const glm::vec3 c(s);
+		const glm::vec3 d = c - glm::clamp(c, bmin, bmax);
+		return glm::dot(d, d) <= s.w * s.w;
+	}
+
+	struct LightClustersFixture : ::testing::Test
+	{
+		void SetUp() override
+		{
+			projection = glm::perspective(glm::radians(45.f), 16.f / 9.f, 0.1f, 100.f);
+			clusters.set_projection(projection);
+			lights = random_lights(400, 9);
+		}
+		glm::mat4 projection;
+		LightClusters clusters;
+		std::vector<glm::vec4> lights;
+	};
+}
+
+TEST_F(LightClustersFixture, ProjectionParameters)
+{
+	EXPECT_NEAR(clusters.znear(), 0.1f, 1e-4f);
+	EXPECT_NEAR(clusters.zfar(), 100.f, 1e-2f);
+	EXPECT_EQ(clusters.slice(0.05f), 0);
+	EXPECT_EQ(clusters.slice(0.11f), 0);
+	EXPECT_EQ(clusters.slice(99.f), LightClusters::grid_z - 1);
+	// slices grow exponentially
+	glm::vec3 near_min, near_max, far_min, far_max;
+	clusters.cluster_bounds(0, 0, 1, near_min, near_max);
+	clusters.cluster_bounds(0, 0, LightClusters::grid_z - 1, far_min, far_max);
+	EXPECT_LT(near_max.z - near_min.z, far_max.z - far_min.z);
+}
+
+TEST_F(LightClustersFixture, MatchesBruteForce)
+{
+	clusters.build(lights, 1);
+	for (int z = 0; z < LightClusters::grid_z; z++)
+	{
+		for (int y = 0; y < LightClusters::grid_y; y++)
+		{
+			for (int x = 0; x < LightClusters::grid_x; x++)
+			{
+				glm::vec3 bmin, bmax;
+				clusters.cluster_bounds(x, y, z, bmin, bmax);
+				std::vector<uint32_t> expected;
+				for (uint32_t i = 0; i < lights.size(); i++)
+				{
+					if (sphere_intersects_box(lights[i], bmin, bmax))
+						expected.push_back(i);
+				}
+				const LightClusters::Cluster& c = clusters.clusters()[LightClusters::cluster_index(x, y, z)];
+				ASSERT_LT(expected.size(), (size_t)LightClusters::max_lights_per_cluster);
+				std::vector<uint32_t> found(clusters.light_indices().begin() + c.offset, clusters.light_indices().begin() + c.offset + c.count);
+				EXPECT_EQ(found, expected) << x << ' ' << y << ' ' << z;
+			}
+		}
+	}
+}
+
+TEST_F(LightClustersFixture, ThreadsGiveSameResult)
+{
+	clusters.build(lights, 1);
+	const auto single_clusters = clusters.clusters();
+	const auto single_indices = clusters.light_indices();
+	clusters.build(lights, 5);
+	ASSERT_EQ(clusters.light_indices(), single_indices);
+	for (int c = 0; c < LightClusters::cluster_count; c++)
+	{
+		EXPECT_EQ(clusters.clusters()[c].offset, single_clusters[c].offset);
+		EXPECT_EQ(clusters.clusters()[c].count, single_clusters[c].count);
+	}
+}
+
+TEST_F(LightClustersFixture, FragmentFindsEveryLightCoveringIt)
+{
+	clusters.build(lights);
+	std::mt19937 rng(4);
+	std::uniform_real_distribution<float> ndc(-0.999f, 0.999f), depth(0.2f, 99.f);
+	for (int k = 0; k < 2000; k++)
+	{
+		// cluster is found the same way as in fragment shader
+		const glm::vec2 p(ndc(rng), ndc(rng));
+		const float d = depth(rng);
+		const glm::vec3 view(p.x * d / projection[0][0], p.y * d / projection[1][1], -d);
+		const int x = std::min((int)((p.x * 0.5f + 0.5f) * LightClusters::grid_x), LightClusters::grid_x - 1);
+		const int y = std::min((int)((p.y * 0.5f + 0.5f) * LightClusters::grid_y), LightClusters::grid_y - 1);
+		const int z = std::clamp((int)std::floor(std::log(d) * clusters.slice_scale() + clusters.slice_bias()), 0, LightClusters::grid_z - 1);
+		const LightClusters::Cluster& c = clusters.clusters()[LightClusters::cluster_index(x, y, z)];
+		const auto begin = clusters.light_indices().begin() + c.offset;
+		const auto end = begin + c.count;
+		for (uint32_t i = 0; i < lights.size(); i++)
+		{
+			if (glm::length(view - glm::vec3(lights[i])) < lights[i].w)
+			{
+				EXPECT_NE(std::find(begin, end, i), end) << k << ' ' << i;
+			}
+		}
+	}
+}
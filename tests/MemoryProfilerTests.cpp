@@ -0,0 +1,86 @@
+#include "core/MemoryProfiler.hpp"
+#include "gtest/gtest.h"
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+	struct alignas(64) Aligned
+	{
+		float values[16];
+	};
+}
+
+TEST(MemoryProfilerTests, AttributesAllocationsToTags)
+{
+	ASSERT_TRUE(MemoryProfiler::enabled());
+	const MemoryProfiler::Snapshot start = MemoryProfiler::snapshot();
+	std::vector<int> general(10);
+	std::vector<char> meshes, loader;
+	{
+		MemoryTagScope tag(MemoryTag::MESHES);
+		meshes.reserve(1000);
+		{
+			MemoryTagScope inner(MemoryTag::LOADER);
+			loader.reserve(300);
+		}
+	}
+	std::unique_ptr<Aligned> aligned(new Aligned);
+	const bool aligned_ok = reinterpret_cast<uintptr_t>(aligned.get()) % 64 == 0;
+	// memory is counted by tag which allocated it, not the one current when it's freed
+	{
+		MemoryTagScope tag(MemoryTag::UI);
+		std::vector<char>().swap(loader);
+	}
+	const MemoryProfiler::Snapshot diff = MemoryProfiler::difference(start, MemoryProfiler::snapshot());
+
+	EXPECT_TRUE(aligned_ok);
+	EXPECT_EQ(general.size(), 10);
+	EXPECT_EQ(diff[MemoryTag::MESHES].allocations, 1);
+	EXPECT_EQ(diff[MemoryTag::MESHES].live_bytes(), 1000);
+	EXPECT_EQ(diff[MemoryTag::LOADER].allocations, 1);
+	EXPECT_EQ(diff[MemoryTag::LOADER].frees, 1);
+	EXPECT_EQ(diff[MemoryTag::LOADER].live_bytes(), 0);
+	EXPECT_EQ(diff[MemoryTag::UI].allocations, 0);
+	EXPECT_EQ(diff[MemoryTag::GENERAL].allocations, 2);
+	EXPECT_EQ(diff[MemoryTag::GENERAL].live_bytes(), 10 * sizeof(int) + sizeof(Aligned));
+	EXPECT_EQ(diff.total.allocations, 4);
+	EXPECT_GE(diff.total.peak_bytes, 1300);
+}
+
+TEST(MemoryProfilerTests, TracksMallocOfCLibraries)
+{
+	const MemoryProfiler::Snapshot start = MemoryProfiler::snapshot();
+	MemoryTagScope tag(MemoryTag::TEXTURES);
+	char* data = static_cast<char*>(MemoryProfiler::malloc(16));
+	std::memcpy(data, "0123456789abcdef", 16);
+	data = static_cast<char*>(MemoryProfiler::realloc(data, 64));
+	const bool kept = std::memcmp(data, "0123456789abcdef", 16) == 0;
+	const MemoryProfiler::Counters grown = MemoryProfiler::difference(start, MemoryProfiler::snapshot())[MemoryTag::TEXTURES];
+	MemoryProfiler::free(data);
+	const MemoryProfiler::Counters freed = MemoryProfiler::difference(start, MemoryProfiler::snapshot())[MemoryTag::TEXTURES];
+	EXPECT_TRUE(kept);
+	EXPECT_EQ(grown.allocations, 2);
+	EXPECT_EQ(grown.live_bytes(), 64);
+	EXPECT_EQ(freed.frees, 2);
+	EXPECT_EQ(freed.live_bytes(), 0);
+}
+
+TEST(MemoryProfilerTests, DumpsDifferenceOfSnapshots)
+{
+	std::ostringstream os;
+	MemoryProfiler::make_memory_snapshot();
+	MemoryProfiler::make_memory_snapshot();
+	EXPECT_EQ(MemoryProfiler::dump(os), MemoryProfiler::eNoMemoryLeaks);
+	std::vector<int>* leak = nullptr;
+	{
+		MemoryTagScope tag(MemoryTag::LOADER);
+		leak = new std::vector<int>(100);
+	}
+	MemoryProfiler::make_memory_snapshot();
+	EXPECT_EQ(MemoryProfiler::dump(os), MemoryProfiler::eExistMemoryLeaks);
+	EXPECT_NE(os.str().find("loader: 2, 0, " + std::to_string(sizeof(std::vector<int>) + 100 * sizeof(int))), std::string::npos) << os.str();
+	delete leak;
+}
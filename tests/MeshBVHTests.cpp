@@ -0,0 +1,240 @@
+#include "ge/MeshBVH.hpp"
+#include "gtest/gtest.h"
+#include <random>
+#include <sstream>
+
+namespace
+{
+	struct MeshBVHFixture : ::testing::Test
+	{
+		void SetUp() override
+		{
+			// random triangle soup with some clustering, so tree has both dense and sparse regions
+			std::mt19937 rng(5);
+			std::uniform_real_distribution<float> pos(-10.f, 10.f), off(-0.6f, 0.6f);
+			for (int i = 0; i < 5000; i++)
+			{
+				const glm::vec3 c = i % 2 ? glm::vec3(pos(rng), pos(rng), pos(rng)) : glm::vec3(pos(rng), pos(rng), pos(rng)) * 0.2f;
+				const GLuint base = (GLuint)vertices.size();
+				for (int k = 0; k < 3; k++)
+					vertices.emplace_back(c + glm::vec3(off(rng), off(rng), off(rng)));
+				faces.push_back(Face{ base, base + 1, base + 2 });
+			}
+			bvh = MeshBVH(vertices, faces);
+		}
+
+		MeshBVH::Hit brute_force(const Ray& ray, float max_t) const
+		{
+			MeshBVH::Hit hit;
+			for (size_t i = 0; i < faces.size(); i++)
+			{
+				float t, u, v;
+				if (intersect_triangle(ray, vertices[faces[i].data[0]].position, vertices[faces[i].data[1]].position,
+					vertices[faces[i].data[2]].position, max_t, t, u, v))
+				{
+					max_t = t;
+					hit.triangle = (int)i;
+					hit.t = t;
+					hit.barycentric = glm::vec2(u, v);
+				}
+			}
+			return hit;
+		}
+
+		std::vector<Ray> random_rays(int n, unsigned seed) const
+		{
+			std::mt19937 rng(seed);
+			std::uniform_real_distribution<float> dir(-1.f, 1.f), jitter(-0.05f, 0.05f);
+			std::vector<Ray> rays;
+			// groups of 8 nearly parallel rays, as in packets of neighbouring pixels
+			for (int i = 0; i < n; i += 8)
+			{
+				const glm::vec3 origin(dir(rng) * 15.f, dir(rng) * 15.f, 20.f);
+				const glm::vec3 target(dir(rng) * 5.f, dir(rng) * 5.f, dir(rng) * 5.f);
+				for (int k = 0; k < 8; k++)
+					rays.emplace_back(origin, glm::normalize(target - origin + glm::vec3(jitter(rng), jitter(rng), jitter(rng))));
+			}
+			return rays;
+		}
+
+		std::vector<Vertex> vertices;
+		std::vector<Face> faces;
+		MeshBVH bvh;
+	};
+}
+
+TEST_F(MeshBVHFixture, Layout)
+{
+	EXPECT_EQ(sizeof(MeshBVH::Node), 32u);
+	EXPECT_EQ(bvh.triangle_count(), faces.size());
+	// every internal node is followed by its left child and right child comes later
+	const auto& nodes = bvh.nodes();
+	for (size_t i = 0; i < nodes.size(); i++)
+	{
+		if (nodes[i].is_leaf())
+		{
+			EXPECT_LE(nodes[i].count, MeshBVH::max_leaf_size);
+		}
+		else
+		{
+			EXPECT_GT(nodes[i].offset, i + 1);
+			for (size_t child : { i + 1, (size_t)nodes[i].offset })
+			{
+				for (int c = 0; c < 3; c++)
+				{
+					EXPECT_LE(nodes[i].bmin[c], nodes[child].bmin[c]);
+					EXPECT_GE(nodes[i].bmax[c], nodes[child].bmax[c]);
+				}
+			}
+		}
+	}
+}
+
+TEST_F(MeshBVHFixture, RaycastMatchesBruteForce)
+{
+	int hits = 0;
+	for (const Ray& ray : random_rays(400, 1))
+	{
+		const MeshBVH::Hit expected = brute_force(ray, 100.f);
+		MeshBVH::Hit actual;
+		EXPECT_EQ(bvh.raycast(ray, 100.f, actual), expected.triangle >= 0);
+		ASSERT_EQ(actual.triangle, expected.triangle);
+		if (expected.triangle >= 0)
+		{
+			EXPECT_FLOAT_EQ(actual.t, expected.t);
+			EXPECT_FLOAT_EQ(actual.barycentric.x, expected.barycentric.x);
+			EXPECT_FLOAT_EQ(actual.barycentric.y, expected.barycentric.y);
+			hits++;
+		}
+	}
+	EXPECT_GT(hits, 100);
+}
+
+TEST_F(MeshBVHFixture, PacketsMatchSingleRays)
+{
+	const std::vector<Ray> rays = random_rays(400, 2);
+	std::vector<float> max_t(rays.size(), 100.f);
+	// limit some rays, so packet lanes finish at different distances
+	for (size_t i = 0; i < max_t.size(); i += 3)
+		max_t[i] = 18.f;
+	for (size_t i = 0; i < rays.size(); i += 8)
+	{
+		MeshBVH::Hit hits4[8], hits8[8];
+		bvh.raycast4(&rays[i], &max_t[i], hits4);
+		bvh.raycast4(&rays[i + 4], &max_t[i + 4], hits4 + 4);
+		bvh.raycast8(&rays[i], &max_t[i], hits8);
+		for (int k = 0; k < 8; k++)
+		{
+			MeshBVH::Hit expected;
+			bvh.raycast(rays[i + k], max_t[i + k], expected);
+			EXPECT_EQ(hits4[k].triangle, expected.triangle);
+			EXPECT_EQ(hits8[k].triangle, expected.triangle);
+			if (expected.triangle >= 0)
+			{
+				EXPECT_NEAR(hits4[k].t, expected.t, 1e-4f);
+				EXPECT_NEAR(hits8[k].t, expected.t, 1e-4f);
+				EXPECT_NEAR(hits8[k].barycentric.x, expected.barycentric.x, 1e-4f);
+			}
+		}
+	}
+}
+
+TEST_F(MeshBVHFixture, ClosestPointMatchesBruteForce)
+{
+	std::mt19937 rng(3);
+	std::uniform_real_distribution<float> pos(-12.f, 12.f);
+	for (int i = 0; i < 100; i++)
+	{
+		const glm::vec3 p(pos(rng), pos(rng), pos(rng));
+		MeshBVH::ClosestPoint result;
+		ASSERT_TRUE(bvh.closest_point(p, 1000.f, result));
+		// any point of a triangle is not closer than the found one
+		float best = std::numeric_limits<float>::max();
+		for (size_t f = 0; f < faces.size(); f++)
+		{
+			MeshBVH single(vertices, { faces[f] });
+			MeshBVH::ClosestPoint cp;
+			single.closest_point(p, 1000.f, cp);
+			best = std::min(best, cp.distance);
+		}
+		EXPECT_NEAR(result.distance, best, 1e-4f);
+		EXPECT_NEAR(glm::length(result.point - p), result.distance, 1e-4f);
+	}
+	MeshBVH::ClosestPoint result;
+	EXPECT_FALSE(bvh.closest_point(glm::vec3(100.f), 1.f, result));
+}
+
+TEST_F(MeshBVHFixture, SerializationRoundTrip)
+{
+	std::stringstream ss;
+	bvh.serialize(ss);
+	MeshBVH loaded;
+	ASSERT_TRUE(loaded.deserialize(ss));
+	EXPECT_EQ(loaded.nodes().size(), bvh.nodes().size());
+	for (const Ray& ray : random_rays(64, 4))
+	{
+		MeshBVH::Hit a, b;
+		bvh.raycast(ray, 100.f, a);
+		loaded.raycast(ray, 100.f, b);
+		EXPECT_EQ(a.triangle, b.triangle);
+	}
+	std::stringstream garbage("not a bvh");
+	EXPECT_FALSE(loaded.deserialize(garbage));
+	EXPECT_TRUE(loaded.empty());
+}
+
+TEST_F(MeshBVHFixture, DeserializeRejectsTooDeepTree)
+{
+	// chain of internal nodes with leaf as left child, deeper than any built tree and traversal stack
+	const int levels = 200;
+	std::vector<MeshBVH::Node> nodes;
+	for (int i = 0; i < levels; i++)
+	{
+		const uint32_t index = (uint32_t)nodes.size();
+		nodes.push_back({ glm::vec3(-1.f), index + 2, glm::vec3(1.f), 0, 0 });
+		nodes.push_back({ glm::vec3(-1.f), 0, glm::vec3(1.f), 1, 0 });
+	}
+	nodes.push_back({ glm::vec3(-1.f), 0, glm::vec3(1.f), 1, 0 });
+	std::stringstream ss;
+	bvh.serialize(ss);
+	// same header and triangles as valid tree, only nodes are replaced
+	uint32_t header[4];
+	ss.read(reinterpret_cast<char*>(header), sizeof(header));
+	ss.seekg(sizeof(header) + sizeof(MeshBVH::Node) * header[2]);
+	const std::string rest(std::istreambuf_iterator<char>(ss), {});
+	header[2] = (uint32_t)nodes.size();
+	std::stringstream chain;
+	chain.write(reinterpret_cast<const char*>(header), sizeof(header));
+	chain.write(reinterpret_cast<const char*>(nodes.data()), sizeof(MeshBVH::Node) * nodes.size());
+	chain << rest;
+	MeshBVH loaded;
+	EXPECT_FALSE(loaded.deserialize(chain));
+	EXPECT_TRUE(loaded.empty());
+}
+
+TEST(MeshBVHTest, ParallelBuildOfLargeMesh)
+{
+	// grid large enough to be built on several threads
+	std::vector<Vertex> vertices;
+	std::vector<Face> faces;
+	const int n = 200;
+	for (int y = 0; y <= n; y++)
+		for (int x = 0; x <= n; x++)
+			vertices.emplace_back((float)x, (float)y, 0.f);
+	for (int y = 0; y < n; y++)
+	{
+		for (int x = 0; x < n; x++)
+		{
+			const GLuint i = y * (n + 1) + x;
+			faces.push_back(Face{ i, i + 1, i + n + 2 });
+			faces.push_back(Face{ i, i + n + 2, i + n + 1 });
+		}
+	}
+	MeshBVH bvh(vertices, faces);
+	EXPECT_EQ(bvh.triangle_count(), faces.size());
+	MeshBVH::Hit hit;
+	ASSERT_TRUE(bvh.raycast(Ray(glm::vec3(10.25f, 20.75f, 5.f), glm::vec3(0.f, 0.f, -1.f)), 10.f, hit));
+	EXPECT_FLOAT_EQ(hit.t, 5.f);
+	// upper triangle of cell (10, 20)
+	EXPECT_EQ(hit.triangle, (20 * n + 10) * 2 + 1);
+}
@@ -0,0 +1,121 @@
+#include "core/MeshCache.hpp"
+#include "gtest/gtest.h"
+#include <filesystem>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+	struct MeshCacheFixture : ::testing::Test
+	{
+		void SetUp() override
+		{
+			directory = fs::temp_directory_path() / "opengl_engine_mesh_cache_test";
+			fs::remove_all(directory);
+			source = (directory / "model.obj").string();
+			fs::create_directories(directory);
+			write_source("source of two meshes");
+			cache = std::make_unique<MeshCache>((directory / "cache").string());
+
+			// meshes with different sizes of faces
+			Mesh& quad = model.mesh(0);
+			quad.append_vertex(Vertex(glm::vec3(0.f, 0.f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(1.f, 0.f, 0.f, 1.f), glm::vec2(0.f, 0.f)));
+			quad.append_vertex(Vertex(glm::vec3(1.f, 0.f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(1.f, 0.f, 0.f, 1.f), glm::vec2(1.f, 0.f)));
+			quad.append_vertex(Vertex(glm::vec3(1.f, 2.f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(1.f, 0.f, 0.f, 1.f), glm::vec2(1.f, 1.f)));
+			quad.append_vertex(Vertex(glm::vec3(0.f, 2.f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(1.f, 0.f, 0.f, 1.f), glm::vec2(0.f, 1.f)));
+			quad.append_face(Face({ 0, 1, 2, 3 }));
+			model.meshes().emplace_back();
+			Mesh& triangle = model.mesh(1);
+			triangle.append_vertex(Vertex(-1.f, 0.f, 0.f));
+			triangle.append_vertex(Vertex(0.f, -3.f, 0.f));
+			triangle.append_vertex(Vertex(0.f, 0.f, 5.f));
+			triangle.append_face(Face({ 2, 1, 0 }));
+		}
+
+		void TearDown() override
+		{
+			std::error_code error;
+			fs::remove_all(directory, error);
+		}
+
+		void write_source(const std::string& content)
+		{
+			std::ofstream out(source, std::ios::binary | std::ios::trunc);
+			out << content;
+		}
+
+		fs::path directory;
+		std::string source;
+		std::unique_ptr<MeshCache> cache;
+		ComplexModel model;
+	};
+}
+
+TEST_F(MeshCacheFixture, LoadsStoredMeshes)
+{
+	EXPECT_FALSE(cache->load(source, 1));
+	ASSERT_TRUE(cache->store(source, 1, model));
+	std::optional<ComplexModel> loaded = cache->load(source, 1);
+	ASSERT_TRUE(loaded);
+	ASSERT_EQ(loaded->meshes().size(), 2u);
+	for (size_t i = 0; i < 2; i++)
+	{
+		const Mesh& expected = model.mesh(i);
+		const Mesh& mesh = loaded->mesh(i);
+		ASSERT_EQ(mesh.vertices().size(), expected.vertices().size());
+		for (size_t v = 0; v < mesh.vertices().size(); v++)
+		{
+			EXPECT_EQ(mesh.vertices()[v].position, expected.vertices()[v].position);
+			EXPECT_EQ(mesh.vertices()[v].color, expected.vertices()[v].color);
+			EXPECT_EQ(mesh.vertices()[v].texture, expected.vertices()[v].texture);
+		}
+		EXPECT_EQ(mesh.faces_as_indices(), expected.faces_as_indices());
+		EXPECT_EQ(mesh.faces().size(), expected.faces().size());
+	}
+	EXPECT_EQ(loaded->mesh(1).bbox().min(), glm::vec3(-1.f, -3.f, 0.f));
+	EXPECT_EQ(loaded->mesh(1).bbox().max(), glm::vec3(0.f, 0.f, 5.f));
+	// entry of other import flags
+	EXPECT_FALSE(cache->load(source, 2));
+}
+
+TEST_F(MeshCacheFixture, ChangedSourceInvalidatesEntry)
+{
+	ASSERT_TRUE(cache->store(source, 1, model));
+	// same content with other time is still valid
+	fs::last_write_time(source, fs::last_write_time(source) + std::chrono::hours(1));
+	EXPECT_TRUE(cache->load(source, 1));
+	EXPECT_TRUE(cache->load(source, 1));
+	// same size, different content
+	write_source("source of two meshez");
+	fs::last_write_time(source, fs::last_write_time(source) + std::chrono::hours(2));
+	EXPECT_FALSE(cache->load(source, 1));
+	write_source("longer source of two meshes");
+	EXPECT_FALSE(cache->load(source, 1));
+}
+
+TEST_F(MeshCacheFixture, RejectsDamagedEntries)
+{
+	ASSERT_TRUE(cache->store(source, 1, model));
+	const std::string entry = cache->entry_path(source, 1);
+	// last index of triangle points past its three vertices, header and sizes are intact
+	{
+		std::fstream file(entry, std::ios::in | std::ios::out | std::ios::binary);
+		file.seekp(fs::file_size(entry) - sizeof(GLuint));
+		const GLuint index = 3;
+		file.write(reinterpret_cast<const char*>(&index), sizeof(index));
+	}
+	EXPECT_FALSE(cache->load(source, 1));
+	ASSERT_TRUE(cache->store(source, 1, model));
+	EXPECT_TRUE(cache->load(source, 1));
+	fs::resize_file(entry, fs::file_size(entry) - 4);
+	EXPECT_FALSE(cache->load(source, 1));
+	{
+		std::ofstream out(entry, std::ios::binary | std::ios::trunc);
+		out << "OEMC";
+	}
+	EXPECT_FALSE(cache->load(source, 1));
+	// mixed sizes of faces in one mesh aren't stored
+	model.mesh(1).append_face(Face({ 0, 1, 2, 0 }));
+	EXPECT_FALSE(cache->store(source, 1, model));
+}
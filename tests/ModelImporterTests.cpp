@@ -0,0 +1,79 @@
+#include "core/ModelImporter.hpp"
+#include "gtest/gtest.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	// quad of two triangles
+	std::string write_obj(const std::string& name)
+	{
+		const std::string filename = (std::filesystem::temp_directory_path() / name).string();
+		std::ofstream out(filename);
+		out << "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nf 1 2 3\nf 1 3 4\n";
+		return filename;
+	}
+
+	// collects results until count of them arrived or time ran out
+	std::vector<ModelImporter::Result> wait_for(ModelImporter& importer, size_t count)
+	{
+		std::vector<ModelImporter::Result> results, taken;
+		const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+		while (results.size() < count && std::chrono::steady_clock::now() < deadline)
+		{
+			if (importer.take_finished(taken))
+			{
+				for (auto& result : taken)
+					results.push_back(std::move(result));
+			}
+			else
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		return results;
+	}
+}
+
+TEST(ModelImporterTest, ConcurrentImportsFinishWithModels)
+{
+	const unsigned int flags = aiProcess_Triangulate | aiProcess_GenBoundingBoxes;
+	const std::string filename = write_obj("opengl_engine_importer_test.obj");
+	ModelImporter importer(2);
+	for (int i = 0; i < 5; i++)
+		importer.import(filename, flags);
+	importer.import(filename + ".missing", flags);
+
+	const std::vector<ModelImporter::Result> results = wait_for(importer, 6);
+	ASSERT_EQ(results.size(), 6u);
+	int loaded = 0;
+	for (const auto& result : results)
+	{
+		if (!result.model)
+		{
+			EXPECT_EQ(result.filename, filename + ".missing");
+			continue;
+		}
+		loaded++;
+		ASSERT_EQ(result.model->meshes().size(), 1u);
+		EXPECT_EQ(result.model->mesh(0).faces().size(), 2u);
+	}
+	EXPECT_EQ(loaded, 5);
+	EXPECT_FALSE(importer.busy());
+	std::vector<ModelImporter::Result> taken;
+	EXPECT_FALSE(importer.take_finished(taken));
+}
+
+TEST(ModelImporterTest, LoaderReportsProgress)
+{
+	const std::string filename = write_obj("opengl_engine_importer_progress_test.obj");
+	ModelLoader::Progress progress;
+	ModelLoader loader;
+	std::optional<ComplexModel> model = loader.load(filename, aiProcess_Triangulate | aiProcess_GenBoundingBoxes, &progress);
+	ASSERT_TRUE(model);
+	EXPECT_GT(progress.bytes_total, 0u);
+	EXPECT_EQ(progress.bytes_parsed, progress.bytes_total);
+	EXPECT_EQ(progress.meshes_total, 1);
+	EXPECT_EQ(progress.meshes_converted, 1);
+}
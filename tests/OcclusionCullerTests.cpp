@@ -0,0 +1,186 @@
+#include "ge/OcclusionCuller.hpp"
+#include "gtest/gtest.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <random>
+
+namespace
+{
+	BoundingBox box(const glm::vec3& center, const glm::vec3& half_size)
+	{
+		return BoundingBox(center - half_size, center + half_size);
+	}
+
+	struct OcclusionCullerFixture : ::testing::Test
+	{
+		void SetUp() override
+		{
+			// camera at origin looking along -z
+			view_projection = glm::perspective(glm::radians(60.f), 2.f, 0.1f, 100.f);
+			culler.begin_frame(view_projection);
+		}
+		glm::mat4 view_projection;
+		OcclusionCuller culler;
+	};
+}
+
+TEST_F(OcclusionCullerFixture, EverythingVisibleWithoutOccluders)
+{
+	culler.finish_occluders();
+	EXPECT_TRUE(culler.is_visible(box(glm::vec3(0.f, 0.f, -10.f), glm::vec3(1.f))));
+	EXPECT_TRUE(culler.is_visible(box(glm::vec3(0.f, 0.f, -90.f), glm::vec3(0.1f))));
+	const int top = culler.level_count() - 1;
+	EXPECT_EQ(culler.level_size(top), glm::ivec2(1, 1));
+	EXPECT_EQ(culler.depth(top, 0, 0), 1.f);
+}
+
+TEST_F(OcclusionCullerFixture, WallHidesObjectsBehindIt)
+{
+	// wall 5 units away covering the middle of the screen
+	culler.add_occluder(box(glm::vec3(0.f, 0.f, -5.f), glm::vec3(2.f, 2.f, 0.1f)));
+	culler.finish_occluders();
+	EXPECT_GT(culler.polygon_count(), 0u);
+	EXPECT_LT(culler.depth(0, culler.width() / 2, culler.height() / 2), 1.f);
+	EXPECT_EQ(culler.depth(0, 0, 0), 1.f);
+
+	EXPECT_FALSE(culler.is_visible(box(glm::vec3(0.f, 0.f, -20.f), glm::vec3(1.f))));
+	EXPECT_FALSE(culler.is_visible(box(glm::vec3(0.5f, -0.5f, -8.f), glm::vec3(0.5f))));
+	// in front of wall
+	EXPECT_TRUE(culler.is_visible(box(glm::vec3(0.f, 0.f, -3.f), glm::vec3(0.5f))));
+	// behind wall, but sticks out from it
+	EXPECT_TRUE(culler.is_visible(box(glm::vec3(9.f, 0.f, -20.f), glm::vec3(1.5f))));
+	// wall itself is never hidden by itself
+	EXPECT_TRUE(culler.is_visible(box(glm::vec3(0.f, 0.f, -5.f), glm::vec3(2.f, 2.f, 0.1f))));
+}
+
+TEST_F(OcclusionCullerFixture, OccluderCrossingNearPlane)
+{
+	// floor below the camera which starts behind it, it is clipped by near plane
+	culler.add_occluder(box(glm::vec3(0.f, -1.f, -10.f), glm::vec3(10.f, 0.1f, 12.f)));
+	culler.finish_occluders();
+	EXPECT_FALSE(culler.is_visible(box(glm::vec3(0.f, -3.f, -6.f), glm::vec3(0.5f))));
+	EXPECT_TRUE(culler.is_visible(box(glm::vec3(0.f, 0.f, -6.f), glm::vec3(0.5f))));
+	// box around camera is always visible
+	EXPECT_TRUE(culler.is_visible(box(glm::vec3(0.f, -1.f, 0.f), glm::vec3(1.f))));
+}
+
+TEST_F(OcclusionCullerFixture, MeshOccluder)
+{
+	// quad made of one polygon face
+	Mesh quad;
+	quad.append_vertex(Vertex(-1.f, -1.f, 0.f));
+	quad.append_vertex(Vertex(1.f, -1.f, 0.f));
+	quad.append_vertex(Vertex(1.f, 1.f, 0.f));
+	quad.append_vertex(Vertex(-1.f, 1.f, 0.f));
+	quad.append_face(Face{ 0, 1, 2, 3 });
+	culler.add_occluder(quad, glm::translate(glm::mat4(1.f), glm::vec3(0.f, 0.f, -4.f)));
+	culler.finish_occluders();
+	EXPECT_EQ(culler.polygon_count(), 1u);
+	EXPECT_FALSE(culler.is_visible(box(glm::vec3(0.f, 0.f, -12.f), glm::vec3(1.f))));
+	EXPECT_TRUE(culler.is_visible(box(glm::vec3(0.f, 3.f, -12.f), glm::vec3(1.f))));
+}
+
+TEST_F(OcclusionCullerFixture, TrianglesOfQuadAreJoined)
+{
+	// the same quad as two triangles, diagonal between them must not leave uncovered pixels
+	Mesh quad;
+	quad.append_vertex(Vertex(-1.f, -1.f, 0.f));
+	quad.append_vertex(Vertex(1.f, -1.f, 0.f));
+	quad.append_vertex(Vertex(1.f, 1.f, 0.f));
+	quad.append_vertex(Vertex(-1.f, 1.f, 0.f));
+	quad.append_face(Face{ 0, 1, 2 });
+	quad.append_face(Face{ 0, 2, 3 });
+	culler.add_occluder(quad, glm::translate(glm::mat4(1.f), glm::vec3(0.f, 0.f, -4.f)));
+	culler.finish_occluders();
+	EXPECT_EQ(culler.polygon_count(), 1u);
+	// small box right behind the center, where diagonal passes
+	EXPECT_FALSE(culler.is_visible(box(glm::vec3(0.f, 0.f, -12.f), glm::vec3(0.1f))));
+}
+
+TEST(OcclusionCullerTest, PartiallyCoveredPixelsAreNotWritten)
+{
+	// clip space is world space, wall ends at x = 128.7 of 256 pixels, i.e. after center of pixel 128
+	OcclusionCuller culler(256, 128);
+	culler.begin_frame(glm::mat4(1.f));
+	const float wall_end = 128.7f / 128.f - 1.f;
+	culler.add_occluder(BoundingBox(glm::vec3(-1.f, -1.f, -0.1f), glm::vec3(wall_end, 1.f, 0.1f)));
+	culler.finish_occluders();
+	EXPECT_EQ(culler.depth(0, 128, 64), 1.f);
+	EXPECT_LT(culler.depth(0, 127, 64), 1.f);
+	// behind the wall, but in part of pixel 128 which wall doesn't cover
+	const float x0 = 128.8f / 128.f - 1.f, x1 = 128.95f / 128.f - 1.f;
+	EXPECT_TRUE(culler.is_visible(BoundingBox(glm::vec3(x0, -0.01f, 0.4f), glm::vec3(x1, 0.01f, 0.6f))));
+	// the same box fully behind wall
+	EXPECT_FALSE(culler.is_visible(BoundingBox(glm::vec3(-0.5f, -0.01f, 0.4f), glm::vec3(-0.49f, 0.01f, 0.6f))));
+}
+
+TEST(OcclusionCullerTest, WrittenDepthIsFarthestInPixel)
+{
+	// wall tilted along x, its depth changes across every pixel
+	OcclusionCuller culler(256, 128);
+	culler.begin_frame(glm::mat4(1.f));
+	Mesh wall;
+	wall.append_vertex(Vertex(-1.f, -1.f, -0.5f));
+	wall.append_vertex(Vertex(1.f, -1.f, 0.5f));
+	wall.append_vertex(Vertex(1.f, 1.f, 0.5f));
+	wall.append_vertex(Vertex(-1.f, 1.f, -0.5f));
+	wall.append_face(Face{ 0, 1, 2, 3 });
+	culler.add_occluder(wall, glm::mat4(1.f));
+	culler.finish_occluders();
+	for (int x = 0; x < culler.width(); x++)
+	{
+		// depth of wall at right border of pixel
+		const float right = ((x + 1) / 128.f - 1.f) * 0.5f * 0.5f + 0.5f;
+		ASSERT_GE(culler.depth(0, x, 64), right - 1e-5f) << x;
+	}
+}
+
+TEST_F(OcclusionCullerFixture, HierarchyIsConservative)
+{
+	std::mt19937 rng(3);
+	std::uniform_real_distribution<float> xy(-15.f, 15.f), depth(4.f, 40.f), size(0.2f, 3.f);
+	for (int i = 0; i < 60; i++)
+		culler.add_occluder(box(glm::vec3(xy(rng), xy(rng), -depth(rng)), glm::vec3(size(rng), size(rng), size(rng))));
+	culler.finish_occluders();
+
+	// every level keeps the farthest depth of texels below it
+	for (int level = 1; level < culler.level_count(); level++)
+	{
+		const glm::ivec2 size = culler.level_size(level - 1);
+		for (int y = 0; y < size.y; y++)
+		{
+			for (int x = 0; x < size.x; x++)
+				ASSERT_GE(culler.depth(level, x / 2, y / 2), culler.depth(level - 1, x, y));
+		}
+	}
+
+	// object which is hidden has no pixel of its screen rectangle in front of occluders
+	int hidden = 0;
+	for (int i = 0; i < 2000; i++)
+	{
+		const BoundingBox b = box(glm::vec3(xy(rng), xy(rng), -depth(rng)), glm::vec3(size(rng) * 0.3f));
+		if (culler.is_visible(b))
+			continue;
+		hidden++;
+		glm::vec2 lo(1e9f), hi(-1e9f);
+		float nearest = 1.f;
+		for (const glm::vec3& p : b.points())
+		{
+			const glm::vec4 clip = view_projection * glm::vec4(p, 1.f);
+			lo = glm::min(lo, glm::vec2(clip) / clip.w);
+			hi = glm::max(hi, glm::vec2(clip) / clip.w);
+			nearest = std::min(nearest, clip.z / clip.w * 0.5f + 0.5f);
+		}
+		// outside of screen
+		if (hi.x < -1.f || hi.y < -1.f || lo.x > 1.f || lo.y > 1.f)
+			continue;
+		const glm::ivec2 size(culler.width(), culler.height());
+		const glm::ivec2 p0 = glm::clamp(glm::ivec2((lo * 0.5f + 0.5f) * glm::vec2(size)), glm::ivec2(0), size - 1);
+		const glm::ivec2 p1 = glm::clamp(glm::ivec2((hi * 0.5f + 0.5f) * glm::vec2(size)), glm::ivec2(0), size - 1);
+		for (int y = p0.y; y <= p1.y; y++)
+		{
+			for (int x = p0.x; x <= p1.x; x++)
+				ASSERT_GT(nearest, culler.depth(0, x, y)) << i;
+		}
+	}
+	EXPECT_GT(hidden, 0);
+}
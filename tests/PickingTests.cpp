@@ -0,0 +1,185 @@
+#include "ge/Picking.hpp"
+#include "ge/Cube.hpp"
+#include "ge/Icosahedron.hpp"
+#include "ge/Pyramid.hpp"
+#include "ge/Polyline.hpp"
+#include "ge/BezierCurve.hpp"
+#include "gtest/gtest.h"
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace
+{
+	constexpr int width = 1600;
+	constexpr int height = 900;
+	constexpr float line_pixels = 3.f;
+
+	// software version of what picking render pass does: the closest rasterized triangle
+	// or line within few pixels wins depth test
+	int reference_pick(const std::vector<std::unique_ptr<Object3D>>& objects, const glm::mat4& view_proj, const glm::vec2& pixel)
+	{
+		int result = -1;
+		float best_depth = 1.f;
+		auto to_screen = [&](const glm::mat4& mvp, const glm::vec3& pos, glm::vec3& out)
+			{
+				const glm::vec4 clip = mvp * glm::vec4(pos, 1.f);
+				if (clip.w <= 0.f)
+					return false;
+				const glm::vec3 ndc = glm::vec3(clip) / clip.w;
+				out = glm::vec3((ndc.x + 1.f) * 0.5f * width, (ndc.y + 1.f) * 0.5f * height, ndc.z);
+				return true;
+			};
+		for (int i = 0; i < (int)objects.size(); i++)
+		{
+			const Object3D& obj = *objects[i];
+			const glm::mat4 mvp = view_proj * obj.model_matrix();
+			for (const Mesh& mesh : obj.meshes())
+			{
+				const auto& vertices = mesh.vertices();
+				if (obj.has_surface())
+				{
+					for (const Face& face : mesh.faces())
+					{
+						glm::vec3 a, b, c;
+						if (!to_screen(mvp, vertices[face.data[0]].position, a) || !to_screen(mvp, vertices[face.data[1]].position, b) ||
+							!to_screen(mvp, vertices[face.data[2]].position, c))
+							continue;
+						const float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+						if (area == 0.f)
+							continue;
+						const float w0 = ((b.x - pixel.x) * (c.y - pixel.y) - (b.y - pixel.y) * (c.x - pixel.x)) / area;
+						const float w1 = ((c.x - pixel.x) * (a.y - pixel.y) - (c.y - pixel.y) * (a.x - pixel.x)) / area;
+						const float w2 = 1.f - w0 - w1;
+						if (w0 < 0.f || w1 < 0.f || w2 < 0.f)
+							continue;
+						// depth in NDC is affine in screen space
+						const float depth = w0 * a.z + w1 * b.z + w2 * c.z;
+						if (depth < best_depth)
+						{
+							best_depth = depth;
+							result = i;
+						}
+					}
+				}
+				else
+				{
+					for (size_t v = 1; v < vertices.size(); v++)
+					{
+						glm::vec3 a, b;
+						if (!to_screen(mvp, vertices[v - 1].position, a) || !to_screen(mvp, vertices[v].position, b))
+							continue;
+						const glm::vec2 ab = glm::vec2(b) - glm::vec2(a);
+						const float len2 = glm::dot(ab, ab);
+						const float u = len2 > 0.f ? glm::clamp(glm::dot(pixel - glm::vec2(a), ab) / len2, 0.f, 1.f) : 0.f;
+						if (glm::length(pixel - (glm::vec2(a) + ab * u)) > line_pixels)
+							continue;
+						const float depth = a.z + (b.z - a.z) * u;
+						if (depth < best_depth)
+						{
+							best_depth = depth;
+							result = i;
+						}
+					}
+				}
+			}
+		}
+		return result;
+	}
+
+	// same objects as default scene, but without textures
+	std::vector<std::unique_ptr<Object3D>> create_scene()
+	{
+		std::vector<std::unique_ptr<Object3D>> objects;
+		auto origin = std::make_unique<Polyline>();
+		origin->add(Vertex(0.f, 1.f, 0.f));
+		origin->add(Vertex(0.f, 0.f, 0.f));
+		origin->add(Vertex(1.f, 0.f, 0.f));
+		origin->add(Vertex(0.f, 0.f, 0.f));
+		origin->add(Vertex(0.f, 0.f, 1.f));
+		objects.push_back(std::move(origin));
+
+		auto sphere = std::make_unique<Icosahedron>();
+		sphere->translate(glm::vec3(2.5f, 0.5f, 2.f));
+		sphere->subdivide_triangles(2);
+		sphere->project_points_on_sphere();
+		sphere->scale(glm::vec3(0.3f));
+		objects.push_back(std::move(sphere));
+
+		auto c = std::make_unique<Cube>();
+		c->translate(glm::vec3(0.25f));
+		c->scale(glm::vec3(0.5f));
+		objects.push_back(std::move(c));
+
+		auto c2 = std::make_unique<Cube>();
+		c2->translate(glm::vec3(1.25f, 1.f, 1.f));
+		c2->set_model_matrix(glm::rotate(c2->model_matrix(), glm::radians(30.f), glm::normalize(glm::vec3(1.f, 1.f, 0.f))));
+		objects.push_back(std::move(c2));
+
+		auto pyr = std::make_unique<Pyramid>();
+		pyr->translate(glm::vec3(0.75f, 0.65f, 2.25f));
+		pyr->scale(glm::vec3(0.5f));
+		objects.push_back(std::move(pyr));
+
+		auto bc = std::make_unique<BezierCurve>(BezierCurve::Type::Quadratic);
+		bc->set_start_point(Vertex());
+		bc->set_end_point(Vertex(2.5f, 0.f, 0.f));
+		bc->set_control_points({ Vertex(1.25f, 2.f, 0.f) });
+		bc->tessellate();
+		objects.push_back(std::move(bc));
+
+		auto bc2 = std::make_unique<BezierCurve>(BezierCurve::Type::Cubic);
+		bc2->set_start_point(Vertex());
+		bc2->set_end_point(Vertex(0.f, 0.f, -2.5f));
+		bc2->set_control_points({ Vertex(0.f, 2.f, -1.25f), Vertex(0.f, -2.f, -1.75f) });
+		bc2->tessellate();
+		objects.push_back(std::move(bc2));
+		return objects;
+	}
+}
+
+TEST(PickingTest, RayFromScreenCenter)
+{
+	const glm::mat4 proj = glm::perspective(glm::radians(45.f), 16.f / 9.f, 0.1f, 100.f);
+	const glm::mat4 view = glm::lookAt(glm::vec3(0.f, 0.f, 5.f), glm::vec3(0.f), glm::vec3(0.f, 1.f, 0.f));
+	float max_t;
+	const Ray ray = ray_from_ndc(proj * view, glm::vec2(0.f), max_t);
+	EXPECT_NEAR(ray.origin.z, 4.9f, 1e-4f);
+	EXPECT_NEAR(ray.direction.z, -1.f, 1e-5f);
+	EXPECT_NEAR(max_t, 99.9f, 1e-2f);
+}
+
+TEST(PickingTest, MatchesRasterizedReference)
+{
+	auto objects = create_scene();
+	DynamicBVH bvh;
+	for (int i = 0; i < (int)objects.size(); i++)
+		bvh.create_proxy(objects[i]->world_bbox(), i);
+
+	// same camera as in default scene
+	const glm::mat4 proj = glm::perspective(glm::radians(45.f), (float)width / height, 0.1f, 100.f);
+	const glm::mat4 view = glm::lookAt(glm::vec3(-4.f, 2.f, 3.f), glm::vec3(2.f, 0.5f, 0.5f), glm::vec3(0.f, 1.f, 0.f));
+	const glm::mat4 view_proj = proj * view;
+	const float tolerance = line_pick_tolerance(proj, height, line_pixels);
+
+	int total = 0, agreed = 0;
+	std::vector<int> picked(objects.size(), 0);
+	for (int y = 0; y < height; y += 9)
+	{
+		for (int x = 0; x < width; x += 9)
+		{
+			const glm::vec2 pixel(x + 0.5f, y + 0.5f);
+			const glm::vec2 ndc(pixel.x / width * 2.f - 1.f, pixel.y / height * 2.f - 1.f);
+			float max_t;
+			const Ray ray = ray_from_ndc(view_proj, ndc, max_t);
+			const int expected = reference_pick(objects, view_proj, pixel);
+			const int actual = pick_object(bvh, objects, ray, max_t, tolerance).object;
+			total++;
+			agreed += expected == actual;
+			if (actual >= 0)
+				picked[actual]++;
+		}
+	}
+	// samples may disagree only exactly on edges of triangles and lines
+	EXPECT_GE(agreed, total * 99 / 100) << agreed << " of " << total;
+	for (size_t i = 0; i < objects.size(); i++)
+		EXPECT_GT(picked[i], 0) << objects[i]->name() << " is never picked";
+}
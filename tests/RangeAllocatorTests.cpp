@@ -0,0 +1,99 @@
+#include "utils/RangeAllocator.hpp"
+#include "gtest/gtest.h"
+#include <random>
+#include <vector>
+
+TEST(RangeAllocatorTest, AllocateAndMergeFreedRanges)
+{
+	RangeAllocator alloc(100);
+	auto a = alloc.allocate(10);
+	auto b = alloc.allocate(20);
+	auto c = alloc.allocate(30);
+	ASSERT_TRUE(a && b && c);
+	EXPECT_EQ(*a, 0u);
+	EXPECT_EQ(*b, 10u);
+	EXPECT_EQ(*c, 30u);
+	EXPECT_EQ(alloc.used(), 60u);
+	EXPECT_FALSE(alloc.allocate(41));
+
+	// freeing middle range and then its neighbours leaves single free range
+	alloc.free(*b, 20);
+	EXPECT_GT(alloc.fragmentation(), 0.f);
+	alloc.free(*a, 10);
+	alloc.free(*c, 30);
+	EXPECT_EQ(alloc.used(), 0u);
+	EXPECT_EQ(alloc.largest_free_range(), 100u);
+	EXPECT_FLOAT_EQ(alloc.fragmentation(), 0.f);
+}
+
+TEST(RangeAllocatorTest, BestFitKeepsLargeRanges)
+{
+	RangeAllocator alloc(100);
+	auto a = alloc.allocate(10);
+	auto b = alloc.allocate(5);
+	auto c = alloc.allocate(50);
+	alloc.free(*a, 10);
+	alloc.free(*c, 50);
+	// hole of 10 at the beginning fits better than 85 at the end
+	auto d = alloc.allocate(8);
+	ASSERT_TRUE(d);
+	EXPECT_EQ(*d, 0u);
+	EXPECT_EQ(alloc.largest_free_range(), 85u);
+	(void)b;
+}
+
+TEST(RangeAllocatorTest, GrowAndCompact)
+{
+	RangeAllocator alloc(64);
+	auto a = alloc.allocate(60);
+	ASSERT_TRUE(a);
+	EXPECT_FALSE(alloc.allocate(10));
+	alloc.grow(128);
+	auto b = alloc.allocate(10);
+	ASSERT_TRUE(b);
+	EXPECT_EQ(*b, 60u);
+	EXPECT_EQ(alloc.largest_free_range(), 58u);
+
+	alloc.reset(128, 70);
+	EXPECT_EQ(alloc.used(), 70u);
+	EXPECT_EQ(*alloc.allocate(58), 70u);
+	EXPECT_EQ(alloc.used(), 128u);
+	EXPECT_FLOAT_EQ(alloc.fragmentation(), 0.f);
+}
+
+TEST(RangeAllocatorTest, RandomAllocationsDontOverlap)
+{
+	constexpr uint32_t capacity = 4096;
+	RangeAllocator alloc(capacity);
+	std::mt19937 rng(5);
+	std::uniform_int_distribution<uint32_t> size(1, 64);
+	std::vector<std::pair<uint32_t, uint32_t>> live;
+	std::vector<int> owner(capacity, -1);
+	for (int i = 0; i < 5000; i++)
+	{
+		if (live.size() && rng() % 3 == 0)
+		{
+			const size_t k = rng() % live.size();
+			alloc.free(live[k].first, live[k].second);
+			for (uint32_t j = 0; j < live[k].second; j++)
+				owner[live[k].first + j] = -1;
+			live.erase(live.begin() + k);
+			continue;
+		}
+		const uint32_t n = size(rng);
+		if (auto offset = alloc.allocate(n))
+		{
+			ASSERT_LE(*offset + n, capacity);
+			for (uint32_t j = 0; j < n; j++)
+			{
+				ASSERT_EQ(owner[*offset + j], -1);
+				owner[*offset + j] = i;
+			}
+			live.emplace_back(*offset, n);
+		}
+	}
+	uint32_t used = 0;
+	for (const auto& range : live)
+		used += range.second;
+	EXPECT_EQ(alloc.used(), used);
+}
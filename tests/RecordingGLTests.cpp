@@ -0,0 +1,142 @@
+#include "core/GPUBuffers.hpp"
+#include "core/IndirectRenderer.hpp"
+#include "core/Shader.hpp"
+#include "ge/Cube.hpp"
+#include "support/RecordingGL.hpp"
+#include "gtest/gtest.h"
+#include <memory>
+#include <vector>
+
+namespace
+{
+	// runs without GPU, so budgets of draw submission are checked on every machine
+	struct RecordingGLFixture : ::testing::Test
+	{
+		void SetUp() override
+		{
+			gl = std::make_unique<RecordingGL>();
+			shader = std::make_unique<Shader>("./src/glsl/shader.vert", "./src/glsl/shader.frag");
+			buffers = std::make_unique<GPUBuffers>();
+			renderer = std::make_unique<IndirectRenderer>();
+		}
+
+		void TearDown() override
+		{
+			// GL objects go before backend which owns their state
+			objects.clear();
+			renderer.reset();
+			buffers.reset();
+			shader.reset();
+			gl.reset();
+		}
+
+		void add_cubes(int count)
+		{
+			for (int i = 0; i < count; i++)
+			{
+				auto cube = std::make_unique<Cube>();
+				cube->translate(glm::vec3(1.5f * i, 0.f, 0.f));
+				renderer->add_object();
+				renderer->upload((int)objects.size(), *cube);
+				objects.push_back(std::move(cube));
+			}
+		}
+
+		// frames until every region of streaming buffer has a fence, later frames do the same calls
+		void warm_up()
+		{
+			for (int i = 0; i < StreamingBuffer::frames_in_flight; i++)
+				draw_batched();
+		}
+
+		// batched part of SceneRenderer::render_scene
+		void draw_batched()
+		{
+			buffers->stream->begin_frame();
+			renderer->begin_frame();
+			for (int i = 0; i < (int)objects.size(); i++)
+				renderer->submit(i, *objects[i]);
+			renderer->draw(*shader, *buffers->stream);
+			buffers->stream->end_frame();
+		}
+
+		std::unique_ptr<RecordingGL> gl;
+		std::unique_ptr<Shader> shader;
+		std::unique_ptr<GPUBuffers> buffers;
+		std::unique_ptr<IndirectRenderer> renderer;
+		std::vector<std::unique_ptr<Object3D>> objects;
+	};
+}
+
+TEST_F(RecordingGLFixture, CountsProgramSwitchesAndUniforms)
+{
+	EXPECT_TRUE(shader->is_linked());
+	gl->reset_counters();
+	shader->bind();
+	shader->bind();
+	shader->set_matrix4f("modelMatrix", glm::mat4(1.f));
+	shader->set_bool("applyShading", true);
+	const RecordingGL::Counters& counters = gl->counters();
+	EXPECT_EQ(counters.program_switches, 1);
+	EXPECT_EQ(counters.uniform_updates, 2);
+	EXPECT_EQ(counters.uniform_lookups, 2);
+	EXPECT_EQ(gl->bound_program(), shader->id());
+}
+
+TEST_F(RecordingGLFixture, KeepsContentsOfBuffers)
+{
+	const std::vector<GLuint> data = { 1, 2, 3, 4 };
+	GLuint buffer = 0;
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GLuint) * data.size(), data.data(), GL_STATIC_DRAW);
+	EXPECT_EQ(gl->buffer_size(buffer), sizeof(GLuint) * data.size());
+	EXPECT_EQ(gl->counters().uploaded_bytes, sizeof(GLuint) * data.size());
+	const GLuint seven = 7;
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, sizeof(GLuint), sizeof(GLuint), &seven);
+	std::vector<GLuint> read(data.size());
+	glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(GLuint) * read.size(), read.data());
+	EXPECT_EQ(read, std::vector<GLuint>({ 1, 7, 3, 4 }));
+	glDeleteBuffers(1, &buffer);
+	EXPECT_EQ(gl->buffer_size(buffer), 0u);
+}
+
+TEST_F(RecordingGLFixture, StreamedObjectIsOneDrawWithoutUploads)
+{
+	Cube cube;
+	buffers->stream->begin_frame();
+	gl->reset_counters();
+	cube.render(buffers.get());
+	buffers->stream->end_frame();
+	const RecordingGL::Counters& counters = gl->counters();
+	EXPECT_EQ(counters.draw_calls, 1);
+	// vertices and indices are written into persistently mapped memory
+	EXPECT_EQ(counters.uploaded_bytes, 0u);
+	EXPECT_GT(buffers->stream->last_frame_size(), 0u);
+	EXPECT_EQ(counters.program_switches, 0);
+}
+
+TEST_F(RecordingGLFixture, BatchedDrawsDontGrowWithObjects)
+{
+	add_cubes(10);
+	warm_up();
+	gl->reset_counters();
+	draw_batched();
+	const RecordingGL::Counters small = gl->counters();
+	EXPECT_EQ(small.draw_calls, 1);
+	EXPECT_EQ(small.indirect_commands, 10);
+
+	add_cubes(490);
+	warm_up();
+	gl->reset_counters();
+	draw_batched();
+	const RecordingGL::Counters& large = gl->counters();
+	EXPECT_EQ(large.draw_calls, 1);
+	EXPECT_EQ(large.indirect_commands, 500);
+	// steady state frame only streams draw parameters, whatever the number of objects is
+	EXPECT_EQ(large.calls, small.calls);
+	EXPECT_EQ(large.uploaded_bytes, 0u);
+	EXPECT_EQ(large.uniform_updates, small.uniform_updates);
+	EXPECT_EQ(large.texture_binds, small.texture_binds);
+	EXPECT_EQ(large.program_switches, 0);
+}
@@ -0,0 +1,104 @@
+#include "core/RenderGraph.hpp"
+#include "gtest/gtest.h"
+
+// compile doesn't touch OpenGL, so these run without context
+namespace
+{
+	const RenderGraph::TextureDesc color_desc = { GL_RGB, GL_RGB, GL_UNSIGNED_BYTE };
+	const RenderGraph::TextureDesc mask_desc = { GL_R8, GL_RED, GL_UNSIGNED_BYTE };
+	const RenderGraph::TextureDesc depth_desc = { GL_DEPTH24_STENCIL8, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8 };
+}
+
+TEST(RenderGraphTests, CullsUnusedAndInactivePasses)
+{
+	RenderGraph graph;
+	const auto color = graph.create_texture("color", color_desc);
+	const auto depth = graph.create_texture("depth", depth_desc);
+	const auto unused = graph.create_texture("unused", mask_desc);
+	bool picking_requested = false;
+	const auto picking = graph.add_pass("picking", [] {}).side_effect().active_if([&] { return picking_requested; }).pass();
+	const auto scene = graph.add_pass("scene", [] {}).write(color, RenderGraph::ATTACHMENT).write(depth, RenderGraph::ATTACHMENT).pass();
+	const auto debug = graph.add_pass("debug", [] {}).read(depth, RenderGraph::SAMPLED).write(unused, RenderGraph::ATTACHMENT).pass();
+	const auto present = graph.add_pass("present", [] {}).read(color, RenderGraph::SAMPLED).write(graph.backbuffer(), RenderGraph::ATTACHMENT).pass();
+
+	graph.compile();
+	EXPECT_TRUE(graph.is_culled(picking));
+	EXPECT_FALSE(graph.is_culled(scene));
+	EXPECT_TRUE(graph.is_culled(debug));
+	EXPECT_FALSE(graph.is_culled(present));
+	EXPECT_EQ(graph.physical_index(unused), -1);
+
+	picking_requested = true;
+	graph.compile();
+	EXPECT_FALSE(graph.is_culled(picking));
+}
+
+TEST(RenderGraphTests, AliasesTransientTexturesWithDisjointLifetimes)
+{
+	RenderGraph graph;
+	const auto scene = graph.create_texture("scene", color_desc, true);
+	const auto mask = graph.create_texture("mask", mask_desc);
+	const auto blur = graph.create_texture("blur", mask_desc);
+	const auto glow = graph.create_texture("glow", mask_desc);
+	graph.add_pass("mask", [] {}).write(mask, RenderGraph::ATTACHMENT);
+	graph.add_pass("blur", [] {}).read(mask, RenderGraph::SAMPLED).write(blur, RenderGraph::ATTACHMENT);
+	// mask is dead here, glow can take its texture, but not texture of blur
+	graph.add_pass("glow", [] {}).read(blur, RenderGraph::SAMPLED).write(glow, RenderGraph::ATTACHMENT);
+	graph.add_pass("composite", [] {}).read(glow, RenderGraph::SAMPLED).write(scene, RenderGraph::ATTACHMENT);
+
+	graph.compile();
+	EXPECT_EQ(graph.physical_index(scene), 0);
+	EXPECT_NE(graph.physical_index(mask), graph.physical_index(blur));
+	EXPECT_EQ(graph.physical_index(glow), graph.physical_index(mask));
+	EXPECT_EQ(graph.physical_count(), 3);
+	// textures are kept between compiles
+	graph.compile();
+	EXPECT_EQ(graph.physical_count(), 3);
+	EXPECT_EQ(graph.physical_index(scene), 0);
+}
+
+TEST(RenderGraphTests, PlacesBarriersAfterStorageWrites)
+{
+	RenderGraph graph;
+	const auto commands = graph.import_resource("commands");
+	const auto color = graph.create_texture("color", color_desc, true);
+	const auto cull = graph.add_pass("cull", [] {}).write(commands, RenderGraph::STORAGE).pass();
+	const auto scene = graph.add_pass("scene", [] {}).read(commands, RenderGraph::INDIRECT).write(color, RenderGraph::ATTACHMENT).pass();
+	const auto shadow = graph.add_pass("shadow", [] {}).read(commands, RenderGraph::INDIRECT).write(color, RenderGraph::ATTACHMENT).pass();
+	const auto stats = graph.add_pass("stats", [] {}).read(commands, RenderGraph::STORAGE).side_effect().pass();
+	const auto present = graph.add_pass("present", [] {}).read(color, RenderGraph::SAMPLED).write(graph.backbuffer(), RenderGraph::ATTACHMENT).pass();
+
+	graph.compile();
+	EXPECT_EQ(graph.barriers(cull), 0u);
+	EXPECT_EQ(graph.barriers(scene), (GLbitfield)GL_COMMAND_BARRIER_BIT);
+	// already synchronized by previous pass
+	EXPECT_EQ(graph.barriers(shadow), 0u);
+	EXPECT_EQ(graph.barriers(stats), (GLbitfield)GL_SHADER_STORAGE_BARRIER_BIT);
+	// attachment writes need no barrier before sampling
+	EXPECT_EQ(graph.barriers(present), 0u);
+}
+
+TEST(RenderGraphTests, TextureBoundToBackbuffer)
+{
+	RenderGraph graph;
+	const auto color = graph.create_texture("color", color_desc);
+	const auto mask = graph.create_texture("mask", mask_desc);
+	bool post_processing = true;
+	const auto scene = graph.add_pass("scene", [] {}).write(color, RenderGraph::ATTACHMENT).pass();
+	const auto outline = graph.add_pass("outline", [] {}).read(mask, RenderGraph::SAMPLED).write(color, RenderGraph::ATTACHMENT).pass();
+	const auto present = graph.add_pass("present", [] {}).read(color, RenderGraph::SAMPLED).write(graph.backbuffer(), RenderGraph::ATTACHMENT)
+		.active_if([&] { return post_processing; }).pass();
+
+	graph.compile();
+	EXPECT_FALSE(graph.is_culled(scene));
+	EXPECT_GE(graph.physical_index(color), 0);
+
+	// scene is drawn straight into window, its passes stay alive without present
+	post_processing = false;
+	graph.bind_to_backbuffer(color, true);
+	graph.compile();
+	EXPECT_FALSE(graph.is_culled(scene));
+	EXPECT_FALSE(graph.is_culled(outline));
+	EXPECT_TRUE(graph.is_culled(present));
+	EXPECT_EQ(graph.physical_index(color), -1);
+}
@@ -0,0 +1,75 @@
+#include "core/RenderScaleController.hpp"
+#include "gtest/gtest.h"
+
+namespace
+{
+	// runs frames with given time until scale changes, returns number of frames or -1
+	int frames_until_change(RenderScaleController& controller, float frame_ms, int max_frames = 1000)
+	{
+		for (int i = 1; i <= max_frames; i++)
+		{
+			if (controller.update(frame_ms, frame_ms))
+				return i;
+		}
+		return -1;
+	}
+}
+
+TEST(RenderScaleControllerTests, KeepsScaleWithinBudget)
+{
+	RenderScaleController controller;
+	const float target = controller.settings().target_frame_ms;
+	EXPECT_EQ(frames_until_change(controller, target * 0.9f), -1);
+	EXPECT_EQ(controller.scale(), 1.f);
+	EXPECT_EQ(controller.render_size(glm::ivec2(1600, 900)), glm::ivec2(1600, 900));
+}
+
+TEST(RenderScaleControllerTests, LowersInStepsDownToMinimum)
+{
+	RenderScaleController controller;
+	const RenderScaleController::Settings& settings = controller.settings();
+	const float slow = settings.target_frame_ms * 2.f;
+	float expected = settings.max_scale;
+	while (expected > settings.min_scale)
+	{
+		EXPECT_GE(frames_until_change(controller, slow), settings.frames_to_lower);
+		expected -= settings.step;
+		EXPECT_FLOAT_EQ(controller.scale(), expected);
+	}
+	EXPECT_EQ(frames_until_change(controller, slow), -1);
+	EXPECT_FLOAT_EQ(controller.scale(), settings.min_scale);
+	EXPECT_EQ(controller.render_size(glm::ivec2(1600, 900)), glm::ivec2(800, 450));
+}
+
+TEST(RenderScaleControllerTests, Hysteresis)
+{
+	RenderScaleController controller;
+	const RenderScaleController::Settings& settings = controller.settings();
+	const float target = settings.target_frame_ms;
+	// single spike doesn't lower scale
+	EXPECT_FALSE(controller.update(target * 10.f, -1.f));
+	EXPECT_EQ(frames_until_change(controller, target * 0.9f, 200), -1);
+
+	ASSERT_GT(frames_until_change(controller, target * 2.f), 0);
+	const float lowered = controller.scale();
+	// frame just below budget is not enough headroom to go back up
+	EXPECT_EQ(frames_until_change(controller, target * 0.9f, 200), -1);
+	EXPECT_EQ(controller.scale(), lowered);
+	// raising takes longer than lowering
+	EXPECT_GE(frames_until_change(controller, target * 0.5f), settings.frames_to_raise);
+	EXPECT_FLOAT_EQ(controller.scale(), lowered + settings.step);
+
+	controller.reset();
+	EXPECT_EQ(controller.scale(), settings.max_scale);
+}
+
+TEST(RenderScaleControllerTests, SlowerOfCpuAndGpuCounts)
+{
+	RenderScaleController controller;
+	const float target = controller.settings().target_frame_ms;
+	bool changed = false;
+	for (int i = 0; i < 100 && !changed; i++)
+		changed = controller.update(target * 0.2f, target * 3.f);
+	EXPECT_TRUE(changed);
+	EXPECT_LT(controller.scale(), 1.f);
+}
@@ -0,0 +1,131 @@
+#include "core/SceneRenderer.hpp"
+#include "support/RecordingGL.hpp"
+#include "gtest/gtest.h"
+#include <memory>
+#include <string>
+
+// friend of SceneRenderer, runs whole frames on recording backend, so budgets of render_scene and other passes
+// are checked without GPU. TEST_F bodies are subclasses, they reach renderer through members of fixture
+struct SceneRendererFixture : ::testing::Test
+{
+	void SetUp() override
+	{
+		LaunchOptions& options = SceneRenderer::launch_options();
+		saved_options = options;
+		options.headless = true;
+		options.external_gl = true;
+		options.width = 320;
+		options.height = 180;
+		options.mesh_cache.clear();
+		gl = std::make_unique<RecordingGL>();
+	}
+
+	void TearDown() override
+	{
+		// GL objects of scene go before backend which owns their state
+		scene.reset();
+		gl.reset();
+		SceneRenderer::launch_options() = saved_options;
+	}
+
+	void create_scene(const std::string& items)
+	{
+		scene.reset();
+		SceneRenderer::launch_options().scene = items;
+		scene.reset(new SceneRenderer());
+		scene->prepare_render();
+	}
+
+	// frames until every region of streaming buffer has a fence and static geometry is uploaded,
+	// later frames of unchanged scene do the same calls
+	void warm_up()
+	{
+		for (int i = 0; i < StreamingBuffer::frames_in_flight + 1; i++)
+			scene->render_frame();
+	}
+
+	void render_frame() { scene->render_frame(); }
+	const SceneRenderer::RenderStats& stats() const { return scene->m_stats; }
+	int object_count() const { return (int)scene->m_drawables.size(); }
+	Object3D& object(int index) { return *scene->m_drawables[index]; }
+	void set_gpu_culling(bool enable) { scene->m_gpu_culling = enable; }
+	// object is drawn by compute culling instead of render_scene
+	bool is_gpu_static(int index) const { return index < (int)scene->m_gpu_static.size() && scene->m_gpu_static[index]; }
+	GPUPicker& picker() { return *scene->m_gpu_picker; }
+	void remove_object(int index) { scene->remove_object(index); }
+
+	LaunchOptions saved_options;
+	std::unique_ptr<RecordingGL> gl;
+	std::unique_ptr<SceneRenderer> scene;
+};
+
+TEST_F(SceneRendererFixture, StaticSceneFrameBudget)
+{
+	create_scene("cubes:100");
+	warm_up();
+	gl->reset_counters();
+	render_frame();
+	const RecordingGL::Counters small = gl->counters();
+	// one multi draw of batched scene in render_scene and skybox
+	EXPECT_EQ(small.draw_calls, 2);
+	EXPECT_EQ(stats().multi_draw_calls, 1);
+	EXPECT_EQ(small.indirect_commands, stats().objects_batched);
+	EXPECT_GT(stats().objects_batched, 0);
+	EXPECT_EQ(small.uploaded_bytes, 0u);
+	EXPECT_EQ(small.readbacks, 0);
+
+	// four times more cubes, frame does the same calls
+	create_scene("cubes:400");
+	warm_up();
+	gl->reset_counters();
+	render_frame();
+	const RecordingGL::Counters& large = gl->counters();
+	EXPECT_EQ(large.draw_calls, 2);
+	EXPECT_EQ(large.indirect_commands, stats().objects_batched);
+	EXPECT_GT(large.indirect_commands, small.indirect_commands);
+	EXPECT_EQ(large.calls, small.calls);
+	EXPECT_EQ(large.uploaded_bytes, 0u);
+	EXPECT_EQ(large.program_switches, small.program_switches);
+	EXPECT_EQ(large.uniform_updates, small.uniform_updates);
+	EXPECT_EQ(large.texture_binds, small.texture_binds);
+}
+
+TEST_F(SceneRendererFixture, RotatingObjectLeavesGpuCulledContent)
+{
+	create_scene("cubes:16");
+	set_gpu_culling(true);
+	warm_up();
+	ASSERT_TRUE(is_gpu_static(0));
+	const int gpu_draws = stats().gpu_culled_draws;
+
+	// static object starts rotating, from the same frame it's drawn on CPU with its new transform
+	object(0).rotating(true);
+	render_frame();
+	EXPECT_FALSE(is_gpu_static(0));
+	EXPECT_EQ(stats().gpu_culled_draws, gpu_draws - 1);
+	render_frame();
+	EXPECT_FALSE(is_gpu_static(0));
+
+	object(0).rotating(false);
+	render_frame();
+	EXPECT_TRUE(is_gpu_static(0));
+	EXPECT_EQ(stats().gpu_culled_draws, gpu_draws);
+}
+
+TEST_F(SceneRendererFixture, RemovedObjectDropsPickInFlight)
+{
+	create_scene("cubes:4");
+	warm_up();
+	picker().request(160, 90);
+	render_frame();
+	ASSERT_FALSE(picker().has_request());
+	ASSERT_TRUE(picker().busy());
+
+	// ids read back refer to objects before removal, query is rendered again instead
+	remove_object(0);
+	EXPECT_TRUE(picker().has_request());
+	EXPECT_FALSE(picker().poll().has_value());
+	render_frame();
+	EXPECT_FALSE(picker().has_request());
+	EXPECT_TRUE(picker().poll().has_value());
+}
@@ -0,0 +1,63 @@
+#include "core/Tracer.hpp"
+#include "gtest/gtest.h"
+#include <sstream>
+#include <thread>
+
+namespace
+{
+	int count(const std::string& str, const std::string& what)
+	{
+		int n = 0;
+		for (size_t pos = str.find(what); pos != std::string::npos; pos = str.find(what, pos + 1))
+			n++;
+		return n;
+	}
+
+	std::string export_trace()
+	{
+		std::ostringstream os;
+		Tracer::write_chrome_trace(os);
+		return os.str();
+	}
+}
+
+TEST(TracerTests, ExportsZonesOfEveryThread)
+{
+	Tracer::clear();
+	Tracer::set_thread_name("tests \"main\"");
+	{
+		Tracer::Zone outer("outer zone");
+		Tracer::Zone inner("inner zone");
+	}
+	std::thread worker([]()
+		{
+			Tracer::set_thread_name("worker");
+			for (int i = 0; i < 3; i++)
+				Tracer::Zone zone("worker zone");
+		});
+	worker.join();
+	const std::string json = export_trace();
+	EXPECT_EQ(json.rfind("{\"traceEvents\":[", 0), 0);
+	EXPECT_EQ(count(json, "\"name\":\"outer zone\",\"ph\":\"X\""), 1);
+	EXPECT_EQ(count(json, "\"name\":\"inner zone\",\"ph\":\"X\""), 1);
+	// zones of finished thread are kept
+	EXPECT_EQ(count(json, "\"name\":\"worker zone\",\"ph\":\"X\""), 3);
+	EXPECT_EQ(count(json, "\"args\":{\"name\":\"worker\"}"), 1);
+	EXPECT_EQ(count(json, "\"args\":{\"name\":\"tests \\\"main\\\"\"}"), 1);
+	Tracer::clear();
+	EXPECT_EQ(count(export_trace(), "\"ph\":\"X\""), 0);
+}
+
+TEST(TracerTests, KeepsLastZonesOfThread)
+{
+	Tracer::clear();
+	const int64_t now = Tracer::now();
+	Tracer::record("old", now, now + 1000);
+	// one slot of ring is the one being written
+	for (uint32_t i = 0; i < Tracer::events_per_thread - 1; i++)
+		Tracer::record("new", now + 2000, now + 3000);
+	const std::string json = export_trace();
+	EXPECT_EQ(count(json, "\"name\":\"old\""), 0);
+	EXPECT_EQ(count(json, "\"name\":\"new\""), (int)Tracer::events_per_thread - 1);
+	Tracer::clear();
+}
@@ -0,0 +1,24 @@
+#include "HeadlessContext.hpp"
+#include "core/MainWindow.hpp"
+#include <GLFW/glfw3.h>
+
+HeadlessContext::HeadlessContext(const char* name)
+{
+  glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+  if (!glfwInit())
+    return;
+  try
+  {
+    m_window = std::make_unique<MainWindow>(64, 64, name, true);
+  }
+  catch (const ContextError&)
+  {
+    // GLFW is terminated by failed window
+  }
+}
+
+HeadlessContext::~HeadlessContext()
+{
+  // terminates GLFW
+  m_window.reset();
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <memory>
+
+class MainWindow;
+
+// OpenGL context of GL tests, created as in headless mode: surfaceless EGL or OSMesa on null GLFW platform, so
+// software rasterizer (Mesa llvmpipe) runs tests without display. Suites create it in SetUpTestSuite and skip
+// their tests when it isn't available, i.e. on machines without OpenGL 4.4.
+// Owns GLFW, which is initialized by constructor and terminated by destructor.
+class HeadlessContext
+{
+public:
+  explicit HeadlessContext(const char* name);
+  ~HeadlessContext();
+  HeadlessContext(const HeadlessContext&) = delete;
+  HeadlessContext& operator=(const HeadlessContext&) = delete;
+  bool available() const { return m_window != nullptr; }
+private:
+  std::unique_ptr<MainWindow> m_window;
+};
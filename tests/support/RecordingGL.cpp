@@ -0,0 +1,376 @@
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+#include "RecordingGL.hpp"
+
+// every GL function engine calls. function missing here stays as it was loaded (or null without context)
+#define RECORDING_GL_FUNCTIONS(X) \
+  X(ActiveTexture) X(AttachShader) X(BeginQuery) X(BindBuffer) X(BindBufferBase) X(BindBufferRange) \
+  X(BindFramebuffer) X(BindRenderbuffer) X(BindTexture) X(BindVertexArray) X(BlendFunc) X(BufferData) \
+  X(BufferStorage) X(BufferSubData) X(CheckFramebufferStatus) X(Clear) X(ClearBufferData) X(ClearBufferuiv) \
+  X(ClearColor) X(ClientWaitSync) X(CompileShader) X(CopyBufferSubData) X(CreateProgram) X(CreateShader) \
+  X(DeleteBuffers) X(DeleteFramebuffers) X(DeleteProgram) X(DeleteQueries) X(DeleteRenderbuffers) \
+  X(DeleteShader) X(DeleteSync) X(DeleteTextures) X(DeleteVertexArrays) X(DepthFunc) X(Disable) \
+  X(DispatchCompute) X(DrawArrays) X(DrawBuffers) X(DrawElementsBaseVertex) X(Enable) \
+  X(EnableVertexAttribArray) X(EndQuery) X(FenceSync) X(FramebufferRenderbuffer) X(FramebufferTexture2D) \
+  X(GenBuffers) X(GenFramebuffers) X(GenQueries) X(GenRenderbuffers) X(GenTextures) X(GenVertexArrays) \
+  X(GenerateMipmap) X(GetBufferSubData) X(GetError) X(GetIntegerv) X(GetProgramiv) X(GetQueryObjectiv) \
+  X(GetQueryObjectui64v) X(GetString) X(GetUniformLocation) X(LinkProgram) X(MapBufferRange) \
+  X(MemoryBarrier) X(MultiDrawElementsIndirect) X(PixelStorei) X(PolygonMode) X(QueryCounter) X(ReadBuffer) \
+  X(ReadPixels) X(RenderbufferStorage) X(Scissor) X(ShaderSource) X(TexImage2D) X(TexParameteri) \
+  X(Uniform1f) X(Uniform1i) X(Uniform1ui) X(Uniform2fv) X(Uniform3fv) X(Uniform4fv) X(UniformMatrix4fv) \
+  X(UnmapBuffer) X(UseProgram) X(VertexAttribDivisor) X(VertexAttribIPointer) X(VertexAttribPointer) X(Viewport)
+
+struct RecordingGL::Functions
+{
+#define X(name) decltype(glad_gl##name) name;
+  RECORDING_GL_FUNCTIONS(X)
+#undef X
+};
+
+RecordingGL* RecordingGL::s_current = nullptr;
+
+// bytes of one pixel of tightly packed client data
+static size_t pixel_size(GLenum format, GLenum type)
+{
+  size_t components = 4;
+  switch (format)
+  {
+  case GL_RED: case GL_RED_INTEGER: case GL_DEPTH_COMPONENT: components = 1; break;
+  case GL_RG: case GL_RG_INTEGER: components = 2; break;
+  case GL_RGB: case GL_BGR: case GL_RGB_INTEGER: components = 3; break;
+  }
+  switch (type)
+  {
+  case GL_UNSIGNED_BYTE: case GL_BYTE: return components;
+  case GL_UNSIGNED_SHORT: case GL_SHORT: case GL_HALF_FLOAT: return components * 2;
+  default: return components * 4;
+  }
+}
+
+struct RecordingGLCalls
+{
+  static RecordingGL& gl()
+  {
+    assert(RecordingGL::s_current);
+    RecordingGL& gl = *RecordingGL::s_current;
+    gl.m_counters.calls++;
+    return gl;
+  }
+
+  static GLuint bound_buffer(RecordingGL& gl, GLenum target)
+  {
+    auto it = gl.m_bound_buffers.find(target);
+    return it == gl.m_bound_buffers.end() ? 0 : it->second;
+  }
+
+  // storage of buffer bound to target, null if there is none
+  static std::vector<uint8_t>* bound_storage(RecordingGL& gl, GLenum target)
+  {
+    auto it = gl.m_buffers.find(bound_buffer(gl, target));
+    return it == gl.m_buffers.end() ? nullptr : &it->second;
+  }
+
+  static void gen_names(RecordingGL& gl, GLsizei n, GLuint* names)
+  {
+    for (GLsizei i = 0; i < n; i++)
+      names[i] = gl.m_next_name++;
+  }
+
+  static void allocate_storage(RecordingGL& gl, GLenum target, GLsizeiptr size, const void* data)
+  {
+    std::vector<uint8_t>* storage = bound_storage(gl, target);
+    if (!storage)
+      return;
+    storage->assign(size, 0);
+    if (data)
+    {
+      memcpy(storage->data(), data, size);
+      gl.m_counters.uploaded_bytes += size;
+    }
+  }
+
+  // objects
+  static void APIENTRY GenBuffers(GLsizei n, GLuint* buffers)
+  {
+    RecordingGL& g = gl();
+    gen_names(g, n, buffers);
+    for (GLsizei i = 0; i < n; i++)
+      g.m_buffers[buffers[i]];
+  }
+  static void APIENTRY DeleteBuffers(GLsizei n, const GLuint* buffers)
+  {
+    RecordingGL& g = gl();
+    for (GLsizei i = 0; i < n; i++)
+    {
+      g.m_buffers.erase(buffers[i]);
+      for (auto& [target, buffer] : g.m_bound_buffers)
+      {
+        if (buffer == buffers[i])
+          buffer = 0;
+      }
+    }
+  }
+  static void APIENTRY GenFramebuffers(GLsizei n, GLuint* names) { gen_names(gl(), n, names); }
+  static void APIENTRY GenQueries(GLsizei n, GLuint* names) { gen_names(gl(), n, names); }
+  static void APIENTRY GenRenderbuffers(GLsizei n, GLuint* names) { gen_names(gl(), n, names); }
+  static void APIENTRY GenTextures(GLsizei n, GLuint* names) { gen_names(gl(), n, names); }
+  static void APIENTRY GenVertexArrays(GLsizei n, GLuint* names) { gen_names(gl(), n, names); }
+  static void APIENTRY DeleteFramebuffers(GLsizei, const GLuint*) { gl(); }
+  static void APIENTRY DeleteQueries(GLsizei, const GLuint*) { gl(); }
+  static void APIENTRY DeleteRenderbuffers(GLsizei, const GLuint*) { gl(); }
+  static void APIENTRY DeleteTextures(GLsizei, const GLuint*) { gl(); }
+  static void APIENTRY DeleteVertexArrays(GLsizei, const GLuint*) { gl(); }
+
+  // buffers
+  static void APIENTRY BindBuffer(GLenum target, GLuint buffer)
+  {
+    RecordingGL& g = gl();
+    g.m_counters.buffer_binds++;
+    g.m_bound_buffers[target] = buffer;
+  }
+  static void APIENTRY BindBufferBase(GLenum target, GLuint, GLuint buffer) { BindBuffer(target, buffer); }
+  static void APIENTRY BindBufferRange(GLenum target, GLuint, GLuint buffer, GLintptr, GLsizeiptr) { BindBuffer(target, buffer); }
+  static void APIENTRY BufferData(GLenum target, GLsizeiptr size, const void* data, GLenum) { allocate_storage(gl(), target, size, data); }
+  static void APIENTRY BufferStorage(GLenum target, GLsizeiptr size, const void* data, GLbitfield) { allocate_storage(gl(), target, size, data); }
+  static void APIENTRY BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data)
+  {
+    RecordingGL& g = gl();
+    std::vector<uint8_t>* storage = bound_storage(g, target);
+    if (!storage || offset + size > (GLintptr)storage->size())
+      return;
+    memcpy(storage->data() + offset, data, size);
+    g.m_counters.uploaded_bytes += size;
+  }
+  static void APIENTRY GetBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, void* data)
+  {
+    RecordingGL& g = gl();
+    g.m_counters.readbacks++;
+    std::vector<uint8_t>* storage = bound_storage(g, target);
+    if (storage && offset + size <= (GLintptr)storage->size())
+      memcpy(data, storage->data() + offset, size);
+  }
+  static void APIENTRY CopyBufferSubData(GLenum read_target, GLenum write_target, GLintptr read_offset, GLintptr write_offset, GLsizeiptr size)
+  {
+    RecordingGL& g = gl();
+    std::vector<uint8_t>* src = bound_storage(g, read_target);
+    std::vector<uint8_t>* dst = bound_storage(g, write_target);
+    if (src && dst && read_offset + size <= (GLintptr)src->size() && write_offset + size <= (GLintptr)dst->size())
+      memmove(dst->data() + write_offset, src->data() + read_offset, size);
+  }
+  static void APIENTRY ClearBufferData(GLenum target, GLenum, GLenum format, GLenum type, const void* data)
+  {
+    RecordingGL& g = gl();
+    std::vector<uint8_t>* storage = bound_storage(g, target);
+    if (!storage)
+      return;
+    const size_t element = pixel_size(format, type);
+    for (size_t offset = 0; offset + element <= storage->size(); offset += element)
+    {
+      if (data)
+        memcpy(storage->data() + offset, data, element);
+      else
+        memset(storage->data() + offset, 0, element);
+    }
+  }
+  static void* APIENTRY MapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield)
+  {
+    RecordingGL& g = gl();
+    std::vector<uint8_t>* storage = bound_storage(g, target);
+    if (!storage || offset + length > (GLintptr)storage->size())
+      return nullptr;
+    return storage->data() + offset;
+  }
+  static GLboolean APIENTRY UnmapBuffer(GLenum) { gl(); return GL_TRUE; }
+
+  // vertex arrays
+  static void APIENTRY BindVertexArray(GLuint) { gl().m_counters.vertex_array_binds++; }
+  static void APIENTRY EnableVertexAttribArray(GLuint) { gl(); }
+  static void APIENTRY VertexAttribDivisor(GLuint, GLuint) { gl(); }
+  static void APIENTRY VertexAttribIPointer(GLuint, GLint, GLenum, GLsizei, const void*) { gl(); }
+  static void APIENTRY VertexAttribPointer(GLuint, GLint, GLenum, GLboolean, GLsizei, const void*) { gl(); }
+
+  // textures and framebuffers
+  static void APIENTRY ActiveTexture(GLenum) { gl().m_counters.state_changes++; }
+  static void APIENTRY BindTexture(GLenum, GLuint) { gl().m_counters.texture_binds++; }
+  static void APIENTRY TexImage2D(GLenum, GLint, GLint, GLsizei width, GLsizei height, GLint, GLenum format, GLenum type, const void* pixels)
+  {
+    RecordingGL& g = gl();
+    if (pixels && !bound_buffer(g, GL_PIXEL_UNPACK_BUFFER))
+      g.m_counters.uploaded_bytes += (uint64_t)width * height * pixel_size(format, type);
+  }
+  static void APIENTRY TexParameteri(GLenum, GLenum, GLint) { gl(); }
+  static void APIENTRY GenerateMipmap(GLenum) { gl(); }
+  static void APIENTRY PixelStorei(GLenum, GLint) { gl(); }
+  static void APIENTRY BindFramebuffer(GLenum, GLuint framebuffer)
+  {
+    RecordingGL& g = gl();
+    g.m_counters.framebuffer_binds++;
+    g.m_framebuffer = framebuffer;
+  }
+  static void APIENTRY BindRenderbuffer(GLenum, GLuint) { gl(); }
+  static void APIENTRY RenderbufferStorage(GLenum, GLenum, GLsizei, GLsizei) { gl(); }
+  static void APIENTRY FramebufferRenderbuffer(GLenum, GLenum, GLenum, GLuint) { gl(); }
+  static void APIENTRY FramebufferTexture2D(GLenum, GLenum, GLenum, GLuint, GLint) { gl(); }
+  static GLenum APIENTRY CheckFramebufferStatus(GLenum) { gl(); return GL_FRAMEBUFFER_COMPLETE; }
+  static void APIENTRY DrawBuffers(GLsizei, const GLenum*) { gl(); }
+  static void APIENTRY ReadBuffer(GLenum) { gl(); }
+  static void APIENTRY ReadPixels(GLint, GLint, GLsizei width, GLsizei height, GLenum format, GLenum type, void* pixels)
+  {
+    RecordingGL& g = gl();
+    g.m_counters.readbacks++;
+    const size_t size = (size_t)width * height * pixel_size(format, type);
+    // into pixel pack buffer pointer is offset
+    if (bound_buffer(g, GL_PIXEL_PACK_BUFFER))
+    {
+      std::vector<uint8_t>* storage = bound_storage(g, GL_PIXEL_PACK_BUFFER);
+      const size_t offset = (size_t)pixels;
+      if (storage && offset + size <= storage->size())
+        memset(storage->data() + offset, 0, size);
+    }
+    else if (pixels)
+      memset(pixels, 0, size);
+  }
+
+  // state
+  static void APIENTRY Enable(GLenum) { gl().m_counters.state_changes++; }
+  static void APIENTRY Disable(GLenum) { gl().m_counters.state_changes++; }
+  static void APIENTRY BlendFunc(GLenum, GLenum) { gl().m_counters.state_changes++; }
+  static void APIENTRY DepthFunc(GLenum) { gl().m_counters.state_changes++; }
+  static void APIENTRY PolygonMode(GLenum, GLenum mode)
+  {
+    RecordingGL& g = gl();
+    g.m_counters.state_changes++;
+    g.m_polygon_mode = mode;
+  }
+  static void APIENTRY Viewport(GLint x, GLint y, GLsizei width, GLsizei height)
+  {
+    RecordingGL& g = gl();
+    g.m_counters.state_changes++;
+    g.m_viewport[0] = x, g.m_viewport[1] = y, g.m_viewport[2] = width, g.m_viewport[3] = height;
+  }
+  static void APIENTRY Scissor(GLint, GLint, GLsizei, GLsizei) { gl().m_counters.state_changes++; }
+  static void APIENTRY ClearColor(GLfloat, GLfloat, GLfloat, GLfloat) { gl().m_counters.state_changes++; }
+  static void APIENTRY Clear(GLbitfield) { gl(); }
+  static void APIENTRY ClearBufferuiv(GLenum, GLint, const GLuint*) { gl(); }
+  static void APIENTRY MemoryBarrier(GLbitfield) { gl(); }
+
+  // shaders
+  static GLuint APIENTRY CreateShader(GLenum) { return gl().m_next_name++; }
+  static GLuint APIENTRY CreateProgram() { return gl().m_next_name++; }
+  static void APIENTRY ShaderSource(GLuint, GLsizei, const GLchar* const*, const GLint*) { gl(); }
+  static void APIENTRY CompileShader(GLuint) { gl(); }
+  static void APIENTRY AttachShader(GLuint, GLuint) { gl(); }
+  static void APIENTRY LinkProgram(GLuint) { gl(); }
+  static void APIENTRY DeleteShader(GLuint) { gl(); }
+  static void APIENTRY DeleteProgram(GLuint program)
+  {
+    RecordingGL& g = gl();
+    if (g.m_program == program)
+      g.m_program = 0;
+  }
+  static void APIENTRY GetProgramiv(GLuint, GLenum pname, GLint* params)
+  {
+    gl();
+    *params = pname == GL_LINK_STATUS ? GL_TRUE : 0;
+  }
+  static void APIENTRY UseProgram(GLuint program)
+  {
+    RecordingGL& g = gl();
+    if (g.m_program != program)
+      g.m_counters.program_switches++;
+    g.m_program = program;
+  }
+  // same name has the same location in every program
+  static GLint APIENTRY GetUniformLocation(GLuint, const GLchar* name)
+  {
+    RecordingGL& g = gl();
+    g.m_counters.uniform_lookups++;
+    return g.m_uniform_locations.emplace(name, (GLint)g.m_uniform_locations.size()).first->second;
+  }
+  static void APIENTRY Uniform1f(GLint, GLfloat) { gl().m_counters.uniform_updates++; }
+  static void APIENTRY Uniform1i(GLint, GLint) { gl().m_counters.uniform_updates++; }
+  static void APIENTRY Uniform1ui(GLint, GLuint) { gl().m_counters.uniform_updates++; }
+  static void APIENTRY Uniform2fv(GLint, GLsizei, const GLfloat*) { gl().m_counters.uniform_updates++; }
+  static void APIENTRY Uniform3fv(GLint, GLsizei, const GLfloat*) { gl().m_counters.uniform_updates++; }
+  static void APIENTRY Uniform4fv(GLint, GLsizei, const GLfloat*) { gl().m_counters.uniform_updates++; }
+  static void APIENTRY UniformMatrix4fv(GLint, GLsizei, GLboolean, const GLfloat*) { gl().m_counters.uniform_updates++; }
+
+  // draws
+  static void APIENTRY DrawArrays(GLenum, GLint, GLsizei) { gl().m_counters.draw_calls++; }
+  static void APIENTRY DrawElementsBaseVertex(GLenum, GLsizei, GLenum, const void*, GLint) { gl().m_counters.draw_calls++; }
+  static void APIENTRY MultiDrawElementsIndirect(GLenum, GLenum, const void*, GLsizei drawcount, GLsizei)
+  {
+    RecordingGL& g = gl();
+    g.m_counters.draw_calls++;
+    g.m_counters.indirect_commands += drawcount;
+  }
+  static void APIENTRY DispatchCompute(GLuint, GLuint, GLuint) { gl().m_counters.compute_dispatches++; }
+
+  // synchronization and queries
+  static GLsync APIENTRY FenceSync(GLenum, GLbitfield) { return reinterpret_cast<GLsync>(gl().m_next_sync++); }
+  static GLenum APIENTRY ClientWaitSync(GLsync, GLbitfield, GLuint64) { gl(); return GL_ALREADY_SIGNALED; }
+  static void APIENTRY DeleteSync(GLsync) { gl(); }
+  static void APIENTRY BeginQuery(GLenum, GLuint) { gl(); }
+  static void APIENTRY EndQuery(GLenum) { gl(); }
+  static void APIENTRY QueryCounter(GLuint, GLenum) { gl(); }
+  static void APIENTRY GetQueryObjectiv(GLuint, GLenum pname, GLint* params)
+  {
+    gl();
+    *params = pname == GL_QUERY_RESULT_AVAILABLE ? GL_TRUE : 0;
+  }
+  static void APIENTRY GetQueryObjectui64v(GLuint, GLenum, GLuint64* params) { gl(); *params = 0; }
+
+  // queries of state
+  static GLenum APIENTRY GetError() { gl(); return GL_NO_ERROR; }
+  static const GLubyte* APIENTRY GetString(GLenum)
+  {
+    gl();
+    return reinterpret_cast<const GLubyte*>("RecordingGL");
+  }
+  static void APIENTRY GetIntegerv(GLenum pname, GLint* data)
+  {
+    RecordingGL& g = gl();
+    switch (pname)
+    {
+    case GL_MAJOR_VERSION: *data = 4; break;
+    case GL_MINOR_VERSION: *data = 4; break;
+    case GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT: *data = 16; break;
+    case GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT: *data = 256; break;
+    case GL_FRAMEBUFFER_BINDING: *data = (GLint)g.m_framebuffer; break;
+    case GL_CURRENT_PROGRAM: *data = (GLint)g.m_program; break;
+    case GL_POLYGON_MODE: data[0] = data[1] = (GLint)g.m_polygon_mode; break;
+    case GL_VIEWPORT: std::copy_n(g.m_viewport, 4, data); break;
+    default: *data = 0; break;
+    }
+  }
+};
+
+RecordingGL::RecordingGL() : m_saved(std::make_unique<Functions>())
+{
+  assert(!s_current && "only one recording backend can be installed");
+  s_current = this;
+#define X(name) m_saved->name = glad_gl##name; glad_gl##name = &RecordingGLCalls::name;
+  RECORDING_GL_FUNCTIONS(X)
+#undef X
+}
+
+RecordingGL::~RecordingGL()
+{
+#define X(name) glad_gl##name = m_saved->name;
+  RECORDING_GL_FUNCTIONS(X)
+#undef X
+  s_current = nullptr;
+}
+
+size_t RecordingGL::buffer_size(GLuint buffer) const
+{
+  auto it = m_buffers.find(buffer);
+  return it == m_buffers.end() ? 0 : it->second.size();
+}
+
+const uint8_t* RecordingGL::buffer_data(GLuint buffer) const
+{
+  auto it = m_buffers.find(buffer);
+  return it == m_buffers.end() ? nullptr : it->second.data();
+}
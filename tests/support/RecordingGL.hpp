@@ -0,0 +1,68 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <glad/glad.h>
+
+// GL backend without GPU for tests and budgets of rendering code. Engine calls GL through function pointers
+// loaded by glad, while this object exists they point to functions which count calls and keep only state needed
+// to answer queries: object names, contents of buffers (mapped ranges point into them), bindings and uniform
+// locations. Shaders always compile, fences are signaled and queries return zero.
+// One backend can be installed at a time. Previous pointers (driver or null) are restored by destructor,
+// so GL objects created while it's installed must be destroyed before it.
+class RecordingGL
+{
+public:
+  struct Counters
+  {
+    int calls = 0;                  // all GL calls
+    int draw_calls = 0;             // glDraw* and glMultiDraw*, multi draw is one call
+    int indirect_commands = 0;      // commands executed by multi draws
+    int compute_dispatches = 0;
+    int program_switches = 0;       // glUseProgram which changed bound program
+    int uniform_updates = 0;        // glUniform*
+    int uniform_lookups = 0;        // glGetUniformLocation
+    int texture_binds = 0;
+    int buffer_binds = 0;           // glBindBuffer, glBindBufferBase and glBindBufferRange
+    int vertex_array_binds = 0;
+    int framebuffer_binds = 0;
+    int state_changes = 0;          // capabilities, depth and blend functions, polygon mode, viewport ...
+    uint64_t uploaded_bytes = 0;    // data passed to glBufferData, glBufferSubData, glBufferStorage and glTexImage2D
+    int readbacks = 0;              // glReadPixels and glGetBufferSubData
+  };
+public:
+  RecordingGL();
+  ~RecordingGL();
+  RecordingGL(const RecordingGL&) = delete;
+  RecordingGL& operator=(const RecordingGL&) = delete;
+  // installed backend, null if there is none
+  static RecordingGL* current() { return s_current; }
+  const Counters& counters() const { return m_counters; }
+  // counters only, objects stay alive. e.g. called before frame whose budget is checked
+  void reset_counters() { m_counters = Counters(); }
+  // bytes of buffer storage, 0 for unknown buffer
+  size_t buffer_size(GLuint buffer) const;
+  const uint8_t* buffer_data(GLuint buffer) const;
+  int live_buffers() const { return (int)m_buffers.size(); }
+  GLuint bound_program() const { return m_program; }
+private:
+  struct Functions;
+  // implementations of GL functions, defined in translation unit, work with installed backend
+  friend struct RecordingGLCalls;
+private:
+  static RecordingGL* s_current;
+  std::unique_ptr<Functions> m_saved;  // pointers replaced by this backend
+  Counters m_counters;
+  GLuint m_next_name = 1;
+  uintptr_t m_next_sync = 1;
+  std::map<GLuint, std::vector<uint8_t>> m_buffers;
+  std::map<GLenum, GLuint> m_bound_buffers;  // by target
+  std::map<std::string, GLint> m_uniform_locations;
+  GLuint m_program = 0;
+  GLuint m_framebuffer = 0;
+  GLenum m_polygon_mode = GL_FILL;
+  GLint m_viewport[4] = {};
+};